@@ -0,0 +1,88 @@
+#include "BitmapPointAgeIndex.h"
+#include "Algo/BinarySearch.h"
+
+FBitmapPointAgeIndex::FBitmapPointAgeIndex(float InBucketSeconds)
+	: BucketSeconds(FMath::Max(InBucketSeconds, KINDA_SMALL_NUMBER))
+	, NumEntries(0)
+{
+}
+
+void FBitmapPointAgeIndex::Add(int32 Id, float Timestamp)
+{
+	const int64 Key = ToKey(Timestamp);
+
+	// Appends land in the newest bucket, only late or refreshed points need a search
+	int32 BucketIndex = Buckets.Num() - 1;
+	if (Buckets.Num() == 0 || Buckets.Last().Key < Key)
+	{
+		BucketIndex = Buckets.AddDefaulted();
+		Buckets[BucketIndex].Key = Key;
+	}
+	else if (Buckets.Last().Key > Key)
+	{
+		BucketIndex = Algo::LowerBoundBy(Buckets, Key, &FBucket::Key);
+		if (Buckets[BucketIndex].Key != Key)
+		{
+			Buckets.InsertDefaulted(BucketIndex);
+			Buckets[BucketIndex].Key = Key;
+		}
+	}
+
+	Buckets[BucketIndex].Ids.Add(Id);
+	Buckets[BucketIndex].Timestamps.Add(Timestamp);
+	NumEntries++;
+}
+
+int32 FBitmapPointAgeIndex::PopOlderThan(float OldestAllowedTime, TArray<int32>& OutIds)
+{
+	const int32 NumBefore = OutIds.Num();
+	const int64 CutKey = ToKey(OldestAllowedTime);
+
+	// Every bucket before the cut bucket is entirely expired
+	const int32 NumExpired = Algo::LowerBoundBy(Buckets, CutKey, &FBucket::Key);
+	for (int32 BucketIndex = 0; BucketIndex < NumExpired; BucketIndex++)
+	{
+		OutIds.Append(Buckets[BucketIndex].Ids);
+		NumEntries -= Buckets[BucketIndex].Ids.Num();
+	}
+	Buckets.RemoveAt(0, NumExpired, false);
+
+	// The cut bucket straddles the limit, only it needs a per-entry test
+	if (Buckets.Num() > 0 && Buckets[0].Key == CutKey)
+	{
+		FBucket& Bucket = Buckets[0];
+		for (int32 Entry = Bucket.Ids.Num() - 1; Entry >= 0; Entry--)
+		{
+			if (Bucket.Timestamps[Entry] < OldestAllowedTime)
+			{
+				OutIds.Add(Bucket.Ids[Entry]);
+				Bucket.Ids.RemoveAtSwap(Entry, 1, false);
+				Bucket.Timestamps.RemoveAtSwap(Entry, 1, false);
+				NumEntries--;
+			}
+		}
+
+		if (Bucket.Ids.Num() == 0)
+		{
+			Buckets.RemoveAt(0, 1, false);
+		}
+	}
+
+	return OutIds.Num() - NumBefore;
+}
+
+void FBitmapPointAgeIndex::Reset()
+{
+	Buckets.Empty();
+	NumEntries = 0;
+}
+
+SIZE_T FBitmapPointAgeIndex::GetAllocatedSize() const
+{
+	SIZE_T AllocatedSize = Buckets.GetAllocatedSize();
+	for (const FBucket& Bucket : Buckets)
+	{
+		AllocatedSize += Bucket.Ids.GetAllocatedSize() + Bucket.Timestamps.GetAllocatedSize();
+	}
+	return AllocatedSize;
+}
@@ -0,0 +1,176 @@
+#include "BitmapPointChunkGrid.h"
+#include "Algo/BinarySearch.h"
+
+FBitmapPointChunkGrid::FBitmapPointChunkGrid(float InChunkSize)
+	: ChunkSize(FMath::Max(InChunkSize, 1.0f))
+	, InfluenceMargin(0.0f)
+	, Version(1)
+{
+}
+
+void FBitmapPointChunkGrid::SetChunkSize(float InChunkSize)
+{
+	ChunkSize = FMath::Max(InChunkSize, 1.0f);
+	InfluenceMargin = FMath::Min(InfluenceMargin, ChunkSize * 0.5f);
+	Chunks.Empty();
+	ChangeLog.Empty();
+	Version++;
+}
+
+void FBitmapPointChunkGrid::RequireInfluenceMargin(float Margin)
+{
+	// Past half a chunk a point would have to mark chunks beyond its direct neighbours
+	InfluenceMargin = FMath::Clamp(FMath::Max(InfluenceMargin, Margin), 0.0f, ChunkSize * 0.5f);
+}
+
+FIntVector FBitmapPointChunkGrid::GetChunkKey(const FVector& Position) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Position.X / ChunkSize),
+		FMath::FloorToInt(Position.Y / ChunkSize),
+		FMath::FloorToInt(Position.Z / ChunkSize));
+}
+
+FBox FBitmapPointChunkGrid::GetChunkBounds(const FIntVector& Key) const
+{
+	const FVector Min = FVector(Key) * ChunkSize;
+	return FBox(Min, Min + FVector(ChunkSize));
+}
+
+void FBitmapPointChunkGrid::AddPoint(const FVector& Position)
+{
+	const FIntVector Key = GetChunkKey(Position);
+	FChunkState& Chunk = Chunks.FindOrAdd(Key, FChunkState{ 0, 0 });
+	Chunk.NumPoints++;
+	MarkChanged(Key, Position);
+}
+
+void FBitmapPointChunkGrid::RemovePoint(const FVector& Position)
+{
+	const FIntVector Key = GetChunkKey(Position);
+	if (FChunkState* Chunk = Chunks.Find(Key))
+	{
+		Chunk->NumPoints = FMath::Max(Chunk->NumPoints - 1, 0);
+		MarkChanged(Key, Position);
+	}
+}
+
+void FBitmapPointChunkGrid::ClearPoints()
+{
+	for (TPair<FIntVector, FChunkState>& Chunk : Chunks)
+	{
+		if (Chunk.Value.NumPoints > 0)
+		{
+			Chunk.Value.NumPoints = 0;
+			StampChunk(Chunk.Key);
+		}
+	}
+}
+
+int32 FBitmapPointChunkGrid::GetChunkPointCount(const FIntVector& Key) const
+{
+	const FChunkState* Chunk = Chunks.Find(Key);
+	return Chunk ? Chunk->NumPoints : 0;
+}
+
+void FBitmapPointChunkGrid::GetOccupiedChunks(TArray<FIntVector>& OutKeys) const
+{
+	for (const TPair<FIntVector, FChunkState>& Chunk : Chunks)
+	{
+		if (Chunk.Value.NumPoints > 0)
+		{
+			OutKeys.Add(Chunk.Key);
+		}
+	}
+}
+
+int64 FBitmapPointChunkGrid::CollectChangedChunks(int64 SinceCursor, TArray<FIntVector>& OutKeys)
+{
+	const int32 FirstEntry = Algo::LowerBoundBy(ChangeLog, SinceCursor, &FChangeEntry::Version);
+
+	TSet<FIntVector> Seen;
+	for (int32 Index = FirstEntry; Index < ChangeLog.Num(); Index++)
+	{
+		bool bAlreadySeen = false;
+		Seen.Add(ChangeLog[Index].Key, &bAlreadySeen);
+		if (!bAlreadySeen)
+		{
+			OutKeys.Add(ChangeLog[Index].Key);
+		}
+	}
+
+	// Later changes get a newer version, so they are after the returned cursor
+	return ++Version;
+}
+
+SIZE_T FBitmapPointChunkGrid::GetAllocatedSize() const
+{
+	return Chunks.GetAllocatedSize() + ChangeLog.GetAllocatedSize();
+}
+
+void FBitmapPointChunkGrid::MarkChanged(const FIntVector& Key, const FVector& Position)
+{
+	StampChunk(Key);
+
+	if (InfluenceMargin <= 0.0f)
+	{
+		return;
+	}
+
+	// Which side of the chunk, if any, the position is close to on each axis
+	const FVector Local = Position - FVector(Key) * ChunkSize;
+	int32 Sides[3];
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		Sides[Axis] = Local[Axis] < InfluenceMargin ? -1 : (Local[Axis] > ChunkSize - InfluenceMargin ? 1 : 0);
+	}
+
+	if (Sides[0] == 0 && Sides[1] == 0 && Sides[2] == 0)
+	{
+		return;
+	}
+
+	// Every neighbour sharing a face, edge or corner the position is close to
+	for (int32 X = FMath::Min(Sides[0], 0); X <= FMath::Max(Sides[0], 0); X++)
+	{
+		for (int32 Y = FMath::Min(Sides[1], 0); Y <= FMath::Max(Sides[1], 0); Y++)
+		{
+			for (int32 Z = FMath::Min(Sides[2], 0); Z <= FMath::Max(Sides[2], 0); Z++)
+			{
+				if (X != 0 || Y != 0 || Z != 0)
+				{
+					const FIntVector NeighbourKey = Key + FIntVector(X, Y, Z);
+					Chunks.FindOrAdd(NeighbourKey, FChunkState{ 0, 0 });
+					StampChunk(NeighbourKey);
+				}
+			}
+		}
+	}
+}
+
+void FBitmapPointChunkGrid::StampChunk(const FIntVector& Key)
+{
+	FChunkState& Chunk = Chunks.FindChecked(Key);
+	if (Chunk.ChangeVersion == Version)
+	{
+		return;
+	}
+
+	Chunk.ChangeVersion = Version;
+	ChangeLog.Add({ Version, Key });
+
+	if (ChangeLog.Num() > Chunks.Num() * 4 + 64)
+	{
+		CompactChangeLog();
+	}
+}
+
+void FBitmapPointChunkGrid::CompactChangeLog()
+{
+	ChangeLog.Reset();
+	for (const TPair<FIntVector, FChunkState>& Chunk : Chunks)
+	{
+		ChangeLog.Add({ Chunk.Value.ChangeVersion, Chunk.Key });
+	}
+	ChangeLog.Sort([](const FChangeEntry& A, const FChangeEntry& B) { return A.Version < B.Version; });
+}
@@ -0,0 +1,134 @@
+#include "BitmapPointColumns.h"
+
+void FBitmapPointColumns::Add(const FBitmapPoint& Point, int32 Id)
+{
+	Positions.Add(Point.Position);
+	Colors.Add(Point.Color);
+	Intensities.Add(Point.Intensity);
+	Timestamps.Add(Point.Timestamp);
+	Normals.Add(Point.Normal);
+	Ids.Add(Id);
+}
+
+void FBitmapPointColumns::Append(const TArray<FBitmapPoint>& Points, int32 FirstId)
+{
+	Reserve(Num() + Points.Num());
+
+	for (int32 i = 0; i < Points.Num(); i++)
+	{
+		Add(Points[i], FirstId + i);
+	}
+}
+
+void FBitmapPointColumns::RemoveAt(int32 Index, int32 Count)
+{
+	Positions.RemoveAt(Index, Count, false);
+	Colors.RemoveAt(Index, Count, false);
+	Intensities.RemoveAt(Index, Count, false);
+	Timestamps.RemoveAt(Index, Count, false);
+	Normals.RemoveAt(Index, Count, false);
+	Ids.RemoveAt(Index, Count, false);
+}
+
+int32 FBitmapPointColumns::RemoveAll(TFunctionRef<bool(int32 Index)> ShouldRemove, TArray<int32>* OutRemovedIds)
+{
+	const int32 InitialCount = Num();
+	int32 WriteIndex = 0;
+
+	// Single stable compaction pass over all columns
+	for (int32 ReadIndex = 0; ReadIndex < InitialCount; ReadIndex++)
+	{
+		if (ShouldRemove(ReadIndex))
+		{
+			if (OutRemovedIds)
+			{
+				OutRemovedIds->Add(Ids[ReadIndex]);
+			}
+			continue;
+		}
+
+		if (WriteIndex != ReadIndex)
+		{
+			Positions[WriteIndex] = Positions[ReadIndex];
+			Colors[WriteIndex] = Colors[ReadIndex];
+			Intensities[WriteIndex] = Intensities[ReadIndex];
+			Timestamps[WriteIndex] = Timestamps[ReadIndex];
+			Normals[WriteIndex] = Normals[ReadIndex];
+			Ids[WriteIndex] = Ids[ReadIndex];
+		}
+		WriteIndex++;
+	}
+
+	const int32 RemovedCount = InitialCount - WriteIndex;
+	if (RemovedCount > 0)
+	{
+		RemoveAt(WriteIndex, RemovedCount);
+	}
+
+	return RemovedCount;
+}
+
+void FBitmapPointColumns::SetPoint(int32 Index, const FBitmapPoint& Point)
+{
+	Positions[Index] = Point.Position;
+	Colors[Index] = Point.Color;
+	Intensities[Index] = Point.Intensity;
+	Timestamps[Index] = Point.Timestamp;
+	Normals[Index] = Point.Normal;
+}
+
+void FBitmapPointColumns::CopyTo(TArray<FBitmapPoint>& OutPoints) const
+{
+	const int32 Count = Num();
+	OutPoints.SetNum(Count, false);
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		FBitmapPoint& Point = OutPoints[i];
+		Point.Position = Positions[i];
+		Point.Color = Colors[i];
+		Point.Intensity = Intensities[i];
+		Point.Timestamp = Timestamps[i];
+		Point.Normal = Normals[i];
+	}
+}
+
+void FBitmapPointColumns::Reserve(int32 Capacity)
+{
+	Positions.Reserve(Capacity);
+	Colors.Reserve(Capacity);
+	Intensities.Reserve(Capacity);
+	Timestamps.Reserve(Capacity);
+	Normals.Reserve(Capacity);
+	Ids.Reserve(Capacity);
+}
+
+void FBitmapPointColumns::Shrink()
+{
+	Positions.Shrink();
+	Colors.Shrink();
+	Intensities.Shrink();
+	Timestamps.Shrink();
+	Normals.Shrink();
+	Ids.Shrink();
+}
+
+void FBitmapPointColumns::Empty()
+{
+	Positions.Empty();
+	Colors.Empty();
+	Intensities.Empty();
+	Timestamps.Empty();
+	Normals.Empty();
+	Ids.Empty();
+}
+
+SIZE_T FBitmapPointColumns::GetAllocatedSize() const
+{
+	return Positions.GetAllocatedSize()
+		+ Colors.GetAllocatedSize()
+		+ Intensities.GetAllocatedSize()
+		+ Timestamps.GetAllocatedSize()
+		+ Normals.GetAllocatedSize()
+		+ Ids.GetAllocatedSize();
+}
@@ -0,0 +1,53 @@
+#include "BitmapPointCompact.h"
+
+FBitmapPointQuantizer FBitmapPointQuantizer::Fit(TConstArrayView<FBitmapPoint> Points)
+{
+	FBitmapPointQuantizer Quantizer;
+	if (Points.Num() == 0)
+	{
+		return Quantizer;
+	}
+
+	FBox Bounds(ForceInit);
+	for (const FBitmapPoint& Point : Points)
+	{
+		Bounds += Point.Position;
+	}
+
+	// Center the frame so the signed range is used on both sides
+	Quantizer.Origin = CanonicalizePosition(Bounds.GetCenter());
+	return Quantizer;
+}
+
+FBitmapPointQuantizer FBitmapPointQuantizer::FitCube(const FVector& Center, float EdgeLength)
+{
+	static bool bWarnedRange = false;
+	if (EdgeLength > MaxCubeEdge && !bWarnedRange)
+	{
+		bWarnedRange = true;
+		UE_LOG(LogTemp, Warning, TEXT("Bitmap Point Compact: Cube edge %.1f exceeds the exact range of %.1f, outlying positions will be clamped"), EdgeLength, MaxCubeEdge);
+	}
+
+	// Keep the origin on the lattice so offsets of canonical positions are whole steps
+	FBitmapPointQuantizer Quantizer;
+	Quantizer.Origin = CanonicalizePosition(Center);
+	return Quantizer;
+}
+
+void FBitmapPointQuantizer::EncodePoints(TConstArrayView<FBitmapPoint> Points, TArray<FBitmapPointCompact>& OutCompact) const
+{
+	OutCompact.Reserve(OutCompact.Num() + Points.Num());
+	for (const FBitmapPoint& Point : Points)
+	{
+		OutCompact.Add(Encode(Point));
+	}
+}
+
+void FBitmapPointQuantizer::DecodePoints(TConstArrayView<FBitmapPointCompact> Compact, TArray<FBitmapPoint>& OutPoints) const
+{
+	OutPoints.Reserve(OutPoints.Num() + Compact.Num());
+	for (const FBitmapPointCompact& Point : Compact)
+	{
+		OutPoints.Add(Decode(Point));
+	}
+}
@@ -0,0 +1,165 @@
+#include "BitmapPointFusion.h"
+
+UBitmapPointFusion::UBitmapPointFusion()
+	: VoxelSize(2.0f)
+	, MaxObservationWeight(64)
+{
+}
+
+void UBitmapPointFusion::SetVoxelSize(float InVoxelSize)
+{
+	VoxelSize = FMath::Max(InVoxelSize, KINDA_SMALL_NUMBER);
+	Reset();
+	UE_LOG(LogTemp, Log, TEXT("Point Fusion: Voxel size set to %.2f"), VoxelSize);
+}
+
+void UBitmapPointFusion::SetMaxObservationWeight(int32 InMaxWeight)
+{
+	MaxObservationWeight = FMath::Max(0, InMaxWeight);
+}
+
+void UBitmapPointFusion::FusePoints(const TArray<FBitmapPoint>& Points, TArray<FBitmapPoint>& OutNewPoints, TArray<int32>& OutUpdatedIds, TArray<FBitmapPoint>& OutUpdatedPoints)
+{
+	PendingVoxels.Reset();
+
+	// Fold every sample first so a voxel hit many times in one batch is emitted once
+	TArray<FIntVector> Touched;
+	for (const FBitmapPoint& Point : Points)
+	{
+		const FIntVector Key = ToVoxel(Point.Position);
+
+		FBitmapPointFusionVoxel* Voxel = Voxels.Find(Key);
+		if (!Voxel)
+		{
+			Voxel = &Voxels.Add(Key);
+			Voxel->Id = INDEX_NONE;
+			Voxel->ObservationCount = 0;
+			Voxel->BatchIndex = INDEX_NONE;
+		}
+
+		if (Voxel->BatchIndex == INDEX_NONE)
+		{
+			Voxel->BatchIndex = Touched.Add(Key);
+		}
+
+		Accumulate(*Voxel, Point);
+	}
+
+	for (const FIntVector& Key : Touched)
+	{
+		FBitmapPointFusionVoxel& Voxel = Voxels[Key];
+		Voxel.BatchIndex = INDEX_NONE;
+
+		if (Voxel.Id == INDEX_NONE)
+		{
+			OutNewPoints.Add(MakePoint(Voxel));
+			PendingVoxels.Add(Key);
+		}
+		else
+		{
+			OutUpdatedIds.Add(Voxel.Id);
+			OutUpdatedPoints.Add(MakePoint(Voxel));
+		}
+	}
+}
+
+void UBitmapPointFusion::BindNewPoints(int32 FirstId)
+{
+	for (int32 i = 0; i < PendingVoxels.Num(); i++)
+	{
+		if (FBitmapPointFusionVoxel* Voxel = Voxels.Find(PendingVoxels[i]))
+		{
+			Voxel->Id = FirstId + i;
+			IdToVoxel.Add(Voxel->Id, PendingVoxels[i]);
+		}
+	}
+	PendingVoxels.Reset();
+}
+
+void UBitmapPointFusion::HandleChangeSet(const FBitmapPointChangeSet& ChangeSet)
+{
+	if (ChangeSet.bCleared)
+	{
+		Reset();
+		return;
+	}
+
+	// A removed point takes its fused history with it, the next sample in that voxel starts fresh
+	for (int32 Id : ChangeSet.RemovedIds)
+	{
+		FIntVector Key;
+		if (IdToVoxel.RemoveAndCopyValue(Id, Key))
+		{
+			Voxels.Remove(Key);
+		}
+	}
+}
+
+int32 UBitmapPointFusion::GetObservationCount(int32 Id) const
+{
+	const FIntVector* Key = IdToVoxel.Find(Id);
+	const FBitmapPointFusionVoxel* Voxel = Key ? Voxels.Find(*Key) : nullptr;
+	return Voxel ? Voxel->ObservationCount : 0;
+}
+
+void UBitmapPointFusion::Reset()
+{
+	Voxels.Empty();
+	IdToVoxel.Empty();
+	PendingVoxels.Empty();
+}
+
+int32 UBitmapPointFusion::GetMemoryUsageBytes() const
+{
+	return static_cast<int32>(Voxels.GetAllocatedSize() + IdToVoxel.GetAllocatedSize() + PendingVoxels.GetAllocatedSize());
+}
+
+FIntVector UBitmapPointFusion::ToVoxel(const FVector& Position) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Position.X / VoxelSize),
+		FMath::FloorToInt(Position.Y / VoxelSize),
+		FMath::FloorToInt(Position.Z / VoxelSize)
+	);
+}
+
+void UBitmapPointFusion::Accumulate(FBitmapPointFusionVoxel& Voxel, const FBitmapPoint& Point) const
+{
+	Voxel.ObservationCount++;
+
+	const FVector4f Color(Point.Color.R, Point.Color.G, Point.Color.B, Point.Color.A);
+	if (Voxel.ObservationCount == 1)
+	{
+		Voxel.Position = Point.Position;
+		Voxel.Normal = Point.Normal;
+		Voxel.Color = Color;
+		Voxel.Intensity = Point.Intensity;
+		Voxel.LastSeen = Point.Timestamp;
+		return;
+	}
+
+	// Incremental mean, the weight saturates so a long-observed point still follows the surface
+	const int32 Weight = MaxObservationWeight > 0 ? FMath::Min(Voxel.ObservationCount, MaxObservationWeight) : Voxel.ObservationCount;
+	const float Alpha = 1.0f / Weight;
+
+	Voxel.Position += (Point.Position - Voxel.Position) * Alpha;
+	Voxel.Normal += (Point.Normal - Voxel.Normal) * Alpha;
+	Voxel.Color += (Color - Voxel.Color) * Alpha;
+	Voxel.Intensity += (Point.Intensity - Voxel.Intensity) * Alpha;
+	Voxel.LastSeen = FMath::Max(Voxel.LastSeen, Point.Timestamp);
+}
+
+FBitmapPoint UBitmapPointFusion::MakePoint(const FBitmapPointFusionVoxel& Voxel)
+{
+	const FColor Color(
+		static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Voxel.Color.X), 0, 255)),
+		static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Voxel.Color.Y), 0, 255)),
+		static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Voxel.Color.Z), 0, 255)),
+		static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Voxel.Color.W), 0, 255))
+	);
+
+	FBitmapPoint Point(Voxel.Position, Color, Voxel.Intensity);
+	Point.Timestamp = Voxel.LastSeen;
+	Point.Normal = Voxel.Normal.GetSafeNormal(SMALL_NUMBER, FVector::UpVector);
+	return Point;
+}
@@ -1,4 +1,6 @@
 #include "BitmapPointMemoryManager.h"
+#include "MRTrackingStateManager.h"
+#include "Misc/Paths.h"
 #include "Engine/Engine.h"
 
 UBitmapPointMemoryManager::UBitmapPointMemoryManager()
@@ -7,6 +9,9 @@ UBitmapPointMemoryManager::UBitmapPointMemoryManager()
 	, MaxPointAgeSeconds(300.0f)
 	, bAutoCleanupEnabled(true)
 	, CleanupIntervalSeconds(30.0f)
+	, EvictionPolicy(EBitmapPointEvictionPolicy::Oldest)
+	, EvictionRegionSize(100.0f)
+	, TrackingStateManager(nullptr)
 	, LastCleanupTime(0.0f)
 	, CleanupCount(0)
 	, TotalPointsRemoved(0)
@@ -44,6 +49,136 @@ void UBitmapPointMemoryManager::SetCleanupInterval(float IntervalSeconds)
 	UE_LOG(LogTemp, Log, TEXT("Memory Manager: Cleanup interval set to %.1f seconds"), CleanupIntervalSeconds);
 }
 
+void UBitmapPointMemoryManager::SetEvictionPolicy(EBitmapPointEvictionPolicy Policy)
+{
+	EvictionPolicy = Policy;
+	UE_LOG(LogTemp, Log, TEXT("Memory Manager: Eviction policy set to %s"), *UEnum::GetValueAsString(Policy));
+}
+
+void UBitmapPointMemoryManager::SetEvictionRegionSize(float RegionSize)
+{
+	// Paged chunk files are keyed by region, resizing would orphan them
+	if (PageStore && PageStore->HasChunks())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Memory Manager: Cannot change the eviction region size while %d chunks are paged out"), PageStore->GetNumChunks());
+		return;
+	}
+
+	EvictionRegionSize = FMath::Max(1.0f, RegionSize);
+	RegionLastUsedTime.Empty();
+	UE_LOG(LogTemp, Log, TEXT("Memory Manager: Eviction region size set to %.1f"), EvictionRegionSize);
+}
+
+void UBitmapPointMemoryManager::SetPagingEnabled(bool bEnabled)
+{
+	if (bEnabled == IsPagingEnabled())
+	{
+		return;
+	}
+
+	if (bEnabled)
+	{
+		PageStore = MakeUnique<FBitmapPointPageStore>(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MRS3D"), TEXT("PointPages")), EvictionRegionSize);
+	}
+	else
+	{
+		PageStore.Reset();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Memory Manager: Paging to disk %s"), bEnabled ? TEXT("enabled") : TEXT("disabled"));
+}
+
+int32 UBitmapPointMemoryManager::ReadPagedPoints(const FBox& Bounds, TArray<FBitmapPoint>& OutPoints)
+{
+	if (!PageStore || !PageStore->HasChunks())
+	{
+		return 0;
+	}
+
+	TArray<FIntVector> Keys;
+	PageStore->FindChunksInBox(Bounds, Keys);
+	return ReadPagedChunks(Keys, OutPoints);
+}
+
+int32 UBitmapPointMemoryManager::ReadAllPagedPoints(TArray<FBitmapPoint>& OutPoints)
+{
+	if (!PageStore || !PageStore->HasChunks())
+	{
+		return 0;
+	}
+
+	TArray<FIntVector> Keys;
+	PageStore->GetChunkKeys(Keys);
+	return ReadPagedChunks(Keys, OutPoints);
+}
+
+int32 UBitmapPointMemoryManager::GetPagedOutPointCount() const
+{
+	return PageStore ? PageStore->GetPagedPointCount() : 0;
+}
+
+void UBitmapPointMemoryManager::ResetPagedPoints()
+{
+	if (PageStore)
+	{
+		PageStore->Reset();
+	}
+}
+
+int32 UBitmapPointMemoryManager::ReadPagedChunks(TConstArrayView<FIntVector> Keys, TArray<FBitmapPoint>& OutPoints)
+{
+	const int32 NumBefore = OutPoints.Num();
+	const double Now = FPlatformTime::Seconds();
+
+	for (const FIntVector& Key : Keys)
+	{
+		if (PageStore->ReadChunk(Key, OutPoints))
+		{
+			// Just used, so the next page-out does not send it straight back
+			RegionLastUsedTime.Add(Key, Now);
+		}
+	}
+
+	const int32 ReadCount = OutPoints.Num() - NumBefore;
+	if (ReadCount > 0)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Memory Manager: Paged in %d points from %d chunks"), ReadCount, Keys.Num());
+	}
+
+	return ReadCount;
+}
+
+void UBitmapPointMemoryManager::SetTrackingStateManager(UMRTrackingStateManager* InTrackingStateManager)
+{
+	TrackingStateManager = InTrackingStateManager;
+}
+
+void UBitmapPointMemoryManager::MarkRegionUsed(const FVector& Center, float Radius)
+{
+	// Only LeastRecentlyUsed ranks by use, paged out or deleted alike
+	if (EvictionPolicy != EBitmapPointEvictionPolicy::LeastRecentlyUsed)
+	{
+		return;
+	}
+
+	// Wide queries only refresh the regions around their center, marking every region they span would cost more than the query
+	const float MarkedRadius = FMath::Clamp(Radius, 0.0f, EvictionRegionSize * MaxMarkedRegionRadius);
+	const FIntVector MinKey = GetRegionKey(Center - FVector(MarkedRadius));
+	const FIntVector MaxKey = GetRegionKey(Center + FVector(MarkedRadius));
+	const double Now = FPlatformTime::Seconds();
+
+	for (int32 X = MinKey.X; X <= MaxKey.X; X++)
+	{
+		for (int32 Y = MinKey.Y; Y <= MaxKey.Y; Y++)
+		{
+			for (int32 Z = MinKey.Z; Z <= MaxKey.Z; Z++)
+			{
+				RegionLastUsedTime.Add(FIntVector(X, Y, Z), Now);
+			}
+		}
+	}
+}
+
 int32 UBitmapPointMemoryManager::PerformCleanup()
 {
 	if (!Storage)
@@ -65,13 +200,13 @@ int32 UBitmapPointMemoryManager::RemoveOldPoints()
 	const float CurrentTime = FPlatformTime::Seconds();
 	const float OldestAllowedTime = CurrentTime - MaxPointAgeSeconds;
 
-	int32 RemovedCount = Storage->RemovePointsWhere([OldestAllowedTime](const FBitmapPoint& Point) {
-		return Point.Timestamp < OldestAllowedTime;
-	});
+	const int64 VersionBefore = Storage->GetVersion();
+	int32 RemovedCount = Storage->RemovePointsOlderThan(OldestAllowedTime);
 
 	if (RemovedCount > 0)
 	{
 		UE_LOG(LogTemp, Verbose, TEXT("Memory Manager: Removed %d old points"), RemovedCount);
+		ReportEvictedPoints(VersionBefore);
 	}
 
 	return RemovedCount;
@@ -92,15 +227,8 @@ int32 UBitmapPointMemoryManager::RemoveExcessPoints()
 
 	const int32 ExcessCount = CurrentCount - MaxBitmapPoints;
 
-	// Remove oldest points first (FIFO strategy)
-	int32 RemovedCount = 0;
-	for (int32 i = 0; i < ExcessCount && Storage->GetPointCount() > 0; i++)
-	{
-		if (Storage->RemovePoint(0)) // Remove first (oldest) point
-		{
-			RemovedCount++;
-		}
-	}
+	// Remove in a single batch, which points go depends on the eviction policy
+	const int32 RemovedCount = EvictPointsInternal(ExcessCount);
 
 	if (RemovedCount > 0)
 	{
@@ -111,6 +239,24 @@ int32 UBitmapPointMemoryManager::RemoveExcessPoints()
 	return RemovedCount;
 }
 
+int32 UBitmapPointMemoryManager::EvictPoints(int32 Count)
+{
+	if (!Storage || Count <= 0)
+	{
+		return 0;
+	}
+
+	const int32 RemovedCount = EvictPointsInternal(Count);
+
+	if (RemovedCount > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Memory Manager: Evicted %d points"), RemovedCount);
+		TotalPointsRemoved += RemovedCount;
+	}
+
+	return RemovedCount;
+}
+
 bool UBitmapPointMemoryManager::ShouldPerformCleanup() const
 {
 	if (!bAutoCleanupEnabled || !Storage)
@@ -150,9 +296,11 @@ void UBitmapPointMemoryManager::Tick(float DeltaTime)
 int32 UBitmapPointMemoryManager::PerformCleanupInternal()
 {
 	const int32 InitialMemoryKB = GetMemoryUsageKB();
+	const int32 InitialPointCount = Storage->GetPointCount();
 	
 	// Remove old points first
 	int32 OldPointsRemoved = RemoveOldPoints();
+	PruneRegionUseTimes();
 	
 	// Then remove excess points if still needed
 	int32 ExcessPointsRemoved = RemoveExcessPoints();
@@ -169,8 +317,11 @@ int32 UBitmapPointMemoryManager::PerformCleanupInternal()
 		TotalPointsRemoved += TotalRemoved;
 		TotalMemoryFreed += MemoryFreed;
 		
-		// Shrink storage to reclaim memory
-		Storage->Shrink();
+		// Only reallocate when a large share was freed, steady trickles of expiry reuse the slack instead
+		if (TotalRemoved * ShrinkRemovedFraction >= InitialPointCount)
+		{
+			Storage->Shrink();
+		}
 		
 		UE_LOG(LogTemp, Log, TEXT("Memory Manager: Cleanup completed - removed %d points, freed %d KB"), 
 			TotalRemoved, MemoryFreed);
@@ -180,4 +331,288 @@ int32 UBitmapPointMemoryManager::PerformCleanupInternal()
 	
 	LastCleanupTime = FPlatformTime::Seconds();
 	return TotalRemoved;
+}
+
+void UBitmapPointMemoryManager::PruneRegionUseTimes()
+{
+	// Age cleanup keeps every resident point newer than the age limit, so an older use can no longer raise a region's rank
+	const double Horizon = MaxPointAgeSeconds > 0.0f ? MaxPointAgeSeconds : DefaultRegionUseHorizonSeconds;
+	const double OldestKeptTime = FPlatformTime::Seconds() - Horizon;
+
+	const int32 NumBefore = RegionLastUsedTime.Num();
+	for (auto It = RegionLastUsedTime.CreateIterator(); It; ++It)
+	{
+		if (It.Value() < OldestKeptTime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (RegionLastUsedTime.Num() < NumBefore)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Memory Manager: Pruned %d stale region use times"), NumBefore - RegionLastUsedTime.Num());
+	}
+}
+
+bool UBitmapPointMemoryManager::HasViewerPose() const
+{
+	if (!TrackingStateManager)
+	{
+		return false;
+	}
+
+	// A lost or never acquired pose is where the camera was, not where it is
+	const FMRSessionInfo& SessionInfo = TrackingStateManager->GetSessionInfo();
+	const bool bTracking = SessionInfo.TrackingState == ETrackingState::FullTracking || SessionInfo.TrackingState == ETrackingState::LimitedTracking;
+	return bTracking && SessionInfo.LastKnownPose.IsValid();
+}
+
+int32 UBitmapPointMemoryManager::EvictPointsInternal(int32 Count)
+{
+	const int64 VersionBefore = Storage->GetVersion();
+	int32 RemovedCount = 0;
+
+	// Without a tracked pose there is no viewer to measure from, so fall back to FIFO
+	const bool bHasViewer = HasViewerPose();
+	if (PageStore)
+	{
+		// Paged points leave memory but stay part of the map
+		RemovedCount = PageOutPoints(Count);
+	}
+	else if (EvictionPolicy == EBitmapPointEvictionPolicy::Oldest
+		|| (EvictionPolicy == EBitmapPointEvictionPolicy::FarthestFromViewer && !bHasViewer))
+	{
+		RemovedCount = Storage->RemoveOldestPoints(Count);
+	}
+	else
+	{
+		TArray<int32> EvictedIds;
+		SelectEvictionCandidates(FMath::Min(Count, Storage->GetPointCount()), EvictedIds);
+		RemovedCount = Storage->RemovePointsById(EvictedIds);
+	}
+
+	if (RemovedCount > 0)
+	{
+		ReportEvictedPoints(VersionBefore);
+	}
+
+	return RemovedCount;
+}
+
+void UBitmapPointMemoryManager::GatherEvictionRegions(TArray<FEvictionRegion>& OutRegions) const
+{
+	TMap<FIntVector, int32> RegionIndices;
+	Storage->ForEachPoint([this, &OutRegions, &RegionIndices](int32 Id, const FBitmapPointView& Point) {
+		const FIntVector Key = GetRegionKey(Point.Position);
+
+		int32 RegionIndex = INDEX_NONE;
+		if (const int32* Found = RegionIndices.Find(Key))
+		{
+			RegionIndex = *Found;
+		}
+		else
+		{
+			RegionIndex = OutRegions.AddDefaulted();
+			OutRegions[RegionIndex].Key = Key;
+			RegionIndices.Add(Key, RegionIndex);
+		}
+
+		FEvictionRegion& Region = OutRegions[RegionIndex];
+		Region.Ids.Add(Id);
+		Region.NewestTimestamp = FMath::Max(Region.NewestTimestamp, Point.Timestamp);
+	});
+}
+
+void UBitmapPointMemoryManager::RankEvictionRegions(TArray<FEvictionRegion>& Regions) const
+{
+	if (EvictionPolicy == EBitmapPointEvictionPolicy::FarthestFromViewer && HasViewerPose())
+	{
+		const FVector Viewer = TrackingStateManager->GetSessionInfo().LastKnownPose.GetLocation();
+		for (FEvictionRegion& Region : Regions)
+		{
+			const FVector RegionCenter = (FVector(Region.Key) + FVector(0.5f)) * EvictionRegionSize;
+			Region.Score = -FVector::DistSquared(RegionCenter, Viewer);
+		}
+	}
+	else
+	{
+		// A region was last used when it was last observed or last queried, whichever is later
+		for (FEvictionRegion& Region : Regions)
+		{
+			const double* LastQueried = RegionLastUsedTime.Find(Region.Key);
+			Region.Score = FMath::Max<double>(Region.NewestTimestamp, LastQueried ? *LastQueried : 0.0);
+		}
+	}
+
+	Regions.Sort([](const FEvictionRegion& A, const FEvictionRegion& B) { return A.Score < B.Score; });
+}
+
+void UBitmapPointMemoryManager::SelectEvictionCandidates(int32 Count, TArray<int32>& OutIds) const
+{
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	TArray<FEvictionRegion> Regions;
+	GatherEvictionRegions(Regions);
+	OutIds.Reserve(Count);
+
+	if (EvictionPolicy == EBitmapPointEvictionPolicy::DensityThinning)
+	{
+		// Find the lowest per-region level whose excess fits in Count, excess is non-increasing in the level
+		int32 MaxRegionCount = 0;
+		for (const FEvictionRegion& Region : Regions)
+		{
+			MaxRegionCount = FMath::Max(MaxRegionCount, Region.Ids.Num());
+		}
+
+		auto ExcessAbove = [&Regions](int32 Level) {
+			int64 Excess = 0;
+			for (const FEvictionRegion& Region : Regions)
+			{
+				Excess += FMath::Max(0, Region.Ids.Num() - Level);
+			}
+			return Excess;
+		};
+
+		int32 Low = 0;
+		int32 High = MaxRegionCount;
+		while (Low < High)
+		{
+			const int32 Mid = (Low + High) / 2;
+			if (ExcessAbove(Mid) <= Count)
+			{
+				High = Mid;
+			}
+			else
+			{
+				Low = Mid + 1;
+			}
+		}
+
+		// Regions at the level give up one more point each until Count is reached
+		const int32 Level = Low;
+		int32 Remaining = Count - static_cast<int32>(ExcessAbove(Level));
+
+		for (const FEvictionRegion& Region : Regions)
+		{
+			int32 RegionRemoved = FMath::Max(0, Region.Ids.Num() - Level);
+			if (Remaining > 0 && Level > 0 && Region.Ids.Num() >= Level)
+			{
+				RegionRemoved++;
+				Remaining--;
+			}
+
+			// Take evenly strided points so old and re-scanned samples are thinned alike
+			const int32 RegionCount = Region.Ids.Num();
+			for (int32 Removed = 0; Removed < RegionRemoved; Removed++)
+			{
+				const int32 Entry = static_cast<int32>((static_cast<int64>(Removed) * 2 + 1) * RegionCount / (static_cast<int64>(RegionRemoved) * 2));
+				OutIds.Add(Region.Ids[Entry]);
+			}
+		}
+		return;
+	}
+
+	RankEvictionRegions(Regions);
+
+	// Drop whole regions, the last one partially and oldest first
+	for (const FEvictionRegion& Region : Regions)
+	{
+		const int32 Take = FMath::Min(Region.Ids.Num(), Count - OutIds.Num());
+		for (int32 Entry = 0; Entry < Take; Entry++)
+		{
+			OutIds.Add(Region.Ids[Entry]);
+		}
+		if (OutIds.Num() >= Count)
+		{
+			break;
+		}
+	}
+}
+
+int32 UBitmapPointMemoryManager::PageOutPoints(int32 Count)
+{
+	// Chunk files take any subset of their region, so paged points are chosen by the eviction policy like deleted ones
+	TMap<FIntVector, TArray<FBitmapPoint>> ChunkPoints;
+	TMap<FIntVector, TArray<int32>> ChunkIds;
+	auto AddToChunk = [this, &ChunkPoints, &ChunkIds](int32 Id, const FBitmapPointView& Point) {
+		const FIntVector Key = GetRegionKey(Point.Position);
+		ChunkPoints.FindOrAdd(Key).Add(Point.ToBitmapPoint());
+		ChunkIds.FindOrAdd(Key).Add(Id);
+	};
+
+	const int32 PageCount = FMath::Min(Count, Storage->GetPointCount());
+	if (EvictionPolicy == EBitmapPointEvictionPolicy::Oldest
+		|| (EvictionPolicy == EBitmapPointEvictionPolicy::FarthestFromViewer && !HasViewerPose()))
+	{
+		Storage->ForEachPointInRange(0, PageCount, AddToChunk);
+	}
+	else
+	{
+		TArray<int32> CandidateIds;
+		SelectEvictionCandidates(PageCount, CandidateIds);
+
+		// Collect the candidates' points in one more pass over storage
+		const TSet<int32> Candidates(CandidateIds);
+		Storage->ForEachPoint([&Candidates, &AddToChunk](int32 Id, const FBitmapPointView& Point) {
+			if (Candidates.Contains(Id))
+			{
+				AddToChunk(Id, Point);
+			}
+		});
+	}
+
+	TArray<int32> PagedIds;
+	for (const TPair<FIntVector, TArray<FBitmapPoint>>& Chunk : ChunkPoints)
+	{
+		// A failed write keeps the points resident rather than losing them
+		if (PageStore->WriteChunk(Chunk.Key, Chunk.Value))
+		{
+			PagedIds.Append(ChunkIds.FindChecked(Chunk.Key));
+		}
+	}
+
+	if (PagedIds.Num() > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Memory Manager: Paged out %d points, %d points in %d chunks on disk"),
+			PagedIds.Num(), PageStore->GetPagedPointCount(), PageStore->GetNumChunks());
+	}
+
+	return Storage->RemovePointsById(PagedIds);
+}
+
+FIntVector UBitmapPointMemoryManager::GetRegionKey(const FVector& Position) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Position.X / EvictionRegionSize),
+		FMath::FloorToInt(Position.Y / EvictionRegionSize),
+		FMath::FloorToInt(Position.Z / EvictionRegionSize));
+}
+
+void UBitmapPointMemoryManager::ReportEvictedPoints(int64 SinceVersion)
+{
+	if (!OnPointsEvicted.IsBound())
+	{
+		return;
+	}
+
+	TArray<FBitmapPointChangeSet> Changes;
+	if (!Storage->GetChangesSince(SinceVersion, Changes))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Memory Manager: Storage change history lost, evicted points not reported"));
+		return;
+	}
+
+	TArray<int32> EvictedIds;
+	for (const FBitmapPointChangeSet& Change : Changes)
+	{
+		EvictedIds.Append(Change.RemovedIds);
+	}
+
+	if (EvictedIds.Num() > 0)
+	{
+		OnPointsEvicted.Broadcast(EvictedIds);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "BitmapPointPageStore.h"
+#include "BitmapPointCompact.h"
+#include "Async/MappedFileHandle.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	/** Leading record of every chunk file, followed by NumPoints compact points */
+	struct FPageFileHeader
+	{
+		uint32 Magic;
+		uint32 FormatVersion;
+		int32 NumPoints;
+		int32 Reserved;
+		double OriginX;
+		double OriginY;
+		double OriginZ;
+	};
+
+	constexpr uint32 PageFileMagic = 0x4750524D; // "MRPG"
+	constexpr uint32 PageFileVersion = 2;
+}
+
+FBitmapPointPageStore::FBitmapPointPageStore(const FString& InRootDirectory, float InChunkSize)
+	: Directory(FPaths::Combine(InRootDirectory, FGuid::NewGuid().ToString()))
+	, ChunkSize(FMath::Max(InChunkSize, 1.0f))
+	, PagedPointCount(0)
+	, LastWriteStamp(0)
+{
+	// Every store gets a folder of its own, so stores of other instances sharing the root are never touched
+	IFileManager::Get().MakeDirectory(*Directory, true);
+}
+
+FBitmapPointPageStore::~FBitmapPointPageStore()
+{
+	Reset();
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+}
+
+FIntVector FBitmapPointPageStore::GetChunkKey(const FVector& Position) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Position.X / ChunkSize),
+		FMath::FloorToInt(Position.Y / ChunkSize),
+		FMath::FloorToInt(Position.Z / ChunkSize));
+}
+
+bool FBitmapPointPageStore::WriteChunk(const FIntVector& Key, TConstArrayView<FBitmapPoint> Points)
+{
+	if (Points.Num() == 0)
+	{
+		return true;
+	}
+
+	// The quantizer only depends on the chunk, so records of every page-out to it share one origin and are appended as they are
+	const FVector ChunkCenter = (FVector(Key) + FVector(0.5f)) * ChunkSize;
+	const FBitmapPointQuantizer Quantizer = FBitmapPointQuantizer::FitCube(ChunkCenter, ChunkSize);
+
+	TArray<FBitmapPointCompact> Records;
+	Records.SetNumUninitialized(Points.Num());
+	for (int32 Index = 0; Index < Points.Num(); Index++)
+	{
+		Records[Index] = Quantizer.Encode(Points[Index]);
+	}
+
+	const FString Filename = GetChunkFilename(Key);
+	const int32* ExistingCount = ChunkPointCounts.Find(Key);
+	const int32 NumPoints = (ExistingCount ? *ExistingCount : 0) + Points.Num();
+
+	TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Filename, ExistingCount != nullptr));
+	bool bWritten = File.IsValid();
+	if (bWritten && !ExistingCount)
+	{
+		FPageFileHeader Header;
+		FMemory::Memzero(Header);
+		Header.Magic = PageFileMagic;
+		Header.FormatVersion = PageFileVersion;
+		Header.OriginX = Quantizer.Origin.X;
+		Header.OriginY = Quantizer.Origin.Y;
+		Header.OriginZ = Quantizer.Origin.Z;
+		bWritten = File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(FPageFileHeader));
+	}
+
+	// Records go first and the count last, so a failed append leaves the file describing only its old records
+	bWritten = bWritten
+		&& File->SeekFromEnd(0)
+		&& File->Write(reinterpret_cast<const uint8*>(Records.GetData()), Records.Num() * sizeof(FBitmapPointCompact))
+		&& File->Seek(STRUCT_OFFSET(FPageFileHeader, NumPoints))
+		&& File->Write(reinterpret_cast<const uint8*>(&NumPoints), sizeof(int32));
+	File.Reset();
+
+	if (!bWritten)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PageStore: Failed to write chunk (%d, %d, %d)"), Key.X, Key.Y, Key.Z);
+		if (!ExistingCount)
+		{
+			IFileManager::Get().Delete(*Filename, false, false, true);
+		}
+		return false;
+	}
+
+	PagedPointCount += Points.Num();
+	ChunkPointCounts.Add(Key, NumPoints);
+	ChunkWriteStamps.Add(Key, ++LastWriteStamp);
+	return true;
+}
+
+bool FBitmapPointPageStore::ReadChunk(const FIntVector& Key, TArray<FBitmapPoint>& OutPoints)
+{
+	const int32* Count = ChunkPointCounts.Find(Key);
+	if (!Count)
+	{
+		return false;
+	}
+
+	if (!ReadChunkFile(Key, OutPoints))
+	{
+		// An unreadable file will not recover, drop it so every later query over the chunk does not retry it
+		UE_LOG(LogTemp, Warning, TEXT("PageStore: Dropping unreadable chunk (%d, %d, %d), %d points lost"), Key.X, Key.Y, Key.Z, *Count);
+		PagedPointCount -= *Count;
+		ChunkPointCounts.Remove(Key);
+		ChunkWriteStamps.Remove(Key);
+		IFileManager::Get().Delete(*GetChunkFilename(Key), false, false, true);
+		return false;
+	}
+
+	PagedPointCount -= *Count;
+	ChunkPointCounts.Remove(Key);
+	ChunkWriteStamps.Remove(Key);
+	IFileManager::Get().Delete(*GetChunkFilename(Key), false, false, true);
+	return true;
+}
+
+bool FBitmapPointPageStore::ReadChunkFile(const FIntVector& Key, TArray<FBitmapPoint>& OutPoints) const
+{
+	const FString Filename = GetChunkFilename(Key);
+
+	// The region must be released before the handle, declaration order takes care of that
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (!MappedFile || MappedFile->GetFileSize() < static_cast<int64>(sizeof(FPageFileHeader)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PageStore: Failed to map chunk file %s"), *Filename);
+		return false;
+	}
+
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	if (!MappedRegion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PageStore: Failed to map chunk file %s"), *Filename);
+		return false;
+	}
+
+	if (!DecodeChunkFile(TConstArrayView<uint8>(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()), OutPoints))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PageStore: Chunk file %s is corrupt"), *Filename);
+		return false;
+	}
+
+	return true;
+}
+
+bool FBitmapPointPageStore::CopyChunkFile(const FIntVector& Key, TArray<uint8>& OutBytes) const
+{
+	if (!ChunkPointCounts.Contains(Key))
+	{
+		return false;
+	}
+
+	// A failed append may leave records past the header count, only the counted ones are copied
+	const int64 NumBytes = sizeof(FPageFileHeader) + static_cast<int64>(ChunkPointCounts[Key]) * sizeof(FBitmapPointCompact);
+	if (!FFileHelper::LoadFileToArray(OutBytes, *GetChunkFilename(Key)) || OutBytes.Num() < NumBytes)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PageStore: Failed to copy chunk (%d, %d, %d)"), Key.X, Key.Y, Key.Z);
+		return false;
+	}
+
+	OutBytes.SetNum(static_cast<int32>(NumBytes));
+	return true;
+}
+
+bool FBitmapPointPageStore::DecodeChunkFile(TConstArrayView<uint8> Bytes, TArray<FBitmapPoint>& OutPoints)
+{
+	if (Bytes.Num() < static_cast<int64>(sizeof(FPageFileHeader)))
+	{
+		return false;
+	}
+
+	FPageFileHeader Header;
+	FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(FPageFileHeader));
+
+	const int64 ExpectedSize = sizeof(FPageFileHeader) + static_cast<int64>(Header.NumPoints) * sizeof(FBitmapPointCompact);
+	if (Header.Magic != PageFileMagic || Header.FormatVersion != PageFileVersion || Header.NumPoints < 0 || Bytes.Num() < ExpectedSize)
+	{
+		return false;
+	}
+
+	FBitmapPointQuantizer Quantizer;
+	Quantizer.Origin = FVector(Header.OriginX, Header.OriginY, Header.OriginZ);
+
+	const FBitmapPointCompact* Records = reinterpret_cast<const FBitmapPointCompact*>(Bytes.GetData() + sizeof(FPageFileHeader));
+	Quantizer.DecodePoints(TConstArrayView<FBitmapPointCompact>(Records, Header.NumPoints), OutPoints);
+	return true;
+}
+
+void FBitmapPointPageStore::FindChunksInBox(const FBox& Bounds, TArray<FIntVector>& OutKeys) const
+{
+	if (ChunkPointCounts.Num() == 0 || !Bounds.IsValid)
+	{
+		return;
+	}
+
+	const FIntVector MinKey = GetChunkKey(Bounds.Min);
+	const FIntVector MaxKey = GetChunkKey(Bounds.Max);
+	const int64 RangeVolume = static_cast<int64>(MaxKey.X - MinKey.X + 1) * (MaxKey.Y - MinKey.Y + 1) * (MaxKey.Z - MinKey.Z + 1);
+
+	// Walk whichever is smaller, the key range or the paged-out chunks
+	if (RangeVolume > ChunkPointCounts.Num())
+	{
+		for (const TPair<FIntVector, int32>& Chunk : ChunkPointCounts)
+		{
+			const FIntVector& Key = Chunk.Key;
+			if (Key.X >= MinKey.X && Key.X <= MaxKey.X && Key.Y >= MinKey.Y && Key.Y <= MaxKey.Y && Key.Z >= MinKey.Z && Key.Z <= MaxKey.Z)
+			{
+				OutKeys.Add(Key);
+			}
+		}
+		return;
+	}
+
+	for (int32 X = MinKey.X; X <= MaxKey.X; X++)
+	{
+		for (int32 Y = MinKey.Y; Y <= MaxKey.Y; Y++)
+		{
+			for (int32 Z = MinKey.Z; Z <= MaxKey.Z; Z++)
+			{
+				const FIntVector Key(X, Y, Z);
+				if (ChunkPointCounts.Contains(Key))
+				{
+					OutKeys.Add(Key);
+				}
+			}
+		}
+	}
+}
+
+void FBitmapPointPageStore::Reset()
+{
+	for (const TPair<FIntVector, int32>& Chunk : ChunkPointCounts)
+	{
+		IFileManager::Get().Delete(*GetChunkFilename(Chunk.Key), false, false, true);
+	}
+
+	ChunkPointCounts.Empty();
+	ChunkWriteStamps.Empty();
+	PagedPointCount = 0;
+}
+
+FString FBitmapPointPageStore::GetChunkFilename(const FIntVector& Key) const
+{
+	return FPaths::Combine(Directory, FString::Printf(TEXT("Chunk_%d_%d_%d.mrpage"), Key.X, Key.Y, Key.Z));
+}
@@ -0,0 +1,359 @@
+#include "BitmapPointPlaneTracker.h"
+#include "PlaneDetectionSubsystem.h"
+
+void FBitmapPointPlaneFit::Accumulate(const FVector& Position, double Sign)
+{
+	Count += Sign > 0.0 ? 1 : -1;
+	Sum += Position * Sign;
+	SumProducts[0] += Position.X * Position.X * Sign;
+	SumProducts[1] += Position.X * Position.Y * Sign;
+	SumProducts[2] += Position.X * Position.Z * Sign;
+	SumProducts[3] += Position.Y * Position.Y * Sign;
+	SumProducts[4] += Position.Y * Position.Z * Sign;
+	SumProducts[5] += Position.Z * Position.Z * Sign;
+	bDirty = true;
+}
+
+void FBitmapPointPlaneFit::Refit()
+{
+	bDirty = false;
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	// Covariance of the members about their centroid
+	const FVector Center = Sum / Count;
+	const double Cxx = SumProducts[0] / Count - Center.X * Center.X;
+	const double Cxy = SumProducts[1] / Count - Center.X * Center.Y;
+	const double Cxz = SumProducts[2] / Count - Center.X * Center.Z;
+	const double Cyy = SumProducts[3] / Count - Center.Y * Center.Y;
+	const double Cyz = SumProducts[4] / Count - Center.Y * Center.Z;
+	const double Czz = SumProducts[5] / Count - Center.Z * Center.Z;
+	auto Covariance = [&](const FVector& A, const FVector& B) {
+		return A.X * (Cxx * B.X + Cxy * B.Y + Cxz * B.Z)
+			+ A.Y * (Cxy * B.X + Cyy * B.Y + Cyz * B.Z)
+			+ A.Z * (Cxz * B.X + Cyz * B.Y + Czz * B.Z);
+	};
+
+	// Fit the height above the current plane as a linear function of the in-plane coordinates and tilt the normal by it
+	FVector Normal = Plane.Normal;
+	FVector AxisU;
+	FVector AxisV;
+	for (int32 Step = 0; Step < 2; Step++)
+	{
+		Normal.FindBestAxisVectors(AxisU, AxisV);
+		const double Cuu = Covariance(AxisU, AxisU);
+		const double Cuv = Covariance(AxisU, AxisV);
+		const double Cvv = Covariance(AxisV, AxisV);
+		const double Cuw = Covariance(AxisU, Normal);
+		const double Cvw = Covariance(AxisV, Normal);
+		const double Det = Cuu * Cvv - Cuv * Cuv;
+		if (Det <= UE_DOUBLE_SMALL_NUMBER)
+		{
+			break;
+		}
+
+		const double SlopeU = (Cvv * Cuw - Cuv * Cvw) / Det;
+		const double SlopeV = (Cuu * Cvw - Cuv * Cuw) / Det;
+		const FVector Tilted = (Normal - AxisU * SlopeU - AxisV * SlopeV).GetSafeNormal();
+		if (Tilted.IsNearlyZero())
+		{
+			break;
+		}
+		Normal = Tilted;
+	}
+	Normal.FindBestAxisVectors(AxisU, AxisV);
+
+	// A uniformly covered rectangle reaches sqrt(3) standard deviations from its center
+	Plane.Center = Center;
+	Plane.Normal = Normal;
+	Plane.Extent = FVector2D(FMath::Sqrt(3.0 * FMath::Max(Covariance(AxisU, AxisU), 0.0)), FMath::Sqrt(3.0 * FMath::Max(Covariance(AxisV, AxisV), 0.0)));
+	Plane.Area = Plane.GetArea();
+	Plane.Confidence = Count > 50 ? EPlaneConfidence::High : Count > 25 ? EPlaneConfidence::Medium : EPlaneConfidence::Low;
+}
+
+UBitmapPointPlaneTracker::UBitmapPointPlaneTracker()
+	: PlaneThickness(0.1f)
+	, PlaneGrowthMargin(50.0f)
+	, NextPlaneSlot(0)
+	, UnassignedAtLastDetection(0)
+	, bPendingClear(false)
+{
+}
+
+void UBitmapPointPlaneTracker::HandleChangeSet(const FBitmapPointChangeSet& ChangeSet)
+{
+	if (ChangeSet.bCleared)
+	{
+		// Everything queued so far is gone with the clear
+		PendingAddedIds.Reset();
+		PendingRemovedIds.Reset();
+		bPendingClear = true;
+	}
+
+	PendingRemovedIds.Append(ChangeSet.RemovedIds);
+
+	// Updated points moved, so they leave their plane and are assigned again at the new position
+	PendingRemovedIds.Append(ChangeSet.UpdatedIds);
+	PendingAddedIds.Append(ChangeSet.UpdatedIds);
+
+	for (int32 i = 0; i < ChangeSet.AddedCount; i++)
+	{
+		PendingAddedIds.Add(ChangeSet.FirstAddedId + i);
+	}
+}
+
+void UBitmapPointPlaneTracker::SeedFromStorage(const UBitmapPointStorage* Storage)
+{
+	if (!Storage)
+	{
+		return;
+	}
+
+	PendingAddedIds.Reserve(PendingAddedIds.Num() + Storage->GetPointCount());
+	Storage->ForEachPoint([this](int32 Id, const FBitmapPointView& Point) {
+		PendingAddedIds.Add(Id);
+	});
+}
+
+int32 UBitmapPointPlaneTracker::Update(const UBitmapPointStorage* Storage, UPlaneDetectionSubsystem* PlaneDetection, int32 MinPointsForDetection)
+{
+	if (!Storage)
+	{
+		return 0;
+	}
+
+	int32 NumChanged = 0;
+	if (bPendingClear)
+	{
+		NumChanged += Planes.Num();
+		Reset(PlaneDetection);
+	}
+
+	// Removals first, so a point added and removed within one interval never joins a plane
+	for (int32 Id : PendingRemovedIds)
+	{
+		RemoveMember(Id);
+	}
+
+	for (int32 Id : PendingAddedIds)
+	{
+		FBitmapPoint Point;
+		if (Storage->GetPointById(Id, Point))
+		{
+			AssignPoint(Id, Point.Position);
+		}
+	}
+	PendingRemovedIds.Reset();
+	PendingAddedIds.Reset();
+
+	// Refit only the planes whose members changed
+	TArray<int32> LostSlots;
+	for (TPair<int32, FBitmapPointPlaneFit>& Pair : Planes)
+	{
+		FBitmapPointPlaneFit& Fit = Pair.Value;
+		if (!Fit.bDirty)
+		{
+			continue;
+		}
+
+		if (Fit.Count < MinPlanePoints)
+		{
+			LostSlots.Add(Pair.Key);
+			continue;
+		}
+
+		Fit.Refit();
+		if (PlaneDetection)
+		{
+			PlaneDetection->AddDetectedPlane(Fit.Plane);
+		}
+		NumChanged++;
+	}
+
+	for (int32 PlaneSlot : LostSlots)
+	{
+		DropPlane(PlaneSlot, PlaneDetection);
+		NumChanged++;
+	}
+
+	UnassignedAtLastDetection = FMath::Min(UnassignedAtLastDetection, UnassignedIds.Num());
+	if (UnassignedIds.Num() >= UnassignedAtLastDetection + FMath::Max(MinPointsForDetection, MinPlanePoints))
+	{
+		NumChanged += DetectNewPlanes(Storage, PlaneDetection);
+		UnassignedAtLastDetection = UnassignedIds.Num();
+	}
+
+	return NumChanged;
+}
+
+void UBitmapPointPlaneTracker::SetPlaneThickness(float InPlaneThickness)
+{
+	PlaneThickness = FMath::Max(InPlaneThickness, KINDA_SMALL_NUMBER);
+}
+
+void UBitmapPointPlaneTracker::Reset(UPlaneDetectionSubsystem* PlaneDetection)
+{
+	if (PlaneDetection)
+	{
+		for (const TPair<int32, FBitmapPointPlaneFit>& Pair : Planes)
+		{
+			PlaneDetection->RemovePlane(Pair.Value.Plane.PlaneID);
+		}
+	}
+
+	Planes.Empty();
+	Members.Empty();
+	UnassignedIds.Empty();
+	UnassignedAtLastDetection = 0;
+	bPendingClear = false;
+}
+
+int32 UBitmapPointPlaneTracker::GetMemoryUsageBytes() const
+{
+	return Planes.GetAllocatedSize()
+		+ Members.GetAllocatedSize()
+		+ UnassignedIds.GetAllocatedSize()
+		+ PendingAddedIds.GetAllocatedSize()
+		+ PendingRemovedIds.GetAllocatedSize();
+}
+
+void UBitmapPointPlaneTracker::RemoveMember(int32 Id)
+{
+	FBitmapPointPlaneMember Member;
+	if (Members.RemoveAndCopyValue(Id, Member))
+	{
+		if (FBitmapPointPlaneFit* Fit = Planes.Find(Member.PlaneSlot))
+		{
+			Fit->Accumulate(Member.Position, -1.0);
+		}
+		return;
+	}
+
+	UnassignedIds.Remove(Id);
+}
+
+void UBitmapPointPlaneTracker::AssignPoint(int32 Id, const FVector& Position)
+{
+	int32 BestSlot = INDEX_NONE;
+	float BestDistance = PlaneThickness;
+	for (const TPair<int32, FBitmapPointPlaneFit>& Pair : Planes)
+	{
+		const FDetectedPlane& Plane = Pair.Value.Plane;
+		const FVector Offset = Position - Plane.Center;
+		const float Distance = FMath::Abs(FVector::DotProduct(Offset, Plane.Normal));
+		if (Distance > BestDistance)
+		{
+			continue;
+		}
+
+		// Coplanar surfaces far apart stay separate planes
+		FVector AxisU;
+		FVector AxisV;
+		Plane.Normal.FindBestAxisVectors(AxisU, AxisV);
+		if (FMath::Abs(FVector::DotProduct(Offset, AxisU)) > Plane.Extent.X + PlaneGrowthMargin
+			|| FMath::Abs(FVector::DotProduct(Offset, AxisV)) > Plane.Extent.Y + PlaneGrowthMargin)
+		{
+			continue;
+		}
+
+		BestSlot = Pair.Key;
+		BestDistance = Distance;
+	}
+
+	if (BestSlot == INDEX_NONE)
+	{
+		UnassignedIds.Add(Id);
+		return;
+	}
+
+	Planes[BestSlot].Accumulate(Position, 1.0);
+	Members.Add(Id, { BestSlot, Position });
+}
+
+int32 UBitmapPointPlaneTracker::DetectNewPlanes(const UBitmapPointStorage* Storage, UPlaneDetectionSubsystem* PlaneDetection)
+{
+	if (!PlaneDetection)
+	{
+		return 0;
+	}
+
+	TArray<int32> CandidateIds;
+	TArray<FBitmapPoint> CandidatePoints;
+	CandidateIds.Reserve(UnassignedIds.Num());
+	CandidatePoints.Reserve(UnassignedIds.Num());
+	for (int32 Id : UnassignedIds)
+	{
+		FBitmapPoint Point;
+		if (Storage->GetPointById(Id, Point))
+		{
+			CandidateIds.Add(Id);
+			CandidatePoints.Add(Point);
+		}
+	}
+
+	const TArray<FDetectedPlane> NewPlanes = PlaneDetection->DetectPlanesFromPoints(CandidatePoints, PlaneThickness);
+	int32 NumAdded = 0;
+	TArray<bool> Claimed;
+	Claimed.SetNumZeroed(CandidateIds.Num());
+	for (const FDetectedPlane& NewPlane : NewPlanes)
+	{
+		FBitmapPointPlaneFit Fit;
+		Fit.Plane = NewPlane;
+
+		// Claim the plane's inliers, the same distance test detection counted them with
+		TArray<int32> Inliers;
+		for (int32 i = 0; i < CandidateIds.Num(); i++)
+		{
+			if (!Claimed[i] && FMath::Abs(FVector::DotProduct(CandidatePoints[i].Position - NewPlane.Center, NewPlane.Normal)) <= PlaneThickness)
+			{
+				Inliers.Add(i);
+				Fit.Accumulate(CandidatePoints[i].Position, 1.0);
+			}
+		}
+
+		if (Fit.Count < MinPlanePoints)
+		{
+			continue;
+		}
+
+		const int32 PlaneSlot = NextPlaneSlot++;
+		for (int32 i : Inliers)
+		{
+			Claimed[i] = true;
+			UnassignedIds.Remove(CandidateIds[i]);
+			Members.Add(CandidateIds[i], { PlaneSlot, CandidatePoints[i].Position });
+		}
+
+		Fit.Refit();
+		PlaneDetection->AddDetectedPlane(Fit.Plane);
+		Planes.Add(PlaneSlot, MoveTemp(Fit));
+		NumAdded++;
+	}
+
+	return NumAdded;
+}
+
+void UBitmapPointPlaneTracker::DropPlane(int32 PlaneSlot, UPlaneDetectionSubsystem* PlaneDetection)
+{
+	FBitmapPointPlaneFit Fit;
+	if (!Planes.RemoveAndCopyValue(PlaneSlot, Fit))
+	{
+		return;
+	}
+
+	if (PlaneDetection)
+	{
+		PlaneDetection->RemovePlane(Fit.Plane.PlaneID);
+	}
+
+	for (auto It = Members.CreateIterator(); It; ++It)
+	{
+		if (It.Value().PlaneSlot == PlaneSlot)
+		{
+			UnassignedIds.Add(It.Key());
+			It.RemoveCurrent();
+		}
+	}
+}
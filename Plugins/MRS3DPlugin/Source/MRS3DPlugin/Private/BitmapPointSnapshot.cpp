@@ -0,0 +1,39 @@
+#include "BitmapPointSnapshot.h"
+
+FBitmapPointSnapshot::FBitmapPointSnapshot()
+	: Version(0)
+	, NumPoints(0)
+	, PageSize(1.0f)
+	, CellSize(1.0f)
+{
+}
+
+void FBitmapPointSnapshot::FindPointsInRadius(const FVector& Location, float Radius, TArray<FBitmapPoint>& OutPoints) const
+{
+	OutPoints.Reset();
+
+	ForEachPointInRadius(Location, Radius, [&OutPoints](const FBitmapPoint& Point) {
+		OutPoints.Add(Point);
+		return true;
+	});
+}
+
+void FBitmapPointSnapshot::CopyPoints(TArray<FBitmapPoint>& OutPoints) const
+{
+	OutPoints.Reset(NumPoints);
+
+	for (const TPair<FIntVector, FPageRef>& PagePair : Pages)
+	{
+		PagePair.Value->Quantizer.DecodePoints(PagePair.Value->Points, OutPoints);
+	}
+}
+
+SIZE_T FBitmapPointSnapshot::GetAllocatedSize() const
+{
+	SIZE_T AllocatedSize = Pages.GetAllocatedSize();
+	for (const TPair<FIntVector, FPageRef>& PagePair : Pages)
+	{
+		AllocatedSize += sizeof(FBitmapPointSnapshotPage) + PagePair.Value->Points.GetAllocatedSize();
+	}
+	return AllocatedSize;
+}
@@ -1,13 +1,20 @@
 #include "BitmapPointSpatialIndex.h"
 #include "Engine/Engine.h"
+#include "Async/ParallelFor.h"
 
 UBitmapPointSpatialIndex::UBitmapPointSpatialIndex()
 	: CellSize(100.0f)
 	, WorldBounds(FVector(10000.0f))
 	, MaxPointsPerCell(100)
+	, MinCellSize(12.5f)
+	, Storage(nullptr)
+	, bOwnsStorage(false)
 	, TotalPointCount(0)
+	, bSnapshotFullyDirty(false)
 {
 	PrimaryComponentTick.bCanEverTick = false;
+	
+	ConfigureLevels();
 }
 
 void UBitmapPointSpatialIndex::Initialize(float InCellSize, const FVector& InWorldBounds)
@@ -16,289 +23,751 @@ void UBitmapPointSpatialIndex::Initialize(float InCellSize, const FVector& InWor
 	WorldBounds = InWorldBounds;
 	
 	Clear();
+	ConfigureLevels();
 	
-	UE_LOG(LogTemp, Log, TEXT("Spatial Index: Initialized with cell size %.1f and bounds %s"), 
-		CellSize, *WorldBounds.ToString());
+	UE_LOG(LogTemp, Log, TEXT("Spatial Index: Initialized with cell size %.1f, %d subdivision levels and bounds %s"), 
+		CellSize, Levels.Num() - 1, *WorldBounds.ToString());
+}
+
+void UBitmapPointSpatialIndex::SetChunkSize(float InChunkSize)
+{
+	if (InChunkSize == ChunkGrid.GetChunkSize())
+	{
+		return;
+	}
+
+	ChunkGrid.SetChunkSize(InChunkSize);
+
+	// Re-count the indexed points into the new chunks
+	for (const FGridLevel& Level : Levels)
+	{
+		Level.VoxelHash.ForEachCell([this, &Level](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+			return Level.VoxelHash.ForEachSpan(CellRef, [this](const FVoxelPointSpan& Span) {
+				for (int32 Lane = 0; Lane < Span.Num; Lane++)
+				{
+					ChunkGrid.AddPoint(FVector(Span.X[Lane], Span.Y[Lane], Span.Z[Lane]));
+				}
+				return true;
+			});
+		});
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Spatial Index: Chunk size set to %.1f, %d chunks"), ChunkGrid.GetChunkSize(), ChunkGrid.GetNumChunks());
+}
+
+void UBitmapPointSpatialIndex::SetStorage(UBitmapPointStorage* InStorage)
+{
+	if (InStorage == Storage)
+	{
+		return;
+	}
+
+	Storage = InStorage;
+	bOwnsStorage = false;
+
+	// Ids from the previous storage mean nothing in the new one
+	Rebuild();
 }
 
 void UBitmapPointSpatialIndex::AddPoint(const FBitmapPoint& Point)
 {
-	const FIntVector GridPos = WorldToGrid(Point.Position);
-	FSpatialCell& Cell = GetOrCreateCell(GridPos);
-	
-	Cell.AddPoint(Point);
-	TotalPointCount++;
-	
-	OnSpatialIndexUpdated.Broadcast(1, 0);
+	UBitmapPointStorage* TargetStorage = GetOrCreateStorage();
+	const int32 StartIndex = TargetStorage->GetPointCount();
+
+	TargetStorage->AddPoint(Point);
+	AddStoredPoints(StartIndex, 1);
 }
 
 void UBitmapPointSpatialIndex::AddPoints(const TArray<FBitmapPoint>& Points)
 {
-	for (const FBitmapPoint& Point : Points)
+	if (Points.Num() == 0)
 	{
-		const FIntVector GridPos = WorldToGrid(Point.Position);
-		FSpatialCell& Cell = GetOrCreateCell(GridPos);
-		Cell.AddPoint(Point);
+		return;
 	}
-	
-	TotalPointCount += Points.Num();
-	OnSpatialIndexUpdated.Broadcast(Points.Num(), 0);
+
+	UBitmapPointStorage* TargetStorage = GetOrCreateStorage();
+	const int32 StartIndex = TargetStorage->GetPointCount();
+
+	TargetStorage->AddPoints(Points);
+	AddStoredPoints(StartIndex, Points.Num());
+}
+
+void UBitmapPointSpatialIndex::AddStoredPoints(int32 StartIndex, int32 Count)
+{
+	if (!Storage)
+	{
+		return;
+	}
+
+	const int32 EndIndex = FMath::Min(StartIndex + Count, Storage->GetPointCount());
+	StartIndex = FMath::Max(StartIndex, 0);
+	if (EndIndex <= StartIndex)
+	{
+		return;
+	}
+
+	// Walk the stored rows directly rather than resolving each index, which costs a chunk search in the ring layout
+	Storage->ForEachPointInRange(StartIndex, EndIndex - StartIndex, [this](int32 Id, const FBitmapPointView& Point) {
+		InsertPoint(Id, Point.Position);
+	});
+
+	OnSpatialIndexUpdated.Broadcast(EndIndex - StartIndex, 0);
 }
 
 bool UBitmapPointSpatialIndex::RemovePoint(const FBitmapPoint& Point)
 {
-	const FIntVector GridPos = WorldToGrid(Point.Position);
-	const FSpatialCell* Cell = GetCell(GridPos);
+	const FGridLevel& Level = Levels[FindLeafLevel(Point.Position)];
 	
-	if (!Cell)
+	FVoxelCellRef CellRef;
+	if (!Level.VoxelHash.FindCell(WorldToGrid(Point.Position, Level.CellSize), CellRef))
 	{
 		return false;
 	}
 	
-	FSpatialCell& MutableCell = SpatialGrid[GridPos];
-	if (MutableCell.RemovePoint(Point))
-	{
-		TotalPointCount--;
-		
-		// Remove empty cell to save memory
-		if (MutableCell.IsEmpty())
+	// Match on the cached position first and only resolve candidates from storage
+	const FVector3f Position(Point.Position);
+	int32 MatchedId = INDEX_NONE;
+	Level.VoxelHash.ForEachSpan(CellRef, [this, &Point, &Position, &MatchedId](const FVoxelPointSpan& Span) {
+		for (int32 Lane = 0; Lane < Span.Num; Lane++)
 		{
-			SpatialGrid.Remove(GridPos);
+			FBitmapPoint StoredPoint;
+			if (Span.X[Lane] == Position.X && Span.Y[Lane] == Position.Y && Span.Z[Lane] == Position.Z &&
+				ResolvePoint(Span.Ids[Lane], StoredPoint) && StoredPoint.Position == Point.Position)
+			{
+				MatchedId = Span.Ids[Lane];
+				return false;
+			}
 		}
-		
-		OnSpatialIndexUpdated.Broadcast(0, 1);
 		return true;
-	}
+	});
 	
-	return false;
+	return MatchedId != INDEX_NONE && RemovePointById(MatchedId);
+}
+
+bool UBitmapPointSpatialIndex::RemovePointById(int32 Id)
+{
+	if (!RemoveIndexedPoint(Id))
+	{
+		return false;
+	}
+
+	// Points added through this index's own storage do not outlive their index entry
+	if (bOwnsStorage && Storage)
+	{
+		Storage->RemovePointsById({ Id });
+	}
+
+	OnSpatialIndexUpdated.Broadcast(0, 1);
+	return true;
+}
+
+int32 UBitmapPointSpatialIndex::RemovePointsById(const TArray<int32>& Ids)
+{
+	int32 RemovedCount = 0;
+	for (int32 Id : Ids)
+	{
+		RemovedCount += RemoveIndexedPoint(Id) ? 1 : 0;
+	}
+
+	if (bOwnsStorage && Storage)
+	{
+		Storage->RemovePointsById(Ids);
+	}
+
+	if (RemovedCount > 0)
+	{
+		OnSpatialIndexUpdated.Broadcast(0, RemovedCount);
+	}
+
+	return RemovedCount;
+}
+
+void UBitmapPointSpatialIndex::RefreshStoredPoints(const TArray<int32>& Ids)
+{
+	if (!Storage)
+	{
+		return;
+	}
+
+	for (int32 Id : Ids)
+	{
+		FBitmapPoint Point;
+		if (RemoveIndexedPoint(Id) && Storage->GetPointById(Id, Point))
+		{
+			InsertPoint(Id, Point.Position);
+		}
+	}
 }
 
 void UBitmapPointSpatialIndex::Clear()
 {
-	SpatialGrid.Empty();
+	const int32 RemovedCount = TotalPointCount;
+
+	for (FGridLevel& Level : Levels)
+	{
+		Level.VoxelHash.Reset();
+		Level.SubdividedCells.Empty();
+		Level.SubdividedCellsByBrick.Empty();
+	}
+	LocationPages.Empty();
 	TotalPointCount = 0;
+	bSnapshotFullyDirty = true;
+	ChunkGrid.ClearPoints();
+
+	if (bOwnsStorage && Storage)
+	{
+		Storage->Clear();
+	}
 	
-	OnSpatialIndexUpdated.Broadcast(0, TotalPointCount);
+	OnSpatialIndexUpdated.Broadcast(0, RemovedCount);
 }
 
 TArray<FBitmapPoint> UBitmapPointSpatialIndex::FindPointsInRadius(const FVector& Location, float Radius) const
 {
 	TArray<FBitmapPoint> Result;
+	FindPointsInRadius(Location, Radius, Result);
+	return Result;
+}
+
+void UBitmapPointSpatialIndex::FindPointsInRadius(const FVector& Location, float Radius, TArray<FBitmapPoint>& OutPoints) const
+{
+	OutPoints.Reset();
 	
-	const TArray<FIntVector> CellsToCheck = GetCellsInSphere(Location, Radius);
+	ForEachPointInRadius(Location, Radius, [this, &OutPoints](int32 Id, const FVector3f& Position) {
+		FBitmapPoint Point;
+		if (ResolvePoint(Id, Point))
+		{
+			OutPoints.Add(Point);
+		}
+		return true;
+	});
+}
+
+void UBitmapPointSpatialIndex::FindPointIdsInRadius(const FVector& Location, float Radius, TArray<int32>& OutIds) const
+{
+	OutIds.Reset();
+	
+	ForEachPointInRadius(Location, Radius, [&OutIds](int32 Id, const FVector3f& Position) {
+		OutIds.Add(Id);
+		return true;
+	});
+}
+
+void UBitmapPointSpatialIndex::FindPointsInRadiusBatch(TConstArrayView<FVector> Centers, float Radius, TArray<TArray<FBitmapPoint>>& OutPointsPerQuery) const
+{
+	OutPointsPerQuery.SetNum(Centers.Num());
 	
-	for (const FIntVector& GridPos : CellsToCheck)
+	// The parallel queries must not modify the index, so the owner gets one chance to add points up front
+	NotifyBatchQueryBounds(Centers, Radius);
+	
+	// Queries only read the index and storage, so each can fill its own output array independently
+	ParallelFor(Centers.Num(), [this, &Centers, Radius, &OutPointsPerQuery](int32 QueryIndex) {
+		TArray<FBitmapPoint>& OutPoints = OutPointsPerQuery[QueryIndex];
+		OutPoints.Reset();
+		VisitPointsInRadius(Centers[QueryIndex], Radius, [this, &OutPoints](int32 Id, const FVector3f& Position) {
+			FBitmapPoint Point;
+			if (ResolvePoint(Id, Point))
+			{
+				OutPoints.Add(Point);
+			}
+			return true;
+		});
+	}, Centers.Num() < MinParallelBatchSize);
+}
+
+void UBitmapPointSpatialIndex::FindPointIdsInRadiusBatch(TConstArrayView<FVector> Centers, float Radius, TArray<TArray<int32>>& OutIdsPerQuery) const
+{
+	OutIdsPerQuery.SetNum(Centers.Num());
+	
+	NotifyBatchQueryBounds(Centers, Radius);
+	
+	ParallelFor(Centers.Num(), [this, &Centers, Radius, &OutIdsPerQuery](int32 QueryIndex) {
+		TArray<int32>& OutIds = OutIdsPerQuery[QueryIndex];
+		OutIds.Reset();
+		VisitPointsInRadius(Centers[QueryIndex], Radius, [&OutIds](int32 Id, const FVector3f& Position) {
+			OutIds.Add(Id);
+			return true;
+		});
+	}, Centers.Num() < MinParallelBatchSize);
+}
+
+void UBitmapPointSpatialIndex::NotifyQueryBounds(const FBox& Bounds) const
+{
+	if (OnQueryBounds.IsBound() && IsInGameThread())
 	{
-		const FSpatialCell* Cell = GetCell(GridPos);
-		if (!Cell)
+		OnQueryBounds.Execute(Bounds);
+	}
+}
+
+void UBitmapPointSpatialIndex::NotifyBatchQueryBounds(TConstArrayView<FVector> Centers, float Radius) const
+{
+	if (!OnQueryBounds.IsBound() || Centers.Num() == 0)
+	{
+		return;
+	}
+	
+	FBox BatchBounds(ForceInit);
+	for (const FVector& Center : Centers)
+	{
+		BatchBounds += Center;
+	}
+	NotifyQueryBounds(BatchBounds.ExpandBy(Radius));
+}
+
+#if !UE_BUILD_SHIPPING
+int32 UBitmapPointSpatialIndex::VerifyRadiusQueries(int32 NumQueries, float Radius) const
+{
+	if (NumQueries <= 0 || TotalPointCount == 0 || !Storage || Storage->IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Spatial Index: Query verification needs indexed points"));
+		return 0;
+	}
+	
+	// Query around stored points so every query lands in occupied space
+	FRandomStream Random(NumQueries);
+	TArray<FVector> Centers;
+	Centers.Reserve(NumQueries);
+	for (int32 i = 0; i < NumQueries; i++)
+	{
+		Centers.Add(Storage->GetPoint(Random.RandHelper(Storage->GetPointCount())).Position);
+	}
+	
+	const float RadiusSquared = Radius * Radius;
+	
+	TArray<TArray<int32>> BatchIds;
+	FindPointIdsInRadiusBatch(Centers, Radius, BatchIds);
+	
+	int32 NumMismatches = 0;
+	TArray<int32> ScalarIds;
+	TArray<int32> SingleIds;
+	for (int32 QueryIndex = 0; QueryIndex < Centers.Num(); QueryIndex++)
+	{
+		// Scalar reference, one distance per point in the same single precision the vectorized kernel uses
+		const FVector& Center = Centers[QueryIndex];
+		const FVector3f Center3f(Center);
+		ScalarIds.Reset();
+		for (const FGridLevel& Level : Levels)
 		{
-			continue;
+			Level.VoxelHash.ForEachCellInRange(WorldToGrid(Center - FVector(Radius), Level.CellSize), WorldToGrid(Center + FVector(Radius), Level.CellSize),
+				[this, &Level, &Center, &Center3f, RadiusSquared, &ScalarIds](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+					if (GetSquaredDistanceToCell(GridPos, Level.CellSize, Center) > RadiusSquared)
+					{
+						return true;
+					}
+					
+					return Level.VoxelHash.ForEachSpan(CellRef, [&Center3f, RadiusSquared, &ScalarIds](const FVoxelPointSpan& Span) {
+						for (int32 Lane = 0; Lane < Span.Num; Lane++)
+						{
+							if (FVector3f::DistSquared(FVector3f(Span.X[Lane], Span.Y[Lane], Span.Z[Lane]), Center3f) <= RadiusSquared)
+							{
+								ScalarIds.Add(Span.Ids[Lane]);
+							}
+						}
+						return true;
+					});
+				});
 		}
 		
-		for (const FBitmapPoint& Point : Cell->Points)
+		FindPointIdsInRadius(Center, Radius, SingleIds);
+		
+		ScalarIds.Sort();
+		SingleIds.Sort();
+		BatchIds[QueryIndex].Sort();
+		if (ScalarIds != SingleIds || SingleIds != BatchIds[QueryIndex])
 		{
-			if (IsPointInRadius(Point, Location, Radius))
+			if (NumMismatches == 0)
 			{
-				Result.Add(Point);
+				UE_LOG(LogTemp, Warning, TEXT("Spatial Index: Query %d at %s found %d scalar, %d vectorized, %d batched ids"),
+					QueryIndex, *Center.ToString(), ScalarIds.Num(), SingleIds.Num(), BatchIds[QueryIndex].Num());
 			}
+			NumMismatches++;
 		}
 	}
 	
-	return Result;
+	if (NumMismatches > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Spatial Index: %d of %d radius %.1f queries disagree between scalar, vectorized and batched paths"), NumMismatches, NumQueries, Radius);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Log, TEXT("Spatial Index: %d radius %.1f queries over %d points agree across scalar, vectorized and batched paths"), NumQueries, Radius, TotalPointCount);
+	}
+	
+	return NumMismatches;
 }
+#endif
 
 bool UBitmapPointSpatialIndex::FindNearestPoint(const FVector& Location, FBitmapPoint& OutPoint, float MaxDistance) const
 {
-	float MinDistanceSquared = MaxDistance * MaxDistance;
-	bool bFoundPoint = false;
-	
-	const TArray<FIntVector> CellsToCheck = GetCellsInSphere(Location, MaxDistance);
+	const int32 NearestId = FindNearestPointId(Location, MaxDistance);
+	return NearestId != INDEX_NONE && ResolvePoint(NearestId, OutPoint);
+}
+
+int32 UBitmapPointSpatialIndex::FindNearestPointId(const FVector& Location, float MaxDistance) const
+{
+	int32 NearestId = INDEX_NONE;
+	ForEachKNearestId(Location, 1, MaxDistance, [&NearestId](int32 Id) {
+		NearestId = Id;
+	});
+	return NearestId;
+}
+
+template<typename VisitorType>
+bool UBitmapPointSpatialIndex::ForEachCellInTopLevelBrick(const FIntVector& Brick, VisitorType&& Visitor) const
+{
+	const FGridLevel& TopLevel = Levels[0];
+	const bool bCompleted = TopLevel.VoxelHash.ForEachCellInBrick(Brick, [&TopLevel, &Visitor](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+		return Visitor(TopLevel, GridPos, CellRef);
+	});
+	if (!bCompleted)
+	{
+		return false;
+	}
 	
-	for (const FIntVector& GridPos : CellsToCheck)
+	// Points below depth 0 only live in the children of subdivided cells, and a brick without any at one depth has none deeper
+	for (int32 LevelIndex = 1; LevelIndex < Levels.Num(); LevelIndex++)
 	{
-		const FSpatialCell* Cell = GetCell(GridPos);
-		if (!Cell)
+		const TArray<FIntVector>* ParentCells = Levels[LevelIndex - 1].SubdividedCellsByBrick.Find(Brick);
+		if (!ParentCells)
 		{
-			continue;
+			break;
 		}
 		
-		for (const FBitmapPoint& Point : Cell->Points)
+		const FGridLevel& Level = Levels[LevelIndex];
+		for (const FIntVector& ParentCell : *ParentCells)
 		{
-			const float DistanceSquared = GetSquaredDistance(Point, Location);
-			if (DistanceSquared < MinDistanceSquared)
+			const bool bChildrenCompleted = Level.VoxelHash.ForEachCellInRange(ParentCell * 2, ParentCell * 2 + FIntVector(1),
+				[&Level, &Visitor](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+					return Visitor(Level, GridPos, CellRef);
+				});
+			if (!bChildrenCompleted)
 			{
-				MinDistanceSquared = DistanceSquared;
-				OutPoint = Point;
-				bFoundPoint = true;
+				return false;
 			}
 		}
 	}
 	
-	return bFoundPoint;
+	return true;
 }
 
-TArray<FBitmapPoint> UBitmapPointSpatialIndex::FindKNearestPoints(const FVector& Location, int32 K, float MaxDistance) const
+template<typename SinkType>
+void UBitmapPointSpatialIndex::ForEachKNearestId(const FVector& Location, int32 K, float MaxDistance, SinkType&& Sink) const
 {
-	TArray<FBitmapPoint> Result;
+	if (K > 0 && MaxDistance >= 0.0f)
+	{
+		NotifyQueryBounds(FBox(Location - FVector(MaxDistance), Location + FVector(MaxDistance)));
+	}
 	
-	if (K <= 0)
+	if (K <= 0 || MaxDistance < 0.0f || TotalPointCount == 0)
 	{
-		return Result;
+		return;
 	}
 	
-	// Use a priority queue to maintain K nearest points
+	// Max heap of the best K candidates so far (furthest on top), kept inline for typical K
 	struct FPointDistance
 	{
-		FBitmapPoint Point;
+		int32 Id;
 		float DistanceSquared;
 		
 		bool operator<(const FPointDistance& Other) const
 		{
-			return DistanceSquared > Other.DistanceSquared; // Max heap (furthest first)
+			return DistanceSquared > Other.DistanceSquared;
 		}
 	};
 	
-	TArray<FPointDistance> NearestPoints;
+	TArray<FPointDistance, TInlineAllocator<64>> NearestPoints;
 	const float MaxDistanceSquared = MaxDistance * MaxDistance;
+	const FVector3f Center(Location);
 	
-	const TArray<FIntVector> CellsToCheck = GetCellsInSphere(Location, MaxDistance);
+	// Candidates must beat both MaxDistance and, once the heap is full, the current K-th distance
+	auto GetCutoffSquared = [&NearestPoints, K, MaxDistanceSquared]() {
+		return NearestPoints.Num() < K ? MaxDistanceSquared : NearestPoints.HeapTop().DistanceSquared;
+	};
 	
-	for (const FIntVector& GridPos : CellsToCheck)
-	{
-		const FSpatialCell* Cell = GetCell(GridPos);
-		if (!Cell)
+	auto VisitCell = [this, &Location, &Center, K, &NearestPoints, &GetCutoffSquared](const FGridLevel& Level, const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+		if (GetSquaredDistanceToCell(GridPos, Level.CellSize, Location) > GetCutoffSquared())
 		{
-			continue;
+			return true;
 		}
 		
-		for (const FBitmapPoint& Point : Cell->Points)
-		{
-			const float DistanceSquared = GetSquaredDistance(Point, Location);
-			
-			if (DistanceSquared <= MaxDistanceSquared)
+		return Level.VoxelHash.ForEachSpan(CellRef, [K, &Center, &NearestPoints, &GetCutoffSquared](const FVoxelPointSpan& Span) {
+			for (int32 Lane = 0; Lane < Span.Num; Lane++)
 			{
+				const float DX = Span.X[Lane] - Center.X;
+				const float DY = Span.Y[Lane] - Center.Y;
+				const float DZ = Span.Z[Lane] - Center.Z;
+				const float DistanceSquared = DX * DX + DY * DY + DZ * DZ;
+				
 				if (NearestPoints.Num() < K)
 				{
-					NearestPoints.Add({Point, DistanceSquared});
-					NearestPoints.HeapifyUp(NearestPoints.Num() - 1);
+					if (DistanceSquared <= GetCutoffSquared())
+					{
+						NearestPoints.HeapPush({Span.Ids[Lane], DistanceSquared});
+					}
 				}
-				else if (DistanceSquared < NearestPoints[0].DistanceSquared)
+				else if (DistanceSquared < NearestPoints.HeapTop().DistanceSquared)
 				{
-					NearestPoints[0] = {Point, DistanceSquared};
-					NearestPoints.Heapify();
+					// Replace the furthest candidate in O(log K)
+					NearestPoints.HeapPopDiscard(false);
+					NearestPoints.HeapPush({Span.Ids[Lane], DistanceSquared});
+				}
+			}
+			return true;
+		});
+	};
+	
+	const float BrickWorldSize = CellSize * FBitmapPointVoxelHash::BrickEdge;
+	const FIntVector CenterBrick = FBitmapPointVoxelHash::CellToBrick(WorldToGrid(Location, CellSize));
+	const FIntVector MinBrick = FBitmapPointVoxelHash::CellToBrick(WorldToGrid(Location - FVector(MaxDistance), CellSize));
+	const FIntVector MaxBrick = FBitmapPointVoxelHash::CellToBrick(WorldToGrid(Location + FVector(MaxDistance), CellSize));
+	const int32 MaxRing = FMath::Max3(
+		FMath::Max(CenterBrick.X - MinBrick.X, MaxBrick.X - CenterBrick.X),
+		FMath::Max(CenterBrick.Y - MinBrick.Y, MaxBrick.Y - CenterBrick.Y),
+		FMath::Max(CenterBrick.Z - MinBrick.Z, MaxBrick.Z - CenterBrick.Z));
+	
+	for (int32 Ring = 0; Ring <= MaxRing; Ring++)
+	{
+		if (Ring > 0)
+		{
+			// Every point in this shell or beyond lies outside the cube of bricks already searched
+			const FVector InnerMin = FVector(CenterBrick - FIntVector(Ring - 1)) * BrickWorldSize;
+			const FVector InnerMax = FVector(CenterBrick + FIntVector(Ring)) * BrickWorldSize;
+			const float RingDistance = FMath::Min((Location - InnerMin).GetMin(), (InnerMax - Location).GetMin());
+			
+			if (RingDistance * RingDistance > GetCutoffSquared())
+			{
+				break;
+			}
+		}
+		
+		for (int32 DZ = -Ring; DZ <= Ring; DZ++)
+		{
+			for (int32 DY = -Ring; DY <= Ring; DY++)
+			{
+				// Rows inside the shell only contribute their two end bricks
+				const bool bOnFace = FMath::Abs(DZ) == Ring || FMath::Abs(DY) == Ring;
+				const int32 StepX = bOnFace ? 1 : 2 * Ring;
+				
+				for (int32 DX = -Ring; DX <= Ring; DX += StepX)
+				{
+					ForEachCellInTopLevelBrick(CenterBrick + FIntVector(DX, DY, DZ), VisitCell);
 				}
 			}
 		}
 	}
 	
-	// Extract points from heap
-	Result.Reserve(NearestPoints.Num());
-	for (const FPointDistance& PointDist : NearestPoints)
+	// The inverted ordering makes HeapSort leave the furthest candidate first
+	NearestPoints.HeapSort();
+	for (int32 Index = NearestPoints.Num() - 1; Index >= 0; Index--)
 	{
-		Result.Add(PointDist.Point);
+		Sink(NearestPoints[Index].Id);
 	}
+}
+
+TArray<FBitmapPoint> UBitmapPointSpatialIndex::FindKNearestPoints(const FVector& Location, int32 K, float MaxDistance) const
+{
+	TArray<FBitmapPoint> Result;
+	FindKNearestPoints(Location, K, MaxDistance, Result);
+	return Result;
+}
+
+void UBitmapPointSpatialIndex::FindKNearestPoints(const FVector& Location, int32 K, float MaxDistance, TArray<FBitmapPoint>& OutPoints) const
+{
+	OutPoints.Reset();
 	
-	// Sort by distance (closest first)
-	Result.Sort([&Location](const FBitmapPoint& A, const FBitmapPoint& B) {
-		const float DistA = FVector::DistSquared(A.Position, Location);
-		const float DistB = FVector::DistSquared(B.Position, Location);
-		return DistA < DistB;
+	ForEachKNearestId(Location, K, MaxDistance, [this, &OutPoints](int32 Id) {
+		FBitmapPoint Point;
+		if (ResolvePoint(Id, Point))
+		{
+			OutPoints.Add(Point);
+		}
 	});
+}
+
+void UBitmapPointSpatialIndex::FindKNearestPointIds(const FVector& Location, int32 K, float MaxDistance, TArray<int32>& OutIds) const
+{
+	OutIds.Reset();
 	
-	return Result;
+	ForEachKNearestId(Location, K, MaxDistance, [&OutIds](int32 Id) {
+		OutIds.Add(Id);
+	});
 }
 
 TArray<FBitmapPoint> UBitmapPointSpatialIndex::FindPointsInBox(const FVector& MinBounds, const FVector& MaxBounds) const
 {
 	TArray<FBitmapPoint> Result;
+	FindPointsInBox(MinBounds, MaxBounds, Result);
+	return Result;
+}
+
+void UBitmapPointSpatialIndex::FindPointsInBox(const FVector& MinBounds, const FVector& MaxBounds, TArray<FBitmapPoint>& OutPoints) const
+{
+	OutPoints.Reset();
 	
-	const TArray<FIntVector> CellsToCheck = GetCellsInBox(MinBounds, MaxBounds);
-	
-	for (const FIntVector& GridPos : CellsToCheck)
-	{
-		const FSpatialCell* Cell = GetCell(GridPos);
-		if (!Cell)
-		{
-			continue;
-		}
-		
-		for (const FBitmapPoint& Point : Cell->Points)
+	ForEachPointInBox(MinBounds, MaxBounds, [this, &OutPoints](int32 Id, const FVector3f& Position) {
+		FBitmapPoint Point;
+		if (ResolvePoint(Id, Point))
 		{
-			if (Point.Position.X >= MinBounds.X && Point.Position.X <= MaxBounds.X &&
-				Point.Position.Y >= MinBounds.Y && Point.Position.Y <= MaxBounds.Y &&
-				Point.Position.Z >= MinBounds.Z && Point.Position.Z <= MaxBounds.Z)
-			{
-				Result.Add(Point);
-			}
+			OutPoints.Add(Point);
 		}
-	}
-	
-	return Result;
+		return true;
+	});
 }
 
-TArray<FBitmapPoint> UBitmapPointSpatialIndex::FindPointsAlongRay(const FVector& Origin, const FVector& Direction, float Tolerance, float MaxDistance) const
+TArray<FBitmapPoint> UBitmapPointSpatialIndex::FindPointsAlongRay(const FVector& Origin, const FVector& Direction, float Tolerance, float MaxDistance, bool bSortByDistance) const
 {
 	TArray<FBitmapPoint> Result;
+	FindPointsAlongRay(Origin, Direction, Tolerance, MaxDistance, Result, bSortByDistance);
+	return Result;
+}
+
+void UBitmapPointSpatialIndex::FindPointsAlongRay(const FVector& Origin, const FVector& Direction, float Tolerance, float MaxDistance, TArray<FBitmapPoint>& OutPoints, bool bSortByDistance) const
+{
+	OutPoints.Reset();
+	
+	if (!bSortByDistance)
+	{
+		ForEachPointAlongRay(Origin, Direction, Tolerance, MaxDistance, [this, &OutPoints](int32 Id, const FVector3f& Position) {
+			FBitmapPoint Point;
+			if (ResolvePoint(Id, Point))
+			{
+				OutPoints.Add(Point);
+			}
+			return true;
+		});
+		return;
+	}
 	
+	struct FRayHit
+	{
+		int32 Id;
+		float Distance;
+	};
+	
+	// Traversal order is only approximately along the ray, so order hits before resolving them
+	TArray<FRayHit, TInlineAllocator<64>> Hits;
 	const FVector NormalizedDirection = Direction.GetSafeNormal();
-	const FVector EndPoint = Origin + NormalizedDirection * MaxDistance;
 	
-	// Create bounding box around the ray
-	const FVector MinBounds = FVector(
-		FMath::Min(Origin.X, EndPoint.X) - Tolerance,
-		FMath::Min(Origin.Y, EndPoint.Y) - Tolerance,
-		FMath::Min(Origin.Z, EndPoint.Z) - Tolerance
-	);
+	ForEachPointAlongRay(Origin, Direction, Tolerance, MaxDistance, [&Origin, &NormalizedDirection, &Hits](int32 Id, const FVector3f& Position) {
+		Hits.Add({Id, static_cast<float>(FVector::DotProduct(FVector(Position) - Origin, NormalizedDirection))});
+		return true;
+	});
 	
-	const FVector MaxBounds = FVector(
-		FMath::Max(Origin.X, EndPoint.X) + Tolerance,
-		FMath::Max(Origin.Y, EndPoint.Y) + Tolerance,
-		FMath::Max(Origin.Z, EndPoint.Z) + Tolerance
-	);
+	Hits.Sort([](const FRayHit& A, const FRayHit& B) {
+		return A.Distance < B.Distance;
+	});
 	
-	const TArray<FIntVector> CellsToCheck = GetCellsInBox(MinBounds, MaxBounds);
+	OutPoints.Reserve(Hits.Num());
+	for (const FRayHit& Hit : Hits)
+	{
+		FBitmapPoint Point;
+		if (ResolvePoint(Hit.Id, Point))
+		{
+			OutPoints.Add(Point);
+		}
+	}
+}
+
+FBitmapPointSnapshotRef UBitmapPointSpatialIndex::AcquireSnapshot()
+{
+	if (LatestSnapshot.IsValid() && !bSnapshotFullyDirty && DirtySnapshotPages.Num() == 0)
+	{
+		return LatestSnapshot.ToSharedRef();
+	}
+	
+	TSharedRef<FBitmapPointSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FBitmapPointSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->Version = Storage ? Storage->GetVersion() : 0;
+	Snapshot->CellSize = CellSize;
+	Snapshot->PageSize = CellSize * FBitmapPointVoxelHash::BrickEdge;
 	
-	for (const FIntVector& GridPos : CellsToCheck)
+	auto PublishPage = [this, &Snapshot](const FIntVector& Brick) {
+		TSharedPtr<const FBitmapPointSnapshotPage, ESPMode::ThreadSafe> Page = BuildSnapshotPage(Brick);
+		if (Page.IsValid())
+		{
+			Snapshot->Pages.Add(Brick, Page.ToSharedRef());
+		}
+		else
+		{
+			Snapshot->Pages.Remove(Brick);
+		}
+	};
+	
+	if (!LatestSnapshot.IsValid() || bSnapshotFullyDirty)
 	{
-		const FSpatialCell* Cell = GetCell(GridPos);
-		if (!Cell)
+		// Every occupied cell at every depth maps to one top-level brick
+		TSet<FIntVector> Bricks;
+		for (int32 LevelIndex = 0; LevelIndex < Levels.Num(); LevelIndex++)
 		{
-			continue;
+			const int32 Shift = LevelIndex + 2;
+			Levels[LevelIndex].VoxelHash.ForEachCell([&Bricks, Shift](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+				Bricks.Add(FIntVector(GridPos.X >> Shift, GridPos.Y >> Shift, GridPos.Z >> Shift));
+				return true;
+			});
 		}
 		
-		for (const FBitmapPoint& Point : Cell->Points)
+		for (const FIntVector& Brick : Bricks)
 		{
-			// Calculate distance from point to ray
-			const FVector PointToOrigin = Point.Position - Origin;
-			const float ProjectedDistance = FVector::DotProduct(PointToOrigin, NormalizedDirection);
-			
-			if (ProjectedDistance >= 0.0f && ProjectedDistance <= MaxDistance)
-			{
-				const FVector ClosestPointOnRay = Origin + NormalizedDirection * ProjectedDistance;
-				const float DistanceToRay = FVector::Dist(Point.Position, ClosestPointOnRay);
-				
-				if (DistanceToRay <= Tolerance)
-				{
-					Result.Add(Point);
-				}
-			}
+			PublishPage(Brick);
+		}
+	}
+	else
+	{
+		// Unchanged pages are shared with the previous snapshot, readers of either never see a page change
+		Snapshot->Pages = LatestSnapshot->Pages;
+		for (const FIntVector& Brick : DirtySnapshotPages)
+		{
+			PublishPage(Brick);
 		}
 	}
 	
-	return Result;
+	for (const TPair<FIntVector, FBitmapPointSnapshot::FPageRef>& PagePair : Snapshot->Pages)
+	{
+		Snapshot->NumPoints += PagePair.Value->Points.Num();
+	}
+	
+	DirtySnapshotPages.Reset();
+	bSnapshotFullyDirty = false;
+	LatestSnapshot = Snapshot;
+	
+	return Snapshot;
+}
+
+int32 UBitmapPointSpatialIndex::GetSnapshotMemoryUsageBytes() const
+{
+	return LatestSnapshot.IsValid() ? static_cast<int32>(LatestSnapshot->GetAllocatedSize()) : 0;
+}
+
+void UBitmapPointSpatialIndex::ReleaseSnapshot()
+{
+	LatestSnapshot.Reset();
+	DirtySnapshotPages.Empty();
+	bSnapshotFullyDirty = true;
 }
 
 int32 UBitmapPointSpatialIndex::GetMemoryUsageBytes() const
 {
 	int32 MemoryUsage = sizeof(*this);
 	
-	// Add memory for spatial grid
-	MemoryUsage += SpatialGrid.GetAllocatedSize();
+	// Add memory for the voxel hash tables, bricks, point payload and subdivision bookkeeping
+	MemoryUsage += Levels.GetAllocatedSize();
+	for (const FGridLevel& Level : Levels)
+	{
+		MemoryUsage += static_cast<int32>(Level.VoxelHash.GetAllocatedSize());
+		MemoryUsage += Level.SubdividedCells.GetAllocatedSize() + Level.SubdividedCellsByBrick.GetAllocatedSize();
+		for (const TPair<FIntVector, TArray<FIntVector>>& BrickCells : Level.SubdividedCellsByBrick)
+		{
+			MemoryUsage += BrickCells.Value.GetAllocatedSize();
+		}
+	}
 	
-	// Add memory for points in cells
-	for (const auto& GridPair : SpatialGrid)
+	// Add memory for the id to payload lookup and chunk bookkeeping
+	MemoryUsage += LocationPages.GetAllocatedSize() + LocationPages.Num() * LocationPageSize * static_cast<int32>(sizeof(int32));
+	MemoryUsage += static_cast<int32>(ChunkGrid.GetAllocatedSize());
+	
+	// Points are only counted here when the index keeps them itself
+	if (bOwnsStorage && Storage)
 	{
-		MemoryUsage += GridPair.Value.Points.GetAllocatedSize();
+		MemoryUsage += Storage->GetMemoryUsageBytes();
 	}
 	
 	return MemoryUsage;
@@ -306,123 +775,485 @@ int32 UBitmapPointSpatialIndex::GetMemoryUsageBytes() const
 
 void UBitmapPointSpatialIndex::GetSpatialStats(int32& ActiveCells, int32& MaxPointsPerCell, float& AveragePointsPerCell) const
 {
-	ActiveCells = SpatialGrid.Num();
+	ActiveCells = 0;
 	MaxPointsPerCell = 0;
-	int32 TotalPoints = 0;
 	
-	for (const auto& GridPair : SpatialGrid)
+	for (const FGridLevel& Level : Levels)
 	{
-		const int32 PointsInCell = GridPair.Value.Points.Num();
-		MaxPointsPerCell = FMath::Max(MaxPointsPerCell, PointsInCell);
-		TotalPoints += PointsInCell;
+		ActiveCells += Level.VoxelHash.GetNumCells();
+		Level.VoxelHash.ForEachCell([&Level, &MaxPointsPerCell](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+			MaxPointsPerCell = FMath::Max(MaxPointsPerCell, Level.VoxelHash.GetCellPointCount(CellRef));
+			return true;
+		});
 	}
 	
-	AveragePointsPerCell = ActiveCells > 0 ? static_cast<float>(TotalPoints) / ActiveCells : 0.0f;
+	AveragePointsPerCell = ActiveCells > 0 ? static_cast<float>(TotalPointCount) / ActiveCells : 0.0f;
 }
 
 void UBitmapPointSpatialIndex::Rebuild()
 {
-	TArray<FBitmapPoint> AllPoints;
+	for (FGridLevel& Level : Levels)
+	{
+		Level.VoxelHash.Reset();
+		Level.SubdividedCells.Empty();
+		Level.SubdividedCellsByBrick.Empty();
+	}
+	LocationPages.Empty();
+	TotalPointCount = 0;
+	bSnapshotFullyDirty = true;
+	ChunkGrid.ClearPoints();
 	
-	// Collect all points
-	for (const auto& GridPair : SpatialGrid)
+	if (Storage)
 	{
-		AllPoints.Append(GridPair.Value.Points);
+		AddStoredPoints(0, Storage->GetPointCount());
 	}
 	
-	// Clear and re-add
-	Clear();
-	AddPoints(AllPoints);
+	UE_LOG(LogTemp, Log, TEXT("Spatial Index: Rebuilt with %d points"), TotalPointCount);
+}
+
+void UBitmapPointSpatialIndex::GetLayout(float& OutCellSize, float& OutMinCellSize, TArray<FIntVector>& OutCells, TArray<int32>& OutCellLevels) const
+{
+	OutCellSize = CellSize;
+	OutMinCellSize = MinCellSize;
+	OutCells.Reset();
+	OutCellLevels.Reset();
 	
-	UE_LOG(LogTemp, Log, TEXT("Spatial Index: Rebuilt with %d points"), AllPoints.Num());
+	for (int32 LevelIndex = 0; LevelIndex < Levels.Num(); LevelIndex++)
+	{
+		for (const TPair<FIntVector, int32>& Cell : Levels[LevelIndex].SubdividedCells)
+		{
+			OutCells.Add(Cell.Key);
+			OutCellLevels.Add(LevelIndex);
+		}
+	}
 }
 
-FIntVector UBitmapPointSpatialIndex::WorldToGrid(const FVector& WorldPos) const
+bool UBitmapPointSpatialIndex::RebuildWithLayout(float InCellSize, float InMinCellSize, const TArray<FIntVector>& Cells, const TArray<int32>& CellLevels)
 {
-	return FIntVector(
-		FMath::FloorToInt(WorldPos.X / CellSize),
-		FMath::FloorToInt(WorldPos.Y / CellSize),
-		FMath::FloorToInt(WorldPos.Z / CellSize)
-	);
+	if (InCellSize != CellSize || InMinCellSize != MinCellSize || Cells.Num() != CellLevels.Num())
+	{
+		Rebuild();
+		return false;
+	}
+	
+	for (FGridLevel& Level : Levels)
+	{
+		Level.VoxelHash.Reset();
+		Level.SubdividedCells.Empty();
+		Level.SubdividedCellsByBrick.Empty();
+	}
+	LocationPages.Empty();
+	TotalPointCount = 0;
+	bSnapshotFullyDirty = true;
+	ChunkGrid.ClearPoints();
+	
+	// Seed the subdivisions so every point lands in its final leaf, counts below each cell are rebuilt by the inserts
+	for (int32 Index = 0; Index < Cells.Num(); Index++)
+	{
+		if (CellLevels[Index] >= 0 && CellLevels[Index] + 1 < Levels.Num())
+		{
+			AddSubdividedCell(CellLevels[Index], Cells[Index], 0);
+		}
+	}
+	
+	if (Storage)
+	{
+		AddStoredPoints(0, Storage->GetPointCount());
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("Spatial Index: Rebuilt with %d points from a saved layout of %d subdivided cells"), TotalPointCount, Cells.Num());
+	return true;
 }
 
-FVector UBitmapPointSpatialIndex::GridToWorld(const FIntVector& GridPos) const
+void UBitmapPointSpatialIndex::MarkSnapshotDirty(const FVector& Position)
 {
-	return FVector(
-		GridPos.X * CellSize,
-		GridPos.Y * CellSize,
-		GridPos.Z * CellSize
-	);
+	// Nothing to track until someone has asked for a snapshot
+	if (LatestSnapshot.IsValid() && !bSnapshotFullyDirty)
+	{
+		DirtySnapshotPages.Add(FBitmapPointVoxelHash::CellToBrick(WorldToGrid(Position, CellSize)));
+	}
 }
 
-TArray<FIntVector> UBitmapPointSpatialIndex::GetCellsInSphere(const FVector& Center, float Radius) const
+TSharedPtr<const FBitmapPointSnapshotPage, ESPMode::ThreadSafe> UBitmapPointSpatialIndex::BuildSnapshotPage(const FIntVector& Brick) const
 {
-	TArray<FIntVector> Cells;
+	TArray<FBitmapPoint> PagePoints;
 	
-	const FIntVector CenterGrid = WorldToGrid(Center);
-	const int32 CellRadius = FMath::CeilToInt(Radius / CellSize);
-	
-	for (int32 X = -CellRadius; X <= CellRadius; X++)
-	{
-		for (int32 Y = -CellRadius; Y <= CellRadius; Y++)
-		{
-			for (int32 Z = -CellRadius; Z <= CellRadius; Z++)
+	ForEachCellInTopLevelBrick(Brick, [this, &PagePoints](const FGridLevel& Level, const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+		return Level.VoxelHash.ForEachSpan(CellRef, [this, &PagePoints](const FVoxelPointSpan& Span) {
+			for (int32 Lane = 0; Lane < Span.Num; Lane++)
 			{
-				const FIntVector GridPos = CenterGrid + FIntVector(X, Y, Z);
-				const FVector CellCenter = GridToWorld(GridPos) + FVector(CellSize * 0.5f);
-				
-				// Check if cell intersects with sphere
-				const float DistanceToCell = FVector::Dist(Center, CellCenter);
-				const float CellDiagonal = CellSize * FMath::Sqrt(3.0f) * 0.5f;
-				
-				if (DistanceToCell <= Radius + CellDiagonal)
+				FBitmapPoint Point;
+				if (ResolvePoint(Span.Ids[Lane], Point))
 				{
-					Cells.Add(GridPos);
+					PagePoints.Add(Point);
 				}
 			}
-		}
+			return true;
+		});
+	});
+	
+	if (PagePoints.Num() == 0)
+	{
+		return nullptr;
 	}
 	
-	return Cells;
+	// The page is a cube of known size, so positions are encoded relative to its center at a fixed step
+	const float PageSize = CellSize * FBitmapPointVoxelHash::BrickEdge;
+	const FVector PageCenter = (FVector(Brick) + FVector(0.5f)) * PageSize;
+	
+	TSharedRef<FBitmapPointSnapshotPage, ESPMode::ThreadSafe> Page = MakeShared<FBitmapPointSnapshotPage, ESPMode::ThreadSafe>();
+	Page->Coord = Brick;
+	Page->Quantizer = FBitmapPointQuantizer::FitCube(PageCenter, PageSize);
+	Page->Quantizer.EncodePoints(PagePoints, Page->Points);
+	return Page;
+}
+
+UBitmapPointStorage* UBitmapPointSpatialIndex::GetOrCreateStorage()
+{
+	if (!Storage)
+	{
+		Storage = NewObject<UBitmapPointStorage>(this);
+		bOwnsStorage = true;
+	}
+	return Storage;
 }
 
-TArray<FIntVector> UBitmapPointSpatialIndex::GetCellsInBox(const FVector& MinBounds, const FVector& MaxBounds) const
+void UBitmapPointSpatialIndex::ConfigureLevels()
 {
-	TArray<FIntVector> Cells;
+	// Each extra depth halves the cell size until it would drop below MinCellSize
+	int32 NumLevels = 1;
+	float LevelCellSize = CellSize;
+	while (NumLevels < MaxLevels && LevelCellSize * 0.5f >= MinCellSize)
+	{
+		LevelCellSize *= 0.5f;
+		NumLevels++;
+	}
 	
-	const FIntVector MinGrid = WorldToGrid(MinBounds);
-	const FIntVector MaxGrid = WorldToGrid(MaxBounds);
+	Levels.Reset();
+	Levels.SetNum(NumLevels);
+	for (int32 LevelIndex = 0; LevelIndex < NumLevels; LevelIndex++)
+	{
+		Levels[LevelIndex].CellSize = CellSize / static_cast<float>(1 << LevelIndex);
+	}
 	
-	for (int32 X = MinGrid.X; X <= MaxGrid.X; X++)
+	LocationPages.Empty();
+	TotalPointCount = 0;
+	bSnapshotFullyDirty = true;
+	ChunkGrid.ClearPoints();
+}
+
+void UBitmapPointSpatialIndex::InsertPoint(int32 Id, const FVector& Position)
+{
+	if (FindLocation(Id))
+	{
+		return; // Already indexed
+	}
+
+	const int32 LeafLevel = FindLeafLevel(Position);
+	AddToLevel(LeafLevel, Id, FVector3f(Position));
+	TotalPointCount++;
+	MarkSnapshotDirty(Position);
+	ChunkGrid.AddPoint(Position);
+
+	// Every subdivided ancestor now has one more point below it
+	for (int32 LevelIndex = 0; LevelIndex < LeafLevel; LevelIndex++)
+	{
+		if (int32* Count = Levels[LevelIndex].SubdividedCells.Find(WorldToGrid(Position, Levels[LevelIndex].CellSize)))
+		{
+			(*Count)++;
+		}
+	}
+
+	if (MaxPointsPerCell > 0 && LeafLevel + 1 < Levels.Num())
+	{
+		const FIntVector Cell = WorldToGrid(Position, Levels[LeafLevel].CellSize);
+		FVoxelCellRef CellRef;
+		if (Levels[LeafLevel].VoxelHash.FindCell(Cell, CellRef) && Levels[LeafLevel].VoxelHash.GetCellPointCount(CellRef) > MaxPointsPerCell)
+		{
+			SplitCell(LeafLevel, Cell);
+		}
+	}
+}
+
+bool UBitmapPointSpatialIndex::RemoveIndexedPoint(int32 Id)
+{
+	int32* Location = FindLocation(Id);
+	if (!Location)
+	{
+		return false;
+	}
+
+	const int32 PackedLocation = *Location;
+	const int32 LeafLevel = GetLocationLevel(PackedLocation);
+	const FVector Position(Levels[LeafLevel].VoxelHash.GetPosition(GetLocationSlot(PackedLocation)));
+
+	ClearLocation(Id);
+	RemoveFromLevel(PackedLocation);
+	TotalPointCount--;
+	MarkSnapshotDirty(Position);
+	ChunkGrid.RemovePoint(Position);
+
+	// Merge the shallowest subdivided ancestor that has thinned out, which also folds in any deeper ones
+	int32 MergeLevel = INDEX_NONE;
+	FIntVector MergeTarget = FIntVector::ZeroValue;
+	for (int32 LevelIndex = 0; LevelIndex < LeafLevel; LevelIndex++)
+	{
+		const FIntVector Cell = WorldToGrid(Position, Levels[LevelIndex].CellSize);
+		int32* Count = Levels[LevelIndex].SubdividedCells.Find(Cell);
+		if (!Count)
+		{
+			continue;
+		}
+
+		(*Count)--;
+		if (MergeLevel == INDEX_NONE && *Count < MaxPointsPerCell / 2)
+		{
+			MergeLevel = LevelIndex;
+			MergeTarget = Cell;
+		}
+	}
+
+	if (MergeLevel != INDEX_NONE)
+	{
+		MergeCell(MergeLevel, MergeTarget);
+	}
+
+	return true;
+}
+
+int32* UBitmapPointSpatialIndex::FindLocation(int32 Id)
+{
+	FLocationPage* Page = LocationPages.Find(Id >> LocationPageShift);
+	if (!Page)
+	{
+		return nullptr;
+	}
+
+	int32& Entry = Page->Entries[Id & (LocationPageSize - 1)];
+	return Entry != INDEX_NONE ? &Entry : nullptr;
+}
+
+void UBitmapPointSpatialIndex::SetLocation(int32 Id, int32 Location)
+{
+	FLocationPage& Page = LocationPages.FindOrAdd(Id >> LocationPageShift);
+	if (Page.Entries.Num() == 0)
+	{
+		Page.Entries.Init(INDEX_NONE, LocationPageSize);
+	}
+
+	int32& Entry = Page.Entries[Id & (LocationPageSize - 1)];
+	if (Entry == INDEX_NONE)
 	{
-		for (int32 Y = MinGrid.Y; Y <= MaxGrid.Y; Y++)
+		Page.NumLive++;
+	}
+	Entry = Location;
+}
+
+void UBitmapPointSpatialIndex::ClearLocation(int32 Id)
+{
+	const int32 PageKey = Id >> LocationPageShift;
+	FLocationPage* Page = LocationPages.Find(PageKey);
+	if (!Page)
+	{
+		return;
+	}
+
+	int32& Entry = Page->Entries[Id & (LocationPageSize - 1)];
+	if (Entry != INDEX_NONE)
+	{
+		Entry = INDEX_NONE;
+		if (--Page->NumLive == 0)
 		{
-			for (int32 Z = MinGrid.Z; Z <= MaxGrid.Z; Z++)
+			LocationPages.Remove(PageKey);
+		}
+	}
+}
+
+int32 UBitmapPointSpatialIndex::FindLeafLevel(const FVector& Position) const
+{
+	int32 LevelIndex = 0;
+	while (LevelIndex + 1 < Levels.Num() &&
+		Levels[LevelIndex].SubdividedCells.Num() > 0 &&
+		Levels[LevelIndex].SubdividedCells.Contains(WorldToGrid(Position, Levels[LevelIndex].CellSize)))
+	{
+		LevelIndex++;
+	}
+	return LevelIndex;
+}
+
+void UBitmapPointSpatialIndex::AddToLevel(int32 Level, int32 Id, const FVector3f& Position)
+{
+	FGridLevel& GridLevel = Levels[Level];
+	const int32 Slot = GridLevel.VoxelHash.Add(WorldToGrid(FVector(Position), GridLevel.CellSize), Id, Position);
+	check(Slot <= LocationSlotMask);
+
+	SetLocation(Id, MakeLocation(Level, Slot));
+}
+
+void UBitmapPointSpatialIndex::RemoveFromLevel(int32 Location)
+{
+	const int32 Level = GetLocationLevel(Location);
+	const int32 Slot = GetLocationSlot(Location);
+
+	// The last point of the cell now lives in the freed slot
+	const int32 MovedId = Levels[Level].VoxelHash.Remove(Slot);
+	if (MovedId != INDEX_NONE)
+	{
+		*FindLocation(MovedId) = Location;
+	}
+}
+
+void UBitmapPointSpatialIndex::SplitCell(int32 Level, const FIntVector& Cell)
+{
+	FGridLevel& GridLevel = Levels[Level];
+
+	FVoxelCellRef CellRef;
+	if (!GridLevel.VoxelHash.FindCell(Cell, CellRef))
+	{
+		return;
+	}
+
+	TArray<int32> MovedIds;
+	MovedIds.Reserve(GridLevel.VoxelHash.GetCellPointCount(CellRef));
+	GridLevel.VoxelHash.ForEachSpan(CellRef, [&MovedIds](const FVoxelPointSpan& Span) {
+		MovedIds.Append(Span.Ids, Span.Num);
+		return true;
+	});
+
+	AddSubdividedCell(Level, Cell, MovedIds.Num());
+
+	for (int32 Id : MovedIds)
+	{
+		const int32 Location = *FindLocation(Id);
+		const FVector3f Position = GridLevel.VoxelHash.GetPosition(GetLocationSlot(Location));
+		RemoveFromLevel(Location);
+		AddToLevel(Level + 1, Id, Position);
+	}
+
+	// A cell packed into one corner may still be overfull one depth down
+	if (Level + 2 < Levels.Num())
+	{
+		const FGridLevel& ChildLevel = Levels[Level + 1];
+		for (int32 Child = 0; Child < 8; Child++)
+		{
+			const FIntVector ChildCell = Cell * 2 + FIntVector(Child & 1, (Child >> 1) & 1, (Child >> 2) & 1);
+			FVoxelCellRef ChildRef;
+			if (ChildLevel.VoxelHash.FindCell(ChildCell, ChildRef) && ChildLevel.VoxelHash.GetCellPointCount(ChildRef) > MaxPointsPerCell)
 			{
-				Cells.Add(FIntVector(X, Y, Z));
+				SplitCell(Level + 1, ChildCell);
 			}
 		}
 	}
-	
-	return Cells;
 }
 
-UBitmapPointSpatialIndex::FSpatialCell& UBitmapPointSpatialIndex::GetOrCreateCell(const FIntVector& GridPos)
+void UBitmapPointSpatialIndex::MergeCell(int32 Level, const FIntVector& Cell)
 {
-	return SpatialGrid.FindOrAdd(GridPos);
+	TArray<int32> MovedIds;
+	const FIntVector TopLevelBrick = GetTopLevelBrick(Level, Cell);
+
+	// Gather every point below the cell and forget the subdivisions beneath it
+	for (int32 LevelIndex = Level + 1; LevelIndex < Levels.Num(); LevelIndex++)
+	{
+		FGridLevel& GridLevel = Levels[LevelIndex];
+		const int32 Scale = 1 << (LevelIndex - Level);
+		const FIntVector MinCell = Cell * Scale;
+		const FIntVector MaxCell = MinCell + FIntVector(Scale - 1);
+
+		GridLevel.VoxelHash.ForEachCellInRange(MinCell, MaxCell, [&GridLevel, &MovedIds](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+			return GridLevel.VoxelHash.ForEachSpan(CellRef, [&MovedIds](const FVoxelPointSpan& Span) {
+				MovedIds.Append(Span.Ids, Span.Num);
+				return true;
+			});
+		});
+
+		// Every subdivision beneath the cell lies in the same top-level brick
+		TArray<FIntVector>* BrickCells = GridLevel.SubdividedCellsByBrick.Find(TopLevelBrick);
+		if (!BrickCells)
+		{
+			continue;
+		}
+
+		for (int32 Index = BrickCells->Num() - 1; Index >= 0; Index--)
+		{
+			const FIntVector Subdivided = (*BrickCells)[Index];
+			if (Subdivided.X >= MinCell.X && Subdivided.X <= MaxCell.X &&
+				Subdivided.Y >= MinCell.Y && Subdivided.Y <= MaxCell.Y &&
+				Subdivided.Z >= MinCell.Z && Subdivided.Z <= MaxCell.Z)
+			{
+				GridLevel.SubdividedCells.Remove(Subdivided);
+				BrickCells->RemoveAtSwap(Index, 1, false);
+			}
+		}
+
+		if (BrickCells->Num() == 0)
+		{
+			GridLevel.SubdividedCellsByBrick.Remove(TopLevelBrick);
+		}
+	}
+
+	FGridLevel& MergedLevel = Levels[Level];
+	MergedLevel.SubdividedCells.Remove(Cell);
+	if (TArray<FIntVector>* BrickCells = MergedLevel.SubdividedCellsByBrick.Find(TopLevelBrick))
+	{
+		BrickCells->RemoveSingleSwap(Cell, false);
+		if (BrickCells->Num() == 0)
+		{
+			MergedLevel.SubdividedCellsByBrick.Remove(TopLevelBrick);
+		}
+	}
+
+	for (int32 Id : MovedIds)
+	{
+		const int32 Location = *FindLocation(Id);
+		const FVector3f Position = Levels[GetLocationLevel(Location)].VoxelHash.GetPosition(GetLocationSlot(Location));
+		RemoveFromLevel(Location);
+		AddToLevel(Level, Id, Position);
+	}
 }
 
-const UBitmapPointSpatialIndex::FSpatialCell* UBitmapPointSpatialIndex::GetCell(const FIntVector& GridPos) const
+void UBitmapPointSpatialIndex::AddSubdividedCell(int32 Level, const FIntVector& Cell, int32 PointCount)
 {
-	return SpatialGrid.Find(GridPos);
+	FGridLevel& GridLevel = Levels[Level];
+	if (!GridLevel.SubdividedCells.Contains(Cell))
+	{
+		GridLevel.SubdividedCellsByBrick.FindOrAdd(GetTopLevelBrick(Level, Cell)).Add(Cell);
+	}
+	GridLevel.SubdividedCells.Add(Cell, PointCount);
+}
+
+bool UBitmapPointSpatialIndex::ResolvePoint(int32 Id, FBitmapPoint& OutPoint) const
+{
+	return Storage && Storage->GetPointById(Id, OutPoint);
+}
+
+FIntVector UBitmapPointSpatialIndex::WorldToGrid(const FVector& WorldPos, float InCellSize) const
+{
+	// Clamp to the range the voxel hash can key
+	const int32 Limit = FBitmapPointVoxelHash::MaxCellCoord;
+	return FIntVector(
+		FMath::Clamp(FMath::FloorToInt(WorldPos.X / InCellSize), -Limit, Limit),
+		FMath::Clamp(FMath::FloorToInt(WorldPos.Y / InCellSize), -Limit, Limit),
+		FMath::Clamp(FMath::FloorToInt(WorldPos.Z / InCellSize), -Limit, Limit)
+	);
 }
 
-bool UBitmapPointSpatialIndex::IsPointInRadius(const FBitmapPoint& Point, const FVector& Center, float Radius) const
+FVector UBitmapPointSpatialIndex::GridToWorld(const FIntVector& GridPos, float InCellSize) const
 {
-	return FVector::DistSquared(Point.Position, Center) <= (Radius * Radius);
+	return FVector(
+		GridPos.X * InCellSize,
+		GridPos.Y * InCellSize,
+		GridPos.Z * InCellSize
+	);
 }
 
-float UBitmapPointSpatialIndex::GetSquaredDistance(const FBitmapPoint& Point, const FVector& Location) const
+float UBitmapPointSpatialIndex::GetSquaredDistanceToCell(const FIntVector& GridPos, float InCellSize, const FVector& Location) const
 {
-	return FVector::DistSquared(Point.Position, Location);
-}
\ No newline at end of file
+	const FVector CellMin = GridToWorld(GridPos, InCellSize);
+	const FVector CellMax = CellMin + FVector(InCellSize);
+	const FVector Closest(
+		FMath::Clamp(Location.X, CellMin.X, CellMax.X),
+		FMath::Clamp(Location.Y, CellMin.Y, CellMax.Y),
+		FMath::Clamp(Location.Z, CellMin.Z, CellMax.Z)
+	);
+	return FVector::DistSquared(Closest, Location);
+}
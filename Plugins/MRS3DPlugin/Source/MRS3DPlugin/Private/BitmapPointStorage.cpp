@@ -1,15 +1,62 @@
 #include "BitmapPointStorage.h"
+#include "BitmapPointCompact.h"
 #include "Engine/Engine.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+	/** Snap rows from Start on onto the lattice compact points encode exactly */
+	void CanonicalizeRows(FBitmapPointColumns& InOutColumns, int32 Start)
+	{
+		for (int32 Row = Start; Row < InOutColumns.Num(); Row++)
+		{
+			InOutColumns.Positions[Row] = FBitmapPointQuantizer::CanonicalizePosition(InOutColumns.Positions[Row]);
+			InOutColumns.Normals[Row] = FBitmapPointQuantizer::CanonicalizeNormal(InOutColumns.Normals[Row]);
+			InOutColumns.Intensities[Row] = FBitmapPointQuantizer::CanonicalizeIntensity(InOutColumns.Intensities[Row]);
+		}
+	}
+}
 
 UBitmapPointStorage::UBitmapPointStorage()
+	: Layout(EBitmapPointStorageLayout::ChunkedRing)
+	, RingPointCount(0)
+	, RingValidChunkEnds(0)
+	, RingPositionBase(0)
+	, bPointCacheDirty(false)
+	, NextPointId(0)
+	, Version(0)
 {
 	BitmapPoints.Reserve(1000); // Default capacity
+	PointIds.Reserve(1000);
 }
 
-void UBitmapPointStorage::AddPoint(const FBitmapPoint& Point)
+void UBitmapPointStorage::AddPoint(const FBitmapPoint& InPoint)
 {
-	BitmapPoints.Add(Point);
-	NotifyPointsChanged();
+	// Stored points sit on the compact lattice, so snapshot pages and paged-out chunks decode back to them exactly
+	const FBitmapPoint Point = FBitmapPointQuantizer::Canonicalize(InPoint);
+
+	FBitmapPointChangeSet Change;
+	Change.AddedStart = GetPointCount();
+	Change.AddedCount = 1;
+	Change.FirstAddedId = NextPointId++;
+
+	if (IsRing())
+	{
+		RingAppend(Point, Change.FirstAddedId);
+		bPointCacheDirty = true;
+	}
+	else if (IsColumnar())
+	{
+		Columns.Add(Point, Change.FirstAddedId);
+		bPointCacheDirty = true;
+	}
+	else
+	{
+		BitmapPoints.Add(Point);
+		PointIds.Add(Change.FirstAddedId);
+	}
+	AgeIndex.Add(Change.FirstAddedId, Point.Timestamp);
+	CommitChange(Change);
 }
 
 void UBitmapPointStorage::AddPoints(const TArray<FBitmapPoint>& Points)
@@ -18,17 +65,177 @@ void UBitmapPointStorage::AddPoints(const TArray<FBitmapPoint>& Points)
 	{
 		return;
 	}
-	
-	BitmapPoints.Append(Points);
-	NotifyPointsChanged();
+
+	FBitmapPointChangeSet Change;
+	Change.AddedStart = GetPointCount();
+	Change.AddedCount = Points.Num();
+	Change.FirstAddedId = NextPointId;
+	NextPointId += Points.Num();
+
+	if (IsRing())
+	{
+		for (int32 i = 0; i < Points.Num(); i++)
+		{
+			RingAppend(FBitmapPointQuantizer::Canonicalize(Points[i]), Change.FirstAddedId + i);
+		}
+		bPointCacheDirty = true;
+	}
+	else if (IsColumnar())
+	{
+		const int32 FirstRow = Columns.Num();
+		Columns.Append(Points, Change.FirstAddedId);
+		CanonicalizeRows(Columns, FirstRow);
+		bPointCacheDirty = true;
+	}
+	else
+	{
+		BitmapPoints.Reserve(BitmapPoints.Num() + Points.Num());
+		for (int32 i = 0; i < Points.Num(); i++)
+		{
+			BitmapPoints.Add(FBitmapPointQuantizer::Canonicalize(Points[i]));
+			PointIds.Add(Change.FirstAddedId + i);
+		}
+	}
+
+	for (int32 i = 0; i < Points.Num(); i++)
+	{
+		AgeIndex.Add(Change.FirstAddedId + i, Points[i].Timestamp);
+	}
+	CommitChange(Change);
+}
+
+void UBitmapPointStorage::ExportColumns(FBitmapPointColumns& OutColumns) const
+{
+	OutColumns = FBitmapPointColumns();
+
+	if (IsColumnar())
+	{
+		OutColumns = Columns;
+		return;
+	}
+
+	const int32 PointCount = GetPointCount();
+	OutColumns.Positions.Reserve(PointCount);
+	OutColumns.Colors.Reserve(PointCount);
+	OutColumns.Intensities.Reserve(PointCount);
+	OutColumns.Timestamps.Reserve(PointCount);
+	OutColumns.Normals.Reserve(PointCount);
+	OutColumns.Ids.Reserve(PointCount);
+
+	if (IsRing())
+	{
+		for (const TUniquePtr<FBitmapPointChunk>& Chunk : Chunks)
+		{
+			const FBitmapPointColumns& ChunkColumns = Chunk->Columns;
+			const int32 Start = Chunk->Start;
+			const int32 Count = Chunk->NumLive();
+			OutColumns.Positions.Append(ChunkColumns.Positions.GetData() + Start, Count);
+			OutColumns.Colors.Append(ChunkColumns.Colors.GetData() + Start, Count);
+			OutColumns.Intensities.Append(ChunkColumns.Intensities.GetData() + Start, Count);
+			OutColumns.Timestamps.Append(ChunkColumns.Timestamps.GetData() + Start, Count);
+			OutColumns.Normals.Append(ChunkColumns.Normals.GetData() + Start, Count);
+			OutColumns.Ids.Append(ChunkColumns.Ids.GetData() + Start, Count);
+		}
+		return;
+	}
+
+	for (int32 Index = 0; Index < PointCount; Index++)
+	{
+		OutColumns.Add(BitmapPoints[Index], PointIds[Index]);
+	}
+}
+
+void UBitmapPointStorage::AppendColumns(const FBitmapPointColumns& InColumns)
+{
+	const int32 Count = InColumns.Num();
+	if (Count == 0)
+	{
+		return;
+	}
+
+	FBitmapPointChangeSet Change;
+	Change.AddedStart = GetPointCount();
+	Change.AddedCount = Count;
+	Change.FirstAddedId = NextPointId;
+	NextPointId += Count;
+
+	if (IsColumnar())
+	{
+		const int32 FirstRow = Columns.Num();
+		Columns.Positions.Append(InColumns.Positions);
+		Columns.Colors.Append(InColumns.Colors);
+		Columns.Intensities.Append(InColumns.Intensities);
+		Columns.Timestamps.Append(InColumns.Timestamps);
+		Columns.Normals.Append(InColumns.Normals);
+		Columns.Ids.Reserve(Columns.Ids.Num() + Count);
+		for (int32 i = 0; i < Count; i++)
+		{
+			Columns.Ids.Add(Change.FirstAddedId + i);
+		}
+		CanonicalizeRows(Columns, FirstRow);
+		bPointCacheDirty = true;
+	}
+	else if (IsRing())
+	{
+		for (int32 i = 0; i < Count; i++)
+		{
+			RingAppend(FBitmapPointQuantizer::Canonicalize(InColumns.GetPoint(i)), Change.FirstAddedId + i);
+		}
+		bPointCacheDirty = true;
+	}
+	else
+	{
+		BitmapPoints.Reserve(BitmapPoints.Num() + Count);
+		PointIds.Reserve(PointIds.Num() + Count);
+		for (int32 i = 0; i < Count; i++)
+		{
+			BitmapPoints.Add(FBitmapPointQuantizer::Canonicalize(InColumns.GetPoint(i)));
+			PointIds.Add(Change.FirstAddedId + i);
+		}
+	}
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		AgeIndex.Add(Change.FirstAddedId + i, InColumns.Timestamps[i]);
+	}
+	CommitChange(Change);
 }
 
 bool UBitmapPointStorage::RemovePoint(int32 Index)
 {
-	if (Index >= 0 && Index < BitmapPoints.Num())
+	if (Index >= 0 && Index < GetPointCount())
 	{
-		BitmapPoints.RemoveAt(Index);
-		NotifyPointsChanged();
+		FBitmapPointChangeSet Change;
+		Change.RemovedIds.Add(GetPointId(Index));
+
+		if (IsRing())
+		{
+			int32 ChunkIndex = 0;
+			int32 Row = 0;
+			RingLocate(Index, ChunkIndex, Row);
+
+			FBitmapPointChunk& Chunk = *Chunks[ChunkIndex];
+			Chunk.Columns.RemoveAt(Row);
+			RingPointCount--;
+			RingInvalidateChunkEnds(ChunkIndex);
+
+			if (Chunk.NumLive() == 0)
+			{
+				RingReleaseChunk(ChunkIndex);
+			}
+			bPointCacheDirty = true;
+		}
+		else if (IsColumnar())
+		{
+			Columns.RemoveAt(Index);
+			bPointCacheDirty = true;
+		}
+		else
+		{
+			BitmapPoints.RemoveAt(Index);
+			PointIds.RemoveAt(Index);
+		}
+		CommitChange(Change);
 		return true;
 	}
 	return false;
@@ -36,57 +243,847 @@ bool UBitmapPointStorage::RemovePoint(int32 Index)
 
 int32 UBitmapPointStorage::RemovePointsWhere(TFunction<bool(const FBitmapPoint&)> Predicate)
 {
-	const int32 InitialCount = BitmapPoints.Num();
-	
-	BitmapPoints.RemoveAll([&Predicate](const FBitmapPoint& Point) {
-		return Predicate(Point);
-	});
-	
-	const int32 RemovedCount = InitialCount - BitmapPoints.Num();
+	FBitmapPointChangeSet Change;
+	int32 RemovedCount = 0;
+
+	if (IsRing())
+	{
+		RemovedCount = RingRemoveAll([&Predicate](const FBitmapPointColumns& ChunkColumns, int32 Row) {
+			return Predicate(ChunkColumns.GetPoint(Row));
+		}, Change.RemovedIds);
+	}
+	else if (IsColumnar())
+	{
+		RemovedCount = Columns.RemoveAll([this, &Predicate](int32 Index) {
+			return Predicate(Columns.GetPoint(Index));
+		}, &Change.RemovedIds);
+		bPointCacheDirty |= RemovedCount > 0;
+	}
+	else
+	{
+		RemovedCount = RemoveAllStructs([this, &Predicate](int32 Index) {
+			return Predicate(BitmapPoints[Index]);
+		}, Change.RemovedIds);
+	}
+
+	if (RemovedCount > 0)
+	{
+		CommitChange(Change);
+	}
+
+	return RemovedCount;
+}
+
+int32 UBitmapPointStorage::RemovePointsById(const TArray<int32>& Ids)
+{
+	if (Ids.Num() == 0 || GetPointCount() == 0)
+	{
+		return 0;
+	}
+
+	TArray<int32> SortedIds = Ids;
+	SortedIds.Sort();
+
+	// Stored ids are ascending and every compaction pass visits rows in order, so a single merge cursor suffices
+	int32 Cursor = 0;
+	auto IsRemovedId = [&SortedIds, &Cursor](int32 Id) {
+		while (Cursor < SortedIds.Num() && SortedIds[Cursor] < Id)
+		{
+			Cursor++;
+		}
+		return Cursor < SortedIds.Num() && SortedIds[Cursor] == Id;
+	};
+
+	FBitmapPointChangeSet Change;
+	int32 RemovedCount = 0;
+
+	if (IsRing())
+	{
+		RemovedCount = RingRemoveAll([&IsRemovedId](const FBitmapPointColumns& ChunkColumns, int32 Row) {
+			return IsRemovedId(ChunkColumns.Ids[Row]);
+		}, Change.RemovedIds);
+	}
+	else if (IsColumnar())
+	{
+		RemovedCount = Columns.RemoveAll([this, &IsRemovedId](int32 Index) {
+			return IsRemovedId(Columns.Ids[Index]);
+		}, &Change.RemovedIds);
+		bPointCacheDirty |= RemovedCount > 0;
+	}
+	else
+	{
+		RemovedCount = RemoveAllStructs([this, &IsRemovedId](int32 Index) {
+			return IsRemovedId(PointIds[Index]);
+		}, Change.RemovedIds);
+	}
+
 	if (RemovedCount > 0)
 	{
-		NotifyPointsChanged();
+		CommitChange(Change);
 	}
-	
+
+	return RemovedCount;
+}
+
+int32 UBitmapPointStorage::UpdatePointsById(const TArray<int32>& Ids, const TArray<FBitmapPoint>& Points)
+{
+	if (Ids.Num() != Points.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BitmapPointStorage: UpdatePointsById got %d ids for %d points"), Ids.Num(), Points.Num());
+		return 0;
+	}
+
+	FBitmapPointChangeSet Change;
+	for (int32 i = 0; i < Ids.Num(); i++)
+	{
+		// Ring rows are addressed by chunk, so skip resolving a storage index there
+		int32 ChunkIndex = 0;
+		int32 Row = 0;
+		const int32 Index = IsRing() ? INDEX_NONE : FindPointIndex(Ids[i]);
+		if (IsRing() ? !RingFindId(Ids[i], ChunkIndex, Row) : Index == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FBitmapPoint Point = FBitmapPointQuantizer::Canonicalize(Points[i]);
+		if (IsRing())
+		{
+			Chunks[ChunkIndex]->Columns.SetPoint(Row, Point);
+			bPointCacheDirty = true;
+		}
+		else if (IsColumnar())
+		{
+			Columns.SetPoint(Index, Point);
+			bPointCacheDirty = true;
+		}
+		else
+		{
+			BitmapPoints[Index] = Point;
+		}
+
+		// The entry under the old timestamp goes stale and is filtered out on expiry
+		AgeIndex.Add(Ids[i], Points[i].Timestamp);
+		Change.UpdatedIds.Add(Ids[i]);
+	}
+
+	if (Change.UpdatedIds.Num() > 0)
+	{
+		Change.UpdatedIds.Sort();
+		CommitChange(Change);
+	}
+
+	return Change.UpdatedIds.Num();
+}
+
+int32 UBitmapPointStorage::RemovePointsOlderThan(float OldestAllowedTime)
+{
+	TArray<int32> CandidateIds;
+	if (AgeIndex.PopOlderThan(OldestAllowedTime, CandidateIds) == 0)
+	{
+		return 0;
+	}
+
+	// Candidates may have been removed or refreshed since they were indexed, keep the ones still stored and still old
+	CandidateIds.Sort();
+	TArray<int32> ExpiredIds;
+	ExpiredIds.Reserve(CandidateIds.Num());
+	for (int32 i = 0; i < CandidateIds.Num(); i++)
+	{
+		if (i > 0 && CandidateIds[i] == CandidateIds[i - 1])
+		{
+			continue;
+		}
+
+		const int32 Index = FindPointIndex(CandidateIds[i]);
+		if (Index != INDEX_NONE && GetTimestampAt(Index) < OldestAllowedTime)
+		{
+			ExpiredIds.Add(CandidateIds[i]);
+		}
+	}
+
+	if (ExpiredIds.Num() == 0)
+	{
+		return 0;
+	}
+
+	// Ids ascend in storage order, so expired points that are all stored and end at row N-1 are exactly the first N rows
+	if (GetPointId(ExpiredIds.Num() - 1) == ExpiredIds.Last())
+	{
+		return RemoveOldestPoints(ExpiredIds.Num());
+	}
+
+	return RemovePointsById(ExpiredIds);
+}
+
+int32 UBitmapPointStorage::RemoveOldestPoints(int32 Count)
+{
+	const int32 RemovedCount = FMath::Clamp(Count, 0, GetPointCount());
+	if (RemovedCount == 0)
+	{
+		return 0;
+	}
+
+	FBitmapPointChangeSet Change;
+	Change.RemovedIds.Reserve(RemovedCount);
+
+	if (IsRing())
+	{
+		// Release whole chunks from the front, then advance the head of the first partial chunk
+		int32 Remaining = RemovedCount;
+		int32 ChunksToRelease = 0;
+		while (ChunksToRelease < Chunks.Num() && Chunks[ChunksToRelease]->NumLive() <= Remaining)
+		{
+			Remaining -= Chunks[ChunksToRelease]->NumLive();
+			ChunksToRelease++;
+		}
+
+		for (int32 i = 0; i < ChunksToRelease; i++)
+		{
+			const FBitmapPointChunk& Chunk = *Chunks[i];
+			Change.RemovedIds.Append(Chunk.Columns.Ids.GetData() + Chunk.Start, Chunk.NumLive());
+			Chunks[i]->Reset();
+			FreeChunks.Add(MoveTemp(Chunks[i]));
+		}
+		Chunks.RemoveAt(0, ChunksToRelease, false);
+
+		if (Remaining > 0)
+		{
+			Change.RemovedIds.Append(Chunks[0]->Columns.Ids.GetData() + Chunks[0]->Start, Remaining);
+			Chunks[0]->Start += Remaining;
+		}
+
+		// Every surviving index drops by RemovedCount, which moving the base accounts for without touching the chunk ends
+		const int32 EndsToRelease = FMath::Min(ChunksToRelease, RingValidChunkEnds);
+		RingChunkEnds.RemoveAt(0, EndsToRelease, false);
+		RingValidChunkEnds -= EndsToRelease;
+		RingPositionBase += RemovedCount;
+
+		RingPointCount -= RemovedCount;
+		bPointCacheDirty = true;
+	}
+	else if (IsColumnar())
+	{
+		Change.RemovedIds.Append(Columns.Ids.GetData(), RemovedCount);
+		Columns.RemoveAt(0, RemovedCount);
+		bPointCacheDirty = true;
+	}
+	else
+	{
+		Change.RemovedIds.Append(PointIds.GetData(), RemovedCount);
+		BitmapPoints.RemoveAt(0, RemovedCount, false);
+		PointIds.RemoveAt(0, RemovedCount, false);
+	}
+
+	CommitChange(Change);
 	return RemovedCount;
 }
 
 void UBitmapPointStorage::Clear()
 {
-	if (BitmapPoints.Num() > 0)
+	if (GetPointCount() > 0)
 	{
 		BitmapPoints.Empty();
-		NotifyPointsChanged();
+		PointIds.Empty();
+		Columns.Empty();
+		RingReleaseAll();
+		AgeIndex.Reset();
+		bPointCacheDirty = false;
+
+		FBitmapPointChangeSet Change;
+		Change.bCleared = true;
+		CommitChange(Change);
+	}
+}
+
+const TArray<FBitmapPoint>& UBitmapPointStorage::GetAllPoints() const
+{
+	if (bPointCacheDirty)
+	{
+		CopyAllPoints(BitmapPoints);
+		bPointCacheDirty = false;
 	}
+	return BitmapPoints;
+}
+
+int32 UBitmapPointStorage::GetPointCount() const
+{
+	if (IsRing())
+	{
+		return RingPointCount;
+	}
+	return IsColumnar() ? Columns.Num() : BitmapPoints.Num();
 }
 
 FBitmapPoint UBitmapPointStorage::GetPoint(int32 Index) const
 {
-	if (Index >= 0 && Index < BitmapPoints.Num())
+	if (Index >= 0 && Index < GetPointCount())
 	{
-		return BitmapPoints[Index];
+		if (IsRing())
+		{
+			return GetPointView(Index).ToBitmapPoint();
+		}
+		return IsColumnar() ? Columns.GetPoint(Index) : BitmapPoints[Index];
 	}
 	return FBitmapPoint(); // Return default point if index is invalid
 }
 
+int32 UBitmapPointStorage::GetPointId(int32 Index) const
+{
+	if (Index < 0 || Index >= GetPointCount())
+	{
+		return INDEX_NONE;
+	}
+
+	if (IsRing())
+	{
+		int32 ChunkIndex = 0;
+		int32 Row = 0;
+		RingLocate(Index, ChunkIndex, Row);
+		return Chunks[ChunkIndex]->Columns.Ids[Row];
+	}
+	return IsColumnar() ? Columns.Ids[Index] : PointIds[Index];
+}
+
+int32 UBitmapPointStorage::FindPointIndex(int32 Id) const
+{
+	if (IsRing())
+	{
+		int32 ChunkIndex = 0;
+		int32 Row = 0;
+		if (!RingFindId(Id, ChunkIndex, Row))
+		{
+			return INDEX_NONE;
+		}
+		return RingChunkStartIndex(ChunkIndex) + Row - Chunks[ChunkIndex]->Start;
+	}
+	return Algo::BinarySearch(IsColumnar() ? Columns.Ids : PointIds, Id);
+}
+
+bool UBitmapPointStorage::GetPointById(int32 Id, FBitmapPoint& OutPoint) const
+{
+	if (IsRing())
+	{
+		int32 ChunkIndex = 0;
+		int32 Row = 0;
+		if (!RingFindId(Id, ChunkIndex, Row))
+		{
+			return false;
+		}
+		OutPoint = Chunks[ChunkIndex]->Columns.GetView(Row).ToBitmapPoint();
+		return true;
+	}
+
+	const int32 Index = FindPointIndex(Id);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutPoint = GetPoint(Index);
+	return true;
+}
+
+bool UBitmapPointStorage::GetChangesSince(int64 SinceVersion, TArray<FBitmapPointChangeSet>& OutChanges) const
+{
+	if (SinceVersion >= Version)
+	{
+		return true;
+	}
+
+	// The oldest retained change must directly follow the requested version, unless it is a clear which resets everything anyway
+	if (ChangeHistory.Num() == 0 || (ChangeHistory[0].Version > SinceVersion + 1 && !ChangeHistory[0].bCleared))
+	{
+		return false;
+	}
+
+	for (const FBitmapPointChangeSet& Change : ChangeHistory)
+	{
+		if (Change.Version > SinceVersion)
+		{
+			OutChanges.Add(Change);
+		}
+	}
+	return true;
+}
+
+FBitmapPointView UBitmapPointStorage::GetPointView(int32 Index) const
+{
+	if (IsRing())
+	{
+		int32 ChunkIndex = 0;
+		int32 Row = 0;
+		RingLocate(Index, ChunkIndex, Row);
+		return Chunks[ChunkIndex]->Columns.GetView(Row);
+	}
+	return Columns.GetView(Index);
+}
+
+void UBitmapPointStorage::SetLayout(EBitmapPointStorageLayout NewLayout)
+{
+	if (NewLayout == Layout)
+	{
+		return;
+	}
+
+	TArray<FBitmapPoint> Points;
+	TArray<int32> Ids;
+	CopyAllPoints(Points);
+	CopyAllPointIds(Ids);
+
+	BitmapPoints.Empty();
+	PointIds.Empty();
+	Columns.Empty();
+	RingReleaseAll();
+	FreeChunks.Empty();
+	bPointCacheDirty = false;
+
+	Layout = NewLayout;
+
+	// Ids carry over unchanged, the layout switch is not a change to the stored points
+	if (IsRing())
+	{
+		for (int32 i = 0; i < Points.Num(); i++)
+		{
+			RingAppend(Points[i], Ids[i]);
+		}
+		bPointCacheDirty = Points.Num() > 0;
+	}
+	else if (IsColumnar())
+	{
+		Columns.Reserve(Points.Num());
+		for (int32 i = 0; i < Points.Num(); i++)
+		{
+			Columns.Add(Points[i], Ids[i]);
+		}
+		bPointCacheDirty = Points.Num() > 0;
+	}
+	else
+	{
+		BitmapPoints = MoveTemp(Points);
+		PointIds = MoveTemp(Ids);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Bitmap Storage: Switched to layout %d with %d points"),
+		static_cast<int32>(Layout), GetPointCount());
+}
+
+void UBitmapPointStorage::FindPointIndicesInRadius(const FVector& Center, float Radius, TArray<int32>& OutIndices) const
+{
+	const float RadiusSquared = Radius * Radius;
+
+	if (IsRing())
+	{
+		int32 BaseIndex = 0;
+		for (const TUniquePtr<FBitmapPointChunk>& Chunk : Chunks)
+		{
+			const FVector* Positions = Chunk->Columns.Positions.GetData();
+			for (int32 Row = Chunk->Start; Row < Chunk->Columns.Num(); Row++)
+			{
+				if (FVector::DistSquared(Positions[Row], Center) <= RadiusSquared)
+				{
+					OutIndices.Add(BaseIndex + Row - Chunk->Start);
+				}
+			}
+			BaseIndex += Chunk->NumLive();
+		}
+	}
+	else if (IsColumnar())
+	{
+		const FVector* Positions = Columns.Positions.GetData();
+		const int32 Count = Columns.Num();
+		for (int32 i = 0; i < Count; i++)
+		{
+			if (FVector::DistSquared(Positions[i], Center) <= RadiusSquared)
+			{
+				OutIndices.Add(i);
+			}
+		}
+	}
+	else
+	{
+		for (int32 i = 0; i < BitmapPoints.Num(); i++)
+		{
+			if (FVector::DistSquared(BitmapPoints[i].Position, Center) <= RadiusSquared)
+			{
+				OutIndices.Add(i);
+			}
+		}
+	}
+}
+
 void UBitmapPointStorage::Reserve(int32 Capacity)
 {
-	BitmapPoints.Reserve(Capacity);
+	if (IsRing())
+	{
+		// Pre-allocate enough pooled chunks for the requested capacity
+		const int32 ChunksNeeded = FMath::DivideAndRoundUp(Capacity, RingChunkCapacity) - Chunks.Num() - FreeChunks.Num();
+		for (int32 i = 0; i < ChunksNeeded; i++)
+		{
+			TUniquePtr<FBitmapPointChunk> Chunk = MakeUnique<FBitmapPointChunk>();
+			Chunk->Columns.Reserve(RingChunkCapacity);
+			FreeChunks.Add(MoveTemp(Chunk));
+		}
+	}
+	else if (IsColumnar())
+	{
+		Columns.Reserve(Capacity);
+	}
+	else
+	{
+		BitmapPoints.Reserve(Capacity);
+		PointIds.Reserve(Capacity);
+	}
 }
 
 void UBitmapPointStorage::Shrink()
 {
 	BitmapPoints.Shrink();
+	PointIds.Shrink();
+	Columns.Shrink();
+
+	// Keep one spare chunk so the ring does not reallocate on the next append after eviction
+	if (FreeChunks.Num() > 1)
+	{
+		FreeChunks.SetNum(1);
+	}
 }
 
 int32 UBitmapPointStorage::GetMemoryUsageBytes() const
 {
-	const int32 PointSize = sizeof(FBitmapPoint);
-	const int32 ArrayOverhead = sizeof(TArray<FBitmapPoint>);
-	return (BitmapPoints.Num() * PointSize) + ArrayOverhead;
+	return static_cast<int32>(FMath::Min<SIZE_T>(GetAllocatedSize(), MAX_int32));
+}
+
+SIZE_T UBitmapPointStorage::GetAllocatedSize() const
+{
+	// Allocated rather than used sizes, so slack left behind by removals is counted
+	SIZE_T AllocatedSize = BitmapPoints.GetAllocatedSize()
+		+ PointIds.GetAllocatedSize()
+		+ Columns.GetAllocatedSize()
+		+ AgeIndex.GetAllocatedSize()
+		+ Chunks.GetAllocatedSize()
+		+ FreeChunks.GetAllocatedSize()
+		+ ChangeHistory.GetAllocatedSize();
+
+	for (const TUniquePtr<FBitmapPointChunk>& Chunk : Chunks)
+	{
+		AllocatedSize += sizeof(FBitmapPointChunk) + Chunk->Columns.GetAllocatedSize();
+	}
+	for (const TUniquePtr<FBitmapPointChunk>& Chunk : FreeChunks)
+	{
+		AllocatedSize += sizeof(FBitmapPointChunk) + Chunk->Columns.GetAllocatedSize();
+	}
+	for (const FBitmapPointChangeSet& Change : ChangeHistory)
+	{
+		AllocatedSize += Change.RemovedIds.GetAllocatedSize() + Change.UpdatedIds.GetAllocatedSize();
+	}
+
+	return AllocatedSize;
+}
+
+int32 UBitmapPointStorage::ReleasePointCache()
+{
+	// In the ArrayOfStructs layout the array is the data, not a cache
+	if (Layout == EBitmapPointStorageLayout::ArrayOfStructs)
+	{
+		return 0;
+	}
+
+	const int32 FreedBytes = static_cast<int32>(BitmapPoints.GetAllocatedSize());
+	BitmapPoints.Empty();
+	bPointCacheDirty = GetPointCount() > 0;
+	return FreedBytes;
+}
+
+void UBitmapPointStorage::CommitChange(FBitmapPointChangeSet& Change)
+{
+	Change.Version = ++Version;
+
+	if (AgeIndex.GetNumEntries() > GetPointCount() * 2 + AgeIndexSlack)
+	{
+		RebuildAgeIndex();
+	}
+
+	// A clear supersedes everything before it, so older history is no longer needed to resync
+	if (Change.bCleared)
+	{
+		ChangeHistory.Reset();
+	}
+	else if (ChangeHistory.Num() >= MaxChangeHistory)
+	{
+		ChangeHistory.RemoveAt(0, ChangeHistory.Num() - MaxChangeHistory + 1, false);
+	}
+	ChangeHistory.Add(Change);
+
+	OnBitmapPointsChangeSet.Broadcast(Change);
+	NotifyPointsChanged();
 }
 
 void UBitmapPointStorage::NotifyPointsChanged()
 {
-	OnBitmapPointsChanged.Broadcast(BitmapPoints);
-}
\ No newline at end of file
+	// Avoid materializing the column cache when nobody is listening
+	if (OnBitmapPointsChanged.IsBound())
+	{
+		OnBitmapPointsChanged.Broadcast(GetAllPoints());
+	}
+}
+
+void UBitmapPointStorage::RingAppend(const FBitmapPoint& Point, int32 Id)
+{
+	if (Chunks.Num() == 0 || Chunks.Last()->Columns.Num() >= RingChunkCapacity)
+	{
+		TUniquePtr<FBitmapPointChunk> Chunk;
+		if (FreeChunks.Num() > 0)
+		{
+			Chunk = FreeChunks.Pop(false);
+		}
+		else
+		{
+			Chunk = MakeUnique<FBitmapPointChunk>();
+			Chunk->Columns.Reserve(RingChunkCapacity);
+		}
+		Chunks.Add(MoveTemp(Chunk));
+	}
+
+	Chunks.Last()->Columns.Add(Point, Id);
+	RingPointCount++;
+	RingInvalidateChunkEnds(Chunks.Num() - 1);
+}
+
+bool UBitmapPointStorage::RingLocate(int32 Index, int32& OutChunk, int32& OutRow) const
+{
+	if (Index < 0 || Index >= RingPointCount)
+	{
+		return false;
+	}
+
+	RingUpdateChunkEnds();
+
+	// First chunk ending past the position holds it
+	const int32 Position = RingPositionBase + Index;
+	const int32 ChunkIndex = Algo::UpperBound(RingChunkEnds, Position);
+	if (ChunkIndex >= Chunks.Num())
+	{
+		return false;
+	}
+
+	OutChunk = ChunkIndex;
+	OutRow = Chunks[ChunkIndex]->Start + Index - RingChunkStartIndex(ChunkIndex);
+	return true;
+}
+
+bool UBitmapPointStorage::RingFindId(int32 Id, int32& OutChunk, int32& OutRow) const
+{
+	// Chunks hold ascending id ranges, find the last chunk whose first live id is at or before Id
+	const int32 ChunkIndex = Algo::UpperBoundBy(Chunks, Id, [](const TUniquePtr<FBitmapPointChunk>& Chunk) {
+		return Chunk->Columns.Ids[Chunk->Start];
+	}) - 1;
+	if (ChunkIndex < 0)
+	{
+		return false;
+	}
+
+	const FBitmapPointChunk& Chunk = *Chunks[ChunkIndex];
+	const int32 Row = Algo::BinarySearch(TConstArrayView<int32>(Chunk.Columns.Ids.GetData() + Chunk.Start, Chunk.NumLive()), Id);
+	if (Row == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutChunk = ChunkIndex;
+	OutRow = Chunk.Start + Row;
+	return true;
+}
+
+int32 UBitmapPointStorage::RingChunkStartIndex(int32 ChunkIndex) const
+{
+	RingUpdateChunkEnds();
+	return (ChunkIndex > 0 ? RingChunkEnds[ChunkIndex - 1] : RingPositionBase) - RingPositionBase;
+}
+
+void UBitmapPointStorage::RingUpdateChunkEnds() const
+{
+	if (RingValidChunkEnds == Chunks.Num())
+	{
+		return;
+	}
+
+	// Nothing valid to stay consistent with, so restart positions at zero
+	if (RingValidChunkEnds == 0)
+	{
+		RingPositionBase = 0;
+	}
+
+	// Appends only invalidate the last chunk, so this usually recomputes a single entry
+	RingChunkEnds.SetNum(Chunks.Num(), false);
+	for (int32 ChunkIndex = RingValidChunkEnds; ChunkIndex < Chunks.Num(); ChunkIndex++)
+	{
+		const int32 ChunkStart = ChunkIndex > 0 ? RingChunkEnds[ChunkIndex - 1] : RingPositionBase;
+		RingChunkEnds[ChunkIndex] = ChunkStart + Chunks[ChunkIndex]->NumLive();
+	}
+	RingValidChunkEnds = Chunks.Num();
+}
+
+int32 UBitmapPointStorage::RingRemoveAll(TFunctionRef<bool(const FBitmapPointColumns&, int32)> ShouldRemove, TArray<int32>& OutRemovedIds)
+{
+	int32 RemovedCount = 0;
+
+	// Walk oldest chunk first so removed ids come out in ascending order
+	int32 ChunkIndex = 0;
+	while (ChunkIndex < Chunks.Num())
+	{
+		FBitmapPointChunk& Chunk = *Chunks[ChunkIndex];
+		Chunk.CompactFront();
+		RingInvalidateChunkEnds(ChunkIndex);
+
+		const FBitmapPointColumns& ChunkColumns = Chunk.Columns;
+		RemovedCount += Chunk.Columns.RemoveAll([&ShouldRemove, &ChunkColumns](int32 Row) {
+			return ShouldRemove(ChunkColumns, Row);
+		}, &OutRemovedIds);
+
+		if (Chunk.NumLive() == 0)
+		{
+			RingReleaseChunk(ChunkIndex);
+		}
+		else
+		{
+			ChunkIndex++;
+		}
+	}
+
+	RingPointCount -= RemovedCount;
+	bPointCacheDirty |= RemovedCount > 0;
+	return RemovedCount;
+}
+
+void UBitmapPointStorage::RingReleaseChunk(int32 ChunkIndex)
+{
+	Chunks[ChunkIndex]->Reset();
+	FreeChunks.Add(MoveTemp(Chunks[ChunkIndex]));
+	Chunks.RemoveAt(ChunkIndex, 1, false);
+	RingInvalidateChunkEnds(ChunkIndex);
+}
+
+void UBitmapPointStorage::RingReleaseAll()
+{
+	for (TUniquePtr<FBitmapPointChunk>& Chunk : Chunks)
+	{
+		Chunk->Reset();
+		FreeChunks.Add(MoveTemp(Chunk));
+	}
+	Chunks.Reset();
+	RingPointCount = 0;
+	RingChunkEnds.Reset();
+	RingValidChunkEnds = 0;
+	RingPositionBase = 0;
+}
+
+int32 UBitmapPointStorage::RemoveAllStructs(TFunctionRef<bool(int32 Index)> ShouldRemove, TArray<int32>& OutRemovedIds)
+{
+	const int32 InitialCount = BitmapPoints.Num();
+	int32 WriteIndex = 0;
+
+	for (int32 ReadIndex = 0; ReadIndex < InitialCount; ReadIndex++)
+	{
+		if (ShouldRemove(ReadIndex))
+		{
+			OutRemovedIds.Add(PointIds[ReadIndex]);
+			continue;
+		}
+
+		if (WriteIndex != ReadIndex)
+		{
+			BitmapPoints[WriteIndex] = BitmapPoints[ReadIndex];
+			PointIds[WriteIndex] = PointIds[ReadIndex];
+		}
+		WriteIndex++;
+	}
+
+	const int32 RemovedCount = InitialCount - WriteIndex;
+	if (RemovedCount > 0)
+	{
+		BitmapPoints.RemoveAt(WriteIndex, RemovedCount, false);
+		PointIds.RemoveAt(WriteIndex, RemovedCount, false);
+	}
+	return RemovedCount;
+}
+
+void UBitmapPointStorage::CopyAllPoints(TArray<FBitmapPoint>& OutPoints) const
+{
+	if (IsRing())
+	{
+		OutPoints.Reset(RingPointCount);
+		for (const TUniquePtr<FBitmapPointChunk>& Chunk : Chunks)
+		{
+			for (int32 Row = Chunk->Start; Row < Chunk->Columns.Num(); Row++)
+			{
+				OutPoints.Add(Chunk->Columns.GetPoint(Row));
+			}
+		}
+	}
+	else if (IsColumnar())
+	{
+		Columns.CopyTo(OutPoints);
+	}
+	else if (&OutPoints != &BitmapPoints)
+	{
+		OutPoints = BitmapPoints;
+	}
+}
+
+void UBitmapPointStorage::CopyAllPointIds(TArray<int32>& OutIds) const
+{
+	if (IsRing())
+	{
+		OutIds.Reset(RingPointCount);
+		for (const TUniquePtr<FBitmapPointChunk>& Chunk : Chunks)
+		{
+			OutIds.Append(Chunk->Columns.Ids.GetData() + Chunk->Start, Chunk->NumLive());
+		}
+	}
+	else
+	{
+		OutIds = IsColumnar() ? Columns.Ids : PointIds;
+	}
+}
+
+float UBitmapPointStorage::GetTimestampAt(int32 Index) const
+{
+	if (IsRing())
+	{
+		int32 ChunkIndex = 0;
+		int32 Row = 0;
+		RingLocate(Index, ChunkIndex, Row);
+		return Chunks[ChunkIndex]->Columns.Timestamps[Row];
+	}
+	return IsColumnar() ? Columns.Timestamps[Index] : BitmapPoints[Index].Timestamp;
+}
+
+void UBitmapPointStorage::RebuildAgeIndex()
+{
+	AgeIndex.Reset();
+
+	if (IsRing())
+	{
+		for (const TUniquePtr<FBitmapPointChunk>& Chunk : Chunks)
+		{
+			for (int32 Row = Chunk->Start; Row < Chunk->Columns.Num(); Row++)
+			{
+				AgeIndex.Add(Chunk->Columns.Ids[Row], Chunk->Columns.Timestamps[Row]);
+			}
+		}
+	}
+	else if (IsColumnar())
+	{
+		for (int32 Index = 0; Index < Columns.Num(); Index++)
+		{
+			AgeIndex.Add(Columns.Ids[Index], Columns.Timestamps[Index]);
+		}
+	}
+	else
+	{
+		for (int32 Index = 0; Index < BitmapPoints.Num(); Index++)
+		{
+			AgeIndex.Add(PointIds[Index], BitmapPoints[Index].Timestamp);
+		}
+	}
+}
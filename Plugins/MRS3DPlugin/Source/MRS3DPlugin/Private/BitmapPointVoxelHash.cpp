@@ -0,0 +1,334 @@
+#include "BitmapPointVoxelHash.h"
+
+namespace
+{
+	/** Spread the low 21 bits of a value so they occupy every third bit */
+	uint64 SpreadBits21(uint64 Value)
+	{
+		Value &= 0x1fffff;
+		Value = (Value | (Value << 32)) & 0x1f00000000ffffull;
+		Value = (Value | (Value << 16)) & 0x1f0000ff0000ffull;
+		Value = (Value | (Value << 8)) & 0x100f00f00f00f00full;
+		Value = (Value | (Value << 4)) & 0x10c30c30c30c30c3ull;
+		Value = (Value | (Value << 2)) & 0x1249249249249249ull;
+		return Value;
+	}
+
+	constexpr int32 MinTableCapacity = 64;
+}
+
+FBitmapPointVoxelHash::FBitmapPointVoxelHash()
+	: NumPoints(0)
+	, NumCells(0)
+	, NumBricks(0)
+{
+}
+
+void FBitmapPointVoxelHash::Reset()
+{
+	Table.Empty();
+	Bricks.Empty();
+	FreeBricks.Empty();
+	Blocks.Empty();
+	FreeBlocks.Empty();
+	NumPoints = 0;
+	NumCells = 0;
+	NumBricks = 0;
+}
+
+int32 FBitmapPointVoxelHash::Add(const FIntVector& Cell, int32 Id, const FVector3f& Position)
+{
+	const int32 BrickIndex = FindOrAddBrick(CellToBrick(Cell));
+	const int32 CellBit = CellToBit(Cell);
+	const uint64 CellMask = 1ull << CellBit;
+
+	FBrick& Brick = Bricks[BrickIndex];
+	FCell& CellData = Brick.Cells[CellBit];
+
+	if ((Brick.Occupancy & CellMask) == 0)
+	{
+		Brick.Occupancy |= CellMask;
+		CellData.LastBlock = INDEX_NONE;
+		CellData.Count = 0;
+		NumCells++;
+	}
+
+	const int32 Lane = CellData.Count % BlockSize;
+	if (Lane == 0)
+	{
+		const int32 NewBlock = AllocateBlock();
+		FBlock& Block = Blocks[NewBlock];
+		Block.Prev = CellData.LastBlock;
+		Block.Brick = BrickIndex;
+		Block.CellBit = CellBit;
+		CellData.LastBlock = NewBlock;
+	}
+
+	FBlock& Block = Blocks[CellData.LastBlock];
+	Block.X[Lane] = Position.X;
+	Block.Y[Lane] = Position.Y;
+	Block.Z[Lane] = Position.Z;
+	Block.Ids[Lane] = Id;
+
+	CellData.Count++;
+	NumPoints++;
+
+	return CellData.LastBlock * BlockSize + Lane;
+}
+
+int32 FBitmapPointVoxelHash::Remove(int32 Slot)
+{
+	const int32 BlockIndex = Slot / BlockSize;
+	const int32 Lane = Slot % BlockSize;
+
+	FBlock& Block = Blocks[BlockIndex];
+	const int32 BrickIndex = Block.Brick;
+	const int32 CellBit = Block.CellBit;
+
+	FBrick& Brick = Bricks[BrickIndex];
+	FCell& CellData = Brick.Cells[CellBit];
+
+	const int32 LastBlockIndex = CellData.LastBlock;
+	const int32 LastLane = (CellData.Count - 1) % BlockSize;
+
+	// Fill the hole with the last point of the cell so blocks stay dense
+	int32 MovedId = INDEX_NONE;
+	if (LastBlockIndex != BlockIndex || LastLane != Lane)
+	{
+		const FBlock& LastBlock = Blocks[LastBlockIndex];
+		Block.X[Lane] = LastBlock.X[LastLane];
+		Block.Y[Lane] = LastBlock.Y[LastLane];
+		Block.Z[Lane] = LastBlock.Z[LastLane];
+		Block.Ids[Lane] = LastBlock.Ids[LastLane];
+		MovedId = Block.Ids[Lane];
+	}
+
+	CellData.Count--;
+	NumPoints--;
+
+	if (LastLane == 0)
+	{
+		CellData.LastBlock = Blocks[LastBlockIndex].Prev;
+		ReleaseBlock(LastBlockIndex);
+	}
+
+	if (CellData.Count == 0)
+	{
+		Brick.Occupancy &= ~(1ull << CellBit);
+		NumCells--;
+
+		if (Brick.Occupancy == 0)
+		{
+			RemoveBrick(BrickIndex);
+		}
+	}
+
+	return MovedId;
+}
+
+bool FBitmapPointVoxelHash::FindCell(const FIntVector& Cell, FVoxelCellRef& OutRef) const
+{
+	const int32 BrickIndex = FindBrick(CellToBrick(Cell));
+	if (BrickIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const int32 CellBit = CellToBit(Cell);
+	if ((Bricks[BrickIndex].Occupancy & (1ull << CellBit)) == 0)
+	{
+		return false;
+	}
+
+	OutRef.Brick = BrickIndex;
+	OutRef.CellBit = CellBit;
+	return true;
+}
+
+SIZE_T FBitmapPointVoxelHash::GetAllocatedSize() const
+{
+	return Table.GetAllocatedSize()
+		+ Bricks.GetAllocatedSize()
+		+ FreeBricks.GetAllocatedSize()
+		+ Blocks.GetAllocatedSize()
+		+ FreeBlocks.GetAllocatedSize();
+}
+
+uint64 FBitmapPointVoxelHash::EncodeMorton(const FIntVector& Coord)
+{
+	// Bias into the unsigned 21-bit range before interleaving
+	const uint64 X = static_cast<uint64>(Coord.X + (1 << 20));
+	const uint64 Y = static_cast<uint64>(Coord.Y + (1 << 20));
+	const uint64 Z = static_cast<uint64>(Coord.Z + (1 << 20));
+	return SpreadBits21(X) | (SpreadBits21(Y) << 1) | (SpreadBits21(Z) << 2);
+}
+
+uint64 FBitmapPointVoxelHash::HashKey(uint64 Key)
+{
+	// MurmurHash3 finalizer
+	Key ^= Key >> 33;
+	Key *= 0xff51afd7ed558ccdull;
+	Key ^= Key >> 33;
+	Key *= 0xc4ceb9fe1a85ec53ull;
+	Key ^= Key >> 33;
+	return Key;
+}
+
+uint64 FBitmapPointVoxelHash::MakeRangeMask(const FIntVector& LocalMin, const FIntVector& LocalMax)
+{
+	const uint64 RowMask = ((1ull << (LocalMax.X + 1)) - 1) & ~((1ull << LocalMin.X) - 1);
+
+	uint64 Mask = 0;
+	for (int32 Z = LocalMin.Z; Z <= LocalMax.Z; Z++)
+	{
+		for (int32 Y = LocalMin.Y; Y <= LocalMax.Y; Y++)
+		{
+			Mask |= RowMask << (Y * BrickEdge + Z * BrickEdge * BrickEdge);
+		}
+	}
+	return Mask;
+}
+
+int32 FBitmapPointVoxelHash::FindBrick(const FIntVector& BrickCoord) const
+{
+	if (Table.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const uint64 Key = EncodeMorton(BrickCoord);
+	const int32 Mask = Table.Num() - 1;
+
+	for (int32 Index = static_cast<int32>(HashKey(Key) & Mask); ; Index = (Index + 1) & Mask)
+	{
+		const FTableSlot& Slot = Table[Index];
+		if (Slot.Brick == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+		if (Slot.Key == Key)
+		{
+			return Slot.Brick;
+		}
+	}
+}
+
+int32 FBitmapPointVoxelHash::FindOrAddBrick(const FIntVector& BrickCoord)
+{
+	const int32 Existing = FindBrick(BrickCoord);
+	if (Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+
+	// Keep the load factor at or below one half so probe sequences stay short
+	if ((NumBricks + 1) * 2 > Table.Num())
+	{
+		GrowTable();
+	}
+
+	int32 BrickIndex;
+	if (FreeBricks.Num() > 0)
+	{
+		BrickIndex = FreeBricks.Pop(false);
+	}
+	else
+	{
+		BrickIndex = Bricks.AddUninitialized();
+	}
+
+	FBrick& Brick = Bricks[BrickIndex];
+	Brick.Coord = BrickCoord;
+	Brick.Occupancy = 0;
+
+	InsertIntoTable(EncodeMorton(BrickCoord), BrickIndex);
+	NumBricks++;
+	return BrickIndex;
+}
+
+void FBitmapPointVoxelHash::RemoveBrick(int32 BrickIndex)
+{
+	const uint64 Key = EncodeMorton(Bricks[BrickIndex].Coord);
+	const int32 Mask = Table.Num() - 1;
+
+	int32 Hole = static_cast<int32>(HashKey(Key) & Mask);
+	while (Table[Hole].Brick != BrickIndex)
+	{
+		Hole = (Hole + 1) & Mask;
+	}
+
+	// Backward-shift deletion keeps linear probing free of tombstones
+	int32 Next = Hole;
+	while (true)
+	{
+		Next = (Next + 1) & Mask;
+		if (Table[Next].Brick == INDEX_NONE)
+		{
+			break;
+		}
+
+		const int32 Home = static_cast<int32>(HashKey(Table[Next].Key) & Mask);
+		const bool bHomeBetween = Hole <= Next ? (Hole < Home && Home <= Next) : (Hole < Home || Home <= Next);
+		if (bHomeBetween)
+		{
+			continue;
+		}
+
+		Table[Hole] = Table[Next];
+		Hole = Next;
+	}
+	Table[Hole].Brick = INDEX_NONE;
+
+	Bricks[BrickIndex].Occupancy = 0;
+	FreeBricks.Add(BrickIndex);
+	NumBricks--;
+}
+
+void FBitmapPointVoxelHash::InsertIntoTable(uint64 Key, int32 BrickIndex)
+{
+	const int32 Mask = Table.Num() - 1;
+
+	int32 Index = static_cast<int32>(HashKey(Key) & Mask);
+	while (Table[Index].Brick != INDEX_NONE)
+	{
+		Index = (Index + 1) & Mask;
+	}
+
+	Table[Index].Key = Key;
+	Table[Index].Brick = BrickIndex;
+}
+
+void FBitmapPointVoxelHash::GrowTable()
+{
+	TArray<FTableSlot> OldTable = MoveTemp(Table);
+
+	const int32 NewCapacity = FMath::Max(MinTableCapacity, OldTable.Num() * 2);
+	Table.SetNumUninitialized(NewCapacity);
+	for (FTableSlot& Slot : Table)
+	{
+		Slot.Key = 0;
+		Slot.Brick = INDEX_NONE;
+	}
+
+	for (const FTableSlot& Slot : OldTable)
+	{
+		if (Slot.Brick != INDEX_NONE)
+		{
+			InsertIntoTable(Slot.Key, Slot.Brick);
+		}
+	}
+}
+
+int32 FBitmapPointVoxelHash::AllocateBlock()
+{
+	if (FreeBlocks.Num() > 0)
+	{
+		return FreeBlocks.Pop(false);
+	}
+	return Blocks.AddUninitialized();
+}
+
+void FBitmapPointVoxelHash::ReleaseBlock(int32 BlockIndex)
+{
+	FreeBlocks.Add(BlockIndex);
+}
\ No newline at end of file
@@ -1,13 +1,45 @@
 #include "MRBitmapMapper.h"
 #include "PlaneDetectionSubsystem.h"
 #include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorldAndArgs GVerifyRadiusQueriesCommand(
+	TEXT("MRS3D.VerifyRadiusQueries"),
+	TEXT("Check that scalar, vectorized and batched spatial index radius queries agree. Usage: MRS3D.VerifyRadiusQueries [NumQueries=1000] [Radius=100]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		UMRBitmapMapper* Mapper = GameInstance ? GameInstance->GetSubsystem<UMRBitmapMapper>() : nullptr;
+		if (!Mapper || !Mapper->GetSpatialIndex())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("MRBitmapMapper: No spatial index to verify"));
+			return;
+		}
+
+		const int32 NumQueries = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+		const float Radius = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 100.0f;
+		Mapper->GetSpatialIndex()->VerifyRadiusQueries(NumQueries, Radius);
+	}));
+#endif
 
 UMRBitmapMapper::UMRBitmapMapper()
 	: Storage(nullptr)
 	, MemoryManager(nullptr)
 	, SpatialIndex(nullptr)
+	, PointFusion(nullptr)
+	, PlaneTracker(nullptr)
 	, TrackingStateManager(nullptr)
 	, bRealTimeUpdatesEnabled(true)
+	, StorageLayout(EBitmapPointStorageLayout::ChunkedRing)
+	, EvictionPolicy(EBitmapPointEvictionPolicy::Oldest)
+	, ChunkSize(100.0f)
+	, bPagingEnabled(false)
+	, bPointFusionEnabled(false)
+	, PointFusionVoxelSize(2.0f)
+	, PointFusionMaxWeight(64)
 	, bAutoPlaneDetectionEnabled(false)
 	, PlaneDetectionInterval(10.0f)
 	, MinPointsForPlaneDetection(100)
@@ -28,10 +60,18 @@ void UMRBitmapMapper::Deinitialize()
 {
 	UE_LOG(LogTemp, Log, TEXT("MRBitmapMapper: Deinitialized"));
 	
+	// Paged-out points do not outlive the session
+	if (MemoryManager)
+	{
+		MemoryManager->ResetPagedPoints();
+	}
+	
 	// Cleanup will be handled by component destructors
 	Storage = nullptr;
 	MemoryManager = nullptr;
 	SpatialIndex = nullptr;
+	PointFusion = nullptr;
+	PlaneTracker = nullptr;
 	TrackingStateManager = nullptr;
 	
 	Super::Deinitialize();
@@ -44,13 +84,20 @@ void UMRBitmapMapper::AddBitmapPoint(const FBitmapPoint& Point)
 		return;
 	}
 
+	if (bPointFusionEnabled && PointFusion)
+	{
+		AddBitmapPoints({ Point });
+		return;
+	}
+
 	// Add to storage (which will trigger events)
+	const int32 StartIndex = Storage->GetPointCount();
 	Storage->AddPoint(Point);
 	
-	// Add to spatial index for fast queries
+	// Index the stored point by id for fast queries
 	if (SpatialIndex)
 	{
-		SpatialIndex->AddPoint(Point);
+		SpatialIndex->AddStoredPoints(StartIndex, 1);
 	}
 	
 	// Perform auto plane detection if enabled
@@ -67,13 +114,21 @@ void UMRBitmapMapper::AddBitmapPoints(const TArray<FBitmapPoint>& Points)
 		return;
 	}
 
-	// Add to storage (which will trigger events)
-	Storage->AddPoints(Points);
-	
-	// Add to spatial index for fast queries
-	if (SpatialIndex)
+	if (bPointFusionEnabled && PointFusion)
 	{
-		SpatialIndex->AddPoints(Points);
+		AddFusedPoints(Points);
+	}
+	else
+	{
+		// Add to storage (which will trigger events)
+		const int32 StartIndex = Storage->GetPointCount();
+		Storage->AddPoints(Points);
+		
+		// Index the stored points by id for fast queries
+		if (SpatialIndex)
+		{
+			SpatialIndex->AddStoredPoints(StartIndex, Points.Num());
+		}
 	}
 	
 	// Perform auto plane detection if enabled
@@ -83,6 +138,27 @@ void UMRBitmapMapper::AddBitmapPoints(const TArray<FBitmapPoint>& Points)
 	}
 }
 
+void UMRBitmapMapper::SetPointFusionEnabled(bool bEnabled)
+{
+	// Fusion only tracks points it stored itself, so start from a clean voxel map either way
+	if (PointFusion && bEnabled != bPointFusionEnabled)
+	{
+		PointFusion->Reset();
+	}
+	
+	bPointFusionEnabled = bEnabled;
+	UE_LOG(LogTemp, Log, TEXT("MRBitmapMapper: Point fusion %s"), bEnabled ? TEXT("enabled") : TEXT("disabled"));
+}
+
+void UMRBitmapMapper::SetPointFusionVoxelSize(float VoxelSize)
+{
+	PointFusionVoxelSize = VoxelSize;
+	if (PointFusion)
+	{
+		PointFusion->SetVoxelSize(VoxelSize);
+	}
+}
+
 void UMRBitmapMapper::ClearBitmapPoints()
 {
 	if (Storage)
@@ -90,6 +166,11 @@ void UMRBitmapMapper::ClearBitmapPoints()
 		Storage->Clear();
 	}
 	
+	if (MemoryManager)
+	{
+		MemoryManager->ResetPagedPoints();
+	}
+	
 	if (SpatialIndex)
 	{
 		SpatialIndex->Clear();
@@ -102,6 +183,16 @@ const TArray<FBitmapPoint>& UMRBitmapMapper::GetBitmapPoints() const
 	return Storage ? Storage->GetAllPoints() : EmptyArray;
 }
 
+int64 UMRBitmapMapper::GetBitmapPointsVersion() const
+{
+	return Storage ? Storage->GetVersion() : 0;
+}
+
+bool UMRBitmapMapper::GetBitmapPointChangesSince(int64 SinceVersion, TArray<FBitmapPointChangeSet>& OutChanges) const
+{
+	return Storage ? Storage->GetChangesSince(SinceVersion, OutChanges) : false;
+}
+
 TArray<FBitmapPoint> UMRBitmapMapper::GetBitmapPointsInRadius(const FVector& Center, float Radius) const
 {
 	if (!SpatialIndex)
@@ -109,6 +200,11 @@ TArray<FBitmapPoint> UMRBitmapMapper::GetBitmapPointsInRadius(const FVector& Cen
 		return TArray<FBitmapPoint>();
 	}
 	
+	if (MemoryManager)
+	{
+		MemoryManager->MarkRegionUsed(Center, Radius);
+	}
+	
 	return SpatialIndex->FindPointsInRadius(Center, Radius);
 }
 
@@ -119,6 +215,11 @@ bool UMRBitmapMapper::FindNearestPoint(const FVector& Location, FBitmapPoint& Ou
 		return false;
 	}
 	
+	if (MemoryManager)
+	{
+		MemoryManager->MarkRegionUsed(Location, 0.0f);
+	}
+	
 	return SpatialIndex->FindNearestPoint(Location, OutPoint, MaxDistance);
 }
 
@@ -129,6 +230,11 @@ TArray<FBitmapPoint> UMRBitmapMapper::FindKNearestPoints(const FVector& Location
 		return TArray<FBitmapPoint>();
 	}
 	
+	if (MemoryManager)
+	{
+		MemoryManager->MarkRegionUsed(Location, 0.0f);
+	}
+	
 	return SpatialIndex->FindKNearestPoints(Location, K, MaxDistance);
 }
 
@@ -146,6 +252,47 @@ void UMRBitmapMapper::SetMaxBitmapPoints(int32 MaxPoints)
 	}
 }
 
+void UMRBitmapMapper::SetEvictionPolicy(EBitmapPointEvictionPolicy Policy)
+{
+	EvictionPolicy = Policy;
+	if (MemoryManager)
+	{
+		MemoryManager->SetEvictionPolicy(Policy);
+	}
+}
+
+void UMRBitmapMapper::SetPagingEnabled(bool bEnabled)
+{
+	bPagingEnabled = bEnabled;
+	if (!MemoryManager)
+	{
+		return;
+	}
+	
+	// Bring everything back before the store goes away
+	if (!bEnabled)
+	{
+		TArray<FBitmapPoint> PagedPoints;
+		MemoryManager->ReadAllPagedPoints(PagedPoints);
+		StorePagedInPoints(PagedPoints);
+	}
+	
+	MemoryManager->SetPagingEnabled(bEnabled);
+}
+
+int32 UMRBitmapMapper::PageInRegion(const FBox& Bounds)
+{
+	if (!MemoryManager)
+	{
+		return 0;
+	}
+	
+	TArray<FBitmapPoint> PagedPoints;
+	MemoryManager->ReadPagedPoints(Bounds, PagedPoints);
+	StorePagedInPoints(PagedPoints);
+	return PagedPoints.Num();
+}
+
 void UMRBitmapMapper::SetMaxPointAge(float MaxAgeSeconds)
 {
 	if (MemoryManager)
@@ -178,9 +325,90 @@ int32 UMRBitmapMapper::GetMemoryUsageKB() const
 		TotalMemory += SpatialIndex->GetMemoryUsageBytes() / 1024;
 	}
 	
+	if (PointFusion)
+	{
+		TotalMemory += PointFusion->GetMemoryUsageBytes() / 1024;
+	}
+	
+	if (PlaneTracker)
+	{
+		TotalMemory += PlaneTracker->GetMemoryUsageBytes() / 1024;
+	}
+	
 	return TotalMemory;
 }
 
+int32 UMRBitmapMapper::DownsamplePoints(float VoxelSize)
+{
+	if (!Storage || VoxelSize <= 0.0f || Storage->GetPointCount() == 0)
+	{
+		return 0;
+	}
+	
+	// The first point seen in a voxel keeps its id and absorbs the others as a running average
+	TMap<FIntVector, int32> VoxelToKept;
+	TArray<int32> KeptIds;
+	TArray<FBitmapPoint> KeptPoints;
+	TArray<int32> KeptCounts;
+	TArray<int32> RemovedIds;
+	
+	const int32 PointCount = Storage->GetPointCount();
+	Storage->ForEachPoint([VoxelSize, &VoxelToKept, &KeptIds, &KeptPoints, &KeptCounts, &RemovedIds](int32 Id, const FBitmapPointView& Point) {
+		const FIntVector Voxel(
+			FMath::FloorToInt(Point.Position.X / VoxelSize),
+			FMath::FloorToInt(Point.Position.Y / VoxelSize),
+			FMath::FloorToInt(Point.Position.Z / VoxelSize));
+		
+		if (const int32* Kept = VoxelToKept.Find(Voxel))
+		{
+			FBitmapPoint& KeptPoint = KeptPoints[*Kept];
+			const float Alpha = 1.0f / ++KeptCounts[*Kept];
+			KeptPoint.Position += (Point.Position - KeptPoint.Position) * Alpha;
+			KeptPoint.Normal += (Point.Normal - KeptPoint.Normal) * Alpha;
+			KeptPoint.Intensity += (Point.Intensity - KeptPoint.Intensity) * Alpha;
+			KeptPoint.Timestamp = FMath::Max(KeptPoint.Timestamp, Point.Timestamp);
+			RemovedIds.Add(Id);
+		}
+		else
+		{
+			VoxelToKept.Add(Voxel, KeptIds.Num());
+			KeptIds.Add(Id);
+			KeptPoints.Add(Point.ToBitmapPoint());
+			KeptCounts.Add(1);
+		}
+	});
+	
+	if (RemovedIds.Num() == 0)
+	{
+		return 0;
+	}
+	
+	// Only voxels that absorbed other points changed
+	TArray<int32> MergedIds;
+	TArray<FBitmapPoint> MergedPoints;
+	for (int32 Kept = 0; Kept < KeptIds.Num(); Kept++)
+	{
+		if (KeptCounts[Kept] > 1)
+		{
+			KeptPoints[Kept].Normal = KeptPoints[Kept].Normal.GetSafeNormal(SMALL_NUMBER, FVector::UpVector);
+			MergedIds.Add(KeptIds[Kept]);
+			MergedPoints.Add(KeptPoints[Kept]);
+		}
+	}
+	
+	Storage->RemovePointsById(RemovedIds);
+	Storage->UpdatePointsById(MergedIds, MergedPoints);
+	
+	if (SpatialIndex)
+	{
+		SpatialIndex->RemovePointsById(RemovedIds);
+		SpatialIndex->RefreshStoredPoints(MergedIds);
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("MRBitmapMapper: Downsampled %d points into %d voxels of %.1f"), PointCount, KeptIds.Num(), VoxelSize);
+	return RemovedIds.Num();
+}
+
 void UMRBitmapMapper::ForceCleanup()
 {
 	if (MemoryManager)
@@ -191,6 +419,16 @@ void UMRBitmapMapper::ForceCleanup()
 
 void UMRBitmapMapper::SetAutoPlaneDetectionEnabled(bool bEnabled)
 {
+	// Tracking only follows change sets while enabled, so start over from the stored points
+	if (PlaneTracker && bEnabled != bAutoPlaneDetectionEnabled)
+	{
+		PlaneTracker->Reset();
+		if (bEnabled)
+		{
+			PlaneTracker->SeedFromStorage(Storage);
+		}
+	}
+
 	bAutoPlaneDetectionEnabled = bEnabled;
 	UE_LOG(LogTemp, Log, TEXT("MRBitmapMapper: Auto plane detection %s"), bEnabled ? TEXT("enabled") : TEXT("disabled"));
 }
@@ -204,7 +442,7 @@ TArray<FDetectedPlane> UMRBitmapMapper::DetectPlanesFromCurrentPoints(float Plan
 	}
 	
 	const TArray<FBitmapPoint>& CurrentPoints = Storage->GetAllPoints();
-	return PlaneDetection->DetectPlanes(CurrentPoints, PlaneThickness);
+	return PlaneDetection->DetectPlanesFromPoints(CurrentPoints, PlaneThickness);
 }
 
 void UMRBitmapMapper::UpdateARTrackingState(ETrackingState NewState, const FTransform& CameraPose, float Quality)
@@ -251,6 +489,8 @@ void UMRBitmapMapper::InitializeComponents()
 	Storage = NewObject<UBitmapPointStorage>(this);
 	MemoryManager = NewObject<UBitmapPointMemoryManager>(this);
 	SpatialIndex = NewObject<UBitmapPointSpatialIndex>(this);
+	PointFusion = NewObject<UBitmapPointFusion>(this);
+	PlaneTracker = NewObject<UBitmapPointPlaneTracker>(this);
 	
 	// Get or create tracking state manager (it's a subsystem)
 	TrackingStateManager = GetGameInstance()->GetSubsystem<UMRTrackingStateManager>();
@@ -258,40 +498,99 @@ void UMRBitmapMapper::InitializeComponents()
 	// Initialize components
 	if (Storage)
 	{
-		Storage->OnBitmapPointsChanged.AddDynamic(this, &UMRBitmapMapper::OnStoragePointsChanged);
+		Storage->SetLayout(StorageLayout);
+		Storage->OnBitmapPointsChangeSet.AddDynamic(this, &UMRBitmapMapper::OnStoragePointsChanged);
 	}
 	
 	if (MemoryManager && Storage)
 	{
 		MemoryManager->Initialize(Storage);
+		MemoryManager->SetEvictionPolicy(EvictionPolicy);
+		MemoryManager->SetEvictionRegionSize(ChunkSize);
+		MemoryManager->SetTrackingStateManager(TrackingStateManager);
+		MemoryManager->SetPagingEnabled(bPagingEnabled);
 		MemoryManager->OnMemoryCleanup.AddDynamic(this, &UMRBitmapMapper::OnMemoryCleanup);
+		MemoryManager->OnPointsEvicted.AddDynamic(this, &UMRBitmapMapper::OnPointsEvicted);
 	}
 	
 	if (SpatialIndex)
 	{
 		SpatialIndex->Initialize();
+		SpatialIndex->SetStorage(Storage);
+		SpatialIndex->SetChunkSize(ChunkSize);
 		SpatialIndex->OnSpatialIndexUpdated.AddDynamic(this, &UMRBitmapMapper::OnSpatialIndexUpdated);
+		SpatialIndex->OnQueryBounds.BindUObject(this, &UMRBitmapMapper::OnSpatialIndexQueried);
+	}
+	
+	if (PointFusion)
+	{
+		PointFusion->SetVoxelSize(PointFusionVoxelSize);
+		PointFusion->SetMaxObservationWeight(PointFusionMaxWeight);
 	}
 	
 	// Initialize tracking
 	LastPlaneDetectionTime = FPlatformTime::Seconds();
 }
 
-void UMRBitmapMapper::OnStoragePointsChanged(const TArray<FBitmapPoint>& Points)
+void UMRBitmapMapper::AddFusedPoints(const TArray<FBitmapPoint>& Points)
 {
-	BroadcastUpdate();
+	TArray<FBitmapPoint> NewPoints;
+	TArray<int32> UpdatedIds;
+	TArray<FBitmapPoint> UpdatedPoints;
+	PointFusion->FusePoints(Points, NewPoints, UpdatedIds, UpdatedPoints);
+	
+	// Refine the points already stored for re-observed voxels
+	if (UpdatedIds.Num() > 0)
+	{
+		Storage->UpdatePointsById(UpdatedIds, UpdatedPoints);
+		
+		if (SpatialIndex)
+		{
+			SpatialIndex->RefreshStoredPoints(UpdatedIds);
+		}
+	}
+	
+	// Store one point per newly observed voxel
+	if (NewPoints.Num() > 0)
+	{
+		const int32 StartIndex = Storage->GetPointCount();
+		Storage->AddPoints(NewPoints);
+		PointFusion->BindNewPoints(Storage->GetPointId(StartIndex));
+		
+		if (SpatialIndex)
+		{
+			SpatialIndex->AddStoredPoints(StartIndex, NewPoints.Num());
+		}
+	}
+}
+
+void UMRBitmapMapper::OnStoragePointsChanged(const FBitmapPointChangeSet& ChangeSet)
+{
+	if (PointFusion)
+	{
+		PointFusion->HandleChangeSet(ChangeSet);
+	}
+	
+	if (PlaneTracker && bAutoPlaneDetectionEnabled)
+	{
+		PlaneTracker->HandleChangeSet(ChangeSet);
+	}
+	
+	BroadcastUpdate(ChangeSet);
 }
 
 void UMRBitmapMapper::OnMemoryCleanup(int32 PointsRemoved, int32 MemoryFreedKB)
 {
 	UE_LOG(LogTemp, Verbose, TEXT("MRBitmapMapper: Memory cleanup removed %d points, freed %d KB"), 
 		PointsRemoved, MemoryFreedKB);
-	
-	// Sync spatial index with storage after cleanup
-	if (SpatialIndex && Storage && PointsRemoved > 0)
+}
+
+void UMRBitmapMapper::OnPointsEvicted(const TArray<int32>& EvictedIds)
+{
+	// Drop only the evicted points from the spatial index instead of rebuilding it
+	if (SpatialIndex)
 	{
-		SpatialIndex->Clear();
-		SpatialIndex->AddPoints(Storage->GetAllPoints());
+		SpatialIndex->RemovePointsById(EvictedIds);
 	}
 }
 
@@ -300,11 +599,41 @@ void UMRBitmapMapper::OnSpatialIndexUpdated(int32 AddedPoints, int32 RemovedPoin
 	// Spatial index updated - could trigger additional processing here if needed
 }
 
-void UMRBitmapMapper::BroadcastUpdate()
+void UMRBitmapMapper::OnSpatialIndexQueried(const FBox& Bounds)
+{
+	// Paging in adds points to the storage and index, so only the game thread may do it before its query reads them
+	check(IsInGameThread());
+	PageInRegion(Bounds);
+}
+
+void UMRBitmapMapper::StorePagedInPoints(const TArray<FBitmapPoint>& Points)
+{
+	if (!Storage || Points.Num() == 0)
+	{
+		return;
+	}
+	
+	// Paged-in points come back with new ids and bypass fusion, they were fused before paging out
+	const int32 StartIndex = Storage->GetPointCount();
+	Storage->AddPoints(Points);
+	
+	if (SpatialIndex)
+	{
+		SpatialIndex->AddStoredPoints(StartIndex, Points.Num());
+	}
+}
+
+void UMRBitmapMapper::BroadcastUpdate(const FBitmapPointChangeSet& ChangeSet)
 {
 	if (bRealTimeUpdatesEnabled && Storage)
 	{
-		OnBitmapPointsUpdated.Broadcast(Storage->GetAllPoints());
+		OnBitmapPointsChangeSet.Broadcast(ChangeSet);
+
+		// Only hand out the full array to listeners that still ask for it
+		if (OnBitmapPointsUpdated.IsBound())
+		{
+			OnBitmapPointsUpdated.Broadcast(Storage->GetAllPoints());
+		}
 	}
 }
 
@@ -316,17 +645,19 @@ void UMRBitmapMapper::PerformAutoPlaneDetection()
 		return;
 	}
 	
-	if (!Storage || Storage->GetPointCount() < MinPointsForPlaneDetection)
+	// Nothing was added or removed since the last pass
+	if (!Storage || !PlaneTracker || !PlaneTracker->HasPendingChanges())
 	{
 		return;
 	}
 	
-	// Trigger plane detection
-	TArray<FDetectedPlane> DetectedPlanes = DetectPlanesFromCurrentPoints();
+	// Only the points that changed are assigned, and only the planes they touched are refit
+	UPlaneDetectionSubsystem* PlaneDetection = GetGameInstance()->GetSubsystem<UPlaneDetectionSubsystem>();
+	const int32 ChangedPlanes = PlaneTracker->Update(Storage, PlaneDetection, MinPointsForPlaneDetection);
 	
-	if (DetectedPlanes.Num() > 0)
+	if (ChangedPlanes > 0)
 	{
-		UE_LOG(LogTemp, Log, TEXT("MRBitmapMapper: Auto-detected %d planes"), DetectedPlanes.Num());
+		UE_LOG(LogTemp, Log, TEXT("MRBitmapMapper: Auto-detection changed %d planes, tracking %d"), ChangedPlanes, PlaneTracker->GetNumTrackedPlanes());
 	}
 	
 	LastPlaneDetectionTime = CurrentTime;
@@ -0,0 +1,253 @@
+#include "MRMemoryBudgetSubsystem.h"
+#include "MRBitmapMapper.h"
+#include "MeshGenerationManager.h"
+#include "ProceduralGenerator.h"
+#include "Engine/GameInstance.h"
+
+UMRMemoryBudgetSubsystem::UMRMemoryBudgetSubsystem()
+	: MemoryBudgetKB(0)
+	, ShedStartFraction(0.9f)
+	, ShedTargetFraction(0.75f)
+	, BudgetCheckInterval(1.0f)
+	, DownsampleVoxelSize(5.0f)
+	, MinFreePhysicalMemoryMB(256)
+	, TimeSinceBudgetCheck(0.0f)
+	, bInitialized(false)
+{
+}
+
+void UMRMemoryBudgetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Collection.InitializeDependency<UMRBitmapMapper>();
+	Collection.InitializeDependency<UMeshGenerationManager>();
+
+	bInitialized = true;
+
+	UE_LOG(LogTemp, Log, TEXT("MemoryBudget: Initialized with budget %d KB"), MemoryBudgetKB);
+}
+
+void UMRMemoryBudgetSubsystem::Deinitialize()
+{
+	bInitialized = false;
+	Generators.Empty();
+
+	Super::Deinitialize();
+}
+
+void UMRMemoryBudgetSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceBudgetCheck += DeltaTime;
+	if (TimeSinceBudgetCheck >= BudgetCheckInterval)
+	{
+		TimeSinceBudgetCheck = 0.0f;
+		EnforceBudget();
+	}
+}
+
+bool UMRMemoryBudgetSubsystem::IsTickable() const
+{
+	// The class default object is never initialized and never ticks
+	return bInitialized && (MemoryBudgetKB > 0 || MinFreePhysicalMemoryMB > 0);
+}
+
+TStatId UMRMemoryBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMRMemoryBudgetSubsystem, STATGROUP_Tickables);
+}
+
+FMRMemoryReport UMRMemoryBudgetSubsystem::GetMemoryReport() const
+{
+	FMRMemoryReport Report;
+	Report.BudgetKB = MemoryBudgetKB;
+
+	UGameInstance* GameInstance = GetGameInstance();
+
+	if (UMRBitmapMapper* Mapper = GameInstance ? GameInstance->GetSubsystem<UMRBitmapMapper>() : nullptr)
+	{
+		if (UBitmapPointStorage* Storage = Mapper->GetStorageComponent())
+		{
+			Report.StorageKB = Storage->GetMemoryUsageBytes() / 1024;
+		}
+
+		if (UBitmapPointSpatialIndex* SpatialIndex = Mapper->GetSpatialIndex())
+		{
+			Report.SpatialIndexKB = SpatialIndex->GetMemoryUsageBytes() / 1024;
+			Report.IndexSnapshotKB = SpatialIndex->GetSnapshotMemoryUsageBytes() / 1024;
+		}
+
+		if (UBitmapPointFusion* PointFusion = Mapper->GetPointFusion())
+		{
+			Report.PointFusionKB = PointFusion->GetMemoryUsageBytes() / 1024;
+		}
+	}
+
+	if (UMeshGenerationManager* MeshManager = GameInstance ? GameInstance->GetSubsystem<UMeshGenerationManager>() : nullptr)
+	{
+		Report.MeshResultsKB = MeshManager->GetTotalMemoryUsageKB();
+	}
+
+	for (const TWeakObjectPtr<UProceduralGenerator>& Generator : Generators)
+	{
+		if (Generator.IsValid())
+		{
+			Report.GeneratorCacheKB += Generator->GetCachedPointsMemoryKB();
+			Report.GeneratorSnapshotKB += Generator->GetPreLossSnapshotMemoryKB();
+		}
+	}
+
+	Report.TotalKB = Report.StorageKB + Report.SpatialIndexKB + Report.PointFusionKB + Report.IndexSnapshotKB
+		+ Report.GeneratorCacheKB + Report.GeneratorSnapshotKB + Report.MeshResultsKB;
+
+	return Report;
+}
+
+int32 UMRMemoryBudgetSubsystem::EnforceBudget()
+{
+	const int32 InitialKB = GetMemoryReport().TotalKB;
+	const bool bOverBudget = MemoryBudgetKB > 0 && InitialKB > MemoryBudgetKB * ShedStartFraction;
+	const bool bDeviceLow = IsDeviceLowOnMemory();
+
+	if (!bOverBudget && !bDeviceLow)
+	{
+		return 0;
+	}
+
+	// Under device pressure alone there is no budget to aim for, so shed a fixed share of what we hold
+	const int32 TargetKB = bOverBudget ? FMath::FloorToInt(MemoryBudgetKB * ShedTargetFraction) : FMath::FloorToInt(InitialKB * ShedTargetFraction);
+
+	int32 CurrentKB = InitialKB;
+	for (uint8 Stage = static_cast<uint8>(EMRMemoryShedStage::DropCaches); Stage <= static_cast<uint8>(EMRMemoryShedStage::Evict) && CurrentKB > TargetKB; Stage++)
+	{
+		RunShedStage(static_cast<EMRMemoryShedStage>(Stage), CurrentKB - TargetKB);
+
+		const int32 StageKB = GetMemoryReport().TotalKB;
+		if (StageKB < CurrentKB)
+		{
+			OnMemoryShed.Broadcast(static_cast<EMRMemoryShedStage>(Stage), CurrentKB - StageKB);
+		}
+		CurrentKB = StageKB;
+	}
+
+	const int32 FreedKB = FMath::Max(0, InitialKB - CurrentKB);
+	UE_LOG(LogTemp, Warning, TEXT("MemoryBudget: Shed %d KB (%d KB -> %d KB, target %d KB%s)"),
+		FreedKB, InitialKB, CurrentKB, TargetKB, bDeviceLow ? TEXT(", device low on memory") : TEXT(""));
+
+	return FreedKB;
+}
+
+void UMRMemoryBudgetSubsystem::SetMemoryBudgetKB(int32 BudgetKB)
+{
+	MemoryBudgetKB = FMath::Max(0, BudgetKB);
+	UE_LOG(LogTemp, Log, TEXT("MemoryBudget: Budget set to %d KB"), MemoryBudgetKB);
+}
+
+void UMRMemoryBudgetSubsystem::RegisterGenerator(UProceduralGenerator* Generator)
+{
+	if (Generator)
+	{
+		Generators.AddUnique(Generator);
+	}
+}
+
+void UMRMemoryBudgetSubsystem::UnregisterGenerator(UProceduralGenerator* Generator)
+{
+	Generators.RemoveAll([Generator](const TWeakObjectPtr<UProceduralGenerator>& Registered) {
+		return !Registered.IsValid() || Registered.Get() == Generator;
+	});
+}
+
+bool UMRMemoryBudgetSubsystem::IsDeviceLowOnMemory() const
+{
+	if (MinFreePhysicalMemoryMB <= 0)
+	{
+		return false;
+	}
+
+	const FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+	return Stats.AvailablePhysical < static_cast<uint64>(MinFreePhysicalMemoryMB) * 1024 * 1024;
+}
+
+void UMRMemoryBudgetSubsystem::RunShedStage(EMRMemoryShedStage Stage, int32 ExcessKB)
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	UMRBitmapMapper* Mapper = GameInstance ? GameInstance->GetSubsystem<UMRBitmapMapper>() : nullptr;
+	UBitmapPointStorage* Storage = Mapper ? Mapper->GetStorageComponent() : nullptr;
+
+	switch (Stage)
+	{
+		case EMRMemoryShedStage::DropCaches:
+		{
+			// Everything here is derived data that is rebuilt on demand
+			for (const TWeakObjectPtr<UProceduralGenerator>& Generator : Generators)
+			{
+				if (Generator.IsValid())
+				{
+					Generator->ReleaseCachedPoints();
+				}
+			}
+
+			if (Storage)
+			{
+				Storage->ReleasePointCache();
+			}
+
+			if (UMeshGenerationManager* MeshManager = GameInstance ? GameInstance->GetSubsystem<UMeshGenerationManager>() : nullptr)
+			{
+				MeshManager->ReleaseCompletedResults();
+			}
+			break;
+		}
+
+		case EMRMemoryShedStage::DropSnapshots:
+		{
+			// Snapshots only cost a rebuild or a slower recovery when dropped
+			for (const TWeakObjectPtr<UProceduralGenerator>& Generator : Generators)
+			{
+				if (Generator.IsValid())
+				{
+					Generator->ReleasePreLossSnapshot();
+				}
+			}
+
+			if (Mapper && Mapper->GetSpatialIndex())
+			{
+				Mapper->GetSpatialIndex()->ReleaseSnapshot();
+			}
+			break;
+		}
+
+		case EMRMemoryShedStage::Downsample:
+		{
+			// Lose detail but keep coverage
+			if (Mapper && Storage && Mapper->DownsamplePoints(DownsampleVoxelSize) > 0)
+			{
+				Storage->Shrink();
+			}
+			break;
+		}
+
+		case EMRMemoryShedStage::Evict:
+		{
+			// Last resort, evict by the memory manager's policy in proportion to what each point costs across storage, index and fusion
+			if (!Mapper || !Storage || !Mapper->GetMemoryManager() || Storage->GetPointCount() == 0)
+			{
+				break;
+			}
+
+			const FMRMemoryReport Report = GetMemoryReport();
+			const float KBPerPoint = FMath::Max(static_cast<float>(Report.StorageKB + Report.SpatialIndexKB + Report.PointFusionKB) / Storage->GetPointCount(), 0.001f);
+			const int32 EvictCount = FMath::Min(FMath::CeilToInt(ExcessKB / KBPerPoint), Storage->GetPointCount());
+
+			if (Mapper->GetMemoryManager()->EvictPoints(EvictCount) > 0)
+			{
+				Storage->Shrink();
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
@@ -0,0 +1,247 @@
+#include "MRPointCloudImporter.h"
+#include "MRBitmapMapper.h"
+#include "Engine/GameInstance.h"
+
+FMRPointCloudImportTask::FMRPointCloudImportTask(TUniquePtr<FMRPointCloudReader> InReader, const FTransform& InTransform, float InUnitScale, int32 InBlockSize, int32 InMaxQueuedBlocks)
+	: Reader(MoveTemp(InReader))
+	, Transform(InTransform)
+	, UnitScale(InUnitScale)
+	, BlockSize(FMath::Max(InBlockSize, 1))
+	, MaxQueuedBlocks(FMath::Max(InMaxQueuedBlocks, 1))
+	, TotalPoints(Reader->GetTotalPoints())
+	, bStopRequested(false)
+	, bReadingFinished(false)
+{
+}
+
+uint32 FMRPointCloudImportTask::Run()
+{
+	while (!bStopRequested && !Reader->IsAtEnd())
+	{
+		// Back off while the game thread catches up, this is what bounds memory
+		if (QueuedBlocks.GetValue() >= MaxQueuedBlocks)
+		{
+			FPlatformProcess::Sleep(0.005f);
+			continue;
+		}
+
+		TArray<FBitmapPoint> Block;
+		Block.Reserve(BlockSize);
+		if (Reader->ReadBlock(BlockSize, Block) == 0)
+		{
+			break;
+		}
+
+		for (FBitmapPoint& Point : Block)
+		{
+			Point.Position = Transform.TransformPosition(Point.Position * UnitScale);
+			Point.Normal = Transform.TransformVectorNoScale(Point.Normal);
+		}
+
+		Blocks.Enqueue(MoveTemp(Block));
+		QueuedBlocks.Increment();
+	}
+
+	Reader->Close();
+	bReadingFinished = true;
+	return 0;
+}
+
+void FMRPointCloudImportTask::Stop()
+{
+	bStopRequested = true;
+}
+
+bool FMRPointCloudImportTask::DequeueBlock(TArray<FBitmapPoint>& OutBlock)
+{
+	if (!Blocks.Dequeue(OutBlock))
+	{
+		return false;
+	}
+
+	QueuedBlocks.Decrement();
+	return true;
+}
+
+UMRPointCloudImporter::UMRPointCloudImporter()
+	: ImportPointsPerSecond(100000)
+	, ImportBlockSize(16384)
+	, MaxQueuedBlocks(8)
+	, ImportUnitScale(100.0f)
+	, ImportThread(nullptr)
+	, CurrentBlockOffset(0)
+	, FeedBudget(0.0f)
+	, PointsFed(0)
+	, bInitialized(false)
+{
+}
+
+void UMRPointCloudImporter::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Collection.InitializeDependency<UMRBitmapMapper>();
+
+	bInitialized = true;
+
+	UE_LOG(LogTemp, Log, TEXT("PointCloudImporter: Initialized at %d points per second"), ImportPointsPerSecond);
+}
+
+void UMRPointCloudImporter::Deinitialize()
+{
+	ReleaseImport();
+	bInitialized = false;
+
+	Super::Deinitialize();
+}
+
+void UMRPointCloudImporter::Tick(float DeltaTime)
+{
+	FeedPoints(DeltaTime);
+}
+
+bool UMRPointCloudImporter::IsTickable() const
+{
+	// The class default object is never initialized and never ticks
+	return bInitialized && ImportTask.IsValid();
+}
+
+TStatId UMRPointCloudImporter::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMRPointCloudImporter, STATGROUP_Tickables);
+}
+
+bool UMRPointCloudImporter::StartImport(const FString& Filename, const FTransform& Transform)
+{
+	StopImport();
+
+	// Header parsing is cheap and lets us fail synchronously, only the point data is read on the worker
+	TUniquePtr<FMRPointCloudReader> Reader = MakeUnique<FMRPointCloudReader>();
+	if (!Reader->Open(Filename))
+	{
+		return false;
+	}
+
+	ImportTask = MakeUnique<FMRPointCloudImportTask>(MoveTemp(Reader), Transform, ImportUnitScale, ImportBlockSize, MaxQueuedBlocks);
+	ImportThread = FRunnableThread::Create(ImportTask.Get(), TEXT("MRPointCloudImport"), 0, TPri_BelowNormal);
+	if (!ImportThread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("PointCloudImporter: Failed to create import thread"));
+		ImportTask.Reset();
+		return false;
+	}
+
+	ImportFilename = Filename;
+	PointsFed = 0;
+	FeedBudget = 0.0f;
+
+	UE_LOG(LogTemp, Log, TEXT("PointCloudImporter: Importing %lld points from %s"), ImportTask->GetTotalPoints(), *Filename);
+	return true;
+}
+
+void UMRPointCloudImporter::StopImport()
+{
+	if (!ImportTask)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("PointCloudImporter: Stopped %s after %lld points"), *ImportFilename, PointsFed);
+	ReleaseImport();
+}
+
+float UMRPointCloudImporter::GetImportProgress() const
+{
+	if (!ImportTask || ImportTask->GetTotalPoints() == 0)
+	{
+		return 0.0f;
+	}
+	return static_cast<float>(static_cast<double>(PointsFed) / ImportTask->GetTotalPoints());
+}
+
+void UMRPointCloudImporter::SetImportRate(int32 PointsPerSecond)
+{
+	ImportPointsPerSecond = FMath::Max(0, PointsPerSecond);
+}
+
+void UMRPointCloudImporter::FeedPoints(float DeltaTime)
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	UMRBitmapMapper* Mapper = GameInstance ? GameInstance->GetSubsystem<UMRBitmapMapper>() : nullptr;
+	if (!Mapper || !ImportTask)
+	{
+		return;
+	}
+
+	// A hitch must not turn into one huge batch, so unused budget carries over for at most a tenth of a second
+	int32 PointsToFeed = MAX_int32;
+	if (ImportPointsPerSecond > 0)
+	{
+		const float MaxBudget = FMath::Max(ImportPointsPerSecond * 0.1f, 1.0f);
+		FeedBudget = FMath::Min(FeedBudget + ImportPointsPerSecond * DeltaTime, MaxBudget);
+		PointsToFeed = FMath::FloorToInt(FeedBudget);
+	}
+
+	TArray<FBitmapPoint> Batch;
+	while (PointsToFeed > 0)
+	{
+		if (CurrentBlockOffset >= CurrentBlock.Num())
+		{
+			CurrentBlockOffset = 0;
+			CurrentBlock.Reset();
+			if (!ImportTask->DequeueBlock(CurrentBlock))
+			{
+				break;
+			}
+		}
+
+		const int32 Count = FMath::Min(PointsToFeed, CurrentBlock.Num() - CurrentBlockOffset);
+		Batch.Append(CurrentBlock.GetData() + CurrentBlockOffset, Count);
+		CurrentBlockOffset += Count;
+		PointsToFeed -= Count;
+	}
+
+	if (Batch.Num() > 0)
+	{
+		// Stamp with the feed time so aging sees the replay as live data
+		const float Now = FPlatformTime::Seconds();
+		for (FBitmapPoint& Point : Batch)
+		{
+			Point.Timestamp = Now;
+		}
+
+		Mapper->AddBitmapPoints(Batch);
+		PointsFed += Batch.Num();
+		if (ImportPointsPerSecond > 0)
+		{
+			FeedBudget -= Batch.Num();
+		}
+	}
+
+	// Reading finishes only after the last block is queued, so check it before the queue
+	if (ImportTask->IsReadingFinished() && ImportTask->IsQueueEmpty() && CurrentBlockOffset >= CurrentBlock.Num())
+	{
+		const FString Filename = ImportFilename;
+		const int32 TotalFed = static_cast<int32>(FMath::Min<int64>(PointsFed, MAX_int32));
+
+		UE_LOG(LogTemp, Log, TEXT("PointCloudImporter: Finished %s, %lld points fed"), *Filename, PointsFed);
+		ReleaseImport();
+		OnImportComplete.Broadcast(Filename, TotalFed);
+	}
+}
+
+void UMRPointCloudImporter::ReleaseImport()
+{
+	if (ImportThread)
+	{
+		ImportThread->Kill(true);
+		delete ImportThread;
+		ImportThread = nullptr;
+	}
+
+	ImportTask.Reset();
+	ImportFilename.Reset();
+	CurrentBlock.Empty();
+	CurrentBlockOffset = 0;
+	FeedBudget = 0.0f;
+}
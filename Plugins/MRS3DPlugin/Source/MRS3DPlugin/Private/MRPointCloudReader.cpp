@@ -0,0 +1,521 @@
+#include "MRPointCloudReader.h"
+#include "Algo/Reverse.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+	/** PLY headers are a few hundred bytes, anything longer is not a PLY file */
+	constexpr int32 MaxPLYHeaderLength = 64 * 1024;
+
+	/** Size of the LAS 1.4 header, older versions stop earlier */
+	constexpr int32 LASHeaderMaxSize = 375;
+	constexpr int32 LASHeaderMinSize = 227;
+
+	template<typename ValueType>
+	ValueType ReadLittleEndian(const uint8* Data)
+	{
+		ValueType Value;
+		FMemory::Memcpy(&Value, Data, sizeof(ValueType));
+		return Value;
+	}
+
+	/** Offset of the RGB triple in a LAS point record by point data format, -1 without colors */
+	int32 GetLASColorOffset(uint8 PointFormat)
+	{
+		switch (PointFormat)
+		{
+			case 2: return 20;
+			case 3: case 5: return 28;
+			case 7: case 8: case 10: return 30;
+			default: return -1;
+		}
+	}
+
+	/** Smallest record size of each LAS point data format */
+	int32 GetLASMinRecordLength(uint8 PointFormat)
+	{
+		static const int32 Lengths[] = { 20, 28, 26, 34, 57, 63, 30, 36, 38, 59, 67 };
+		return PointFormat < UE_ARRAY_COUNT(Lengths) ? Lengths[PointFormat] : -1;
+	}
+}
+
+FMRPointCloudReader::FMRPointCloudReader()
+	: Format(EMRPointCloudFormat::Unknown)
+	, RecordStride(0)
+	, bBigEndian(false)
+	, PositionScale(FVector::OneVector)
+	, PositionOffset(FVector::ZeroVector)
+	, TotalPoints(0)
+	, PointsRead(0)
+	, ColorRange(0.0)
+	, bDetectColorRange(false)
+{
+}
+
+FMRPointCloudReader::~FMRPointCloudReader()
+{
+	Close();
+}
+
+bool FMRPointCloudReader::Open(const FString& Filename)
+{
+	Close();
+
+	Reader.Reset(IFileManager::Get().CreateFileReader(*Filename));
+	if (!Reader)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: Failed to open %s"), *Filename);
+		return false;
+	}
+
+	uint8 Signature[4] = {};
+	if (Reader->TotalSize() >= 4)
+	{
+		Reader->Serialize(Signature, 4);
+		Reader->Seek(0);
+	}
+
+	bool bParsed = false;
+	if (FMemory::Memcmp(Signature, "ply\n", 4) == 0 || FMemory::Memcmp(Signature, "ply\r", 4) == 0)
+	{
+		Format = EMRPointCloudFormat::PLY;
+		bParsed = ParsePLYHeader();
+	}
+	else if (FMemory::Memcmp(Signature, "LASF", 4) == 0)
+	{
+		Format = EMRPointCloudFormat::LAS;
+		bParsed = ParseLASHeader();
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: %s is neither a PLY nor a LAS file"), *Filename);
+	}
+
+	if (!bParsed || !HasField(EPointField::X) || !HasField(EPointField::Y) || !HasField(EPointField::Z))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: Unsupported point cloud %s"), *Filename);
+		Close();
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("PointCloudReader: Opened %s with %lld points (%d byte records, colors %s, normals %s)"), 
+		*Filename, TotalPoints, RecordStride, HasColors() ? TEXT("yes") : TEXT("no"), HasNormals() ? TEXT("yes") : TEXT("no"));
+	return true;
+}
+
+void FMRPointCloudReader::Close()
+{
+	if (Reader)
+	{
+		Reader->Close();
+		Reader.Reset();
+	}
+
+	Format = EMRPointCloudFormat::Unknown;
+	RecordStride = 0;
+	bBigEndian = false;
+	Fields.Empty();
+	PositionScale = FVector::OneVector;
+	PositionOffset = FVector::ZeroVector;
+	TotalPoints = 0;
+	PointsRead = 0;
+	ColorRange = 0.0;
+	bDetectColorRange = false;
+	BlockBuffer.Empty();
+}
+
+bool FMRPointCloudReader::ParsePLYHeader()
+{
+	// Collect header lines up to end_header, the binary payload starts right after it
+	TArray<FString> Lines;
+	FString Line;
+	bool bHeaderComplete = false;
+	while (!bHeaderComplete && Reader->Tell() < FMath::Min<int64>(Reader->TotalSize(), MaxPLYHeaderLength))
+	{
+		ANSICHAR Char;
+		Reader->Serialize(&Char, 1);
+		if (Char == '\n')
+		{
+			Line.TrimEndInline();
+			bHeaderComplete = Line == TEXT("end_header");
+			Lines.Add(MoveTemp(Line));
+			Line.Reset();
+		}
+		else
+		{
+			Line.AppendChar(static_cast<TCHAR>(Char));
+		}
+	}
+
+	if (!bHeaderComplete)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: PLY header is not terminated"));
+		return false;
+	}
+
+	// Elements ahead of the vertex element have to be skipped, which needs their fixed record size
+	int64 SkipBytes = 0;
+	bool bInVertexElement = false;
+	bool bVertexElementFound = false;
+	int64 CurrentElementCount = 0;
+	int32 CurrentElementStride = 0;
+	bool bCurrentElementHasList = false;
+
+	for (const FString& HeaderLine : Lines)
+	{
+		TArray<FString> Tokens;
+		HeaderLine.ParseIntoArrayWS(Tokens);
+		if (Tokens.Num() == 0)
+		{
+			continue;
+		}
+
+		if (Tokens[0] == TEXT("format") && Tokens.Num() >= 2)
+		{
+			if (Tokens[1] == TEXT("binary_little_endian"))
+			{
+				bBigEndian = false;
+			}
+			else if (Tokens[1] == TEXT("binary_big_endian"))
+			{
+				bBigEndian = true;
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: PLY format %s is not supported, convert to binary first"), *Tokens[1]);
+				return false;
+			}
+		}
+		else if (Tokens[0] == TEXT("element") && Tokens.Num() >= 3)
+		{
+			if (bVertexElementFound)
+			{
+				break;
+			}
+
+			if (CurrentElementCount > 0)
+			{
+				if (bCurrentElementHasList)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: PLY elements with lists ahead of the vertices are not supported"));
+					return false;
+				}
+				SkipBytes += CurrentElementCount * CurrentElementStride;
+			}
+
+			CurrentElementCount = FCString::Atoi64(*Tokens[2]);
+			CurrentElementStride = 0;
+			bCurrentElementHasList = false;
+			bInVertexElement = Tokens[1] == TEXT("vertex");
+			if (bInVertexElement)
+			{
+				TotalPoints = CurrentElementCount;
+			}
+		}
+		else if (Tokens[0] == TEXT("property") && Tokens.Num() >= 3)
+		{
+			if (Tokens[1] == TEXT("list"))
+			{
+				if (bInVertexElement)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: PLY vertex lists are not supported"));
+					return false;
+				}
+				bCurrentElementHasList = true;
+				continue;
+			}
+
+			EScalarType Type;
+			if (!ParsePLYScalarType(Tokens[1], Type))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: Unknown PLY property type %s"), *Tokens[1]);
+				return false;
+			}
+
+			if (bInVertexElement)
+			{
+				static const TMap<FString, EPointField> FieldNames = {
+					{ TEXT("x"), EPointField::X }, { TEXT("y"), EPointField::Y }, { TEXT("z"), EPointField::Z },
+					{ TEXT("red"), EPointField::Red }, { TEXT("green"), EPointField::Green }, { TEXT("blue"), EPointField::Blue },
+					{ TEXT("r"), EPointField::Red }, { TEXT("g"), EPointField::Green }, { TEXT("b"), EPointField::Blue },
+					{ TEXT("diffuse_red"), EPointField::Red }, { TEXT("diffuse_green"), EPointField::Green }, { TEXT("diffuse_blue"), EPointField::Blue },
+					{ TEXT("nx"), EPointField::NormalX }, { TEXT("ny"), EPointField::NormalY }, { TEXT("nz"), EPointField::NormalZ },
+					{ TEXT("intensity"), EPointField::Intensity }, { TEXT("scalar_intensity"), EPointField::Intensity }
+				};
+
+				if (const EPointField* Field = FieldNames.Find(Tokens[2].ToLower()))
+				{
+					Fields.Add({ *Field, Type, CurrentElementStride });
+				}
+			}
+			CurrentElementStride += GetScalarSize(Type);
+
+			if (bInVertexElement)
+			{
+				RecordStride = CurrentElementStride;
+				bVertexElementFound = true;
+			}
+		}
+	}
+
+	if (!bVertexElementFound || RecordStride == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: PLY file has no vertex element"));
+		return false;
+	}
+
+	const int64 DataStart = Reader->Tell() + SkipBytes;
+	if (DataStart + TotalPoints * RecordStride > Reader->TotalSize())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: PLY file is shorter than its header declares"));
+		return false;
+	}
+
+	Reader->Seek(DataStart);
+	return true;
+}
+
+bool FMRPointCloudReader::ParseLASHeader()
+{
+	uint8 Header[LASHeaderMaxSize] = {};
+	const int32 HeaderBytes = static_cast<int32>(FMath::Min<int64>(Reader->TotalSize(), LASHeaderMaxSize));
+	if (HeaderBytes < LASHeaderMinSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: LAS header is truncated"));
+		return false;
+	}
+	Reader->Serialize(Header, HeaderBytes);
+
+	const uint8 VersionMinor = Header[25];
+	const uint16 HeaderSize = ReadLittleEndian<uint16>(Header + 94);
+	const uint32 PointDataOffset = ReadLittleEndian<uint32>(Header + 96);
+	const uint8 PointFormatByte = Header[104];
+	const uint16 RecordLength = ReadLittleEndian<uint16>(Header + 105);
+
+	// LAZ marks compressed point formats in the top two bits
+	if (PointFormatByte & 0xC0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: Compressed LAZ files are not supported, decompress to LAS first"));
+		return false;
+	}
+
+	const uint8 PointFormat = PointFormatByte & 0x3F;
+	const int32 MinRecordLength = GetLASMinRecordLength(PointFormat);
+	if (MinRecordLength < 0 || RecordLength < MinRecordLength)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: LAS point data format %d is not supported"), PointFormat);
+		return false;
+	}
+
+	TotalPoints = ReadLittleEndian<uint32>(Header + 107);
+	if (VersionMinor >= 4 && HeaderSize >= LASHeaderMaxSize && HeaderBytes >= LASHeaderMaxSize)
+	{
+		// LAS 1.4 formats 6 and up leave the legacy count at zero
+		const uint64 ExtendedCount = ReadLittleEndian<uint64>(Header + 247);
+		if (ExtendedCount > 0)
+		{
+			TotalPoints = static_cast<int64>(ExtendedCount);
+		}
+	}
+
+	PositionScale = FVector(ReadLittleEndian<double>(Header + 131), ReadLittleEndian<double>(Header + 139), ReadLittleEndian<double>(Header + 147));
+	PositionOffset = FVector(ReadLittleEndian<double>(Header + 155), ReadLittleEndian<double>(Header + 163), ReadLittleEndian<double>(Header + 171));
+
+	RecordStride = RecordLength;
+	bBigEndian = false;
+
+	Fields.Add({ EPointField::X, EScalarType::Int32, 0 });
+	Fields.Add({ EPointField::Y, EScalarType::Int32, 4 });
+	Fields.Add({ EPointField::Z, EScalarType::Int32, 8 });
+	Fields.Add({ EPointField::Intensity, EScalarType::UInt16, 12 });
+
+	const int32 ColorOffset = GetLASColorOffset(PointFormat);
+	if (ColorOffset >= 0)
+	{
+		Fields.Add({ EPointField::Red, EScalarType::UInt16, ColorOffset });
+		Fields.Add({ EPointField::Green, EScalarType::UInt16, ColorOffset + 2 });
+		Fields.Add({ EPointField::Blue, EScalarType::UInt16, ColorOffset + 4 });
+		bDetectColorRange = true;
+	}
+
+	if (PointDataOffset + TotalPoints * RecordStride > Reader->TotalSize())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: LAS file is shorter than its header declares"));
+		return false;
+	}
+
+	Reader->Seek(PointDataOffset);
+	return true;
+}
+
+int32 FMRPointCloudReader::ReadBlock(int32 MaxPoints, TArray<FBitmapPoint>& OutPoints)
+{
+	if (!Reader || IsAtEnd() || MaxPoints <= 0)
+	{
+		return 0;
+	}
+
+	const int32 Count = static_cast<int32>(FMath::Min<int64>(MaxPoints, TotalPoints - PointsRead));
+	BlockBuffer.SetNumUninitialized(Count * RecordStride, false);
+	Reader->Serialize(BlockBuffer.GetData(), BlockBuffer.Num());
+	if (Reader->IsError())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PointCloudReader: Read error after %lld points, stopping"), PointsRead);
+		TotalPoints = PointsRead;
+		return 0;
+	}
+
+	if (bDetectColorRange)
+	{
+		DetectColorRange(Count);
+	}
+
+	const int32 FirstNewPoint = OutPoints.Num();
+	OutPoints.AddDefaulted(Count);
+
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		const uint8* Record = BlockBuffer.GetData() + static_cast<int64>(Index) * RecordStride;
+		FBitmapPoint& Point = OutPoints[FirstNewPoint + Index];
+		FVector Normal = FVector::ZeroVector;
+
+		for (const FFieldLayout& Layout : Fields)
+		{
+			const double Value = ReadScalar(Record + Layout.Offset, Layout.Type);
+			switch (Layout.Field)
+			{
+				case EPointField::X: Point.Position.X = Value * PositionScale.X + PositionOffset.X; break;
+				case EPointField::Y: Point.Position.Y = Value * PositionScale.Y + PositionOffset.Y; break;
+				case EPointField::Z: Point.Position.Z = Value * PositionScale.Z + PositionOffset.Z; break;
+				case EPointField::Red: Point.Color.R = static_cast<uint8>(FMath::Clamp(Value / GetColorRange(Layout.Type), 0.0, 1.0) * 255.0 + 0.5); break;
+				case EPointField::Green: Point.Color.G = static_cast<uint8>(FMath::Clamp(Value / GetColorRange(Layout.Type), 0.0, 1.0) * 255.0 + 0.5); break;
+				case EPointField::Blue: Point.Color.B = static_cast<uint8>(FMath::Clamp(Value / GetColorRange(Layout.Type), 0.0, 1.0) * 255.0 + 0.5); break;
+				case EPointField::NormalX: Normal.X = Value; break;
+				case EPointField::NormalY: Normal.Y = Value; break;
+				case EPointField::NormalZ: Normal.Z = Value; break;
+				case EPointField::Intensity: Point.Intensity = static_cast<float>(Value / GetNormalizationRange(Layout.Type)); break;
+			}
+		}
+
+		if (!Normal.IsNearlyZero())
+		{
+			Point.Normal = Normal.GetSafeNormal();
+		}
+	}
+
+	PointsRead += Count;
+	return Count;
+}
+
+void FMRPointCloudReader::DetectColorRange(int32 Count)
+{
+	double MaxComponent = 0.0;
+	for (const FFieldLayout& Layout : Fields)
+	{
+		if (Layout.Field != EPointField::Red && Layout.Field != EPointField::Green && Layout.Field != EPointField::Blue)
+		{
+			continue;
+		}
+
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			MaxComponent = FMath::Max(MaxComponent, ReadScalar(BlockBuffer.GetData() + static_cast<int64>(Index) * RecordStride + Layout.Offset, Layout.Type));
+		}
+	}
+
+	// Black decodes the same at either range, so an all black block leaves the choice to the next one
+	if (MaxComponent <= 0.0)
+	{
+		return;
+	}
+
+	ColorRange = MaxComponent <= MAX_uint8 ? MAX_uint8 : MAX_uint16;
+	bDetectColorRange = false;
+	UE_LOG(LogTemp, Log, TEXT("PointCloudReader: LAS colors hold %d-bit values"), ColorRange == MAX_uint8 ? 8 : 16);
+}
+
+bool FMRPointCloudReader::HasColors() const
+{
+	return HasField(EPointField::Red);
+}
+
+bool FMRPointCloudReader::HasNormals() const
+{
+	return HasField(EPointField::NormalX);
+}
+
+bool FMRPointCloudReader::HasField(EPointField Field) const
+{
+	return Fields.ContainsByPredicate([Field](const FFieldLayout& Layout) { return Layout.Field == Field; });
+}
+
+double FMRPointCloudReader::ReadScalar(const uint8* Data, EScalarType Type) const
+{
+	uint8 Bytes[8];
+	const int32 Size = GetScalarSize(Type);
+	FMemory::Memcpy(Bytes, Data, Size);
+	if (bBigEndian)
+	{
+		Algo::Reverse(Bytes, Size);
+	}
+
+	switch (Type)
+	{
+		case EScalarType::Int8: return ReadLittleEndian<int8>(Bytes);
+		case EScalarType::UInt8: return ReadLittleEndian<uint8>(Bytes);
+		case EScalarType::Int16: return ReadLittleEndian<int16>(Bytes);
+		case EScalarType::UInt16: return ReadLittleEndian<uint16>(Bytes);
+		case EScalarType::Int32: return ReadLittleEndian<int32>(Bytes);
+		case EScalarType::UInt32: return ReadLittleEndian<uint32>(Bytes);
+		case EScalarType::Float32: return ReadLittleEndian<float>(Bytes);
+		case EScalarType::Float64: return ReadLittleEndian<double>(Bytes);
+	}
+	return 0.0;
+}
+
+double FMRPointCloudReader::GetNormalizationRange(EScalarType Type)
+{
+	switch (Type)
+	{
+		case EScalarType::UInt8: return MAX_uint8;
+		case EScalarType::UInt16: return MAX_uint16;
+		case EScalarType::UInt32: return MAX_uint32;
+		case EScalarType::Int8: return MAX_int8;
+		case EScalarType::Int16: return MAX_int16;
+		case EScalarType::Int32: return MAX_int32;
+		default: return 1.0;
+	}
+}
+
+int32 FMRPointCloudReader::GetScalarSize(EScalarType Type)
+{
+	switch (Type)
+	{
+		case EScalarType::Int8: case EScalarType::UInt8: return 1;
+		case EScalarType::Int16: case EScalarType::UInt16: return 2;
+		case EScalarType::Int32: case EScalarType::UInt32: case EScalarType::Float32: return 4;
+		case EScalarType::Float64: return 8;
+	}
+	return 0;
+}
+
+bool FMRPointCloudReader::ParsePLYScalarType(const FString& Name, EScalarType& OutType)
+{
+	static const TMap<FString, EScalarType> TypeNames = {
+		{ TEXT("char"), EScalarType::Int8 }, { TEXT("int8"), EScalarType::Int8 },
+		{ TEXT("uchar"), EScalarType::UInt8 }, { TEXT("uint8"), EScalarType::UInt8 },
+		{ TEXT("short"), EScalarType::Int16 }, { TEXT("int16"), EScalarType::Int16 },
+		{ TEXT("ushort"), EScalarType::UInt16 }, { TEXT("uint16"), EScalarType::UInt16 },
+		{ TEXT("int"), EScalarType::Int32 }, { TEXT("int32"), EScalarType::Int32 },
+		{ TEXT("uint"), EScalarType::UInt32 }, { TEXT("uint32"), EScalarType::UInt32 },
+		{ TEXT("float"), EScalarType::Float32 }, { TEXT("float32"), EScalarType::Float32 },
+		{ TEXT("double"), EScalarType::Float64 }, { TEXT("float64"), EScalarType::Float64 }
+	};
+
+	if (const EScalarType* Type = TypeNames.Find(Name))
+	{
+		OutType = *Type;
+		return true;
+	}
+	return false;
+}
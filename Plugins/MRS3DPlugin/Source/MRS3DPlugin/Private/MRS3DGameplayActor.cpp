@@ -1,4 +1,5 @@
 #include "MRS3DGameplayActor.h"
+#include "MRPointCloudImporter.h"
 #include "Engine/World.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
@@ -11,6 +12,7 @@ AMRS3DGameplayActor::AMRS3DGameplayActor()
 	, bARDataReceptionEnabled(true)
 	, CurrentAsyncJobID(-1)
 	, bAsyncGenerationInProgress(false)
+	, TimeSinceGeneration(0.0f)
 	, bAutoPlaneDetectionEnabled(false)
 	, bVisualizeDetectedPlanes(true)
 	, PlaneVisualizationDuration(5.0f)
@@ -46,7 +48,6 @@ void AMRS3DGameplayActor::BeginPlay()
 		
 		if (BitmapMapper)
 		{
-			BitmapMapper->OnBitmapPointsUpdated.AddDynamic(this, &AMRS3DGameplayActor::OnBitmapPointsUpdated);
 			BitmapMapper->SetAutoPlaneDetectionEnabled(bAutoPlaneDetectionEnabled);
 		}
 		
@@ -97,6 +98,18 @@ void AMRS3DGameplayActor::Tick(float DeltaTime)
 		}
 	}
 	
+	// The generator polls the mapper itself when it auto-updates, otherwise remesh here at most once per its update interval
+	if (bAutoGenerateOnReceive && ProceduralGenerator && BitmapMapper && !ProceduralGenerator->bAutoUpdate)
+	{
+		TimeSinceGeneration += DeltaTime;
+		if (TimeSinceGeneration >= ProceduralGenerator->UpdateInterval)
+		{
+			// The generator tracks the mapper version itself and remeshes only changed chunks when meshing per chunk
+			TimeSinceGeneration = 0.0f;
+			ProceduralGenerator->UpdateFromMapper(BitmapMapper);
+		}
+	}
+	
 	// Visualize detected planes
 	if (bVisualizeDetectedPlanes)
 	{
@@ -148,17 +161,21 @@ void AMRS3DGameplayActor::SimulateARInput(int32 NumPoints, float Radius)
 	ReceiveARData(Positions, Colors);
 }
 
-void AMRS3DGameplayActor::SetARDataReception(bool bEnabled)
+bool AMRS3DGameplayActor::ReplayPointCloudFile(const FString& Filename)
 {
-	bARDataReceptionEnabled = bEnabled;
+	UGameInstance* GameInstance = GetWorld()->GetGameInstance();
+	UMRPointCloudImporter* Importer = GameInstance ? GameInstance->GetSubsystem<UMRPointCloudImporter>() : nullptr;
+	if (!bARDataReceptionEnabled || !Importer)
+	{
+		return false;
+	}
+
+	return Importer->StartImport(Filename, GetActorTransform());
 }
 
-void AMRS3DGameplayActor::OnBitmapPointsUpdated(const TArray<FBitmapPoint>& Points)
+void AMRS3DGameplayActor::SetARDataReception(bool bEnabled)
 {
-	if (bAutoGenerateOnReceive && ProceduralGenerator)
-	{
-		ProceduralGenerator->UpdateGeometry(Points);
-	}
+	bARDataReceptionEnabled = bEnabled;
 }
 
 void AMRS3DGameplayActor::UpdateTrackingState(ETrackingState NewState, float Quality, const FString& LossReason)
@@ -590,33 +607,38 @@ int32 AMRS3DGameplayActor::GenerateAsyncMesh(bool bForceAsync)
 		return CurrentAsyncJobID;
 	}
 
-	const TArray<FBitmapPoint>& Points = BitmapMapper->GetBitmapPoints();
-	if (Points.Num() == 0)
+	UBitmapPointSpatialIndex* SpatialIndex = BitmapMapper->GetSpatialIndex();
+	if (!SpatialIndex || SpatialIndex->GetPointCount() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("MRS3DGameplayActor: No bitmap points available for async generation"));
 		return -1;
 	}
 
-	// Check if we should use async generation based on size
-	if (!bForceAsync && !bEnableAsyncGeneration)
+	// Either path meshes the mapper's points, so bring back what was paged out of the mesh bounds first
+	ProceduralGenerator->PageInMeshBounds(BitmapMapper);
+
+	// Check if we should use async generation based on size, before publishing a snapshot nothing would read
+	if ((!bForceAsync && !bEnableAsyncGeneration) || !ProceduralGenerator->WillGenerateAsync(SpatialIndex->GetPointCount(), bForceAsync))
 	{
-		UE_LOG(LogTemp, Log, TEXT("MRS3DGameplayActor: Async generation disabled, using sync generation"));
-		ProceduralGenerator->GenerateFromBitmapPoints(Points);
+		UE_LOG(LogTemp, Log, TEXT("MRS3DGameplayActor: Async generation disabled or below threshold, using sync generation"));
+		ProceduralGenerator->GenerateFromBitmapPoints(BitmapMapper->GetBitmapPoints());
 		return -1;
 	}
 
-	CurrentAsyncJobID = ProceduralGenerator->GenerateAsyncFromBitmapPoints(Points, bForceAsync);
+	// The worker reads a snapshot of the index, so nothing is copied here while ingestion continues
+	const FBitmapPointSnapshotRef Snapshot = SpatialIndex->AcquireSnapshot();
+	CurrentAsyncJobID = ProceduralGenerator->GenerateAsyncFromSnapshot(Snapshot, bForceAsync);
 	
 	if (CurrentAsyncJobID != -1)
 	{
 		bAsyncGenerationInProgress = true;
 		UE_LOG(LogTemp, Log, TEXT("MRS3DGameplayActor: Started async mesh generation (Job %d) for %d points"), 
-			CurrentAsyncJobID, Points.Num());
+			CurrentAsyncJobID, Snapshot->GetNumPoints());
 	}
 	else
 	{
 		UE_LOG(LogTemp, Warning, TEXT("MRS3DGameplayActor: Failed to start async generation, falling back to sync"));
-		ProceduralGenerator->GenerateFromBitmapPoints(Points);
+		ProceduralGenerator->GenerateFromBitmapPoints(BitmapMapper->GetBitmapPoints());
 	}
 
 	return CurrentAsyncJobID;
@@ -0,0 +1,786 @@
+#include "MRSessionSnapshotSubsystem.h"
+#include "MRBitmapMapper.h"
+#include "BitmapPointMemoryManager.h"
+#include "MRSnapshotFile.h"
+#include "PlaneDetectionSubsystem.h"
+#include "ProceduralGenerator.h"
+#include "Async/Async.h"
+#include "Engine/GameInstance.h"
+#include "HAL/FileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	using MRSnapshotFile::MakeTag;
+
+	constexpr uint32 PointsKind = MakeTag('P', 'M', 'A', 'N');
+	constexpr uint32 PointChunkKind = MakeTag('P', 'C', 'H', 'K');
+	constexpr uint32 PagedChunkKind = MakeTag('P', 'P', 'A', 'G');
+	constexpr uint32 PlanesKind = MakeTag('P', 'L', 'N', 'S');
+	constexpr uint32 MeshKind = MakeTag('M', 'E', 'S', 'H');
+
+	// Points manifest
+	constexpr uint32 ChunkSizeTag = MakeTag('C', 'S', 'I', 'Z');
+	constexpr uint32 ChunkKeysTag = MakeTag('C', 'K', 'E', 'Y');
+	constexpr uint32 IndexCellSizesTag = MakeTag('I', 'C', 'S', 'Z');
+	constexpr uint32 IndexCellsTag = MakeTag('I', 'C', 'E', 'L');
+	constexpr uint32 IndexCellLevelsTag = MakeTag('I', 'L', 'V', 'L');
+
+	// Point chunk files
+	constexpr uint32 SaveTimeTag = MakeTag('T', 'S', 'A', 'V');
+	constexpr uint32 PositionsTag = MakeTag('P', 'O', 'S', 'N');
+	constexpr uint32 ColorsTag = MakeTag('C', 'O', 'L', 'R');
+	constexpr uint32 IntensitiesTag = MakeTag('I', 'N', 'T', 'S');
+	constexpr uint32 TimestampsTag = MakeTag('T', 'I', 'M', 'E');
+	constexpr uint32 NormalsTag = MakeTag('N', 'R', 'M', 'L');
+
+	// Paged chunk files, the save time plus the page store's own chunk file
+	constexpr uint32 PageFileTag = MakeTag('P', 'F', 'I', 'L');
+
+	// Planes file
+	constexpr uint32 PlaneCountTag = MakeTag('P', 'C', 'N', 'T');
+	constexpr uint32 PlaneDataTag = MakeTag('P', 'D', 'A', 'T');
+
+	// Mesh files
+	constexpr uint32 VerticesTag = MakeTag('V', 'E', 'R', 'T');
+	constexpr uint32 TrianglesTag = MakeTag('T', 'R', 'I', 'S');
+	constexpr uint32 MeshNormalsTag = MakeTag('V', 'N', 'R', 'M');
+	constexpr uint32 UVsTag = MakeTag('V', 'U', 'V', '0');
+	constexpr uint32 VertexColorsTag = MakeTag('V', 'C', 'O', 'L');
+
+	const TCHAR* MeshFilePrefix = TEXT("Mesh_");
+	const TCHAR* PointChunkFilePrefix = TEXT("Chunk_");
+	const TCHAR* PagedChunkFilePrefix = TEXT("Paged_");
+	const TCHAR* SnapshotExtension = TEXT(".mrsnap");
+
+	uint32 ComputeMeshCrc(const FMeshGenerationResult& Mesh)
+	{
+		uint32 Crc = FCrc::MemCrc32(Mesh.Vertices.GetData(), Mesh.Vertices.Num() * sizeof(FVector));
+		Crc = FCrc::MemCrc32(Mesh.Triangles.GetData(), Mesh.Triangles.Num() * sizeof(int32), Crc);
+		return FCrc::MemCrc32(Mesh.VertexColors.GetData(), Mesh.VertexColors.Num() * sizeof(FColor), Crc);
+	}
+
+	/**
+	 * Read one point chunk file and append its rows
+	 * Timestamps are shifted so points keep the age they had when the chunk was saved, measured against this session's clock
+	 */
+	bool ReadPointChunk(const FString& Filename, FBitmapPointColumns& InOutColumns)
+	{
+		FMRSnapshotReader Reader;
+		FBitmapPointColumns Columns;
+		TArray<double> SaveTime;
+		const bool bColumnsRead = Reader.Open(Filename, PointChunkKind)
+			&& Reader.ReadArray(SaveTimeTag, SaveTime) && SaveTime.Num() == 1
+			&& Reader.ReadArray(PositionsTag, Columns.Positions)
+			&& Reader.ReadArray(ColorsTag, Columns.Colors)
+			&& Reader.ReadArray(IntensitiesTag, Columns.Intensities)
+			&& Reader.ReadArray(TimestampsTag, Columns.Timestamps)
+			&& Reader.ReadArray(NormalsTag, Columns.Normals);
+
+		const int32 PointCount = Columns.Positions.Num();
+		if (!bColumnsRead || Columns.Colors.Num() != PointCount || Columns.Intensities.Num() != PointCount
+			|| Columns.Timestamps.Num() != PointCount || Columns.Normals.Num() != PointCount)
+		{
+			return false;
+		}
+
+		const float TimeShift = static_cast<float>(FPlatformTime::Seconds() - SaveTime[0]);
+		for (float& Timestamp : Columns.Timestamps)
+		{
+			Timestamp += TimeShift;
+		}
+
+		InOutColumns.Positions.Append(Columns.Positions);
+		InOutColumns.Colors.Append(Columns.Colors);
+		InOutColumns.Intensities.Append(Columns.Intensities);
+		InOutColumns.Timestamps.Append(Columns.Timestamps);
+		InOutColumns.Normals.Append(Columns.Normals);
+		return true;
+	}
+
+	/**
+	 * Read one paged chunk file and append its rows, with timestamps shifted like ReadPointChunk
+	 */
+	bool ReadPagedChunk(const FString& Filename, FBitmapPointColumns& InOutColumns)
+	{
+		FMRSnapshotReader Reader;
+		TArray<double> SaveTime;
+		TArray<FBitmapPoint> Points;
+		if (!Reader.Open(Filename, PagedChunkKind) || !Reader.ReadArray(SaveTimeTag, SaveTime) || SaveTime.Num() != 1
+			|| !FBitmapPointPageStore::DecodeChunkFile(Reader.GetSection(PageFileTag), Points))
+		{
+			return false;
+		}
+
+		const float TimeShift = static_cast<float>(FPlatformTime::Seconds() - SaveTime[0]);
+		for (FBitmapPoint& Point : Points)
+		{
+			Point.Timestamp += TimeShift;
+			InOutColumns.Add(Point, INDEX_NONE);
+		}
+		return true;
+	}
+
+	/** Everything a save writes, captured on the game thread and turned into files by a worker */
+	struct FSessionSave
+	{
+		double SaveTime = 0.0;
+
+		/** Snapshot the changed point chunks are exported from, unset if no point chunk changed */
+		TSharedPtr<const FBitmapPointSnapshot, ESPMode::ThreadSafe> PointSnapshot;
+		float ChunkSize = 0.0f;
+		TArray<TPair<FString, FIntVector>> PointChunks;
+
+		/** Raw page store files of the paged-out chunks written since the last save */
+		TArray<TPair<FString, TArray<uint8>>> PagedChunks;
+
+		/** Every paged chunk file the session keeps, the other files in PagedDirectory are stale */
+		FString PagedDirectory;
+		TSet<FString> PagedChunkFiles;
+
+		TArray<TPair<FString, FMeshGenerationResult>> Meshes;
+
+		/** Files built on the game thread, written last since the manifest names the chunks, or deleted if null */
+		TArray<TPair<FString, TSharedPtr<FMRSnapshotWriter>>> Files;
+
+		bool IsEmpty() const
+		{
+			return PointChunks.Num() == 0 && PagedChunks.Num() == 0 && Meshes.Num() == 0 && Files.Num() == 0;
+		}
+	};
+
+	/** Write a save, point chunks first and the files naming them last */
+	bool WriteSessionSave(const FSessionSave& Save)
+	{
+		bool bSuccess = true;
+
+		// Chunk columns are exported from the snapshot here, so the game thread only paid for publishing it
+		if (Save.PointSnapshot.IsValid())
+		{
+			const FBitmapPointChunkGrid KeyGrid(Save.ChunkSize);
+			for (const TPair<FString, FIntVector>& PointChunk : Save.PointChunks)
+			{
+				// The box is inclusive, a point on a shared face belongs only to the chunk the grid assigns it to
+				FBitmapPointColumns Columns;
+				const FBox ChunkBounds = KeyGrid.GetChunkBounds(PointChunk.Value);
+				Save.PointSnapshot->ForEachPointInBox(ChunkBounds.Min, ChunkBounds.Max, [&KeyGrid, &PointChunk, &Columns](const FBitmapPoint& Point) {
+					if (KeyGrid.GetChunkKey(Point.Position) == PointChunk.Value)
+					{
+						Columns.Add(Point, INDEX_NONE);
+					}
+					return true;
+				});
+
+				if (Columns.Num() == 0)
+				{
+					IFileManager::Get().Delete(*PointChunk.Key, false, false, true);
+					continue;
+				}
+
+				FMRSnapshotWriter Writer(PointChunkKind);
+				Writer.AddSection(SaveTimeTag, &Save.SaveTime, sizeof(Save.SaveTime));
+				Writer.AddArray(PositionsTag, Columns.Positions);
+				Writer.AddArray(ColorsTag, Columns.Colors);
+				Writer.AddArray(IntensitiesTag, Columns.Intensities);
+				Writer.AddArray(TimestampsTag, Columns.Timestamps);
+				Writer.AddArray(NormalsTag, Columns.Normals);
+				bSuccess &= Writer.SaveToFile(PointChunk.Key);
+			}
+		}
+
+		for (const TPair<FString, TArray<uint8>>& PagedChunk : Save.PagedChunks)
+		{
+			FMRSnapshotWriter Writer(PagedChunkKind);
+			Writer.AddSection(SaveTimeTag, &Save.SaveTime, sizeof(Save.SaveTime));
+			Writer.AddArray(PageFileTag, PagedChunk.Value);
+			bSuccess &= Writer.SaveToFile(PagedChunk.Key);
+		}
+
+		// Paged chunks that were paged back in, or belong to an earlier session, are now held by the point chunks
+		TArray<FString> ExistingPagedFiles;
+		IFileManager::Get().FindFiles(ExistingPagedFiles, *FPaths::Combine(Save.PagedDirectory, FString(PagedChunkFilePrefix) + TEXT("*") + SnapshotExtension), true, false);
+		for (const FString& ExistingFile : ExistingPagedFiles)
+		{
+			const FString ExistingFilename = FPaths::Combine(Save.PagedDirectory, ExistingFile);
+			if (!Save.PagedChunkFiles.Contains(ExistingFilename))
+			{
+				IFileManager::Get().Delete(*ExistingFilename, false, false, true);
+			}
+		}
+
+		for (const TPair<FString, FMeshGenerationResult>& Mesh : Save.Meshes)
+		{
+			FMRSnapshotWriter Writer(MeshKind);
+			Writer.AddArray(VerticesTag, Mesh.Value.Vertices);
+			Writer.AddArray(TrianglesTag, Mesh.Value.Triangles);
+			Writer.AddArray(MeshNormalsTag, Mesh.Value.Normals);
+			Writer.AddArray(UVsTag, Mesh.Value.UV0);
+			Writer.AddArray(VertexColorsTag, Mesh.Value.VertexColors);
+			bSuccess &= Writer.SaveToFile(Mesh.Key);
+		}
+
+		for (const TPair<FString, TSharedPtr<FMRSnapshotWriter>>& File : Save.Files)
+		{
+			if (File.Value.IsValid())
+			{
+				bSuccess &= File.Value->SaveToFile(File.Key);
+			}
+			else
+			{
+				IFileManager::Get().Delete(*File.Key, false, false, true);
+			}
+		}
+
+		return bSuccess;
+	}
+
+	TArray<uint8> SerializePlanes(TArray<FDetectedPlane>& Planes)
+	{
+		TArray<uint8> Bytes;
+		FMemoryWriter Writer(Bytes);
+		for (FDetectedPlane& Plane : Planes)
+		{
+			FDetectedPlane::StaticStruct()->SerializeBin(Writer, &Plane);
+		}
+		return Bytes;
+	}
+}
+
+UMRSessionSnapshotSubsystem::UMRSessionSnapshotSubsystem()
+	: bAutoSaveEnabled(false)
+	, AutoSaveInterval(30.0f)
+	, bLoadSnapshotOnStart(false)
+	, SavedChunkCursor(0)
+	, SavedChunkSize(0.0f)
+	, SavedPlanesCrc(0)
+	, TimeSinceAutoSave(0.0f)
+	, bInitialized(false)
+{
+}
+
+void UMRSessionSnapshotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Collection.InitializeDependency<UMRBitmapMapper>();
+	Collection.InitializeDependency<UPlaneDetectionSubsystem>();
+
+	bInitialized = true;
+
+	if (bLoadSnapshotOnStart && HasSnapshot())
+	{
+		LoadSnapshot();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Snapshot: Session snapshots initialized (auto save %s)"), bAutoSaveEnabled ? TEXT("enabled") : TEXT("disabled"));
+}
+
+void UMRSessionSnapshotSubsystem::Deinitialize()
+{
+	// Never let the process tear down the state a background write still reads
+	WaitForPendingSave();
+
+	bInitialized = false;
+	Generators.Empty();
+	PendingMeshes.Empty();
+
+	Super::Deinitialize();
+}
+
+void UMRSessionSnapshotSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceAutoSave += DeltaTime;
+	if (TimeSinceAutoSave >= AutoSaveInterval && !IsSaveInProgress())
+	{
+		TimeSinceAutoSave = 0.0f;
+		SaveSnapshot();
+	}
+}
+
+bool UMRSessionSnapshotSubsystem::IsTickable() const
+{
+	// The class default object is never initialized and never ticks
+	return bInitialized && bAutoSaveEnabled;
+}
+
+TStatId UMRSessionSnapshotSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMRSessionSnapshotSubsystem, STATGROUP_Tickables);
+}
+
+bool UMRSessionSnapshotSubsystem::SaveSnapshot()
+{
+	if (IsSaveInProgress())
+	{
+		return false;
+	}
+
+	// A failed write leaves the files on disk stale, so rewrite everything next time
+	if (PendingSave.IsValid() && !PendingSave.Get())
+	{
+		SavedChunkCursor = 0;
+		SavedPlanesCrc = 0;
+		SavedMeshCrcs.Empty();
+		SavedPagedChunkStamps.Empty();
+	}
+
+	UGameInstance* GameInstance = GetGameInstance();
+	TSharedRef<FSessionSave> Save = MakeShared<FSessionSave>();
+	Save->SaveTime = FPlatformTime::Seconds();
+	Save->PagedDirectory = GetPagedChunkDirectory();
+
+	// Points, only the chunks changed since the last save are captured and rewritten
+	UMRBitmapMapper* Mapper = GameInstance ? GameInstance->GetSubsystem<UMRBitmapMapper>() : nullptr;
+	UBitmapPointSpatialIndex* SpatialIndex = Mapper ? Mapper->GetSpatialIndex() : nullptr;
+	if (SpatialIndex)
+	{
+		FBitmapPointChunkGrid& ChunkGrid = SpatialIndex->GetChunkGrid();
+		if (ChunkGrid.GetChunkSize() != SavedChunkSize)
+		{
+			// Files on disk were cut at another chunk size, none of them can be kept
+			SavedChunkCursor = 0;
+		}
+
+		const bool bRewriteAllChunks = SavedChunkCursor == 0;
+		TArray<FIntVector> ChangedChunks;
+		const int64 ChunkCursor = ChunkGrid.CollectChangedChunks(SavedChunkCursor, ChangedChunks);
+
+		if (ChangedChunks.Num() > 0 || bRewriteAllChunks)
+		{
+			// The worker exports the chunks from a snapshot, publishing one only rebuilds the pages changed since the last
+			TSet<FString> ChunkFiles;
+			for (const FIntVector& ChunkKey : ChangedChunks)
+			{
+				const FString ChunkFilename = GetPointChunkFilename(ChunkKey);
+				if (ChunkGrid.GetChunkPointCount(ChunkKey) == 0)
+				{
+					// A file without a writer is deleted
+					Save->Files.Emplace(ChunkFilename, nullptr);
+					continue;
+				}
+
+				Save->PointChunks.Emplace(ChunkFilename, ChunkKey);
+				ChunkFiles.Add(ChunkFilename);
+			}
+
+			if (Save->PointChunks.Num() > 0)
+			{
+				Save->PointSnapshot = SpatialIndex->AcquireSnapshot();
+				Save->ChunkSize = ChunkGrid.GetChunkSize();
+			}
+
+			if (bRewriteAllChunks)
+			{
+				// Drop chunk files left by an earlier session or chunk size
+				TArray<FString> ExistingFiles;
+				IFileManager::Get().FindFiles(ExistingFiles, *FPaths::Combine(GetPointChunkDirectory(), FString(PointChunkFilePrefix) + TEXT("*") + SnapshotExtension), true, false);
+				for (const FString& ExistingFile : ExistingFiles)
+				{
+					const FString ExistingFilename = FPaths::Combine(GetPointChunkDirectory(), ExistingFile);
+					if (!ChunkFiles.Contains(ExistingFilename))
+					{
+						Save->Files.Emplace(ExistingFilename, nullptr);
+					}
+				}
+			}
+
+			// The manifest lists the occupied chunks and the index layout, it is written after the chunks it names
+			TSharedPtr<FMRSnapshotWriter> Manifest = MakeShared<FMRSnapshotWriter>(PointsKind);
+			const float ChunkSize = ChunkGrid.GetChunkSize();
+			TArray<FIntVector> OccupiedChunks;
+			ChunkGrid.GetOccupiedChunks(OccupiedChunks);
+			Manifest->AddSection(ChunkSizeTag, &ChunkSize, sizeof(ChunkSize));
+			Manifest->AddArray(ChunkKeysTag, OccupiedChunks);
+
+			float CellSizes[2];
+			TArray<FIntVector> Cells;
+			TArray<int32> CellLevels;
+			SpatialIndex->GetLayout(CellSizes[0], CellSizes[1], Cells, CellLevels);
+			Manifest->AddSection(IndexCellSizesTag, CellSizes, sizeof(CellSizes));
+			Manifest->AddArray(IndexCellsTag, Cells);
+			Manifest->AddArray(IndexCellLevelsTag, CellLevels);
+			Save->Files.Emplace(GetPointsFilename(), Manifest);
+
+			SavedChunkCursor = ChunkCursor;
+			SavedChunkSize = ChunkSize;
+		}
+	}
+
+	// Paged-out points are part of the map, their page files are saved alongside the chunks as they are
+	const UBitmapPointMemoryManager* MemoryManager = Mapper ? Mapper->GetMemoryManager() : nullptr;
+	const FBitmapPointPageStore* PageStore = MemoryManager ? MemoryManager->GetPageStore() : nullptr;
+	TMap<FIntVector, int64> PagedChunkStamps;
+	if (PageStore)
+	{
+		for (const TPair<FIntVector, int64>& PagedChunk : PageStore->GetChunkWriteStamps())
+		{
+			const FString PagedFilename = GetPagedChunkFilename(PagedChunk.Key);
+			const int64* SavedStamp = SavedPagedChunkStamps.Find(PagedChunk.Key);
+			if (!SavedStamp || *SavedStamp != PagedChunk.Value)
+			{
+				// Page files only change on the game thread, so the copy is taken here and everything else is left to the worker
+				TArray<uint8> PageFile;
+				if (!PageStore->CopyChunkFile(PagedChunk.Key, PageFile))
+				{
+					// Keep whatever an earlier save wrote for the chunk and retry next time
+					Save->PagedChunkFiles.Add(PagedFilename);
+					continue;
+				}
+				Save->PagedChunks.Emplace(PagedFilename, MoveTemp(PageFile));
+			}
+
+			Save->PagedChunkFiles.Add(PagedFilename);
+			PagedChunkStamps.Add(PagedChunk.Key, PagedChunk.Value);
+		}
+	}
+	SavedPagedChunkStamps = MoveTemp(PagedChunkStamps);
+
+	// Planes, serialized as tagless binary since the file is versioned as a whole
+	if (UPlaneDetectionSubsystem* PlaneDetection = GameInstance ? GameInstance->GetSubsystem<UPlaneDetectionSubsystem>() : nullptr)
+	{
+		TArray<FDetectedPlane> Planes = PlaneDetection->GetAllPlanes();
+		const TArray<uint8> PlaneBytes = SerializePlanes(Planes);
+		const uint32 PlanesCrc = FCrc::MemCrc32(PlaneBytes.GetData(), PlaneBytes.Num(), Planes.Num());
+		if (PlanesCrc != SavedPlanesCrc)
+		{
+			TSharedPtr<FMRSnapshotWriter> Writer = MakeShared<FMRSnapshotWriter>(PlanesKind);
+			const int32 PlaneCount = Planes.Num();
+			Writer->AddSection(PlaneCountTag, &PlaneCount, sizeof(PlaneCount));
+			Writer->AddArray(PlaneDataTag, PlaneBytes);
+			Save->Files.Emplace(GetPlanesFilename(), Writer);
+			SavedPlanesCrc = PlanesCrc;
+		}
+	}
+
+	// One file per generator so an unchanged mesh is never rewritten
+	for (const TWeakObjectPtr<UProceduralGenerator>& Generator : Generators)
+	{
+		FMeshGenerationResult Mesh;
+		if (!Generator.IsValid() || !Generator->CaptureMeshSnapshot(Mesh))
+		{
+			continue;
+		}
+
+		const FString Key = Generator->GetSnapshotKey();
+		const uint32 MeshCrc = ComputeMeshCrc(Mesh);
+		const uint32* SavedCrc = SavedMeshCrcs.Find(Key);
+		if (SavedCrc && *SavedCrc == MeshCrc)
+		{
+			continue;
+		}
+
+		// The captured mesh moves into the save, its writer copy is made by the worker
+		Save->Meshes.Emplace(GetMeshFilename(Key), MoveTemp(Mesh));
+		SavedMeshCrcs.Add(Key, MeshCrc);
+	}
+
+	// Paged files only go stale when their points return to the index, which changes point chunks and makes the save non-empty
+	if (Save->IsEmpty())
+	{
+		return true;
+	}
+
+	IFileManager::Get().MakeDirectory(*GetPointChunkDirectory(), true);
+	IFileManager::Get().MakeDirectory(*GetPagedChunkDirectory(), true);
+
+	// The save owns everything it writes, the game thread is free as soon as it is captured
+	PendingSave = Async(EAsyncExecution::ThreadPool, [Save]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const bool bSuccess = WriteSessionSave(*Save);
+
+		UE_LOG(LogTemp, Log, TEXT("Snapshot: Wrote %d point chunks, %d paged chunks and %d other files in %.1f ms"),
+			Save->PointChunks.Num(), Save->PagedChunks.Num(), Save->Meshes.Num() + Save->Files.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		return bSuccess;
+	});
+
+	return true;
+}
+
+bool UMRSessionSnapshotSubsystem::LoadSnapshot()
+{
+	WaitForPendingSave();
+
+	const double StartTime = FPlatformTime::Seconds();
+	if (!LoadPoints())
+	{
+		return false;
+	}
+
+	LoadPlanes();
+
+	// Meshes, applied now to generators that are already registered and held for the rest
+	PendingMeshes.Empty();
+	SavedMeshCrcs.Empty();
+
+	TArray<FString> MeshFiles;
+	IFileManager::Get().FindFiles(MeshFiles, *FPaths::Combine(GetSnapshotDirectory(), FString(MeshFilePrefix) + TEXT("*") + SnapshotExtension), true, false);
+	for (const FString& MeshFile : MeshFiles)
+	{
+		FMeshGenerationResult Mesh;
+		if (!LoadMesh(FPaths::Combine(GetSnapshotDirectory(), MeshFile), Mesh))
+		{
+			continue;
+		}
+
+		const FString Key = FPaths::GetBaseFilename(MeshFile).RightChop(FCString::Strlen(MeshFilePrefix));
+		SavedMeshCrcs.Add(Key, ComputeMeshCrc(Mesh));
+		PendingMeshes.Add(Key, MoveTemp(Mesh));
+	}
+
+	for (const TWeakObjectPtr<UProceduralGenerator>& Generator : Generators)
+	{
+		FMeshGenerationResult Mesh;
+		if (Generator.IsValid() && PendingMeshes.RemoveAndCopyValue(Generator->GetSnapshotKey(), Mesh))
+		{
+			Generator->ApplyMeshSnapshot(Mesh);
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Snapshot: Loaded session in %.1f ms, %d meshes waiting for their generator"), 
+		(FPlatformTime::Seconds() - StartTime) * 1000.0, PendingMeshes.Num());
+	return true;
+}
+
+bool UMRSessionSnapshotSubsystem::LoadPoints()
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	UMRBitmapMapper* Mapper = GameInstance ? GameInstance->GetSubsystem<UMRBitmapMapper>() : nullptr;
+	UBitmapPointStorage* Storage = Mapper ? Mapper->GetStorageComponent() : nullptr;
+	if (!Storage)
+	{
+		return false;
+	}
+
+	FMRSnapshotReader Reader;
+	TArray<float> ChunkSize;
+	TArray<FIntVector> ChunkKeys;
+	if (!Reader.Open(GetPointsFilename(), PointsKind) || !Reader.ReadArray(ChunkSizeTag, ChunkSize) || ChunkSize.Num() != 1
+		|| !Reader.ReadArray(ChunkKeysTag, ChunkKeys))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: No compatible point snapshot in %s"), *GetSnapshotDirectory());
+		return false;
+	}
+
+	// Whole columns come straight out of each chunk's mapping, nothing is parsed per point
+	FBitmapPointColumns Columns;
+	int32 SkippedChunks = 0;
+	for (const FIntVector& ChunkKey : ChunkKeys)
+	{
+		if (!ReadPointChunk(GetPointChunkFilename(ChunkKey), Columns))
+		{
+			SkippedChunks++;
+		}
+	}
+
+	if (SkippedChunks > 0 && SkippedChunks == ChunkKeys.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: Point snapshot is corrupt"));
+		return false;
+	}
+
+	if (SkippedChunks > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: Skipped %d missing or corrupt point chunks"), SkippedChunks);
+	}
+
+	// Points that were paged out come back resident, the memory manager pages them out again if they exceed the limit
+	const int32 ChunkPointCount = Columns.Num();
+	TArray<FString> PagedFiles;
+	IFileManager::Get().FindFiles(PagedFiles, *FPaths::Combine(GetPagedChunkDirectory(), FString(PagedChunkFilePrefix) + TEXT("*") + SnapshotExtension), true, false);
+	for (const FString& PagedFile : PagedFiles)
+	{
+		if (!ReadPagedChunk(FPaths::Combine(GetPagedChunkDirectory(), PagedFile), Columns))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Snapshot: Skipping unreadable paged chunk %s"), *PagedFile);
+		}
+	}
+	const bool bRestoredPagedPoints = Columns.Num() > ChunkPointCount;
+
+	Mapper->ClearBitmapPoints();
+	Storage->AppendColumns(Columns);
+
+	if (UBitmapPointSpatialIndex* SpatialIndex = Mapper->GetSpatialIndex())
+	{
+		TArray<float> CellSizes;
+		TArray<FIntVector> Cells;
+		TArray<int32> CellLevels;
+		if (Reader.ReadArray(IndexCellSizesTag, CellSizes) && CellSizes.Num() == 2
+			&& Reader.ReadArray(IndexCellsTag, Cells) && Reader.ReadArray(IndexCellLevelsTag, CellLevels))
+		{
+			SpatialIndex->RebuildWithLayout(CellSizes[0], CellSizes[1], Cells, CellLevels);
+		}
+		else
+		{
+			SpatialIndex->Rebuild();
+		}
+
+		// What is on disk now matches the index, unless chunks were skipped, cut at another size or joined by paged points
+		TArray<FIntVector> RestoredChunks;
+		const int64 ChunkCursor = SpatialIndex->GetChunkGrid().CollectChangedChunks(MAX_int64, RestoredChunks);
+		const bool bChunksMatch = SkippedChunks == 0 && !bRestoredPagedPoints && ChunkSize[0] == SpatialIndex->GetChunkGrid().GetChunkSize();
+		SavedChunkCursor = bChunksMatch ? ChunkCursor : 0;
+		SavedChunkSize = ChunkSize[0];
+	}
+
+	// Paged files on disk are now held by the point chunks, the next save drops them
+	SavedPagedChunkStamps.Empty();
+
+	const int32 PointCount = Columns.Num();
+	UE_LOG(LogTemp, Log, TEXT("Snapshot: Restored %d points, %d of them paged out when saved"), PointCount, PointCount - ChunkPointCount);
+	return true;
+}
+
+bool UMRSessionSnapshotSubsystem::LoadPlanes()
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	UPlaneDetectionSubsystem* PlaneDetection = GameInstance ? GameInstance->GetSubsystem<UPlaneDetectionSubsystem>() : nullptr;
+	if (!PlaneDetection)
+	{
+		return false;
+	}
+
+	FMRSnapshotReader Reader;
+	TArray<int32> PlaneCount;
+	TArray<uint8> PlaneBytes;
+	if (!Reader.Open(GetPlanesFilename(), PlanesKind) || !Reader.ReadArray(PlaneCountTag, PlaneCount) || PlaneCount.Num() != 1
+		|| !Reader.ReadArray(PlaneDataTag, PlaneBytes))
+	{
+		return false;
+	}
+
+	TArray<FDetectedPlane> Planes;
+	Planes.SetNum(PlaneCount[0]);
+	FMemoryReader PlaneReader(PlaneBytes);
+	for (FDetectedPlane& Plane : Planes)
+	{
+		FDetectedPlane::StaticStruct()->SerializeBin(PlaneReader, &Plane);
+	}
+
+	if (PlaneReader.IsError())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: Plane snapshot is corrupt"));
+		return false;
+	}
+
+	PlaneDetection->ClearAllPlanes();
+	for (const FDetectedPlane& Plane : Planes)
+	{
+		PlaneDetection->AddDetectedPlane(Plane);
+	}
+
+	SavedPlanesCrc = FCrc::MemCrc32(PlaneBytes.GetData(), PlaneBytes.Num(), Planes.Num());
+	return true;
+}
+
+bool UMRSessionSnapshotSubsystem::LoadMesh(const FString& Filename, FMeshGenerationResult& OutMesh) const
+{
+	FMRSnapshotReader Reader;
+	if (!Reader.Open(Filename, MeshKind)
+		|| !Reader.ReadArray(VerticesTag, OutMesh.Vertices)
+		|| !Reader.ReadArray(TrianglesTag, OutMesh.Triangles)
+		|| !Reader.ReadArray(MeshNormalsTag, OutMesh.Normals)
+		|| !Reader.ReadArray(UVsTag, OutMesh.UV0)
+		|| !Reader.ReadArray(VertexColorsTag, OutMesh.VertexColors))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: Skipping unreadable mesh snapshot %s"), *Filename);
+		return false;
+	}
+
+	OutMesh.TriangleCount = OutMesh.Triangles.Num() / 3;
+	return true;
+}
+
+bool UMRSessionSnapshotSubsystem::HasSnapshot() const
+{
+	return IFileManager::Get().FileExists(*GetPointsFilename());
+}
+
+void UMRSessionSnapshotSubsystem::DeleteSnapshot()
+{
+	WaitForPendingSave();
+
+	IFileManager::Get().DeleteDirectory(*GetSnapshotDirectory(), false, true);
+	SavedChunkCursor = 0;
+	SavedPlanesCrc = 0;
+	SavedMeshCrcs.Empty();
+	SavedPagedChunkStamps.Empty();
+	PendingMeshes.Empty();
+}
+
+bool UMRSessionSnapshotSubsystem::IsSaveInProgress() const
+{
+	return PendingSave.IsValid() && !PendingSave.IsReady();
+}
+
+void UMRSessionSnapshotSubsystem::RegisterGenerator(UProceduralGenerator* Generator)
+{
+	if (!Generator)
+	{
+		return;
+	}
+
+	Generators.AddUnique(Generator);
+
+	FMeshGenerationResult Mesh;
+	if (PendingMeshes.RemoveAndCopyValue(Generator->GetSnapshotKey(), Mesh))
+	{
+		Generator->ApplyMeshSnapshot(Mesh);
+	}
+}
+
+void UMRSessionSnapshotSubsystem::UnregisterGenerator(UProceduralGenerator* Generator)
+{
+	Generators.Remove(Generator);
+}
+
+FString UMRSessionSnapshotSubsystem::GetSnapshotDirectory() const
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MRS3D"), TEXT("Session"));
+}
+
+FString UMRSessionSnapshotSubsystem::GetPointsFilename() const
+{
+	return FPaths::Combine(GetSnapshotDirectory(), FString(TEXT("Points")) + SnapshotExtension);
+}
+
+FString UMRSessionSnapshotSubsystem::GetPointChunkDirectory() const
+{
+	return FPaths::Combine(GetSnapshotDirectory(), TEXT("Points"));
+}
+
+FString UMRSessionSnapshotSubsystem::GetPointChunkFilename(const FIntVector& ChunkKey) const
+{
+	return FPaths::Combine(GetPointChunkDirectory(), FString::Printf(TEXT("%s%d_%d_%d"), PointChunkFilePrefix, ChunkKey.X, ChunkKey.Y, ChunkKey.Z) + SnapshotExtension);
+}
+
+FString UMRSessionSnapshotSubsystem::GetPagedChunkDirectory() const
+{
+	return FPaths::Combine(GetSnapshotDirectory(), TEXT("Paged"));
+}
+
+FString UMRSessionSnapshotSubsystem::GetPagedChunkFilename(const FIntVector& ChunkKey) const
+{
+	return FPaths::Combine(GetPagedChunkDirectory(), FString::Printf(TEXT("%s%d_%d_%d"), PagedChunkFilePrefix, ChunkKey.X, ChunkKey.Y, ChunkKey.Z) + SnapshotExtension);
+}
+
+FString UMRSessionSnapshotSubsystem::GetPlanesFilename() const
+{
+	return FPaths::Combine(GetSnapshotDirectory(), FString(TEXT("Planes")) + SnapshotExtension);
+}
+
+FString UMRSessionSnapshotSubsystem::GetMeshFilename(const FString& Key) const
+{
+	return FPaths::Combine(GetSnapshotDirectory(), MeshFilePrefix + Key + SnapshotExtension);
+}
+
+void UMRSessionSnapshotSubsystem::WaitForPendingSave()
+{
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+	}
+}
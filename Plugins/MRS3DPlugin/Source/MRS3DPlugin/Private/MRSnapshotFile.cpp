@@ -0,0 +1,166 @@
+#include "MRSnapshotFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	struct FSnapshotFileHeader
+	{
+		uint32 Magic;
+		uint32 FormatVersion;
+		uint32 Kind;
+		uint32 NumSections;
+	};
+
+	struct FSnapshotSectionEntry
+	{
+		uint32 Tag;
+		uint32 Reserved;
+		uint64 Offset;
+		uint64 Size;
+	};
+
+	constexpr uint32 SnapshotMagic = MRSnapshotFile::MakeTag('M', 'R', 'S', 'S');
+
+	/** Payload alignment, enough for any column to be used straight from the mapping */
+	constexpr uint64 SectionAlignment = 16;
+}
+
+FMRSnapshotWriter::FMRSnapshotWriter(uint32 InKind)
+	: Kind(InKind)
+{
+}
+
+void FMRSnapshotWriter::AddSection(uint32 Tag, const void* Data, int64 NumBytes)
+{
+	FSection& Section = Sections.AddDefaulted_GetRef();
+	Section.Tag = Tag;
+	Section.Bytes.SetNumUninitialized(static_cast<int32>(NumBytes));
+	if (NumBytes > 0)
+	{
+		FMemory::Memcpy(Section.Bytes.GetData(), Data, NumBytes);
+	}
+}
+
+bool FMRSnapshotWriter::SaveToFile(const FString& Filename) const
+{
+	FSnapshotFileHeader Header;
+	Header.Magic = SnapshotMagic;
+	Header.FormatVersion = MRSnapshotFile::FormatVersion;
+	Header.Kind = Kind;
+	Header.NumSections = Sections.Num();
+
+	// Lay out the payloads after the table
+	TArray<FSnapshotSectionEntry> Table;
+	uint64 Offset = Align(sizeof(FSnapshotFileHeader) + Sections.Num() * sizeof(FSnapshotSectionEntry), SectionAlignment);
+	for (const FSection& Section : Sections)
+	{
+		FSnapshotSectionEntry& Entry = Table.AddZeroed_GetRef();
+		Entry.Tag = Section.Tag;
+		Entry.Offset = Offset;
+		Entry.Size = Section.Bytes.Num();
+		Offset = Align(Offset + Entry.Size, SectionAlignment);
+	}
+
+	const FString TempFilename = Filename + TEXT(".tmp");
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFilename));
+	if (!Writer)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: Failed to open %s for writing"), *TempFilename);
+		return false;
+	}
+
+	static const uint8 Padding[SectionAlignment] = {};
+	auto PadTo = [&Writer](uint64 Target) {
+		const int64 PadBytes = static_cast<int64>(Target) - Writer->Tell();
+		if (PadBytes > 0)
+		{
+			Writer->Serialize(const_cast<uint8*>(Padding), PadBytes);
+		}
+	};
+
+	Writer->Serialize(&Header, sizeof(Header));
+	Writer->Serialize(Table.GetData(), Table.Num() * sizeof(FSnapshotSectionEntry));
+	for (int32 Index = 0; Index < Sections.Num(); Index++)
+	{
+		PadTo(Table[Index].Offset);
+		Writer->Serialize(const_cast<uint8*>(Sections[Index].Bytes.GetData()), Sections[Index].Bytes.Num());
+	}
+
+	const bool bWriteFailed = Writer->IsError();
+	Writer->Close();
+	Writer.Reset();
+
+	if (bWriteFailed || !IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: Failed to write %s"), *Filename);
+		IFileManager::Get().Delete(*TempFilename, false, false, true);
+		return false;
+	}
+
+	return true;
+}
+
+bool FMRSnapshotReader::Open(const FString& Filename, uint32 ExpectedKind)
+{
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	Sections.Empty();
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (!MappedFile || MappedFile->GetFileSize() < static_cast<int64>(sizeof(FSnapshotFileHeader)))
+	{
+		MappedFile.Reset();
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	if (!MappedRegion)
+	{
+		return false;
+	}
+
+	const uint8* Data = MappedRegion->GetMappedPtr();
+	const int64 FileSize = MappedRegion->GetMappedSize();
+
+	FSnapshotFileHeader Header;
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+	if (Header.Magic != SnapshotMagic || Header.FormatVersion != MRSnapshotFile::FormatVersion || Header.Kind != ExpectedKind)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: %s is not a compatible snapshot"), *Filename);
+		return false;
+	}
+
+	const int64 TableEnd = sizeof(FSnapshotFileHeader) + static_cast<int64>(Header.NumSections) * sizeof(FSnapshotSectionEntry);
+	if (TableEnd > FileSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: %s is truncated"), *Filename);
+		return false;
+	}
+
+	for (uint32 Index = 0; Index < Header.NumSections; Index++)
+	{
+		FSnapshotSectionEntry Entry;
+		FMemory::Memcpy(&Entry, Data + sizeof(FSnapshotFileHeader) + Index * sizeof(FSnapshotSectionEntry), sizeof(Entry));
+		if (Entry.Offset + Entry.Size > static_cast<uint64>(FileSize))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Snapshot: %s is truncated"), *Filename);
+			Sections.Empty();
+			return false;
+		}
+		Sections.Add(Entry.Tag, TPair<int64, int64>(Entry.Offset, Entry.Size));
+	}
+
+	return true;
+}
+
+TConstArrayView<uint8> FMRSnapshotReader::GetSection(uint32 Tag) const
+{
+	const TPair<int64, int64>* Section = Sections.Find(Tag);
+	if (!Section || !MappedRegion)
+	{
+		return TConstArrayView<uint8>();
+	}
+	return TConstArrayView<uint8>(MappedRegion->GetMappedPtr() + Section->Key, static_cast<int32>(Section->Value));
+}
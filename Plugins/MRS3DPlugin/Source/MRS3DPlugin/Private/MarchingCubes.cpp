@@ -1,5 +1,7 @@
 #include "MarchingCubes.h"
+#include "BitmapPointSnapshot.h"
 #include "Engine/Engine.h"
+#include "Async/ParallelFor.h"
 
 // Marching cubes lookup table for edge intersections
 const int32 FMarchingCubesGenerator::EdgeTable[256] = {
@@ -71,11 +73,405 @@ const int32 FMarchingCubesGenerator::TriTable[256][16] = {
 	{1, 11, 10, 1, 4, 11, 1, 0, 4, 7, 11, 4, -1, -1, -1, -1},
 	{4, 7, 8, 9, 0, 11, 9, 11, 10, 11, 0, 3, -1, -1, -1, -1},
 	{4, 7, 11, 4, 11, 9, 9, 11, 10, -1, -1, -1, -1, -1, -1, -1},
-	// ... (continuing with remaining 224 entries - truncated for brevity)
-	// The full table would continue here with all 256 entries
+	{9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 4, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 5, 4, 1, 5, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{8, 5, 4, 8, 3, 5, 3, 1, 5, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 8, 1, 2, 10, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+	{5, 2, 10, 5, 4, 2, 4, 0, 2, -1, -1, -1, -1, -1, -1, -1},
+	{2, 10, 5, 3, 2, 5, 3, 5, 4, 3, 4, 8, -1, -1, -1, -1},
+	{9, 5, 4, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 11, 2, 0, 8, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+	{0, 5, 4, 0, 1, 5, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
+	{2, 1, 5, 2, 5, 8, 2, 8, 11, 4, 8, 5, -1, -1, -1, -1},
+	{10, 3, 11, 10, 1, 3, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1},
+	{4, 9, 5, 0, 8, 1, 8, 10, 1, 8, 11, 10, -1, -1, -1, -1},
+	{5, 4, 0, 5, 0, 11, 5, 11, 10, 11, 0, 3, -1, -1, -1, -1},
+	{5, 4, 8, 5, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1},
+	{9, 7, 8, 5, 7, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 3, 0, 9, 5, 3, 5, 7, 3, -1, -1, -1, -1, -1, -1, -1},
+	{0, 7, 8, 0, 1, 7, 1, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+	{1, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 7, 8, 9, 5, 7, 10, 1, 2, -1, -1, -1, -1, -1, -1, -1},
+	{10, 1, 2, 9, 5, 0, 5, 3, 0, 5, 7, 3, -1, -1, -1, -1},
+	{8, 0, 2, 8, 2, 5, 8, 5, 7, 10, 5, 2, -1, -1, -1, -1},
+	{2, 10, 5, 2, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+	{7, 9, 5, 7, 8, 9, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 7, 9, 7, 2, 9, 2, 0, 2, 7, 11, -1, -1, -1, -1},
+	{2, 3, 11, 0, 1, 8, 1, 7, 8, 1, 5, 7, -1, -1, -1, -1},
+	{11, 2, 1, 11, 1, 7, 7, 1, 5, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 8, 8, 5, 7, 10, 1, 3, 10, 3, 11, -1, -1, -1, -1},
+	{5, 7, 0, 5, 0, 9, 7, 11, 0, 1, 0, 10, 11, 10, 0, -1},
+	{11, 10, 0, 11, 0, 3, 10, 5, 0, 8, 0, 7, 5, 7, 0, -1},
+	{11, 10, 5, 7, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 0, 1, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 8, 3, 1, 9, 8, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+	{1, 6, 5, 2, 6, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 6, 5, 1, 2, 6, 3, 0, 8, -1, -1, -1, -1, -1, -1, -1},
+	{9, 6, 5, 9, 0, 6, 0, 2, 6, -1, -1, -1, -1, -1, -1, -1},
+	{5, 9, 8, 5, 8, 2, 5, 2, 6, 3, 2, 8, -1, -1, -1, -1},
+	{2, 3, 11, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{11, 0, 8, 11, 2, 0, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
+	{0, 1, 9, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+	{5, 10, 6, 1, 9, 2, 9, 11, 2, 9, 8, 11, -1, -1, -1, -1},
+	{6, 3, 11, 6, 5, 3, 5, 1, 3, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 11, 0, 11, 5, 0, 5, 1, 5, 11, 6, -1, -1, -1, -1},
+	{3, 11, 6, 0, 3, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1},
+	{6, 5, 9, 6, 9, 11, 11, 9, 8, -1, -1, -1, -1, -1, -1, -1},
+	{5, 10, 6, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 3, 0, 4, 7, 3, 6, 5, 10, -1, -1, -1, -1, -1, -1, -1},
+	{1, 9, 0, 5, 10, 6, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
+	{10, 6, 5, 1, 9, 7, 1, 7, 3, 7, 9, 4, -1, -1, -1, -1},
+	{6, 1, 2, 6, 5, 1, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 5, 5, 2, 6, 3, 0, 4, 3, 4, 7, -1, -1, -1, -1},
+	{8, 4, 7, 9, 0, 5, 0, 6, 5, 0, 2, 6, -1, -1, -1, -1},
+	{7, 3, 9, 7, 9, 4, 3, 2, 9, 5, 9, 6, 2, 6, 9, -1},
+	{3, 11, 2, 7, 8, 4, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
+	{5, 10, 6, 4, 7, 2, 4, 2, 0, 2, 7, 11, -1, -1, -1, -1},
+	{0, 1, 9, 4, 7, 8, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1},
+	{9, 2, 1, 9, 11, 2, 9, 4, 11, 7, 11, 4, 5, 10, 6, -1},
+	{8, 4, 7, 3, 11, 5, 3, 5, 1, 5, 11, 6, -1, -1, -1, -1},
+	{5, 1, 11, 5, 11, 6, 1, 0, 11, 7, 11, 4, 0, 4, 11, -1},
+	{0, 5, 9, 0, 6, 5, 0, 3, 6, 11, 6, 3, 8, 4, 7, -1},
+	{6, 5, 9, 6, 9, 11, 4, 7, 9, 7, 11, 9, -1, -1, -1, -1},
+	{10, 4, 9, 6, 4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 10, 6, 4, 9, 10, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1},
+	{10, 0, 1, 10, 6, 0, 6, 4, 0, -1, -1, -1, -1, -1, -1, -1},
+	{8, 3, 1, 8, 1, 6, 8, 6, 4, 6, 1, 10, -1, -1, -1, -1},
+	{1, 4, 9, 1, 2, 4, 2, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 8, 1, 2, 9, 2, 4, 9, 2, 6, 4, -1, -1, -1, -1},
+	{0, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{8, 3, 2, 8, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1},
+	{10, 4, 9, 10, 6, 4, 11, 2, 3, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 2, 2, 8, 11, 4, 9, 10, 4, 10, 6, -1, -1, -1, -1},
+	{3, 11, 2, 0, 1, 6, 0, 6, 4, 6, 1, 10, -1, -1, -1, -1},
+	{6, 4, 1, 6, 1, 10, 4, 8, 1, 2, 1, 11, 8, 11, 1, -1},
+	{9, 6, 4, 9, 3, 6, 9, 1, 3, 11, 6, 3, -1, -1, -1, -1},
+	{8, 11, 1, 8, 1, 0, 11, 6, 1, 9, 1, 4, 6, 4, 1, -1},
+	{3, 11, 6, 3, 6, 0, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+	{6, 4, 8, 11, 6, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{7, 10, 6, 7, 8, 10, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1},
+	{0, 7, 3, 0, 10, 7, 0, 9, 10, 6, 7, 10, -1, -1, -1, -1},
+	{10, 6, 7, 1, 10, 7, 1, 7, 8, 1, 8, 0, -1, -1, -1, -1},
+	{10, 6, 7, 10, 7, 1, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 6, 1, 6, 8, 1, 8, 9, 8, 6, 7, -1, -1, -1, -1},
+	{2, 6, 9, 2, 9, 1, 6, 7, 9, 0, 9, 3, 7, 3, 9, -1},
+	{7, 8, 0, 7, 0, 6, 6, 0, 2, -1, -1, -1, -1, -1, -1, -1},
+	{7, 3, 2, 6, 7, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 3, 11, 10, 6, 8, 10, 8, 9, 8, 6, 7, -1, -1, -1, -1},
+	{2, 0, 7, 2, 7, 11, 0, 9, 7, 6, 7, 10, 9, 10, 7, -1},
+	{1, 8, 0, 1, 7, 8, 1, 10, 7, 6, 7, 10, 2, 3, 11, -1},
+	{11, 2, 1, 11, 1, 7, 10, 6, 1, 6, 7, 1, -1, -1, -1, -1},
+	{8, 9, 6, 8, 6, 7, 9, 1, 6, 11, 6, 3, 1, 3, 6, -1},
+	{0, 9, 1, 11, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{7, 8, 0, 7, 0, 6, 3, 11, 0, 11, 6, 0, -1, -1, -1, -1},
+	{7, 11, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 8, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 1, 9, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{8, 1, 9, 8, 3, 1, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
+	{10, 1, 2, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 3, 0, 8, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+	{2, 9, 0, 2, 10, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+	{6, 11, 7, 2, 10, 3, 10, 8, 3, 10, 9, 8, -1, -1, -1, -1},
+	{7, 2, 3, 6, 2, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{7, 0, 8, 7, 6, 0, 6, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+	{2, 7, 6, 2, 3, 7, 0, 1, 9, -1, -1, -1, -1, -1, -1, -1},
+	{1, 6, 2, 1, 8, 6, 1, 9, 8, 8, 7, 6, -1, -1, -1, -1},
+	{10, 7, 6, 10, 1, 7, 1, 3, 7, -1, -1, -1, -1, -1, -1, -1},
+	{10, 7, 6, 1, 7, 10, 1, 8, 7, 1, 0, 8, -1, -1, -1, -1},
+	{0, 3, 7, 0, 7, 10, 0, 10, 9, 6, 10, 7, -1, -1, -1, -1},
+	{7, 6, 10, 7, 10, 8, 8, 10, 9, -1, -1, -1, -1, -1, -1, -1},
+	{6, 8, 4, 11, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 6, 11, 3, 0, 6, 0, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+	{8, 6, 11, 8, 4, 6, 9, 0, 1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 4, 6, 9, 6, 3, 9, 3, 1, 11, 3, 6, -1, -1, -1, -1},
+	{6, 8, 4, 6, 11, 8, 2, 10, 1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 3, 0, 11, 0, 6, 11, 0, 4, 6, -1, -1, -1, -1},
+	{4, 11, 8, 4, 6, 11, 0, 2, 9, 2, 10, 9, -1, -1, -1, -1},
+	{10, 9, 3, 10, 3, 2, 9, 4, 3, 11, 3, 6, 4, 6, 3, -1},
+	{8, 2, 3, 8, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1},
+	{0, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 9, 0, 2, 3, 4, 2, 4, 6, 4, 3, 8, -1, -1, -1, -1},
+	{1, 9, 4, 1, 4, 2, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+	{8, 1, 3, 8, 6, 1, 8, 4, 6, 6, 10, 1, -1, -1, -1, -1},
+	{10, 1, 0, 10, 0, 6, 6, 0, 4, -1, -1, -1, -1, -1, -1, -1},
+	{4, 6, 3, 4, 3, 8, 6, 10, 3, 0, 3, 9, 10, 9, 3, -1},
+	{10, 9, 4, 6, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 9, 5, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 4, 9, 5, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
+	{5, 0, 1, 5, 4, 0, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
+	{11, 7, 6, 8, 3, 4, 3, 5, 4, 3, 1, 5, -1, -1, -1, -1},
+	{9, 5, 4, 10, 1, 2, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
+	{6, 11, 7, 1, 2, 10, 0, 8, 3, 4, 9, 5, -1, -1, -1, -1},
+	{7, 6, 11, 5, 4, 10, 4, 2, 10, 4, 0, 2, -1, -1, -1, -1},
+	{3, 4, 8, 3, 5, 4, 3, 2, 5, 10, 5, 2, 11, 7, 6, -1},
+	{7, 2, 3, 7, 6, 2, 5, 4, 9, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 4, 0, 8, 6, 0, 6, 2, 6, 8, 7, -1, -1, -1, -1},
+	{3, 6, 2, 3, 7, 6, 1, 5, 0, 5, 4, 0, -1, -1, -1, -1},
+	{6, 2, 8, 6, 8, 7, 2, 1, 8, 4, 8, 5, 1, 5, 8, -1},
+	{9, 5, 4, 10, 1, 6, 1, 7, 6, 1, 3, 7, -1, -1, -1, -1},
+	{1, 6, 10, 1, 7, 6, 1, 0, 7, 8, 7, 0, 9, 5, 4, -1},
+	{4, 0, 10, 4, 10, 5, 0, 3, 10, 6, 10, 7, 3, 7, 10, -1},
+	{7, 6, 10, 7, 10, 8, 5, 4, 10, 4, 8, 10, -1, -1, -1, -1},
+	{6, 9, 5, 6, 11, 9, 11, 8, 9, -1, -1, -1, -1, -1, -1, -1},
+	{3, 6, 11, 0, 6, 3, 0, 5, 6, 0, 9, 5, -1, -1, -1, -1},
+	{0, 11, 8, 0, 5, 11, 0, 1, 5, 5, 6, 11, -1, -1, -1, -1},
+	{6, 11, 3, 6, 3, 5, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 9, 5, 11, 9, 11, 8, 11, 5, 6, -1, -1, -1, -1},
+	{0, 11, 3, 0, 6, 11, 0, 9, 6, 5, 6, 9, 1, 2, 10, -1},
+	{11, 8, 5, 11, 5, 6, 8, 0, 5, 10, 5, 2, 0, 2, 5, -1},
+	{6, 11, 3, 6, 3, 5, 2, 10, 3, 10, 5, 3, -1, -1, -1, -1},
+	{5, 8, 9, 5, 2, 8, 5, 6, 2, 3, 8, 2, -1, -1, -1, -1},
+	{9, 5, 6, 9, 6, 0, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1},
+	{1, 5, 8, 1, 8, 0, 5, 6, 8, 3, 8, 2, 6, 2, 8, -1},
+	{1, 5, 6, 2, 1, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 3, 6, 1, 6, 10, 3, 8, 6, 5, 6, 9, 8, 9, 6, -1},
+	{10, 1, 0, 10, 0, 6, 9, 5, 0, 5, 6, 0, -1, -1, -1, -1},
+	{0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{10, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{11, 5, 10, 7, 5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{11, 5, 10, 11, 7, 5, 8, 3, 0, -1, -1, -1, -1, -1, -1, -1},
+	{5, 11, 7, 5, 10, 11, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1},
+	{10, 7, 5, 10, 11, 7, 9, 8, 1, 8, 3, 1, -1, -1, -1, -1},
+	{11, 1, 2, 11, 7, 1, 7, 5, 1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 1, 2, 7, 1, 7, 5, 7, 2, 11, -1, -1, -1, -1},
+	{9, 7, 5, 9, 2, 7, 9, 0, 2, 2, 11, 7, -1, -1, -1, -1},
+	{7, 5, 2, 7, 2, 11, 5, 9, 2, 3, 2, 8, 9, 8, 2, -1},
+	{2, 5, 10, 2, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+	{8, 2, 0, 8, 5, 2, 8, 7, 5, 10, 2, 5, -1, -1, -1, -1},
+	{9, 0, 1, 5, 10, 3, 5, 3, 7, 3, 10, 2, -1, -1, -1, -1},
+	{9, 8, 2, 9, 2, 1, 8, 7, 2, 10, 2, 5, 7, 5, 2, -1},
+	{1, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 7, 0, 7, 1, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+	{9, 0, 3, 9, 3, 5, 5, 3, 7, -1, -1, -1, -1, -1, -1, -1},
+	{9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{5, 8, 4, 5, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1},
+	{5, 0, 4, 5, 11, 0, 5, 10, 11, 11, 3, 0, -1, -1, -1, -1},
+	{0, 1, 9, 8, 4, 10, 8, 10, 11, 10, 4, 5, -1, -1, -1, -1},
+	{10, 11, 4, 10, 4, 5, 11, 3, 4, 9, 4, 1, 3, 1, 4, -1},
+	{2, 5, 1, 2, 8, 5, 2, 11, 8, 4, 5, 8, -1, -1, -1, -1},
+	{0, 4, 11, 0, 11, 3, 4, 5, 11, 2, 11, 1, 5, 1, 11, -1},
+	{0, 2, 5, 0, 5, 9, 2, 11, 5, 4, 5, 8, 11, 8, 5, -1},
+	{9, 4, 5, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 5, 10, 3, 5, 2, 3, 4, 5, 3, 8, 4, -1, -1, -1, -1},
+	{5, 10, 2, 5, 2, 4, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+	{3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, -1},
+	{5, 10, 2, 5, 2, 4, 1, 9, 2, 9, 4, 2, -1, -1, -1, -1},
+	{8, 4, 5, 8, 5, 3, 3, 5, 1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 4, 5, 1, 0, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{8, 4, 5, 8, 5, 3, 9, 0, 5, 0, 3, 5, -1, -1, -1, -1},
+	{9, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 11, 7, 4, 9, 11, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 4, 9, 7, 9, 11, 7, 9, 10, 11, -1, -1, -1, -1},
+	{1, 10, 11, 1, 11, 4, 1, 4, 0, 7, 4, 11, -1, -1, -1, -1},
+	{3, 1, 4, 3, 4, 8, 1, 10, 4, 7, 4, 11, 10, 11, 4, -1},
+	{4, 11, 7, 9, 11, 4, 9, 2, 11, 9, 1, 2, -1, -1, -1, -1},
+	{9, 7, 4, 9, 11, 7, 9, 1, 11, 2, 11, 1, 0, 8, 3, -1},
+	{11, 7, 4, 11, 4, 2, 2, 4, 0, -1, -1, -1, -1, -1, -1, -1},
+	{11, 7, 4, 11, 4, 2, 8, 3, 4, 3, 2, 4, -1, -1, -1, -1},
+	{2, 9, 10, 2, 7, 9, 2, 3, 7, 7, 4, 9, -1, -1, -1, -1},
+	{9, 10, 7, 9, 7, 4, 10, 2, 7, 8, 7, 0, 2, 0, 7, -1},
+	{3, 7, 10, 3, 10, 2, 7, 4, 10, 1, 10, 0, 4, 0, 10, -1},
+	{1, 10, 2, 8, 7, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 9, 1, 4, 1, 7, 7, 1, 3, -1, -1, -1, -1, -1, -1, -1},
+	{4, 9, 1, 4, 1, 7, 0, 8, 1, 8, 7, 1, -1, -1, -1, -1},
+	{4, 0, 3, 7, 4, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 9, 3, 9, 11, 11, 9, 10, -1, -1, -1, -1, -1, -1, -1},
+	{0, 1, 10, 0, 10, 8, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+	{3, 1, 10, 11, 3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 11, 1, 11, 9, 9, 11, 8, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 9, 3, 9, 11, 1, 2, 9, 2, 11, 9, -1, -1, -1, -1},
+	{0, 2, 11, 8, 0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 3, 8, 2, 8, 10, 10, 8, 9, -1, -1, -1, -1, -1, -1, -1},
+	{9, 10, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 3, 8, 2, 8, 10, 0, 1, 8, 1, 10, 8, -1, -1, -1, -1},
+	{1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 3, 8, 9, 1, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
 	{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}
 };
 
+namespace
+{
+	/**
+	 * Range of grid samples within a kernel radius of a position, clamped to the grid
+	 * @return False if the kernel misses the grid
+	 */
+	bool GetKernelSampleRange(const FVector& GridMin, const FVector& VoxelSpacing, const FIntVector& Resolution,
+		const FVector& Position, float Radius, FIntVector& OutMin, FIntVector& OutMax)
+	{
+		const FVector Lower = (Position - FVector(Radius) - GridMin) / VoxelSpacing;
+		const FVector Upper = (Position + FVector(Radius) - GridMin) / VoxelSpacing;
+		
+		OutMin = FIntVector(
+			FMath::Max(FMath::CeilToInt(Lower.X), 0),
+			FMath::Max(FMath::CeilToInt(Lower.Y), 0),
+			FMath::Max(FMath::CeilToInt(Lower.Z), 0));
+		OutMax = FIntVector(
+			FMath::Min(FMath::FloorToInt(Upper.X), Resolution.X - 1),
+			FMath::Min(FMath::FloorToInt(Upper.Y), Resolution.Y - 1),
+			FMath::Min(FMath::FloorToInt(Upper.Z), Resolution.Z - 1));
+		
+		return OutMin.X <= OutMax.X && OutMin.Y <= OutMax.Y && OutMin.Z <= OutMax.Z;
+	}
+	
+	/** Weighted color and normal sums a voxel collects while points are splatted into it */
+	struct FSplatAccumulator
+	{
+		float Weight;
+		FLinearColor Color;
+		FVector Normal;
+	};
+	
+	/** Add one point's quadratic falloff kernel to a voxel */
+	FORCEINLINE void SplatPoint(FVoxel& Voxel, FSplatAccumulator& Accumulator, const FBitmapPoint& Point, float Radius)
+	{
+		const float DistanceSquared = FVector::DistSquared(Voxel.Position, Point.Position);
+		if (DistanceSquared >= Radius * Radius)
+		{
+			return;
+		}
+		
+		float Weight = 1.0f - (FMath::Sqrt(DistanceSquared) / Radius);
+		Weight = Weight * Weight; // Quadratic falloff
+		Voxel.Value += Weight * Point.Intensity;
+		
+		Accumulator.Weight += Weight;
+		Accumulator.Color += Point.Color.ReinterpretAsLinear() * Weight;
+		Accumulator.Normal += Point.Normal * Weight;
+	}
+	
+	/** Cube layers polygonized per parallel task on the dense grid */
+	constexpr int32 SlabDepth = 4;
+	
+	/** Bricks polygonized per parallel task on the sparse grid */
+	constexpr int32 BricksPerBatch = 4;
+	
+	/** Corners joined by each cube edge, in the edge order of the lookup tables */
+	constexpr int32 EdgeCorners[12][2] = {
+		{0, 1}, {1, 2}, {2, 3}, {3, 0},
+		{4, 5}, {5, 6}, {6, 7}, {7, 4},
+		{0, 4}, {1, 5}, {2, 6}, {3, 7}
+	};
+	
+	/** Lower grid sample of each cube edge relative to the cube's minimum corner, and the axis the edge runs along */
+	const FIntVector EdgeOrigins[12] = {
+		FIntVector(0, 0, 0), FIntVector(1, 0, 0), FIntVector(0, 1, 0), FIntVector(0, 0, 0),
+		FIntVector(0, 0, 1), FIntVector(1, 0, 1), FIntVector(0, 1, 1), FIntVector(0, 0, 1),
+		FIntVector(0, 0, 0), FIntVector(1, 0, 0), FIntVector(1, 1, 0), FIntVector(0, 1, 0)
+	};
+	constexpr int32 EdgeAxes[12] = { 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2 };
+	
+	/** Turn a voxel's accumulated sums into its color and normal */
+	FORCEINLINE void ResolveSplat(FVoxel& Voxel, const FSplatAccumulator& Accumulator)
+	{
+		if (Accumulator.Weight > 0.0f)
+		{
+			Voxel.Color = (Accumulator.Color / Accumulator.Weight).ToFColor(false);
+			Voxel.Normal = Accumulator.Normal.GetSafeNormal(SMALL_NUMBER, FVector::UpVector);
+		}
+	}
+}
+
+struct FMarchingCubesGenerator::FMeshPart
+{
+	FMCMesh Mesh;
+	
+	/** Grid edge of each vertex another part may also produce, INDEX_NONE for the rest */
+	TArray<int64> SharedEdgeKeys;
+	
+	/** Vertex already produced on each grid edge this part visited */
+	TMap<int64, int32> EdgeVertices;
+	
+	/** Flat shading gives every triangle its own vertices instead */
+	bool bWeldVertices = true;
+	
+	/** Dense slab parts share the edges lying in their bottom and top sample planes */
+	int32 SharedMinZ = INDEX_NONE;
+	int32 SharedMaxZ = INDEX_NONE;
+	
+	/** Sparse parts share the edges lying in any brick face */
+	bool bShareBrickFaces = false;
+	
+	bool IsSharedEdge(const FIntVector& Sample, int32 Axis) const
+	{
+		if (bShareBrickFaces)
+		{
+			return (Axis != 0 && Sample.X % FMCSparseVoxelGrid::BrickEdge == 0)
+				|| (Axis != 1 && Sample.Y % FMCSparseVoxelGrid::BrickEdge == 0)
+				|| (Axis != 2 && Sample.Z % FMCSparseVoxelGrid::BrickEdge == 0);
+		}
+		return Axis != 2 && (Sample.Z == SharedMinZ || Sample.Z == SharedMaxZ);
+	}
+};
+
+void FMCSparseVoxelGrid::Init(const FMarchingCubesConfig& Config)
+{
+	Resolution = FIntVector(
+		FMath::Max(Config.GridResolution.X, 2),
+		FMath::Max(Config.GridResolution.Y, 2),
+		FMath::Max(Config.GridResolution.Z, 2));
+	GridMin = Config.GridMin;
+	
+	const FVector GridSize = Config.GridMax - Config.GridMin;
+	VoxelSpacing = FVector(
+		GridSize.X / (Resolution.X - 1),
+		GridSize.Y / (Resolution.Y - 1),
+		GridSize.Z / (Resolution.Z - 1)
+	).ComponentMax(FVector(KINDA_SMALL_NUMBER));
+	
+	BrickCoords.Reset();
+	Voxels.Reset();
+	BrickLookup.Reset();
+}
+
+int32 FMCSparseVoxelGrid::FindOrAddBrick(const FIntVector& Brick)
+{
+	if (const int32* Existing = BrickLookup.Find(Brick))
+	{
+		return *Existing;
+	}
+	
+	const int32 BrickIndex = BrickCoords.Add(Brick);
+	BrickLookup.Add(Brick, BrickIndex);
+	
+	// Samples start empty at their grid positions
+	const FIntVector Base = Brick * BrickEdge;
+	Voxels.AddDefaulted(BrickVoxels);
+	FVoxel* BrickData = Voxels.GetData() + BrickIndex * BrickVoxels;
+	for (int32 LocalZ = 0; LocalZ < BrickEdge; LocalZ++)
+	{
+		for (int32 LocalY = 0; LocalY < BrickEdge; LocalY++)
+		{
+			for (int32 LocalX = 0; LocalX < BrickEdge; LocalX++)
+			{
+				BrickData[GetLocalIndex(LocalX, LocalY, LocalZ)].Position = GetSamplePosition(Base.X + LocalX, Base.Y + LocalY, Base.Z + LocalZ);
+			}
+		}
+	}
+	
+	return BrickIndex;
+}
+
+FVoxel FMCSparseVoxelGrid::GetVoxel(int32 X, int32 Y, int32 Z) const
+{
+	const FIntVector Brick(X / BrickEdge, Y / BrickEdge, Z / BrickEdge);
+	if (const int32* BrickIndex = BrickLookup.Find(Brick))
+	{
+		return Voxels[*BrickIndex * BrickVoxels + GetLocalIndex(X - Brick.X * BrickEdge, Y - Brick.Y * BrickEdge, Z - Brick.Z * BrickEdge)];
+	}
+	
+	return FVoxel(0.0f, GetSamplePosition(X, Y, Z));
+}
+
 FMarchingCubesGenerator::FMarchingCubesGenerator()
 {
 }
@@ -84,57 +480,95 @@ FMarchingCubesGenerator::~FMarchingCubesGenerator()
 {
 }
 
-TArray<FMCTriangle> FMarchingCubesGenerator::GenerateFromBitmapPoints(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config)
+FMCMesh FMarchingCubesGenerator::GenerateMeshFromBitmapPoints(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config)
 {
+	if (Config.bSparseVoxelization)
+	{
+		const FMCSparseVoxelGrid SparseGrid = CreateSparseVoxelGrid(Points, Config);
+		return GenerateMeshFromSparseVoxelGrid(SparseGrid, Config);
+	}
+	
 	// Create voxel grid from bitmap points
 	TArray<FVoxel> VoxelGrid = CreateVoxelGrid(Points, Config);
 	
 	// Generate mesh from voxel grid
-	return GenerateFromVoxelGrid(VoxelGrid, Config);
+	return GenerateMeshFromVoxelGrid(VoxelGrid, Config);
 }
 
-TArray<FMCTriangle> FMarchingCubesGenerator::GenerateFromVoxelGrid(const TArray<FVoxel>& VoxelGrid, const FMarchingCubesConfig& Config)
+TArray<FMCTriangle> FMarchingCubesGenerator::GenerateFromBitmapPoints(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config)
 {
-	TArray<FMCTriangle> Triangles;
+	return ExpandToTriangles(GenerateMeshFromBitmapPoints(Points, Config));
+}
+
+FMCMesh FMarchingCubesGenerator::GenerateMeshFromVoxelGrid(const TArray<FVoxel>& VoxelGrid, const FMarchingCubesConfig& Config)
+{
+	FMCMesh Mesh;
 	
-	// Iterate through each cube in the grid
-	for (int32 x = 0; x < Config.GridResolution.X - 1; x++)
+	const FIntVector NumCubes = Config.GridResolution - FIntVector(1, 1, 1);
+	if (NumCubes.X <= 0 || NumCubes.Y <= 0 || NumCubes.Z <= 0)
 	{
-		for (int32 y = 0; y < Config.GridResolution.Y - 1; y++)
+		return Mesh;
+	}
+	
+	// Polygonize Z slabs in parallel, each into its own mesh part
+	const int32 NumSlabs = FMath::DivideAndRoundUp(NumCubes.Z, SlabDepth);
+	TArray<FMeshPart> Parts;
+	Parts.SetNum(NumSlabs);
+	
+	ParallelFor(NumSlabs, [this, &VoxelGrid, &Config, &NumCubes, &Parts](int32 SlabIndex) {
+		const int32 SlabStart = SlabIndex * SlabDepth;
+		const int32 SlabEnd = FMath::Min(SlabStart + SlabDepth, NumCubes.Z);
+		
+		FMeshPart& Part = Parts[SlabIndex];
+		Part.bWeldVertices = Config.bSmoothNormals;
+		Part.SharedMinZ = SlabStart;
+		Part.SharedMaxZ = SlabEnd;
+		
+		for (int32 z = SlabStart; z < SlabEnd; z++)
 		{
-			for (int32 z = 0; z < Config.GridResolution.Z - 1; z++)
+			for (int32 y = 0; y < NumCubes.Y; y++)
 			{
-				// Get the 8 vertices of the current cube
-				FVoxel Cube[8];
-				Cube[0] = GetVoxel(x, y, z, VoxelGrid, Config.GridResolution);
-				Cube[1] = GetVoxel(x + 1, y, z, VoxelGrid, Config.GridResolution);
-				Cube[2] = GetVoxel(x + 1, y + 1, z, VoxelGrid, Config.GridResolution);
-				Cube[3] = GetVoxel(x, y + 1, z, VoxelGrid, Config.GridResolution);
-				Cube[4] = GetVoxel(x, y, z + 1, VoxelGrid, Config.GridResolution);
-				Cube[5] = GetVoxel(x + 1, y, z + 1, VoxelGrid, Config.GridResolution);
-				Cube[6] = GetVoxel(x + 1, y + 1, z + 1, VoxelGrid, Config.GridResolution);
-				Cube[7] = GetVoxel(x, y + 1, z + 1, VoxelGrid, Config.GridResolution);
-				
-				// Process the cube and generate triangles
-				TArray<FMCTriangle> CubeTriangles = ProcessCube(Cube, Config);
-				Triangles.Append(CubeTriangles);
+				for (int32 x = 0; x < NumCubes.X; x++)
+				{
+					// Get the 8 vertices of the current cube
+					FVoxel Cube[8];
+					Cube[0] = GetVoxel(x, y, z, VoxelGrid, Config.GridResolution);
+					Cube[1] = GetVoxel(x + 1, y, z, VoxelGrid, Config.GridResolution);
+					Cube[2] = GetVoxel(x + 1, y + 1, z, VoxelGrid, Config.GridResolution);
+					Cube[3] = GetVoxel(x, y + 1, z, VoxelGrid, Config.GridResolution);
+					Cube[4] = GetVoxel(x, y, z + 1, VoxelGrid, Config.GridResolution);
+					Cube[5] = GetVoxel(x + 1, y, z + 1, VoxelGrid, Config.GridResolution);
+					Cube[6] = GetVoxel(x + 1, y + 1, z + 1, VoxelGrid, Config.GridResolution);
+					Cube[7] = GetVoxel(x, y + 1, z + 1, VoxelGrid, Config.GridResolution);
+					
+					ProcessCube(Cube, FIntVector(x, y, z), Config.GridResolution, Config, Part);
+				}
 			}
 		}
-	}
+		
+		Part.EdgeVertices.Empty();
+	});
+	
+	MergeMeshParts(Parts, Config.bSmoothNormals, Mesh);
 	
-	// Apply normal smoothing if enabled
 	if (Config.bSmoothNormals)
 	{
-		SmoothNormals(Triangles, Config.SmoothingFactor);
+		ComputeWeldedNormals(Mesh);
 	}
 	
-	UE_LOG(LogTemp, Log, TEXT("Marching cubes generated %d triangles from %d voxels"), 
-		Triangles.Num(), VoxelGrid.Num());
+	UE_LOG(LogTemp, Log, TEXT("Marching cubes generated %d triangles, %d vertices from %d voxels in %d slabs"), 
+		Mesh.GetNumTriangles(), Mesh.Vertices.Num(), VoxelGrid.Num(), NumSlabs);
 	
-	return Triangles;
+	return Mesh;
 }
 
-TArray<FVoxel> FMarchingCubesGenerator::CreateVoxelGrid(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config)
+TArray<FMCTriangle> FMarchingCubesGenerator::GenerateFromVoxelGrid(const TArray<FVoxel>& VoxelGrid, const FMarchingCubesConfig& Config)
+{
+	return ExpandToTriangles(GenerateMeshFromVoxelGrid(VoxelGrid, Config));
+}
+
+template<typename PointSourceType>
+TArray<FVoxel> FMarchingCubesGenerator::SplatVoxelGrid(PointSourceType&& ForEachPoint, const FMarchingCubesConfig& Config)
 {
 	TArray<FVoxel> VoxelGrid;
 	VoxelGrid.SetNum(Config.GridResolution.X * Config.GridResolution.Y * Config.GridResolution.Z);
@@ -147,44 +581,255 @@ TArray<FVoxel> FMarchingCubesGenerator::CreateVoxelGrid(const TArray<FBitmapPoin
 		GridSize.Z / (Config.GridResolution.Z - 1)
 	);
 	
-	// Fill voxel grid
-	for (int32 x = 0; x < Config.GridResolution.X; x++)
+	// Place every voxel
+	for (int32 z = 0; z < Config.GridResolution.Z; z++)
 	{
 		for (int32 y = 0; y < Config.GridResolution.Y; y++)
 		{
-			for (int32 z = 0; z < Config.GridResolution.Z; z++)
+			for (int32 x = 0; x < Config.GridResolution.X; x++)
 			{
-				int32 VoxelIndex = GetVoxelIndex(x, y, z, Config.GridResolution);
-				
-				// Calculate voxel position
-				FVector VoxelPosition = Config.GridMin + FVector(
+				const FVector VoxelPosition = Config.GridMin + FVector(
 					x * VoxelSpacing.X,
 					y * VoxelSpacing.Y,
 					z * VoxelSpacing.Z
 				);
-				
-				// Calculate density value from nearby bitmap points
-				float Density = CalculateDensity(VoxelPosition, Points, Config.VoxelSize * 2.0f);
-				
-				// Create voxel
-				VoxelGrid[VoxelIndex] = FVoxel(Density, VoxelPosition);
-				
-				// Calculate normal if density is above threshold
-				if (Density > Config.IsoValue)
+				VoxelGrid[GetVoxelIndex(x, y, z, Config.GridResolution)] = FVoxel(0.0f, VoxelPosition);
+			}
+		}
+	}
+	
+	// Scatter each point into the few voxels its kernel overlaps
+	const float Radius = Config.VoxelSize * 2.0f;
+	TArray<FSplatAccumulator> Accumulators;
+	Accumulators.SetNumZeroed(VoxelGrid.Num());
+	ForEachPoint([&](const FBitmapPoint& Point) {
+		FIntVector SampleMin;
+		FIntVector SampleMax;
+		if (!GetKernelSampleRange(Config.GridMin, VoxelSpacing, Config.GridResolution, Point.Position, Radius, SampleMin, SampleMax))
+		{
+			return;
+		}
+		
+		for (int32 z = SampleMin.Z; z <= SampleMax.Z; z++)
+		{
+			for (int32 y = SampleMin.Y; y <= SampleMax.Y; y++)
+			{
+				for (int32 x = SampleMin.X; x <= SampleMax.X; x++)
 				{
-					VoxelGrid[VoxelIndex].Normal = CalculateNormal(VoxelPosition, VoxelGrid, Config);
+					const int32 VoxelIndex = GetVoxelIndex(x, y, z, Config.GridResolution);
+					SplatPoint(VoxelGrid[VoxelIndex], Accumulators[VoxelIndex], Point, Radius);
 				}
 			}
 		}
+	});
+	
+	for (int32 VoxelIndex = 0; VoxelIndex < VoxelGrid.Num(); VoxelIndex++)
+	{
+		ResolveSplat(VoxelGrid[VoxelIndex], Accumulators[VoxelIndex]);
 	}
 	
 	return VoxelGrid;
 }
 
-TArray<FMCTriangle> FMarchingCubesGenerator::ProcessCube(const FVoxel Cube[8], const FMarchingCubesConfig& Config)
+template<typename PointSourceType>
+FMCSparseVoxelGrid FMarchingCubesGenerator::SplatSparseVoxelGrid(PointSourceType&& ForEachPoint, const FMarchingCubesConfig& Config)
 {
-	TArray<FMCTriangle> Triangles;
+	FMCSparseVoxelGrid VoxelGrid;
+	VoxelGrid.Init(Config);
+	
+	const float Radius = Config.VoxelSize * 2.0f;
+	TArray<FSplatAccumulator> Accumulators;
+	
+	// Scatter each point into the voxels its kernel overlaps, allocating their bricks on the way. Bricks extend
+	// one sample below the kernel so that every cube with a non-empty corner starts inside an allocated brick.
+	ForEachPoint([&](const FBitmapPoint& Point) {
+		FIntVector SampleMin;
+		FIntVector SampleMax;
+		if (!GetKernelSampleRange(VoxelGrid.GridMin, VoxelGrid.VoxelSpacing, VoxelGrid.Resolution, Point.Position, Radius, SampleMin, SampleMax))
+		{
+			return;
+		}
+		
+		const FIntVector BrickMin(
+			FMath::Max(SampleMin.X - 1, 0) / FMCSparseVoxelGrid::BrickEdge,
+			FMath::Max(SampleMin.Y - 1, 0) / FMCSparseVoxelGrid::BrickEdge,
+			FMath::Max(SampleMin.Z - 1, 0) / FMCSparseVoxelGrid::BrickEdge);
+		const FIntVector BrickMax = SampleMax / FMCSparseVoxelGrid::BrickEdge;
+		for (int32 BrickZ = BrickMin.Z; BrickZ <= BrickMax.Z; BrickZ++)
+		{
+			for (int32 BrickY = BrickMin.Y; BrickY <= BrickMax.Y; BrickY++)
+			{
+				for (int32 BrickX = BrickMin.X; BrickX <= BrickMax.X; BrickX++)
+				{
+					const int32 BrickIndex = VoxelGrid.FindOrAddBrick(FIntVector(BrickX, BrickY, BrickZ));
+					if (Accumulators.Num() < VoxelGrid.Voxels.Num())
+					{
+						Accumulators.SetNumZeroed(VoxelGrid.Voxels.Num());
+					}
+					
+					// Only the part of the kernel inside this brick
+					const FIntVector Base = FIntVector(BrickX, BrickY, BrickZ) * FMCSparseVoxelGrid::BrickEdge;
+					const int32 FirstVoxel = BrickIndex * FMCSparseVoxelGrid::BrickVoxels;
+					for (int32 z = FMath::Max(SampleMin.Z, Base.Z); z <= FMath::Min(SampleMax.Z, Base.Z + FMCSparseVoxelGrid::BrickEdge - 1); z++)
+					{
+						for (int32 y = FMath::Max(SampleMin.Y, Base.Y); y <= FMath::Min(SampleMax.Y, Base.Y + FMCSparseVoxelGrid::BrickEdge - 1); y++)
+						{
+							for (int32 x = FMath::Max(SampleMin.X, Base.X); x <= FMath::Min(SampleMax.X, Base.X + FMCSparseVoxelGrid::BrickEdge - 1); x++)
+							{
+								const int32 VoxelIndex = FirstVoxel + FMCSparseVoxelGrid::GetLocalIndex(x - Base.X, y - Base.Y, z - Base.Z);
+								SplatPoint(VoxelGrid.Voxels[VoxelIndex], Accumulators[VoxelIndex], Point, Radius);
+							}
+						}
+					}
+				}
+			}
+		}
+	});
+	
+	for (int32 VoxelIndex = 0; VoxelIndex < VoxelGrid.Voxels.Num(); VoxelIndex++)
+	{
+		ResolveSplat(VoxelGrid.Voxels[VoxelIndex], Accumulators[VoxelIndex]);
+	}
+	
+	return VoxelGrid;
+}
+
+TArray<FVoxel> FMarchingCubesGenerator::CreateVoxelGrid(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config)
+{
+	return SplatVoxelGrid([&Points](auto&& Visit) {
+		for (const FBitmapPoint& Point : Points)
+		{
+			Visit(Point);
+		}
+	}, Config);
+}
+
+FMCSparseVoxelGrid FMarchingCubesGenerator::CreateSparseVoxelGrid(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config)
+{
+	return SplatSparseVoxelGrid([&Points](auto&& Visit) {
+		for (const FBitmapPoint& Point : Points)
+		{
+			Visit(Point);
+		}
+	}, Config);
+}
+
+FMCMesh FMarchingCubesGenerator::GenerateMeshFromSnapshot(const FBitmapPointSnapshot& Snapshot, const FMarchingCubesConfig& Config)
+{
+	// Points are decoded one page at a time as they are splatted, pages out of the kernel's reach of the grid are skipped
+	const FVector Reach(Config.VoxelSize * 2.0f);
+	auto ForEachPoint = [&Snapshot, &Config, &Reach](auto&& Visit) {
+		Snapshot.ForEachPointInBox(Config.GridMin - Reach, Config.GridMax + Reach, [&Visit](const FBitmapPoint& Point) {
+			Visit(Point);
+			return true;
+		});
+	};
 	
+	if (Config.bSparseVoxelization)
+	{
+		const FMCSparseVoxelGrid SparseGrid = SplatSparseVoxelGrid(ForEachPoint, Config);
+		return GenerateMeshFromSparseVoxelGrid(SparseGrid, Config);
+	}
+	
+	TArray<FVoxel> VoxelGrid = SplatVoxelGrid(ForEachPoint, Config);
+	return GenerateMeshFromVoxelGrid(VoxelGrid, Config);
+}
+
+FMCMesh FMarchingCubesGenerator::GenerateMeshFromSparseVoxelGrid(const FMCSparseVoxelGrid& VoxelGrid, const FMarchingCubesConfig& Config)
+{
+	// Polygonize runs of bricks in parallel, each into its own mesh part
+	const int32 NumBatches = FMath::DivideAndRoundUp(VoxelGrid.GetNumBricks(), BricksPerBatch);
+	TArray<FMeshPart> Parts;
+	Parts.SetNum(NumBatches);
+	
+	ParallelFor(NumBatches, [this, &VoxelGrid, &Config, &Parts](int32 BatchIndex) {
+		FMeshPart& Part = Parts[BatchIndex];
+		Part.bWeldVertices = Config.bSmoothNormals;
+		Part.bShareBrickFaces = true;
+		
+		const int32 BatchEnd = FMath::Min((BatchIndex + 1) * BricksPerBatch, VoxelGrid.GetNumBricks());
+		
+		// Each cube belongs to the brick holding its minimum corner
+		for (int32 BrickIndex = BatchIndex * BricksPerBatch; BrickIndex < BatchEnd; BrickIndex++)
+		{
+			const FIntVector Base = VoxelGrid.BrickCoords[BrickIndex] * FMCSparseVoxelGrid::BrickEdge;
+			const FIntVector End(
+				FMath::Min(Base.X + FMCSparseVoxelGrid::BrickEdge, VoxelGrid.Resolution.X - 1),
+				FMath::Min(Base.Y + FMCSparseVoxelGrid::BrickEdge, VoxelGrid.Resolution.Y - 1),
+				FMath::Min(Base.Z + FMCSparseVoxelGrid::BrickEdge, VoxelGrid.Resolution.Z - 1));
+			const FVoxel* BrickVoxels = VoxelGrid.Voxels.GetData() + BrickIndex * FMCSparseVoxelGrid::BrickVoxels;
+			
+			// Corners inside this brick are read directly, the far faces fall through to the lookup
+			auto GetCorner = [&VoxelGrid, &Base, BrickVoxels](int32 X, int32 Y, int32 Z) {
+				const FIntVector Local(X - Base.X, Y - Base.Y, Z - Base.Z);
+				if (Local.X < FMCSparseVoxelGrid::BrickEdge && Local.Y < FMCSparseVoxelGrid::BrickEdge && Local.Z < FMCSparseVoxelGrid::BrickEdge)
+				{
+					return BrickVoxels[FMCSparseVoxelGrid::GetLocalIndex(Local.X, Local.Y, Local.Z)];
+				}
+				return VoxelGrid.GetVoxel(X, Y, Z);
+			};
+			
+			for (int32 z = Base.Z; z < End.Z; z++)
+			{
+				for (int32 y = Base.Y; y < End.Y; y++)
+				{
+					for (int32 x = Base.X; x < End.X; x++)
+					{
+						FVoxel Cube[8];
+						Cube[0] = GetCorner(x, y, z);
+						Cube[1] = GetCorner(x + 1, y, z);
+						Cube[2] = GetCorner(x + 1, y + 1, z);
+						Cube[3] = GetCorner(x, y + 1, z);
+						Cube[4] = GetCorner(x, y, z + 1);
+						Cube[5] = GetCorner(x + 1, y, z + 1);
+						Cube[6] = GetCorner(x + 1, y + 1, z + 1);
+						Cube[7] = GetCorner(x, y + 1, z + 1);
+						
+						ProcessCube(Cube, FIntVector(x, y, z), VoxelGrid.Resolution, Config, Part);
+					}
+				}
+			}
+		}
+		
+		Part.EdgeVertices.Empty();
+	});
+	
+	FMCMesh Mesh;
+	MergeMeshParts(Parts, Config.bSmoothNormals, Mesh);
+	
+	if (Config.bSmoothNormals)
+	{
+		ComputeWeldedNormals(Mesh);
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("Marching cubes generated %d triangles, %d vertices from %d sparse bricks (%d of %d voxels)"), 
+		Mesh.GetNumTriangles(), Mesh.Vertices.Num(), VoxelGrid.GetNumBricks(), VoxelGrid.Voxels.Num(),
+		VoxelGrid.Resolution.X * VoxelGrid.Resolution.Y * VoxelGrid.Resolution.Z);
+	
+	return Mesh;
+}
+
+TArray<FMCTriangle> FMarchingCubesGenerator::ExpandToTriangles(const FMCMesh& Mesh)
+{
+	TArray<FMCTriangle> Triangles;
+	Triangles.SetNum(Mesh.GetNumTriangles());
+	for (int32 TriangleIndex = 0; TriangleIndex < Triangles.Num(); TriangleIndex++)
+	{
+		FMCTriangle& Triangle = Triangles[TriangleIndex];
+		for (int32 j = 0; j < 3; j++)
+		{
+			const int32 VertexIndex = Mesh.Indices[TriangleIndex * 3 + j];
+			Triangle.Vertices[j] = Mesh.Vertices[VertexIndex];
+			Triangle.Normals[j] = Mesh.Normals[VertexIndex];
+			Triangle.Colors[j] = Mesh.Colors[VertexIndex];
+			Triangle.UVs[j] = Mesh.UVs[VertexIndex];
+		}
+	}
+	return Triangles;
+}
+
+void FMarchingCubesGenerator::ProcessCube(const FVoxel Cube[8], const FIntVector& Cell, const FIntVector& GridResolution, const FMarchingCubesConfig& Config, FMeshPart& Part)
+{
 	// Determine the index into the edge table
 	int32 CubeIndex = 0;
 	if (Cube[0].Value < Config.IsoValue) CubeIndex |= 1;
@@ -198,104 +843,169 @@ TArray<FMCTriangle> FMarchingCubesGenerator::ProcessCube(const FVoxel Cube[8], c
 	
 	// Cube is entirely in/out of the surface
 	if (EdgeTable[CubeIndex] == 0)
-		return Triangles;
+		return;
 	
-	// Find the vertices where the surface intersects the cube
-	FVector VertList[12];
-	FColor ColorList[12];
+	FMCMesh& Mesh = Part.Mesh;
 	
-	if (EdgeTable[CubeIndex] & 1)
-	{
-		VertList[0] = InterpolateVertex(Cube[0], Cube[1], Config.IsoValue);
-		ColorList[0] = InterpolateColor(Cube[0], Cube[1], Config.IsoValue);
-	}
-	if (EdgeTable[CubeIndex] & 2)
-	{
-		VertList[1] = InterpolateVertex(Cube[1], Cube[2], Config.IsoValue);
-		ColorList[1] = InterpolateColor(Cube[1], Cube[2], Config.IsoValue);
-	}
-	if (EdgeTable[CubeIndex] & 4)
-	{
-		VertList[2] = InterpolateVertex(Cube[2], Cube[3], Config.IsoValue);
-		ColorList[2] = InterpolateColor(Cube[2], Cube[3], Config.IsoValue);
-	}
-	if (EdgeTable[CubeIndex] & 8)
-	{
-		VertList[3] = InterpolateVertex(Cube[3], Cube[0], Config.IsoValue);
-		ColorList[3] = InterpolateColor(Cube[3], Cube[0], Config.IsoValue);
-	}
-	if (EdgeTable[CubeIndex] & 16)
-	{
-		VertList[4] = InterpolateVertex(Cube[4], Cube[5], Config.IsoValue);
-		ColorList[4] = InterpolateColor(Cube[4], Cube[5], Config.IsoValue);
-	}
-	if (EdgeTable[CubeIndex] & 32)
-	{
-		VertList[5] = InterpolateVertex(Cube[5], Cube[6], Config.IsoValue);
-		ColorList[5] = InterpolateColor(Cube[5], Cube[6], Config.IsoValue);
-	}
-	if (EdgeTable[CubeIndex] & 64)
-	{
-		VertList[6] = InterpolateVertex(Cube[6], Cube[7], Config.IsoValue);
-		ColorList[6] = InterpolateColor(Cube[6], Cube[7], Config.IsoValue);
-	}
-	if (EdgeTable[CubeIndex] & 128)
-	{
-		VertList[7] = InterpolateVertex(Cube[7], Cube[4], Config.IsoValue);
-		ColorList[7] = InterpolateColor(Cube[7], Cube[4], Config.IsoValue);
-	}
-	if (EdgeTable[CubeIndex] & 256)
+	// Add the vertex where the surface crosses a cube edge
+	auto AddEdgeVertex = [this, Cube, &Config, &Mesh](int32 Edge) {
+		const FVoxel& V1 = Cube[EdgeCorners[Edge][0]];
+		const FVoxel& V2 = Cube[EdgeCorners[Edge][1]];
+		const FVector Position = InterpolateVertex(V1, V2, Config.IsoValue);
+		
+		Mesh.Normals.Add(FVector::UpVector);
+		Mesh.Colors.Add(InterpolateColor(V1, V2, Config.IsoValue));
+		
+		// Simple UV mapping
+		Mesh.UVs.Add(FVector2D(
+			(Position.X - Config.GridMin.X) / (Config.GridMax.X - Config.GridMin.X),
+			(Position.Y - Config.GridMin.Y) / (Config.GridMax.Y - Config.GridMin.Y)
+		));
+		return Mesh.Vertices.Add(Position);
+	};
+	
+	if (!Part.bWeldVertices)
 	{
-		VertList[8] = InterpolateVertex(Cube[0], Cube[4], Config.IsoValue);
-		ColorList[8] = InterpolateColor(Cube[0], Cube[4], Config.IsoValue);
+		// Flat shading, three vertices of its own per triangle
+		for (int32 i = 0; TriTable[CubeIndex][i] != -1; i += 3)
+		{
+			const int32 BaseIndex = Mesh.Vertices.Num();
+			for (int32 j = 0; j < 3; j++)
+			{
+				Mesh.Indices.Add(AddEdgeVertex(TriTable[CubeIndex][i + j]));
+			}
+			
+			const FVector Normal = FVector::CrossProduct(
+				Mesh.Vertices[BaseIndex + 1] - Mesh.Vertices[BaseIndex],
+				Mesh.Vertices[BaseIndex + 2] - Mesh.Vertices[BaseIndex]).GetSafeNormal();
+			Mesh.Normals[BaseIndex] = Mesh.Normals[BaseIndex + 1] = Mesh.Normals[BaseIndex + 2] = Normal;
+		}
+		return;
 	}
-	if (EdgeTable[CubeIndex] & 512)
+	
+	// Find or create the vertex on every crossed edge, neighbouring cubes of this part reuse it
+	int32 EdgeVertexIndices[12];
+	for (int32 Edge = 0; Edge < 12; Edge++)
 	{
-		VertList[9] = InterpolateVertex(Cube[1], Cube[5], Config.IsoValue);
-		ColorList[9] = InterpolateColor(Cube[1], Cube[5], Config.IsoValue);
+		if (!(EdgeTable[CubeIndex] & (1 << Edge)))
+		{
+			continue;
+		}
+		
+		const FIntVector Sample = Cell + EdgeOrigins[Edge];
+		const int64 EdgeKey = ((static_cast<int64>(Sample.Z) * GridResolution.Y + Sample.Y) * GridResolution.X + Sample.X) * 3 + EdgeAxes[Edge];
+		if (const int32* Existing = Part.EdgeVertices.Find(EdgeKey))
+		{
+			EdgeVertexIndices[Edge] = *Existing;
+			continue;
+		}
+		
+		EdgeVertexIndices[Edge] = AddEdgeVertex(Edge);
+		Part.EdgeVertices.Add(EdgeKey, EdgeVertexIndices[Edge]);
+		Part.SharedEdgeKeys.Add(Part.IsSharedEdge(Sample, EdgeAxes[Edge]) ? EdgeKey : INDEX_NONE);
 	}
-	if (EdgeTable[CubeIndex] & 1024)
+	
+	// Create the triangles
+	for (int32 i = 0; TriTable[CubeIndex][i] != -1; i++)
 	{
-		VertList[10] = InterpolateVertex(Cube[2], Cube[6], Config.IsoValue);
-		ColorList[10] = InterpolateColor(Cube[2], Cube[6], Config.IsoValue);
+		Mesh.Indices.Add(EdgeVertexIndices[TriTable[CubeIndex][i]]);
 	}
-	if (EdgeTable[CubeIndex] & 2048)
+}
+
+void FMarchingCubesGenerator::MergeMeshParts(TArray<FMeshPart>& Parts, bool bWeldVertices, FMCMesh& OutMesh)
+{
+	// Number the vertices in part order. A vertex on an edge an earlier part already produced maps onto that
+	// part's vertex and is recorded as ~Index, so the copy below skips it.
+	TArray<TArray<int32>> VertexRemaps;
+	VertexRemaps.SetNum(Parts.Num());
+	TArray<int32> IndexOffsets;
+	IndexOffsets.SetNumUninitialized(Parts.Num());
+	TMap<int64, int32> SharedVertices;
+	int32 NumVertices = 0;
+	int32 NumIndices = 0;
+	
+	for (int32 PartIndex = 0; PartIndex < Parts.Num(); PartIndex++)
 	{
-		VertList[11] = InterpolateVertex(Cube[3], Cube[7], Config.IsoValue);
-		ColorList[11] = InterpolateColor(Cube[3], Cube[7], Config.IsoValue);
+		const FMeshPart& Part = Parts[PartIndex];
+		TArray<int32>& Remap = VertexRemaps[PartIndex];
+		Remap.SetNumUninitialized(Part.Mesh.Vertices.Num());
+		
+		for (int32 VertexIndex = 0; VertexIndex < Part.Mesh.Vertices.Num(); VertexIndex++)
+		{
+			const int64 EdgeKey = bWeldVertices ? Part.SharedEdgeKeys[VertexIndex] : INDEX_NONE;
+			if (EdgeKey != INDEX_NONE)
+			{
+				if (const int32* Existing = SharedVertices.Find(EdgeKey))
+				{
+					Remap[VertexIndex] = ~*Existing;
+					continue;
+				}
+				SharedVertices.Add(EdgeKey, NumVertices);
+			}
+			Remap[VertexIndex] = NumVertices++;
+		}
+		
+		IndexOffsets[PartIndex] = NumIndices;
+		NumIndices += Part.Mesh.Indices.Num();
 	}
 	
-	// Create the triangles
-	for (int32 i = 0; TriTable[CubeIndex][i] != -1; i += 3)
-	{
-		FMCTriangle Triangle;
+	OutMesh.Vertices.SetNumUninitialized(NumVertices);
+	OutMesh.Normals.SetNumUninitialized(NumVertices);
+	OutMesh.Colors.SetNumUninitialized(NumVertices);
+	OutMesh.UVs.SetNumUninitialized(NumVertices);
+	OutMesh.Indices.SetNumUninitialized(NumIndices);
+	
+	// Every part owns disjoint output ranges, so the copy runs in parallel
+	ParallelFor(Parts.Num(), [&Parts, &VertexRemaps, &IndexOffsets, &OutMesh](int32 PartIndex) {
+		FMCMesh& PartMesh = Parts[PartIndex].Mesh;
+		const TArray<int32>& Remap = VertexRemaps[PartIndex];
 		
-		for (int32 j = 0; j < 3; j++)
+		for (int32 VertexIndex = 0; VertexIndex < PartMesh.Vertices.Num(); VertexIndex++)
 		{
-			int32 EdgeIndex = TriTable[CubeIndex][i + j];
-			Triangle.Vertices[j] = VertList[EdgeIndex];
-			Triangle.Colors[j] = ColorList[EdgeIndex];
-			
-			// Calculate normals (simplified - could be improved)
-			if (j == 0)
+			const int32 Target = Remap[VertexIndex];
+			if (Target >= 0)
 			{
-				FVector Edge1 = Triangle.Vertices[1] - Triangle.Vertices[0];
-				FVector Edge2 = Triangle.Vertices[2] - Triangle.Vertices[0];
-				FVector Normal = FVector::CrossProduct(Edge1, Edge2).GetSafeNormal();
-				Triangle.Normals[0] = Triangle.Normals[1] = Triangle.Normals[2] = Normal;
+				OutMesh.Vertices[Target] = PartMesh.Vertices[VertexIndex];
+				OutMesh.Normals[Target] = PartMesh.Normals[VertexIndex];
+				OutMesh.Colors[Target] = PartMesh.Colors[VertexIndex];
+				OutMesh.UVs[Target] = PartMesh.UVs[VertexIndex];
 			}
-			
-			// Simple UV mapping
-			Triangle.UVs[j] = FVector2D(
-				(Triangle.Vertices[j].X - Config.GridMin.X) / (Config.GridMax.X - Config.GridMin.X),
-				(Triangle.Vertices[j].Y - Config.GridMin.Y) / (Config.GridMax.Y - Config.GridMin.Y)
-			);
 		}
 		
-		Triangles.Add(Triangle);
+		int32* OutIndices = OutMesh.Indices.GetData() + IndexOffsets[PartIndex];
+		for (int32 Index = 0; Index < PartMesh.Indices.Num(); Index++)
+		{
+			const int32 Target = Remap[PartMesh.Indices[Index]];
+			OutIndices[Index] = Target >= 0 ? Target : ~Target;
+		}
+		
+		PartMesh = FMCMesh();
+	});
+}
+
+void FMarchingCubesGenerator::ComputeWeldedNormals(FMCMesh& Mesh)
+{
+	for (FVector& Normal : Mesh.Normals)
+	{
+		Normal = FVector::ZeroVector;
 	}
 	
-	return Triangles;
+	// Unnormalized face normals weight each face by its area
+	for (int32 Index = 0; Index + 2 < Mesh.Indices.Num(); Index += 3)
+	{
+		const int32 A = Mesh.Indices[Index];
+		const int32 B = Mesh.Indices[Index + 1];
+		const int32 C = Mesh.Indices[Index + 2];
+		const FVector FaceNormal = FVector::CrossProduct(Mesh.Vertices[B] - Mesh.Vertices[A], Mesh.Vertices[C] - Mesh.Vertices[A]);
+		Mesh.Normals[A] += FaceNormal;
+		Mesh.Normals[B] += FaceNormal;
+		Mesh.Normals[C] += FaceNormal;
+	}
+	
+	for (FVector& Normal : Mesh.Normals)
+	{
+		Normal = Normal.GetSafeNormal(SMALL_NUMBER, FVector::UpVector);
+	}
 }
 
 FVector FMarchingCubesGenerator::InterpolateVertex(const FVoxel& V1, const FVoxel& V2, float IsoValue)
@@ -313,6 +1023,11 @@ FVector FMarchingCubesGenerator::InterpolateVertex(const FVoxel& V1, const FVoxe
 
 FColor FMarchingCubesGenerator::InterpolateColor(const FVoxel& V1, const FVoxel& V2, float IsoValue)
 {
+	// Voxels no point reached carry no color of their own
+	if (V1.Value <= 0.0f)
+		return V2.Color;
+	if (V2.Value <= 0.0f)
+		return V1.Color;
 	if (FMath::Abs(V1.Value - V2.Value) < 0.00001f)
 		return V1.Color;
 	
@@ -326,33 +1041,6 @@ FColor FMarchingCubesGenerator::InterpolateColor(const FVoxel& V1, const FVoxel&
 	);
 }
 
-FVector FMarchingCubesGenerator::CalculateNormal(const FVector& Position, const TArray<FVoxel>& VoxelGrid, const FMarchingCubesConfig& Config)
-{
-	// Simplified normal calculation - in practice, you'd want to sample the density field
-	return FVector::UpVector;
-}
-
-float FMarchingCubesGenerator::CalculateDensity(const FVector& Position, const TArray<FBitmapPoint>& Points, float Radius)
-{
-	float Density = 0.0f;
-	float RadiusSquared = Radius * Radius;
-	
-	for (const FBitmapPoint& Point : Points)
-	{
-		float DistanceSquared = FVector::DistSquared(Position, Point.Position);
-		if (DistanceSquared < RadiusSquared)
-		{
-			// Use inverse distance weighting
-			float Distance = FMath::Sqrt(DistanceSquared);
-			float Weight = 1.0f - (Distance / Radius);
-			Weight = Weight * Weight; // Quadratic falloff
-			Density += Weight * Point.Intensity;
-		}
-	}
-	
-	return Density;
-}
-
 int32 FMarchingCubesGenerator::GetVoxelIndex(int32 X, int32 Y, int32 Z, const FIntVector& GridResolution)
 {
 	return Z * GridResolution.X * GridResolution.Y + Y * GridResolution.X + X;
@@ -368,34 +1056,3 @@ FVoxel FMarchingCubesGenerator::GetVoxel(int32 X, int32 Y, int32 Z, const TArray
 	int32 Index = GetVoxelIndex(X, Y, Z, GridResolution);
 	return VoxelGrid[Index];
 }
-
-void FMarchingCubesGenerator::SmoothNormals(TArray<FMCTriangle>& Triangles, float SmoothingFactor)
-{
-	// Simple normal smoothing - average normals of nearby vertices
-	for (int32 i = 0; i < Triangles.Num(); i++)
-	{
-		for (int32 j = 0; j < 3; j++)
-		{
-			FVector SmoothedNormal = Triangles[i].Normals[j];
-			int32 SampleCount = 1;
-			
-			// Find nearby vertices and average their normals
-			for (int32 k = 0; k < Triangles.Num(); k++)
-			{
-				if (k == i) continue;
-				
-				for (int32 l = 0; l < 3; l++)
-				{
-					float Distance = FVector::Dist(Triangles[i].Vertices[j], Triangles[k].Vertices[l]);
-					if (Distance < SmoothingFactor)
-					{
-						SmoothedNormal += Triangles[k].Normals[l];
-						SampleCount++;
-					}
-				}
-			}
-			
-			Triangles[i].Normals[j] = (SmoothedNormal / SampleCount).GetSafeNormal();
-		}
-	}
-}
\ No newline at end of file
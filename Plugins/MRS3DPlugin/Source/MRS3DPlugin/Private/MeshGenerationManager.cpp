@@ -61,6 +61,40 @@ int32 UMeshGenerationManager::SubmitMeshGenerationJob(
 		return -1;
 	}
 
+	return StartJob(MakeShared<FMeshGenerationTask>(Points, TaskType, MarchingCubesConfig, VoxelSize), TaskType, Points.Num(), CompletionCallback);
+}
+
+int32 UMeshGenerationManager::SubmitSnapshotMeshGenerationJob(
+	const FBitmapPointSnapshotRef& Snapshot,
+	EMeshGenerationTaskType TaskType,
+	const FMarchingCubesConfig& MarchingCubesConfig,
+	float VoxelSize,
+	const FOnMeshGenerationComplete& CompletionCallback)
+{
+	// Check if we can start a new job
+	if (!CanStartNewJob())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("MeshGenerationManager: Cannot start new job - too many active jobs"));
+		return -1;
+	}
+
+	// Validate input
+	if (Snapshot->GetNumPoints() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("MeshGenerationManager: Cannot submit job with no points"));
+		return -1;
+	}
+
+	// The snapshot is shared, not copied, the worker reads it while ingestion continues
+	return StartJob(MakeShared<FMeshGenerationTask>(Snapshot, TaskType, MarchingCubesConfig, VoxelSize), TaskType, Snapshot->GetNumPoints(), CompletionCallback);
+}
+
+int32 UMeshGenerationManager::StartJob(
+	const TSharedPtr<FMeshGenerationTask>& Task,
+	EMeshGenerationTaskType TaskType,
+	int32 PointCount,
+	const FOnMeshGenerationComplete& CompletionCallback)
+{
 	// Create job
 	TSharedPtr<FMeshGenerationJob> Job = MakeShared<FMeshGenerationJob>();
 	Job->JobID = GenerateJobID();
@@ -71,11 +105,10 @@ int32 UMeshGenerationManager::SubmitMeshGenerationJob(
 	Job->Info.TaskType = TaskType;
 	Job->Info.Status = EMeshGenerationTaskStatus::Pending;
 	Job->Info.Progress = 0.0f;
-	Job->Info.InputPointCount = Points.Num();
+	Job->Info.InputPointCount = PointCount;
 	Job->Info.SubmissionTime = FPlatformTime::Seconds();
 
-	// Create task
-	Job->Task = MakeShared<FMeshGenerationTask>(Points, TaskType, MarchingCubesConfig, VoxelSize);
+	Job->Task = Task;
 	
 	// Set completion callback to handle result
 	Job->Task->SetCompletionCallback(FOnMeshGenerationComplete::CreateUObject(
@@ -98,7 +131,7 @@ int32 UMeshGenerationManager::SubmitMeshGenerationJob(
 	}
 
 	UE_LOG(LogTemp, Log, TEXT("MeshGenerationManager: Started job %d (Type: %d, Points: %d)"),
-		Job->JobID, static_cast<int32>(TaskType), Points.Num());
+		Job->JobID, static_cast<int32>(TaskType), PointCount);
 
 	return Job->JobID;
 }
@@ -248,6 +281,23 @@ int32 UMeshGenerationManager::GetTotalMemoryUsageKB() const
 	return TotalMemory;
 }
 
+int32 UMeshGenerationManager::ReleaseCompletedResults()
+{
+	FScopeLock Lock(&JobsMutex);
+	
+	int32 FreedKB = 0;
+	for (const auto& JobPair : CompletedJobs)
+	{
+		if (JobPair.Value)
+		{
+			FreedKB += JobPair.Value->Result.MemoryUsageKB;
+		}
+	}
+	
+	CompletedJobs.Empty();
+	return FreedKB;
+}
+
 void UMeshGenerationManager::SetAutoCleanupEnabled(bool bEnabled, float CleanupDelaySeconds)
 {
 	bAutoCleanupEnabled = bEnabled;
@@ -24,16 +24,45 @@ FMeshGenerationTask::FMeshGenerationTask(
 	}
 }
 
+FMeshGenerationTask::FMeshGenerationTask(
+	const FBitmapPointSnapshotRef& InSnapshot,
+	EMeshGenerationTaskType InTaskType,
+	const FMarchingCubesConfig& InMarchingCubesConfig,
+	float InVoxelSize
+)
+	: Snapshot(InSnapshot)
+	, TaskType(InTaskType)
+	, MarchingCubesConfig(InMarchingCubesConfig)
+	, VoxelSize(InVoxelSize)
+	, bShouldCancel(false)
+{
+	Status.Set(static_cast<int32>(EMeshGenerationTaskStatus::Pending));
+	Progress.Set(0);
+	
+	if (TaskType == EMeshGenerationTaskType::MarchingCubes)
+	{
+		MarchingCubesGenerator = MakeUnique<FMarchingCubesGenerator>();
+	}
+}
+
 FMeshGenerationTask::~FMeshGenerationTask()
 {
 }
 
 bool FMeshGenerationTask::Init()
 {
+	// Marching cubes splats straight from the snapshot pages, the other types walk a flat array built here on the worker thread
+	if (Snapshot.IsValid() && TaskType != EMeshGenerationTaskType::MarchingCubes)
+	{
+		Snapshot->CopyPoints(Points);
+		Snapshot.Reset();
+	}
+	
+	const int32 InputPointCount = Snapshot.IsValid() ? Snapshot->GetNumPoints() : Points.Num();
 	UE_LOG(LogTemp, Log, TEXT("MeshGenerationTask: Initializing task for %d points (Type: %d)"), 
-		Points.Num(), static_cast<int32>(TaskType));
+		InputPointCount, static_cast<int32>(TaskType));
 	
-	Result.InputPointCount = Points.Num();
+	Result.InputPointCount = InputPointCount;
 	SetStatus(EMeshGenerationTaskStatus::Running);
 	return true;
 }
@@ -369,51 +398,26 @@ bool FMeshGenerationTask::GenerateMarchingCubesMesh()
 
 	if (ShouldCancel()) return false;
 
-	// Generate marching cubes triangles
+	// Generate the indexed marching cubes mesh, its buffers are used as they are
 	UpdateProgress(0.3f);
-	TArray<FMCTriangle> MCTriangles = MarchingCubesGenerator->GenerateFromBitmapPoints(Points, MarchingCubesConfig);
+	FMCMesh MCMesh = Snapshot.IsValid()
+		? MarchingCubesGenerator->GenerateMeshFromSnapshot(*Snapshot, MarchingCubesConfig)
+		: MarchingCubesGenerator->GenerateMeshFromBitmapPoints(Points, MarchingCubesConfig);
 
 	if (ShouldCancel()) return false;
 	UpdateProgress(0.7f);
 
-	if (MCTriangles.Num() == 0)
+	if (MCMesh.Indices.Num() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("MeshGenerationTask: Marching cubes generated no triangles"));
 		return false;
 	}
 
-	// Convert marching cubes triangles to mesh format
-	Result.Vertices.Reserve(MCTriangles.Num() * 3);
-	Result.Triangles.Reserve(MCTriangles.Num() * 3);
-	Result.Normals.Reserve(MCTriangles.Num() * 3);
-	Result.UV0.Reserve(MCTriangles.Num() * 3);
-	Result.VertexColors.Reserve(MCTriangles.Num() * 3);
-
-	for (int32 i = 0; i < MCTriangles.Num(); i++)
-	{
-		if (i % 1000 == 0)
-		{
-			if (ShouldCancel()) return false;
-			UpdateProgress(0.7f + (0.1f * i / MCTriangles.Num()));
-		}
-
-		const FMCTriangle& Triangle = MCTriangles[i];
-		const int32 BaseIndex = Result.Vertices.Num();
-
-		// Add vertices
-		for (int32 j = 0; j < 3; j++)
-		{
-			Result.Vertices.Add(Triangle.Vertices[j]);
-			Result.Normals.Add(Triangle.Normals[j]);
-			Result.UV0.Add(Triangle.UVs[j]);
-			Result.VertexColors.Add(Triangle.Colors[j]);
-		}
-
-		// Add triangle indices
-		Result.Triangles.Add(BaseIndex);
-		Result.Triangles.Add(BaseIndex + 1);
-		Result.Triangles.Add(BaseIndex + 2);
-	}
+	Result.Vertices = MoveTemp(MCMesh.Vertices);
+	Result.Normals = MoveTemp(MCMesh.Normals);
+	Result.UV0 = MoveTemp(MCMesh.UVs);
+	Result.VertexColors = MoveTemp(MCMesh.Colors);
+	Result.Triangles = MoveTemp(MCMesh.Indices);
 
 	UpdateProgress(0.8f);
 	return true;
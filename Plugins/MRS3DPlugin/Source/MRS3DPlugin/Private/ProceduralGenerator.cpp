@@ -1,14 +1,21 @@
 #include "ProceduralGenerator.h"
 #include "MRBitmapMapper.h"
 #include "MeshGenerationManager.h"
+#include "MRMemoryBudgetSubsystem.h"
+#include "MRSessionSnapshotSubsystem.h"
+#include "BitmapPointSpatialIndex.h"
+#include "BitmapPointStorage.h"
 #include "Engine/Engine.h"
 #include "GameFramework/Actor.h"
+#include "Misc/Paths.h"
 
 UProceduralGenerator::UProceduralGenerator()
 	: GenerationType(EProceduralGenerationType::Mesh)
 	, VoxelSize(10.0f)
 	, bAutoUpdate(true)
 	, UpdateInterval(0.1f)
+	, bChunkedMeshing(true)
+	, MaxChunksPerUpdate(8)
 	, AsyncGenerationThreshold(10000)
 	, bEnableAsyncGeneration(true)
 	, bShowAsyncProgress(true)
@@ -18,6 +25,9 @@ UProceduralGenerator::UProceduralGenerator()
 	, MaxTrackingLossDuration(30.0f)
 	, bUseSpatialAnchors(true)
 	, TimeSinceLastUpdate(0.0f)
+	, GeneratedPointsVersion(0)
+	, ChunkCursor(0)
+	, MeshedChunkSize(0.0f)
 	, MarchingCubesGenerator(nullptr)
 	, MeshGenerationManager(nullptr)
 	, CurrentTrackingQuality(1.0f)
@@ -75,16 +85,40 @@ void UProceduralGenerator::BeginPlay()
 		bEnableAsyncGeneration = false;
 	}
 	
-	// Subscribe to bitmap mapper updates
-	if (UGameInstance* GameInstance = GetWorld()->GetGameInstance())
+	// Let the memory budget account for and shed our caches
+	if (GetWorld() && GetWorld()->GetGameInstance())
 	{
-		if (UMRBitmapMapper* Mapper = GameInstance->GetSubsystem<UMRBitmapMapper>())
+		if (UMRMemoryBudgetSubsystem* MemoryBudget = GetWorld()->GetGameInstance()->GetSubsystem<UMRMemoryBudgetSubsystem>())
+		{
+			MemoryBudget->RegisterGenerator(this);
+		}
+		
+		// Include our mesh in session snapshots, a restored mesh is applied on registration
+		if (UMRSessionSnapshotSubsystem* SessionSnapshot = GetWorld()->GetGameInstance()->GetSubsystem<UMRSessionSnapshotSubsystem>())
 		{
-			Mapper->OnBitmapPointsUpdated.AddDynamic(this, &UProceduralGenerator::UpdateGeometry);
+			SessionSnapshot->RegisterGenerator(this);
 		}
 	}
 }
 
+void UProceduralGenerator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (GetWorld() && GetWorld()->GetGameInstance())
+	{
+		if (UMRMemoryBudgetSubsystem* MemoryBudget = GetWorld()->GetGameInstance()->GetSubsystem<UMRMemoryBudgetSubsystem>())
+		{
+			MemoryBudget->UnregisterGenerator(this);
+		}
+		
+		if (UMRSessionSnapshotSubsystem* SessionSnapshot = GetWorld()->GetGameInstance()->GetSubsystem<UMRSessionSnapshotSubsystem>())
+		{
+			SessionSnapshot->UnregisterGenerator(this);
+		}
+	}
+	
+	Super::EndPlay(EndPlayReason);
+}
+
 void UProceduralGenerator::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
@@ -116,19 +150,66 @@ void UProceduralGenerator::TickComponent(float DeltaTime, ELevelTick TickType, F
 			
 			if (UGameInstance* GameInstance = GetWorld()->GetGameInstance())
 			{
-				if (UMRBitmapMapper* Mapper = GameInstance->GetSubsystem<UMRBitmapMapper>())
-				{
-					const TArray<FBitmapPoint>& Points = Mapper->GetBitmapPoints();
-					if (Points.Num() > 0 && Points != CachedPoints)
-					{
-						UpdateGeometry(Points);
-					}
-				}
+				UpdateFromMapper(GameInstance->GetSubsystem<UMRBitmapMapper>());
 			}
 		}
 	}
 }
 
+void UProceduralGenerator::UpdateFromMapper(UMRBitmapMapper* Mapper)
+{
+	if (!Mapper)
+	{
+		return;
+	}
+
+	// Chunked meshing follows the chunk grid cursor, so only chunks holding added or removed points are remeshed
+	if (bChunkedMeshing && GenerationType == EProceduralGenerationType::MarchingCubes)
+	{
+		UpdateChunkedMarchingCubes(Mapper);
+		return;
+	}
+
+	// Compare storage versions rather than point arrays so an idle update is O(1)
+	if (Mapper->GetBitmapPointsVersion() == GeneratedPointsVersion)
+	{
+		return;
+	}
+
+	// Leaving chunked meshing, the whole-grid mesh replaces every chunk section
+	if (MeshedChunkSize > 0.0f)
+	{
+		ResetChunkedMeshing();
+		MeshedChunkSize = 0.0f;
+	}
+
+	// Paging in adds points, so it goes before the version is recorded and the snapshot taken
+	PageInMeshBounds(Mapper);
+	GeneratedPointsVersion = Mapper->GetBitmapPointsVersion();
+
+	// Large clouds are meshed from a snapshot so the point array is never flattened for the worker, small ones skip publishing it
+	UBitmapPointSpatialIndex* SpatialIndex = Mapper->GetSpatialIndex();
+	if (!SpatialIndex || !WillGenerateAsync(SpatialIndex->GetPointCount()) || GenerateAsyncFromSnapshot(SpatialIndex->AcquireSnapshot()) == -1)
+	{
+		const TArray<FBitmapPoint>& Points = Mapper->GetBitmapPoints();
+		if (Points.Num() > 0)
+		{
+			UpdateGeometry(Points);
+		}
+	}
+}
+
+int32 UProceduralGenerator::PageInMeshBounds(UMRBitmapMapper* Mapper)
+{
+	if (!Mapper || GenerationType != EProceduralGenerationType::MarchingCubes)
+	{
+		return 0;
+	}
+
+	// The kernel's reach past the grid stays as resident as it is, it only shades the border
+	return Mapper->PageInRegion(FBox(MarchingCubesConfig.GridMin, MarchingCubesConfig.GridMax));
+}
+
 void UProceduralGenerator::GenerateFromBitmapPoints(const TArray<FBitmapPoint>& Points)
 {
 	// Check if we should use async generation for large datasets
@@ -196,6 +277,7 @@ void UProceduralGenerator::ClearGeometry()
 	{
 		ProceduralMesh->ClearAllMeshSections();
 	}
+	ResetChunkedMeshing();
 	
 	// Clear cached points and shrink array to free memory
 	CachedPoints.Empty();
@@ -205,6 +287,7 @@ void UProceduralGenerator::ClearGeometry()
 void UProceduralGenerator::SetGenerationType(EProceduralGenerationType NewType)
 {
 	GenerationType = NewType;
+	ResetChunkedMeshing();
 	if (CachedPoints.Num() > 0)
 	{
 		GenerateFromBitmapPoints(CachedPoints);
@@ -405,10 +488,89 @@ void UProceduralGenerator::GenerateSurface(const TArray<FBitmapPoint>& Points)
 
 int32 UProceduralGenerator::GetCachedPointsMemoryKB() const
 {
-	const int32 PointSize = sizeof(FBitmapPoint);
-	const int32 ArrayOverhead = sizeof(TArray<FBitmapPoint>);
-	const int32 TotalBytes = (CachedPoints.Num() * PointSize) + ArrayOverhead;
-	return TotalBytes / 1024;
+	return static_cast<int32>(CachedPoints.GetAllocatedSize() / 1024);
+}
+
+int32 UProceduralGenerator::GetPreLossSnapshotMemoryKB() const
+{
+	FScopeLock Lock(&TrackingStateMutex);
+	return static_cast<int32>(PreLossGeometrySnapshot.GetAllocatedSize() / 1024);
+}
+
+int32 UProceduralGenerator::ReleaseCachedPoints()
+{
+	const int32 PreviousMemory = GetCachedPointsMemoryKB();
+	CachedPoints.Empty();
+	return PreviousMemory;
+}
+
+int32 UProceduralGenerator::ReleasePreLossSnapshot()
+{
+	FScopeLock Lock(&TrackingStateMutex);
+	const int32 PreviousMemory = static_cast<int32>(PreLossGeometrySnapshot.GetAllocatedSize() / 1024);
+	PreLossGeometrySnapshot.Empty();
+	return PreviousMemory;
+}
+
+FString UProceduralGenerator::GetSnapshotKey() const
+{
+	const FString OwnerName = GetOwner() ? GetOwner()->GetName() : TEXT("None");
+	return FPaths::MakeValidFileName(OwnerName + TEXT("_") + GetName());
+}
+
+bool UProceduralGenerator::CaptureMeshSnapshot(FMeshGenerationResult& OutMesh) const
+{
+	if (!ProceduralMesh)
+	{
+		return false;
+	}
+	
+	// Chunked meshing spreads the mesh over many sections, they are saved as one
+	OutMesh.Vertices.Reset();
+	OutMesh.Normals.Reset();
+	OutMesh.UV0.Reset();
+	OutMesh.VertexColors.Reset();
+	OutMesh.Triangles.Reset();
+	for (int32 SectionIndex = 0; SectionIndex < ProceduralMesh->GetNumSections(); SectionIndex++)
+	{
+		const FProcMeshSection* Section = ProceduralMesh->GetProcMeshSection(SectionIndex);
+		if (!Section || Section->ProcVertexBuffer.Num() == 0)
+		{
+			continue;
+		}
+		
+		const int32 BaseVertex = OutMesh.Vertices.Num();
+		for (const FProcMeshVertex& Vertex : Section->ProcVertexBuffer)
+		{
+			OutMesh.Vertices.Add(Vertex.Position);
+			OutMesh.Normals.Add(Vertex.Normal);
+			OutMesh.UV0.Add(Vertex.UV0);
+			OutMesh.VertexColors.Add(Vertex.Color);
+		}
+		
+		for (const uint32 VertexIndex : Section->ProcIndexBuffer)
+		{
+			OutMesh.Triangles.Add(BaseVertex + static_cast<int32>(VertexIndex));
+		}
+	}
+	
+	OutMesh.TriangleCount = OutMesh.Triangles.Num() / 3;
+	return OutMesh.Vertices.Num() > 0;
+}
+
+void UProceduralGenerator::ApplyMeshSnapshot(const FMeshGenerationResult& Mesh)
+{
+	CreateProceduralMeshIfNeeded();
+	ProceduralMesh->ClearAllMeshSections();
+	ProceduralMesh->CreateMeshSection(0, Mesh.Vertices, Mesh.Triangles, Mesh.Normals, Mesh.UV0, Mesh.VertexColors, TArray<FProcMeshTangent>(), true);
+	
+	if (DefaultMaterial)
+	{
+		ProceduralMesh->SetMaterial(0, DefaultMaterial);
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("ProceduralGenerator: Restored mesh with %d vertices, %d triangles from session snapshot"), 
+		Mesh.Vertices.Num(), Mesh.Triangles.Num() / 3);
 }
 
 void UProceduralGenerator::ForceMemoryCleanup()
@@ -418,6 +580,7 @@ void UProceduralGenerator::ForceMemoryCleanup()
 	{
 		ProceduralMesh->ClearAllMeshSections();
 	}
+	ResetChunkedMeshing();
 	
 	// Clear and shrink cached points array
 	const int32 PreviousMemory = GetCachedPointsMemoryKB();
@@ -515,81 +678,181 @@ void UProceduralGenerator::GenerateMarchingCubesInternal(const TArray<FBitmapPoi
 	ProceduralMesh->ClearAllMeshSections();
 	
 	// Generate triangles using marching cubes
-	TArray<FMCTriangle> MCTriangles = MarchingCubesGenerator->GenerateFromBitmapPoints(Points, MarchingCubesConfig);
+	const FMCMesh MCMesh = MarchingCubesGenerator->GenerateMeshFromBitmapPoints(Points, MarchingCubesConfig);
 	
-	if (MCTriangles.Num() == 0)
+	if (MCMesh.Indices.Num() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Marching cubes generated no triangles"));
 		return;
 	}
 	
 	// Convert marching cubes triangles to procedural mesh format
-	ConvertMCTrianglesToMesh(MCTriangles);
+	ConvertMCMeshToSection(MCMesh);
 	
-	UE_LOG(LogTemp, Log, TEXT("Marching cubes generated %d triangles from %d points"), MCTriangles.Num(), Points.Num());
+	UE_LOG(LogTemp, Log, TEXT("Marching cubes generated %d triangles from %d points"), MCMesh.GetNumTriangles(), Points.Num());
 }
 
-void UProceduralGenerator::ConvertMCTrianglesToMesh(const TArray<FMCTriangle>& MCTriangles)
+void UProceduralGenerator::ConvertMCMeshToSection(const FMCMesh& MCMesh, int32 SectionIndex)
 {
-	if (!ProceduralMesh || MCTriangles.Num() == 0)
+	if (!ProceduralMesh || MCMesh.Indices.Num() == 0)
 	{
 		return;
 	}
 	
-	TArray<FVector> Vertices;
-	TArray<int32> Triangles;
-	TArray<FVector> Normals;
-	TArray<FVector2D> UV0;
-	TArray<FColor> VertexColors;
+	// Vertices are already shared between triangles, only tangents need to be derived
 	TArray<FProcMeshTangent> Tangents;
+	Tangents.Reserve(MCMesh.Normals.Num());
+	for (const FVector& Normal : MCMesh.Normals)
+	{
+		// Calculate tangent perpendicular to normal
+		FVector Tangent = FVector::ForwardVector;
+		if (!Normal.Equals(FVector::ForwardVector))
+		{
+			Tangent = FVector::CrossProduct(Normal, FVector::UpVector).GetSafeNormal();
+		}
+		Tangents.Add(FProcMeshTangent(Tangent, false));
+	}
 	
-	// Convert marching cubes triangles to mesh data
-	for (int32 i = 0; i < MCTriangles.Num(); i++)
+	// Create mesh section
+	ProceduralMesh->CreateMeshSection(SectionIndex, MCMesh.Vertices, MCMesh.Indices, MCMesh.Normals, MCMesh.UVs, MCMesh.Colors, Tangents, true);
+	
+	// Apply material if set
+	if (DefaultMaterial)
 	{
-		const FMCTriangle& Triangle = MCTriangles[i];
-		
-		// Add vertices
-		int32 BaseIndex = Vertices.Num();
-		for (int32 j = 0; j < 3; j++)
+		ProceduralMesh->SetMaterial(SectionIndex, DefaultMaterial);
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("Created mesh with %d vertices and %d triangles"), MCMesh.Vertices.Num(), MCMesh.GetNumTriangles());
+}
+
+void UProceduralGenerator::UpdateChunkedMarchingCubes(UMRBitmapMapper* Mapper)
+{
+	UBitmapPointSpatialIndex* SpatialIndex = Mapper->GetSpatialIndex();
+	if (!SpatialIndex || !MarchingCubesGenerator)
+	{
+		return;
+	}
+	
+	FBitmapPointChunkGrid& ChunkGrid = SpatialIndex->GetChunkGrid();
+	if (ChunkGrid.GetChunkSize() != MeshedChunkSize)
+	{
+		// Sections were cut at the old chunk size, start over
+		if (ProceduralMesh)
 		{
-			Vertices.Add(Triangle.Vertices[j]);
-			Normals.Add(Triangle.Normals[j]);
-			UV0.Add(Triangle.UVs[j]);
-			VertexColors.Add(Triangle.Colors[j]);
+			ProceduralMesh->ClearAllMeshSections();
 		}
-		
-		// Add triangle indices
-		Triangles.Add(BaseIndex);
-		Triangles.Add(BaseIndex + 1);
-		Triangles.Add(BaseIndex + 2);
+		ResetChunkedMeshing();
+		MeshedChunkSize = ChunkGrid.GetChunkSize();
 	}
 	
-	// Calculate tangents
-	for (int32 i = 0; i < Vertices.Num(); i++)
+	// Density near a face depends on points up to twice the voxel size across it
+	ChunkGrid.RequireInfluenceMargin(MarchingCubesConfig.VoxelSize * 2.0f);
+	
+	TArray<FIntVector> ChangedChunks;
+	ChunkCursor = ChunkGrid.CollectChangedChunks(ChunkCursor, ChangedChunks);
+	PendingChunks.Append(ChangedChunks);
+	
+	if (PendingChunks.Num() == 0)
 	{
-		FVector Tangent = FVector::ForwardVector;
-		if (i < Normals.Num())
+		return;
+	}
+	
+	CreateProceduralMeshIfNeeded();
+	
+	// Page in the chunks of this pass once each, then absorb the chunks that changed by it so they are not remeshed next pass
+	TArray<FIntVector> MeshedChunks;
+	int32 PagedInCount = 0;
+	for (const FIntVector& ChunkKey : PendingChunks)
+	{
+		if (MeshedChunks.Num() >= FMath::Max(1, MaxChunksPerUpdate))
 		{
-			// Calculate tangent perpendicular to normal
-			FVector Normal = Normals[i];
-			if (!Normal.Equals(FVector::ForwardVector))
-			{
-				Tangent = FVector::CrossProduct(Normal, FVector::UpVector).GetSafeNormal();
-			}
+			break;
+		}
+		MeshedChunks.Add(ChunkKey);
+	}
+	for (const FIntVector& ChunkKey : MeshedChunks)
+	{
+		PagedInCount += Mapper->PageInRegion(ChunkGrid.GetChunkBounds(ChunkKey));
+	}
+	
+	if (PagedInCount > 0)
+	{
+		ChangedChunks.Reset();
+		ChunkCursor = ChunkGrid.CollectChangedChunks(ChunkCursor, ChangedChunks);
+		PendingChunks.Append(ChangedChunks);
 	}
-	Tangents.Add(FProcMeshTangent(Tangent, false));
+	
+	for (const FIntVector& ChunkKey : MeshedChunks)
+	{
+		GenerateChunkMarchingCubes(Mapper, ChunkKey);
+		PendingChunks.Remove(ChunkKey);
+	}
+	
+	GeneratedPointsVersion = Mapper->GetBitmapPointsVersion();
 }
 
-// Create mesh section
-ProceduralMesh->CreateMeshSection(0, Vertices, Triangles, Normals, UV0, VertexColors, Tangents, true);
-
-// Apply material if set
-if (DefaultMaterial)
+void UProceduralGenerator::GenerateChunkMarchingCubes(UMRBitmapMapper* Mapper, const FIntVector& ChunkKey)
 {
-	ProceduralMesh->SetMaterial(0, DefaultMaterial);
+	UBitmapPointSpatialIndex* SpatialIndex = Mapper->GetSpatialIndex();
+	UBitmapPointStorage* Storage = Mapper->GetStorageComponent();
+	const FBitmapPointChunkGrid& ChunkGrid = SpatialIndex->GetChunkGrid();
+	const FBox ChunkBounds = ChunkGrid.GetChunkBounds(ChunkKey);
+	
+	// Gather the chunk's points plus the ones across its faces that still reach its samples
+	// The chunk was paged in by the caller, the margin reads only what is resident so neighbours stay paged out
+	TArray<FBitmapPoint> ChunkPoints;
+	if (ChunkGrid.GetChunkPointCount(ChunkKey) > 0 && Storage)
+	{
+		const FVector Margin(MarchingCubesConfig.VoxelSize * 2.0f);
+		SpatialIndex->ForEachResidentPointInBox(ChunkBounds.Min - Margin, ChunkBounds.Max + Margin, [Storage, &ChunkPoints](int32 Id, const FVector3f& Position) {
+			FBitmapPoint Point;
+			if (Storage->GetPointById(Id, Point))
+			{
+				ChunkPoints.Add(Point);
+			}
+			return true;
+		});
+	}
+	
+	FMCMesh MCMesh;
+	if (ChunkPoints.Num() > 0)
+	{
+		// Neighbouring chunks sample their shared face at the same positions, so their surfaces meet without seams
+		FMarchingCubesConfig ChunkConfig = MarchingCubesConfig;
+		const int32 Resolution = FMath::Max(2, FMath::RoundToInt(ChunkGrid.GetChunkSize() / FMath::Max(MarchingCubesConfig.VoxelSize, 1.0f)) + 1);
+		ChunkConfig.GridMin = ChunkBounds.Min;
+		ChunkConfig.GridMax = ChunkBounds.Max;
+		ChunkConfig.GridResolution = FIntVector(Resolution);
+		MCMesh = MarchingCubesGenerator->GenerateMeshFromBitmapPoints(ChunkPoints, ChunkConfig);
+	}
+	
+	int32* SectionIndex = ChunkMeshSections.Find(ChunkKey);
+	if (MCMesh.Indices.Num() == 0)
+	{
+		if (SectionIndex)
+		{
+			ProceduralMesh->ClearMeshSection(*SectionIndex);
+			FreeMeshSections.Add(*SectionIndex);
+			ChunkMeshSections.Remove(ChunkKey);
+		}
+		return;
+	}
+	
+	if (!SectionIndex)
+	{
+		const int32 NewSection = FreeMeshSections.Num() > 0 ? FreeMeshSections.Pop(false) : ChunkMeshSections.Num();
+		SectionIndex = &ChunkMeshSections.Add(ChunkKey, NewSection);
+	}
+	
+	ConvertMCMeshToSection(MCMesh, *SectionIndex);
 }
 
-UE_LOG(LogTemp, Log, TEXT("Created mesh with %d vertices and %d triangles"), Vertices.Num(), Triangles.Num() / 3);
+void UProceduralGenerator::ResetChunkedMeshing()
+{
+	ChunkMeshSections.Empty();
+	FreeMeshSections.Empty();
+	PendingChunks.Empty();
+	ChunkCursor = 0;
 }
 
 // Async Generation Methods
@@ -634,6 +897,35 @@ int32 UProceduralGenerator::GenerateAsyncFromBitmapPoints(const TArray<FBitmapPo
 	return JobID;
 }
 
+int32 UProceduralGenerator::GenerateAsyncFromSnapshot(const FBitmapPointSnapshotRef& Snapshot, bool bForceAsync)
+{
+	if (!WillGenerateAsync(Snapshot->GetNumPoints(), bForceAsync))
+	{
+		return -1;
+	}
+
+	FOnMeshGenerationComplete CompletionCallback;
+	CompletionCallback.BindUObject(this, &UProceduralGenerator::ApplyAsyncResult);
+	
+	int32 JobID = MeshGenerationManager->SubmitSnapshotMeshGenerationJob(
+		Snapshot,
+		GetTaskTypeFromGenerationType(),
+		MarchingCubesConfig,
+		VoxelSize,
+		CompletionCallback
+	);
+
+	if (JobID != -1)
+	{
+		FScopeLock Lock(&AsyncJobsMutex);
+		ActiveAsyncJobs.Add(JobID);
+		
+		UE_LOG(LogTemp, Log, TEXT("ProceduralGenerator: Started async job %d for a snapshot of %d points"), JobID, Snapshot->GetNumPoints());
+	}
+
+	return JobID;
+}
+
 bool UProceduralGenerator::CancelAsyncGeneration(int32 JobID)
 {
 	if (!MeshGenerationManager)
@@ -681,11 +973,14 @@ void UProceduralGenerator::SetAsyncThreshold(int32 NewThreshold)
 	UE_LOG(LogTemp, Log, TEXT("ProceduralGenerator: Async threshold set to %d points"), AsyncGenerationThreshold);
 }
 
+bool UProceduralGenerator::WillGenerateAsync(int32 PointCount, bool bForceAsync) const
+{
+	return bEnableAsyncGeneration && MeshGenerationManager && (bForceAsync || PointCount >= AsyncGenerationThreshold);
+}
+
 bool UProceduralGenerator::ShouldUseAsyncGeneration(int32 PointCount) const
 {
-	return bEnableAsyncGeneration && 
-		   MeshGenerationManager && 
-		   PointCount >= AsyncGenerationThreshold;
+	return WillGenerateAsync(PointCount);
 }
 
 EMeshGenerationTaskType UProceduralGenerator::GetTaskTypeFromGenerationType() const
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Point ids grouped into fixed-width time buckets, oldest bucket first
+ * Points arrive in roughly timestamp order, so adding is almost always an append to the newest bucket
+ * and expiring by age is a binary search over buckets followed by dropping whole buckets.
+ * Entries are never updated in place: a point whose timestamp changes gets a second entry and a removed point leaves
+ * a stale one, so callers must check candidates against storage and rebuild when GetNumEntries outgrows the store.
+ */
+class MRS3DPLUGIN_API FBitmapPointAgeIndex
+{
+public:
+	explicit FBitmapPointAgeIndex(float InBucketSeconds = 1.0f);
+
+	/** Record a point id at a timestamp */
+	void Add(int32 Id, float Timestamp);
+
+	/**
+	 * Remove every entry with a timestamp older than a time
+	 * @param OutIds - Receives the removed ids in no particular order, possibly stale or duplicated
+	 * @return Number of ids appended to OutIds
+	 */
+	int32 PopOlderThan(float OldestAllowedTime, TArray<int32>& OutIds);
+
+	/** Drop every entry */
+	void Reset();
+
+	/** Number of entries, including stale ones */
+	int32 GetNumEntries() const { return NumEntries; }
+
+	/** Number of non-empty buckets */
+	int32 GetNumBuckets() const { return Buckets.Num(); }
+
+	/** Bytes allocated by all buckets */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FBucket
+	{
+		/** Bucket start time in units of BucketSeconds */
+		int64 Key;
+
+		TArray<int32> Ids;
+		TArray<float> Timestamps;
+	};
+
+	/** Buckets in ascending key order */
+	TArray<FBucket> Buckets;
+
+	float BucketSeconds;
+	int32 NumEntries;
+
+	int64 ToKey(float Timestamp) const { return FMath::FloorToInt64(Timestamp / BucketSeconds); }
+};
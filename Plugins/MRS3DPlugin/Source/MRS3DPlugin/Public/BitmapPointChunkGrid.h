@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed-size cubic chunks the mapped world is partitioned into, shared by storage cleanup, the index and meshing
+ * The grid keeps a point count and a change stamp per chunk. Every stage that works per chunk keeps its own cursor
+ * and asks for the chunks changed since it, so its work scales with the area that changed rather than the area mapped.
+ * A change within InfluenceMargin of a chunk face also stamps the neighbour across that face, for consumers such as
+ * meshing whose output near a face depends on points on both sides.
+ */
+class MRS3DPLUGIN_API FBitmapPointChunkGrid
+{
+public:
+	explicit FBitmapPointChunkGrid(float InChunkSize = 100.0f);
+
+	/** Change the chunk size, every chunk is dropped and must be repopulated */
+	void SetChunkSize(float InChunkSize);
+
+	float GetChunkSize() const { return ChunkSize; }
+
+	/**
+	 * Distance from a chunk face within which a change also marks the neighbouring chunk
+	 * Only ever grows, since several consumers share the grid and each needs at least its own margin
+	 */
+	void RequireInfluenceMargin(float Margin);
+
+	float GetInfluenceMargin() const { return InfluenceMargin; }
+
+	/** Chunk containing a position */
+	FIntVector GetChunkKey(const FVector& Position) const;
+
+	/** World bounds of a chunk */
+	FBox GetChunkBounds(const FIntVector& Key) const;
+
+	/** Record a point added at a position */
+	void AddPoint(const FVector& Position);
+
+	/** Record a point removed from a position */
+	void RemovePoint(const FVector& Position);
+
+	/** Empty every chunk, the chunks stay known and are reported as changed */
+	void ClearPoints();
+
+	/** Number of points currently in a chunk */
+	int32 GetChunkPointCount(const FIntVector& Key) const;
+
+	/** Collect every chunk holding points */
+	void GetOccupiedChunks(TArray<FIntVector>& OutKeys) const;
+
+	int32 GetNumChunks() const { return Chunks.Num(); }
+
+	/**
+	 * Collect the chunks changed at or after a cursor, emptied chunks included
+	 * @param SinceCursor - Cursor returned by the previous call, 0 for every chunk ever changed
+	 * @return Cursor to pass next time
+	 */
+	int64 CollectChangedChunks(int64 SinceCursor, TArray<FIntVector>& OutKeys);
+
+	/** Bytes allocated for chunk bookkeeping */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FChunkState
+	{
+		int32 NumPoints;
+
+		/** Version of the last change that touched this chunk */
+		int64 ChangeVersion;
+	};
+
+	struct FChangeEntry
+	{
+		int64 Version;
+		FIntVector Key;
+	};
+
+	float ChunkSize;
+	float InfluenceMargin;
+
+	TMap<FIntVector, FChunkState> Chunks;
+
+	/** Chunks in the order they were stamped, one entry per chunk and version, ascending by version */
+	TArray<FChangeEntry> ChangeLog;
+
+	/** Version stamped on changes, advanced by every CollectChangedChunks so each cursor sees later changes */
+	int64 Version;
+
+	/** Stamp a chunk and, if the position is near a face, its neighbours */
+	void MarkChanged(const FIntVector& Key, const FVector& Position);
+
+	void StampChunk(const FIntVector& Key);
+
+	/** Rebuild the change log with one entry per chunk once duplicates dominate it */
+	void CompactChangeLog();
+};
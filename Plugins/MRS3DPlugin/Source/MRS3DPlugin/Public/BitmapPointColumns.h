@@ -0,0 +1,128 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BitmapPoint.h"
+
+/**
+ * Read-only view of a single row in FBitmapPointColumns
+ * Exposes the same field names as FBitmapPoint so templated code can consume either
+ */
+struct MRS3DPLUGIN_API FBitmapPointView
+{
+	const FVector& Position;
+	const FColor& Color;
+	const float& Intensity;
+	const float& Timestamp;
+	const FVector& Normal;
+
+	FBitmapPointView(const FVector& InPosition, const FColor& InColor, const float& InIntensity, const float& InTimestamp, const FVector& InNormal)
+		: Position(InPosition)
+		, Color(InColor)
+		, Intensity(InIntensity)
+		, Timestamp(InTimestamp)
+		, Normal(InNormal)
+	{}
+
+	/** Copy the viewed row out into a standalone point */
+	FBitmapPoint ToBitmapPoint() const
+	{
+		FBitmapPoint Point(Position, Color, Intensity);
+		Point.Timestamp = Timestamp;
+		Point.Normal = Normal;
+		return Point;
+	}
+
+	operator FBitmapPoint() const { return ToBitmapPoint(); }
+};
+
+/**
+ * Structure-of-arrays backing store for bitmap points
+ * Every attribute lives in its own contiguous column so scans only stream the bytes they use
+ */
+struct MRS3DPLUGIN_API FBitmapPointColumns
+{
+	TArray<FVector> Positions;
+	TArray<FColor> Colors;
+	TArray<float> Intensities;
+	TArray<float> Timestamps;
+	TArray<FVector> Normals;
+
+	/** Stable storage id of each row, ascending in row order */
+	TArray<int32> Ids;
+
+	/** Number of rows stored */
+	int32 Num() const { return Positions.Num(); }
+
+	/** Append a single point */
+	void Add(const FBitmapPoint& Point, int32 Id);
+
+	/** Append multiple points with consecutive ids starting at FirstId */
+	void Append(const TArray<FBitmapPoint>& Points, int32 FirstId);
+
+	/** Remove a contiguous range of rows, preserving order */
+	void RemoveAt(int32 Index, int32 Count = 1);
+
+	/**
+	 * Remove every row for which ShouldRemove(Index) returns true, preserving order
+	 * @param OutRemovedIds - Optional array that receives the ids of removed rows in row order
+	 * @return Number of rows removed
+	 */
+	int32 RemoveAll(TFunctionRef<bool(int32 Index)> ShouldRemove, TArray<int32>* OutRemovedIds = nullptr);
+
+	/** Get a view of a row */
+	FBitmapPointView GetView(int32 Index) const
+	{
+		return FBitmapPointView(Positions[Index], Colors[Index], Intensities[Index], Timestamps[Index], Normals[Index]);
+	}
+
+	/** Copy a row out as a point */
+	FBitmapPoint GetPoint(int32 Index) const { return GetView(Index).ToBitmapPoint(); }
+
+	/** Overwrite the attributes of a row, keeping its id */
+	void SetPoint(int32 Index, const FBitmapPoint& Point);
+
+	/** Copy every row into an array-of-structs buffer */
+	void CopyTo(TArray<FBitmapPoint>& OutPoints) const;
+
+	void Reserve(int32 Capacity);
+	void Shrink();
+	void Empty();
+
+	/** Bytes allocated by all columns, including slack */
+	SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * Fixed-capacity block of columns used by the chunked ring-buffer storage layout
+ * Rows before Start have been consumed from the front and are skipped
+ */
+struct MRS3DPLUGIN_API FBitmapPointChunk
+{
+	FBitmapPointColumns Columns;
+
+	/** First live row */
+	int32 Start;
+
+	FBitmapPointChunk()
+		: Start(0)
+	{}
+
+	int32 NumLive() const { return Columns.Num() - Start; }
+
+	/** Physically drop consumed rows so the chunk can be compacted or edited in place */
+	void CompactFront()
+	{
+		if (Start > 0)
+		{
+			Columns.RemoveAt(0, Start);
+			Start = 0;
+		}
+	}
+
+	/** Reset for reuse without releasing column allocations */
+	void Reset()
+	{
+		Columns.RemoveAt(0, Columns.Num());
+		Start = 0;
+	}
+};
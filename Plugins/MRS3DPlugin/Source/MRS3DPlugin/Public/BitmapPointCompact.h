@@ -0,0 +1,186 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Float16.h"
+#include "BitmapPoint.h"
+
+/**
+ * Quantized 20 byte encoding of a bitmap point, under a third of FBitmapPoint
+ * Fields are relative to the FBitmapPointQuantizer of the chunk that holds the point
+ */
+struct MRS3DPLUGIN_API FBitmapPointCompact
+{
+	/** Exact timestamp, sessions outlast any range 16 relative bits could cover at full precision */
+	float Timestamp;
+
+	FColor Color;
+
+	/** Position offset from the chunk origin in position steps */
+	int16 X;
+	int16 Y;
+	int16 Z;
+
+	/** Octahedral-encoded unit normal */
+	uint8 NormalU;
+	uint8 NormalV;
+
+	/** Half-precision intensity */
+	uint16 Intensity;
+
+	/** Always zero, keeps the record free of uninitialized padding when written to disk */
+	uint16 Reserved;
+};
+
+static_assert(sizeof(FBitmapPointCompact) == 20, "FBitmapPointCompact is expected to pack into 20 bytes");
+
+/**
+ * Frame that compact points of one chunk are encoded against
+ * Storage canonicalizes every point it accepts onto a global lattice of PositionStep, octahedral normals and half-precision
+ * intensity, all well below depth sensor noise. Decoding a canonical point within the frame's range reproduces it exactly,
+ * so snapshot pages and paged-out chunks read back the same points storage holds.
+ */
+struct MRS3DPLUGIN_API FBitmapPointQuantizer
+{
+	/** Position that encodes to zero, on the lattice */
+	FVector Origin;
+
+	/** World units per position step, a power of two so lattice positions and their offsets stay exact in double precision */
+	static constexpr double PositionStep = 1.0 / 32.0;
+
+	/** Largest encodable offset from the origin in position steps */
+	static constexpr int32 MaxPositionSteps = 32767;
+
+	/** Largest cube edge a frame encodes exactly, about 20 meters */
+	static constexpr double MaxCubeEdge = 2.0 * MaxPositionSteps * PositionStep;
+
+	FBitmapPointQuantizer()
+		: Origin(FVector::ZeroVector)
+	{}
+
+	/** Build a quantizer centered on the bounds of a set of points */
+	static FBitmapPointQuantizer Fit(TConstArrayView<FBitmapPoint> Points);
+
+	/** Build a quantizer for a cube of space, exact for cubes up to MaxCubeEdge */
+	static FBitmapPointQuantizer FitCube(const FVector& Center, float EdgeLength);
+
+	/** Snap a point onto the lattice compact points encode exactly */
+	static FBitmapPoint Canonicalize(const FBitmapPoint& Point)
+	{
+		FBitmapPoint Canonical = Point;
+		Canonical.Position = CanonicalizePosition(Point.Position);
+		Canonical.Normal = CanonicalizeNormal(Point.Normal);
+		Canonical.Intensity = CanonicalizeIntensity(Point.Intensity);
+		return Canonical;
+	}
+
+	static FVector CanonicalizePosition(const FVector& Position)
+	{
+		return FVector(
+			FMath::RoundHalfFromZero(Position.X / PositionStep) * PositionStep,
+			FMath::RoundHalfFromZero(Position.Y / PositionStep) * PositionStep,
+			FMath::RoundHalfFromZero(Position.Z / PositionStep) * PositionStep);
+	}
+
+	static FVector CanonicalizeNormal(const FVector& Normal)
+	{
+		// A code and the normal it decodes to can re-encode to a neighbouring code, settle on one that maps to itself
+		uint8 U;
+		uint8 V;
+		EncodeOctahedral(Normal, U, V);
+		for (int32 Step = 0; Step < 4; Step++)
+		{
+			uint8 NextU;
+			uint8 NextV;
+			EncodeOctahedral(DecodeOctahedral(U, V), NextU, NextV);
+			if (NextU == U && NextV == V)
+			{
+				break;
+			}
+			U = NextU;
+			V = NextV;
+		}
+		return DecodeOctahedral(U, V);
+	}
+
+	static float CanonicalizeIntensity(float Intensity)
+	{
+		return FFloat16(Intensity).GetFloat();
+	}
+
+	/** Whether a position lies inside the encodable range */
+	bool CanEncode(const FVector& Position) const
+	{
+		const FVector Offset = (Position - Origin) / PositionStep;
+		return FMath::Abs(Offset.X) <= MaxPositionSteps && FMath::Abs(Offset.Y) <= MaxPositionSteps && FMath::Abs(Offset.Z) <= MaxPositionSteps;
+	}
+
+	/** Encode a point, positions outside the range are clamped to it and are the only canonical points that lose precision */
+	FORCEINLINE FBitmapPointCompact Encode(const FBitmapPoint& Point) const
+	{
+		FBitmapPointCompact Compact;
+		const FVector Offset = (Point.Position - Origin) / PositionStep;
+		Compact.Timestamp = Point.Timestamp;
+		Compact.Color = Point.Color;
+		Compact.X = static_cast<int16>(FMath::Clamp<int64>(FMath::RoundToInt64(Offset.X), -MaxPositionSteps, MaxPositionSteps));
+		Compact.Y = static_cast<int16>(FMath::Clamp<int64>(FMath::RoundToInt64(Offset.Y), -MaxPositionSteps, MaxPositionSteps));
+		Compact.Z = static_cast<int16>(FMath::Clamp<int64>(FMath::RoundToInt64(Offset.Z), -MaxPositionSteps, MaxPositionSteps));
+		EncodeOctahedral(Point.Normal, Compact.NormalU, Compact.NormalV);
+		Compact.Intensity = FFloat16(Point.Intensity).Encoded;
+		Compact.Reserved = 0;
+		return Compact;
+	}
+
+	/** Decode only the position, for hot loops that filter before touching other fields */
+	FORCEINLINE FVector DecodePosition(const FBitmapPointCompact& Compact) const
+	{
+		return Origin + FVector(Compact.X, Compact.Y, Compact.Z) * PositionStep;
+	}
+
+	/** Decode a full point */
+	FORCEINLINE FBitmapPoint Decode(const FBitmapPointCompact& Compact) const
+	{
+		FFloat16 Intensity;
+		Intensity.Encoded = Compact.Intensity;
+
+		FBitmapPoint Point(DecodePosition(Compact), Compact.Color, Intensity);
+		Point.Timestamp = Compact.Timestamp;
+		Point.Normal = DecodeOctahedral(Compact.NormalU, Compact.NormalV);
+		return Point;
+	}
+
+	/** Append encoded copies of points */
+	void EncodePoints(TConstArrayView<FBitmapPoint> Points, TArray<FBitmapPointCompact>& OutCompact) const;
+
+	/** Append decoded copies of compact points */
+	void DecodePoints(TConstArrayView<FBitmapPointCompact> Compact, TArray<FBitmapPoint>& OutPoints) const;
+
+	/** Map a unit vector onto the octahedron unfolded into a square, 8 bits per axis */
+	static void EncodeOctahedral(const FVector& Normal, uint8& OutU, uint8& OutV)
+	{
+		const float L1 = FMath::Abs(Normal.X) + FMath::Abs(Normal.Y) + FMath::Abs(Normal.Z);
+		float U = L1 > 0.0f ? Normal.X / L1 : 0.0f;
+		float V = L1 > 0.0f ? Normal.Y / L1 : 0.0f;
+		if (L1 > 0.0f && Normal.Z < 0.0f)
+		{
+			// Fold the lower hemisphere over the diagonals
+			const float FoldedU = (1.0f - FMath::Abs(V)) * (U >= 0.0f ? 1.0f : -1.0f);
+			const float FoldedV = (1.0f - FMath::Abs(U)) * (V >= 0.0f ? 1.0f : -1.0f);
+			U = FoldedU;
+			V = FoldedV;
+		}
+		OutU = static_cast<uint8>(FMath::RoundToInt((U * 0.5f + 0.5f) * 255.0f));
+		OutV = static_cast<uint8>(FMath::RoundToInt((V * 0.5f + 0.5f) * 255.0f));
+	}
+
+	static FVector DecodeOctahedral(uint8 InU, uint8 InV)
+	{
+		const float U = InU / 255.0f * 2.0f - 1.0f;
+		const float V = InV / 255.0f * 2.0f - 1.0f;
+
+		FVector Normal(U, V, 1.0f - FMath::Abs(U) - FMath::Abs(V));
+		const float Fold = FMath::Max(-static_cast<float>(Normal.Z), 0.0f);
+		Normal.X += Normal.X >= 0.0f ? -Fold : Fold;
+		Normal.Y += Normal.Y >= 0.0f ? -Fold : Fold;
+		return Normal.GetSafeNormal(SMALL_NUMBER, FVector::UpVector);
+	}
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "BitmapPointStorage.h"
+#include "BitmapPointFusion.generated.h"
+
+/**
+ * Running average of every sample that fell into one fusion voxel
+ */
+struct FBitmapPointFusionVoxel
+{
+	/** Storage id of the fused point, INDEX_NONE until it has been stored */
+	int32 Id;
+
+	/** Number of samples fused into this voxel */
+	int32 ObservationCount;
+
+	/** Slot in the batch being fused, INDEX_NONE outside FusePoints */
+	int32 BatchIndex;
+
+	FVector Position;
+	FVector Normal;
+	FVector4f Color;
+	float Intensity;
+
+	/** Timestamp of the most recent sample */
+	float LastSeen;
+};
+
+/**
+ * Ingest stage that fuses bitmap points falling into the same fine voxel into one running-average point
+ * Repeated scans of a surface refine its stored points instead of appending duplicates,
+ * so memory scales with the surface area scanned rather than the time spent scanning
+ */
+UCLASS(BlueprintType)
+class FMRS3DPLUGIN_API UBitmapPointFusion : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UBitmapPointFusion();
+
+	/**
+	 * Set the fusion voxel edge length, clears all fusion state
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Fusion")
+	void SetVoxelSize(float InVoxelSize);
+
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Fusion")
+	float GetVoxelSize() const { return VoxelSize; }
+
+	/**
+	 * Cap the weight of the running average so long-observed points still follow new samples (0 = no cap)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Fusion")
+	void SetMaxObservationWeight(int32 InMaxWeight);
+
+	/**
+	 * Fuse a batch of samples into the voxel map
+	 * @param OutNewPoints - One point per voxel that has no stored point yet, pass their ids to BindNewPoints once stored
+	 * @param OutUpdatedIds - Storage ids of fused points that changed
+	 * @param OutUpdatedPoints - New attributes of those points, parallel to OutUpdatedIds
+	 */
+	void FusePoints(const TArray<FBitmapPoint>& Points, TArray<FBitmapPoint>& OutNewPoints, TArray<int32>& OutUpdatedIds, TArray<FBitmapPoint>& OutUpdatedPoints);
+
+	/**
+	 * Assign storage ids to the points returned in OutNewPoints by the last FusePoints call
+	 * @param FirstId - Id of the first new point, the rest follow consecutively
+	 */
+	void BindNewPoints(int32 FirstId);
+
+	/**
+	 * Drop fusion state for points that left storage, call with every storage change set
+	 */
+	void HandleChangeSet(const FBitmapPointChangeSet& ChangeSet);
+
+	/**
+	 * Get the number of samples fused into a stored point, or 0 if it is not a fused point
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Fusion")
+	int32 GetObservationCount(int32 Id) const;
+
+	/**
+	 * Get the number of occupied fusion voxels
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Fusion")
+	int32 GetNumVoxels() const { return Voxels.Num(); }
+
+	/**
+	 * Clear all fusion state
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Fusion")
+	void Reset();
+
+	/**
+	 * Get memory usage in bytes
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Fusion")
+	int32 GetMemoryUsageBytes() const;
+
+protected:
+	/** Fusion voxel edge length */
+	UPROPERTY()
+	float VoxelSize;
+
+	/** Largest sample count used to weight the running average */
+	UPROPERTY()
+	int32 MaxObservationWeight;
+
+	/** Fused state keyed by voxel coordinate */
+	TMap<FIntVector, FBitmapPointFusionVoxel> Voxels;
+
+	/** Voxel of every stored fused point, used to drop state when points are removed */
+	TMap<int32, FIntVector> IdToVoxel;
+
+	/** Voxels of the points returned as new by the last FusePoints call */
+	TArray<FIntVector> PendingVoxels;
+
+	FIntVector ToVoxel(const FVector& Position) const;
+
+	/** Fold one sample into a voxel's running average */
+	void Accumulate(FBitmapPointFusionVoxel& Voxel, const FBitmapPoint& Point) const;
+
+	/** Build the stored point for a voxel */
+	static FBitmapPoint MakePoint(const FBitmapPointFusionVoxel& Voxel);
+};
@@ -3,9 +3,30 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "BitmapPointStorage.h"
+#include "BitmapPointPageStore.h"
 #include "BitmapPointMemoryManager.generated.h"
 
+class UMRTrackingStateManager;
+
+/**
+ * Which points the memory manager removes first when storage is over its point limit
+ * Every policy except Oldest groups points into cubic regions of EvictionRegionSize and ranks the regions
+ */
+UENUM(BlueprintType)
+enum class EBitmapPointEvictionPolicy : uint8
+{
+	/** First inserted points first */
+	Oldest UMETA(DisplayName = "Oldest"),
+	/** Regions that were neither queried nor observed for the longest time first */
+	LeastRecentlyUsed UMETA(DisplayName = "Least Recently Used"),
+	/** Regions farthest from the current camera pose first */
+	FarthestFromViewer UMETA(DisplayName = "Farthest From Viewer"),
+	/** Thin the densest regions down towards a common level, keeping sparse coverage intact */
+	DensityThinning UMETA(DisplayName = "Density Thinning")
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMemoryCleanup, int32, PointsRemoved, int32, MemoryFreedKB);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBitmapPointsEvicted, const TArray<int32>&, EvictedIds);
 
 /**
  * Memory management component for bitmap points with automatic cleanup
@@ -65,6 +86,71 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
 	int32 RemoveExcessPoints();
 
+	/**
+	 * Evict a number of points chosen by the eviction policy regardless of the configured limits
+	 * Evicted ids are reported through OnPointsEvicted like any other cleanup
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	int32 EvictPoints(int32 Count);
+
+	/**
+	 * Set which points are evicted first when over the point limit
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	void SetEvictionPolicy(EBitmapPointEvictionPolicy Policy);
+
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	EBitmapPointEvictionPolicy GetEvictionPolicy() const { return EvictionPolicy; }
+
+	/**
+	 * Set the edge length of the regions ranked by the region-based eviction policies
+	 * Usage recorded so far is dropped since it was keyed by the old regions
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	void SetEvictionRegionSize(float RegionSize);
+
+	/**
+	 * Page points out to an on-disk chunk store instead of deleting them when over the point limit
+	 * Chunks are eviction regions, the eviction policy picks which points leave just as it does for deletion.
+	 * Disabling drops whatever is still on disk, page it back in first to keep it.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	void SetPagingEnabled(bool bEnabled);
+
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	bool IsPagingEnabled() const { return PageStore.IsValid(); }
+
+	/** On-disk chunk store, null while paging is disabled */
+	const FBitmapPointPageStore* GetPageStore() const { return PageStore.Get(); }
+
+	/**
+	 * Take the paged-out points of every chunk overlapping a box off disk
+	 * The caller owns the points from then on and normally stores them again
+	 * @return Number of points appended to OutPoints
+	 */
+	int32 ReadPagedPoints(const FBox& Bounds, TArray<FBitmapPoint>& OutPoints);
+
+	/** Take every paged-out point off disk */
+	int32 ReadAllPagedPoints(TArray<FBitmapPoint>& OutPoints);
+
+	/** Number of points currently paged out to disk */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	int32 GetPagedOutPointCount() const;
+
+	/** Delete every paged-out point */
+	void ResetPagedPoints();
+
+	/**
+	 * Set the tracking state manager whose last known pose is the viewer for FarthestFromViewer
+	 */
+	void SetTrackingStateManager(UMRTrackingStateManager* InTrackingStateManager);
+
+	/**
+	 * Record that the regions touching a sphere were just used, for LeastRecentlyUsed
+	 * Observation is tracked through point timestamps, this covers regions that are only read
+	 */
+	void MarkRegionUsed(const FVector& Center, float Radius);
+
 	/**
 	 * Check if cleanup is needed
 	 */
@@ -94,6 +180,12 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "MRS3D|Memory")
 	FOnMemoryCleanup OnMemoryCleanup;
 
+	/**
+	 * Event fired with the storage ids of every point removed by an age or limit pass
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "MRS3D|Memory")
+	FOnBitmapPointsEvicted OnPointsEvicted;
+
 protected:
 	UPROPERTY()
 	UBitmapPointStorage* Storage;
@@ -111,6 +203,32 @@ protected:
 	UPROPERTY(Config)
 	float CleanupIntervalSeconds;
 
+	UPROPERTY(Config)
+	EBitmapPointEvictionPolicy EvictionPolicy;
+
+	/** Edge length of the regions ranked by region-based eviction policies */
+	UPROPERTY(Config)
+	float EvictionRegionSize;
+
+	/** Source of the viewer position for FarthestFromViewer */
+	UPROPERTY()
+	UMRTrackingStateManager* TrackingStateManager;
+
+	/** On-disk chunk store, only created while paging is enabled */
+	TUniquePtr<FBitmapPointPageStore> PageStore;
+
+	/** Largest query radius MarkRegionUsed honors, in regions */
+	static constexpr int32 MaxMarkedRegionRadius = 2;
+
+	/** Last time each region was queried, in FPlatformTime::Seconds like point timestamps */
+	TMap<FIntVector, double> RegionLastUsedTime;
+
+	/** How long region use times are kept when points have no age limit */
+	static constexpr double DefaultRegionUseHorizonSeconds = 600.0;
+
+	/** A cleanup shrinks storage once it removed at least 1/ShrinkRemovedFraction of the points */
+	static constexpr int32 ShrinkRemovedFraction = 4;
+
 	// Internal state
 	float LastCleanupTime;
 	int32 CleanupCount;
@@ -121,4 +239,54 @@ protected:
 	 * Internal cleanup logic
 	 */
 	int32 PerformCleanupInternal();
+
+	/**
+	 * Remove points chosen by the eviction policy without logging or statistics
+	 */
+	int32 EvictPointsInternal(int32 Count);
+
+	/** Stored points that share an eviction region */
+	struct FEvictionRegion
+	{
+		FIntVector Key = FIntVector::ZeroValue;
+
+		/** Storage ids in storage order, so oldest first */
+		TArray<int32> Ids;
+
+		float NewestTimestamp = 0.0f;
+
+		/** Rank under the eviction policy, lowest goes first */
+		double Score = 0.0;
+	};
+
+	/** Bucket every stored point into its eviction region */
+	void GatherEvictionRegions(TArray<FEvictionRegion>& OutRegions) const;
+
+	/** Drop region use times older than the age limit, they no longer change any ranking */
+	void PruneRegionUseTimes();
+
+	/** Whether the tracking state manager currently tracks a valid pose to measure FarthestFromViewer from */
+	bool HasViewerPose() const;
+
+	/** Sort regions by LeastRecentlyUsed, or by FarthestFromViewer when that policy is active and a pose is tracked */
+	void RankEvictionRegions(TArray<FEvictionRegion>& Regions) const;
+
+	/**
+	 * Choose the ids of points to evict under a region-based policy
+	 */
+	void SelectEvictionCandidates(int32 Count, TArray<int32>& OutIds) const;
+
+	/** Write the points the eviction policy picks to the page store, each to the chunk of its region */
+	int32 PageOutPoints(int32 Count);
+
+	/** Read and drop paged-out chunks */
+	int32 ReadPagedChunks(TConstArrayView<FIntVector> Keys, TArray<FBitmapPoint>& OutPoints);
+
+	/** Region containing a position */
+	FIntVector GetRegionKey(const FVector& Position) const;
+
+	/**
+	 * Broadcast the ids removed from storage since a given version
+	 */
+	void ReportEvictedPoints(int64 SinceVersion);
 };
\ No newline at end of file
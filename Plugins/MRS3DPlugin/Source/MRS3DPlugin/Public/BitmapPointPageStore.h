@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BitmapPoint.h"
+
+/**
+ * On-disk store for bitmap points paged out of memory, one file per cubic chunk
+ * Chunks are written as 20 byte FBitmapPointCompact records and read back through a memory-mapped view of their file,
+ * so paging a chunk in only touches that chunk's pages. Only the chunk directory stays resident.
+ */
+class MRS3DPLUGIN_API FBitmapPointPageStore
+{
+public:
+	/**
+	 * @param InRootDirectory - Folder the store creates its own uniquely named chunk folder in, removed again on destruction
+	 * @param InChunkSize - Chunk edge length in world units
+	 */
+	FBitmapPointPageStore(const FString& InRootDirectory, float InChunkSize);
+	~FBitmapPointPageStore();
+
+	/** Chunk containing a position */
+	FIntVector GetChunkKey(const FVector& Position) const;
+
+	/**
+	 * Page points out to a chunk, appending their records to any points already paged out there
+	 * @return False if the file could not be written, the points must then stay resident
+	 */
+	bool WriteChunk(const FIntVector& Key, TConstArrayView<FBitmapPoint> Points);
+
+	/**
+	 * Page a chunk back in and drop its file
+	 * A chunk whose file cannot be read is dropped as well, its points are lost
+	 * @return False if the chunk is not paged out or its file could not be read
+	 */
+	bool ReadChunk(const FIntVector& Key, TArray<FBitmapPoint>& OutPoints);
+
+	/** Collect the paged-out chunks overlapping a box */
+	void FindChunksInBox(const FBox& Bounds, TArray<FIntVector>& OutKeys) const;
+
+	/** Collect every paged-out chunk */
+	void GetChunkKeys(TArray<FIntVector>& OutKeys) const { ChunkPointCounts.GetKeys(OutKeys); }
+
+	/** Stamp of the last write to each paged-out chunk, stamps are never reused so an unchanged stamp means an unchanged file */
+	const TMap<FIntVector, int64>& GetChunkWriteStamps() const { return ChunkWriteStamps; }
+
+	/**
+	 * Copy the raw file of a paged-out chunk without paging it in, e.g. to save it with a session
+	 * @return False if the chunk is not paged out or its file could not be read
+	 */
+	bool CopyChunkFile(const FIntVector& Key, TArray<uint8>& OutBytes) const;
+
+	/**
+	 * Decode the points of a chunk file copied by CopyChunkFile
+	 * @return False if the bytes are not a complete chunk file of this format version
+	 */
+	static bool DecodeChunkFile(TConstArrayView<uint8> Bytes, TArray<FBitmapPoint>& OutPoints);
+
+	bool HasChunks() const { return ChunkPointCounts.Num() > 0; }
+
+	int32 GetNumChunks() const { return ChunkPointCounts.Num(); }
+
+	/** Number of points currently on disk */
+	int32 GetPagedPointCount() const { return PagedPointCount; }
+
+	float GetChunkSize() const { return ChunkSize; }
+
+	/** Delete every chunk file */
+	void Reset();
+
+private:
+	FString Directory;
+	float ChunkSize;
+
+	/** Points held by each paged-out chunk */
+	TMap<FIntVector, int32> ChunkPointCounts;
+	int32 PagedPointCount;
+
+	/** Stamp of the last write to each paged-out chunk */
+	TMap<FIntVector, int64> ChunkWriteStamps;
+	int64 LastWriteStamp;
+
+	FString GetChunkFilename(const FIntVector& Key) const;
+
+	/** Decode a chunk file through a memory-mapped view without dropping it */
+	bool ReadChunkFile(const FIntVector& Key, TArray<FBitmapPoint>& OutPoints) const;
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "BitmapPointStorage.h"
+#include "PlaneDetection.h"
+#include "BitmapPointPlaneTracker.generated.h"
+
+class UPlaneDetectionSubsystem;
+
+/**
+ * Least-squares moments of the points assigned to one tracked plane
+ * Points join and leave by adding or subtracting their moments, so a refit never revisits the members
+ */
+struct FBitmapPointPlaneFit
+{
+	/** Plane as last reported to the plane detection subsystem */
+	FDetectedPlane Plane;
+
+	/** Number of member points */
+	int32 Count;
+
+	/** Sum of member positions */
+	FVector Sum;
+
+	/** Sums of the XX, XY, XZ, YY, YZ and ZZ position products */
+	double SumProducts[6];
+
+	/** Whether members changed since the last refit */
+	bool bDirty;
+
+	FBitmapPointPlaneFit()
+		: Count(0)
+		, Sum(FVector::ZeroVector)
+		, SumProducts{}
+		, bDirty(false)
+	{}
+
+	/** Add a member position, or remove it with a sign of -1 */
+	void Accumulate(const FVector& Position, double Sign);
+
+	/** Re-estimate center, normal and extent from the moments */
+	void Refit();
+};
+
+/**
+ * Tracked plane a stored point belongs to, with the position it was accumulated at
+ */
+struct FBitmapPointPlaneMember
+{
+	int32 PlaneSlot;
+	FVector Position;
+};
+
+/**
+ * Keeps detected planes up to date from storage change sets instead of rerunning detection over every point
+ * Added points join the plane they lie on and removed points leave it, then only the touched planes are refit.
+ * RANSAC detection runs over the points no plane claimed, and only once enough of them have accumulated.
+ */
+UCLASS(BlueprintType)
+class FMRS3DPLUGIN_API UBitmapPointPlaneTracker : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UBitmapPointPlaneTracker();
+
+	/**
+	 * Queue the added, updated and removed points of a storage change set for the next Update
+	 */
+	void HandleChangeSet(const FBitmapPointChangeSet& ChangeSet);
+
+	/**
+	 * Queue every point already in storage, for tracking that starts on a populated storage
+	 */
+	void SeedFromStorage(const UBitmapPointStorage* Storage);
+
+	/**
+	 * Apply the queued changes to the tracked planes and publish the planes that changed
+	 * @param MinPointsForDetection - Unclaimed points that must accumulate before detection looks for new planes
+	 * @return Number of planes found, refit or lost
+	 */
+	int32 Update(const UBitmapPointStorage* Storage, UPlaneDetectionSubsystem* PlaneDetection, int32 MinPointsForDetection);
+
+	/**
+	 * Whether any change is waiting for the next Update
+	 */
+	bool HasPendingChanges() const { return bPendingClear || PendingAddedIds.Num() > 0 || PendingRemovedIds.Num() > 0; }
+
+	/**
+	 * Set the largest distance from a plane at which a point still belongs to it
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|PlaneDetection")
+	void SetPlaneThickness(float InPlaneThickness);
+
+	/**
+	 * Get the number of tracked planes
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|PlaneDetection")
+	int32 GetNumTrackedPlanes() const { return Planes.Num(); }
+
+	/**
+	 * Drop all tracking state, removing the tracked planes from PlaneDetection when given
+	 */
+	void Reset(UPlaneDetectionSubsystem* PlaneDetection = nullptr);
+
+	/**
+	 * Get memory usage in bytes
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|PlaneDetection")
+	int32 GetMemoryUsageBytes() const;
+
+	/** Fewest members a plane keeps before it is dropped, matches the detection minimum */
+	static constexpr int32 MinPlanePoints = 10;
+
+protected:
+	/** Largest distance from a plane at which a point belongs to it */
+	UPROPERTY()
+	float PlaneThickness;
+
+	/** How far past its current extent a plane may grow in one step */
+	UPROPERTY()
+	float PlaneGrowthMargin;
+
+	/** Tracked planes by slot */
+	TMap<int32, FBitmapPointPlaneFit> Planes;
+
+	/** Slot handed to the next tracked plane */
+	int32 NextPlaneSlot;
+
+	/** Plane membership of every claimed point, keyed by storage id */
+	TMap<int32, FBitmapPointPlaneMember> Members;
+
+	/** Stored points no plane claimed */
+	TSet<int32> UnassignedIds;
+
+	/** Unclaimed point count after the last detection, detection reruns once it has grown by the minimum again */
+	int32 UnassignedAtLastDetection;
+
+	/** Changes queued since the last Update */
+	TArray<int32> PendingAddedIds;
+	TArray<int32> PendingRemovedIds;
+	bool bPendingClear;
+
+	/** Remove a point from its plane or from the unclaimed set */
+	void RemoveMember(int32 Id);
+
+	/** Add a point to the closest plane it lies on, or to the unclaimed set */
+	void AssignPoint(int32 Id, const FVector& Position);
+
+	/** Look for new planes among the unclaimed points and claim their inliers */
+	int32 DetectNewPlanes(const UBitmapPointStorage* Storage, UPlaneDetectionSubsystem* PlaneDetection);
+
+	/** Drop a plane, returning its members to the unclaimed set */
+	void DropPlane(int32 PlaneSlot, UPlaneDetectionSubsystem* PlaneDetection);
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BitmapPoint.h"
+#include "BitmapPointCompact.h"
+#include "BitmapPointVoxelHash.h"
+
+/**
+ * Immutable group of points covering one cube of space in a snapshot
+ * Pages that did not change are shared between consecutive snapshots
+ */
+struct MRS3DPLUGIN_API FBitmapPointSnapshotPage
+{
+	/** Page coordinate in units of the snapshot page size */
+	FIntVector Coord;
+
+	/** Frame the page points are encoded against, centered on the page */
+	FBitmapPointQuantizer Quantizer;
+
+	/** Compact copies of the points inside the page */
+	TArray<FBitmapPointCompact> Points;
+};
+
+/**
+ * Read-only view of the indexed points at one storage version
+ * Points are held as FBitmapPointCompact and decoded as they are visited.
+ * Snapshots are reference counted and never modified after publishing, so any thread may query one without locks
+ * while the game thread keeps ingesting. Memory is reclaimed once the last reader releases it.
+ */
+class MRS3DPLUGIN_API FBitmapPointSnapshot
+{
+public:
+	typedef TSharedRef<const FBitmapPointSnapshotPage, ESPMode::ThreadSafe> FPageRef;
+
+	FBitmapPointSnapshot();
+
+	/** Storage version the snapshot was published at */
+	int64 GetVersion() const { return Version; }
+
+	/** Number of points in the snapshot */
+	int32 GetNumPoints() const { return NumPoints; }
+
+	/** Edge length of a page in world units */
+	float GetPageSize() const { return PageSize; }
+
+	/** Number of non-empty pages */
+	int32 GetNumPages() const { return Pages.Num(); }
+
+	/**
+	 * Visit every point
+	 * Visitor signature is bool(const FBitmapPoint& Point), return false to stop
+	 * @return False if the visitor stopped early
+	 */
+	template<typename VisitorType>
+	bool ForEachPoint(VisitorType&& Visitor) const;
+
+	/** Visit every point inside a bounding box, same visitor signature as ForEachPoint */
+	template<typename VisitorType>
+	bool ForEachPointInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const;
+
+	/** Visit every point within radius of a location, same visitor signature as ForEachPoint */
+	template<typename VisitorType>
+	bool ForEachPointInRadius(const FVector& Location, float Radius, VisitorType&& Visitor) const;
+
+	/** Collect every point within radius of a location, OutPoints is reset but keeps its allocation */
+	void FindPointsInRadius(const FVector& Location, float Radius, TArray<FBitmapPoint>& OutPoints) const;
+
+	/** Copy every point into a flat array for consumers that need one */
+	void CopyPoints(TArray<FBitmapPoint>& OutPoints) const;
+
+	/** Bytes owned by this snapshot, including pages shared with other snapshots */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	friend class UBitmapPointSpatialIndex;
+
+	int64 Version;
+	int32 NumPoints;
+	float PageSize;
+
+	/** Top-level cell size of the index the snapshot was taken from, pages are its bricks */
+	float CellSize;
+
+	TMap<FIntVector, FPageRef> Pages;
+
+	/** Page containing a position, matching how the index assigns cells to bricks */
+	FIntVector ToPage(const FVector& Position) const
+	{
+		return FBitmapPointVoxelHash::CellToBrick(FIntVector(
+			FMath::FloorToInt(Position.X / CellSize),
+			FMath::FloorToInt(Position.Y / CellSize),
+			FMath::FloorToInt(Position.Z / CellSize)));
+	}
+
+	/** Visit the pages overlapping a bounding box */
+	template<typename VisitorType>
+	bool ForEachPageInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const;
+};
+
+typedef TSharedRef<const FBitmapPointSnapshot, ESPMode::ThreadSafe> FBitmapPointSnapshotRef;
+
+template<typename VisitorType>
+bool FBitmapPointSnapshot::ForEachPoint(VisitorType&& Visitor) const
+{
+	for (const TPair<FIntVector, FPageRef>& PagePair : Pages)
+	{
+		const FBitmapPointSnapshotPage& Page = *PagePair.Value;
+		for (const FBitmapPointCompact& Point : Page.Points)
+		{
+			if (!Visitor(Page.Quantizer.Decode(Point)))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+template<typename VisitorType>
+bool FBitmapPointSnapshot::ForEachPageInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const
+{
+	if (Pages.Num() == 0)
+	{
+		return true;
+	}
+
+	const FIntVector MinPage = ToPage(MinBounds);
+	const FIntVector MaxPage = ToPage(MaxBounds);
+	const int64 RangePages = int64(MaxPage.X - MinPage.X + 1) * int64(MaxPage.Y - MinPage.Y + 1) * int64(MaxPage.Z - MinPage.Z + 1);
+
+	// Walk the pages directly when the box covers more of space than there are pages
+	if (RangePages > Pages.Num())
+	{
+		for (const TPair<FIntVector, FPageRef>& PagePair : Pages)
+		{
+			const FIntVector& Coord = PagePair.Key;
+			if (Coord.X >= MinPage.X && Coord.X <= MaxPage.X &&
+				Coord.Y >= MinPage.Y && Coord.Y <= MaxPage.Y &&
+				Coord.Z >= MinPage.Z && Coord.Z <= MaxPage.Z &&
+				!Visitor(*PagePair.Value))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	for (int32 Z = MinPage.Z; Z <= MaxPage.Z; Z++)
+	{
+		for (int32 Y = MinPage.Y; Y <= MaxPage.Y; Y++)
+		{
+			for (int32 X = MinPage.X; X <= MaxPage.X; X++)
+			{
+				const FPageRef* Page = Pages.Find(FIntVector(X, Y, Z));
+				if (Page && !Visitor(**Page))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+template<typename VisitorType>
+bool FBitmapPointSnapshot::ForEachPointInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const
+{
+	return ForEachPageInBox(MinBounds, MaxBounds, [&MinBounds, &MaxBounds, &Visitor](const FBitmapPointSnapshotPage& Page) {
+		for (const FBitmapPointCompact& Point : Page.Points)
+		{
+			const FVector Position = Page.Quantizer.DecodePosition(Point);
+			if (Position.X >= MinBounds.X && Position.X <= MaxBounds.X &&
+				Position.Y >= MinBounds.Y && Position.Y <= MaxBounds.Y &&
+				Position.Z >= MinBounds.Z && Position.Z <= MaxBounds.Z &&
+				!Visitor(Page.Quantizer.Decode(Point)))
+			{
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
+template<typename VisitorType>
+bool FBitmapPointSnapshot::ForEachPointInRadius(const FVector& Location, float Radius, VisitorType&& Visitor) const
+{
+	const float RadiusSquared = Radius * Radius;
+
+	return ForEachPageInBox(Location - FVector(Radius), Location + FVector(Radius), [&Location, RadiusSquared, &Visitor](const FBitmapPointSnapshotPage& Page) {
+		for (const FBitmapPointCompact& Point : Page.Points)
+		{
+			if (FVector::DistSquared(Page.Quantizer.DecodePosition(Point), Location) <= RadiusSquared && !Visitor(Page.Quantizer.Decode(Point)))
+			{
+				return false;
+			}
+		}
+		return true;
+	});
+}
@@ -3,14 +3,21 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "BitmapPoint.h"
+#include "BitmapPointStorage.h"
+#include "BitmapPointVoxelHash.h"
+#include "BitmapPointSnapshot.h"
+#include "BitmapPointChunkGrid.h"
 #include "Components/ActorComponent.h"
 #include "BitmapPointSpatialIndex.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSpatialIndexUpdated, int32, AddedPoints, int32, RemovedPoints);
+DECLARE_DELEGATE_OneParam(FOnSpatialIndexQueried, const FBox&);
 
 /**
  * Spatial index for efficient bitmap point queries
  * Provides fast radius-based searches and nearest neighbor queries
+ * Cells hold storage point ids and positions only, full points are resolved from the backing storage
+ * Cells holding more than MaxPointsPerCell points are split octree-style into finer grid depths
  */
 UCLASS(BlueprintType, Blueprintable, meta = (BlueprintSpawnableComponent))
 class MRS3DPLUGIN_API UBitmapPointSpatialIndex : public UActorComponent
@@ -24,18 +31,64 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
 	void Initialize(float InCellSize = 100.0f, const FVector& InWorldBounds = FVector(10000.0f));
 
-	/** Add a single point to the spatial index */
+	/**
+	 * Bind the storage that indexed ids refer to
+	 * Without a bound storage the index creates its own on first add
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
+	void SetStorage(UBitmapPointStorage* InStorage);
+
+	/** Get the storage that indexed ids refer to */
+	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
+	UBitmapPointStorage* GetStorage() const { return Storage; }
+
+	/**
+	 * Set the edge length of the chunks the indexed points are partitioned into
+	 * Indexed points are re-counted, every chunk is reported as changed
+	 */
+	void SetChunkSize(float InChunkSize);
+
+	/**
+	 * Chunks of the indexed points, kept in step with every insert and removal
+	 * Per-chunk consumers query the points of a chunk with ForEachPointInBox over GetChunkBounds
+	 */
+	FBitmapPointChunkGrid& GetChunkGrid() { return ChunkGrid; }
+	const FBitmapPointChunkGrid& GetChunkGrid() const { return ChunkGrid; }
+
+	/** Add a single point to the backing storage and index it */
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
 	void AddPoint(const FBitmapPoint& Point);
 
-	/** Add multiple points to the spatial index */
+	/** Add multiple points to the backing storage and index them */
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
 	void AddPoints(const TArray<FBitmapPoint>& Points);
 
+	/**
+	 * Index points that are already in the backing storage
+	 * @param StartIndex - Storage index of the first point to index
+	 * @param Count - Number of consecutive points to index
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
+	void AddStoredPoints(int32 StartIndex, int32 Count);
+
 	/** Remove a point from the spatial index */
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
 	bool RemovePoint(const FBitmapPoint& Point);
 
+	/** Remove a point from the spatial index by storage id in constant time */
+	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
+	bool RemovePointById(int32 Id);
+
+	/** Remove points from the spatial index by storage id, each in constant time */
+	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
+	int32 RemovePointsById(const TArray<int32>& Ids);
+
+	/**
+	 * Re-read stored points by id after their positions were updated in storage and move them to their new cells
+	 * Ids that are not indexed or no longer stored are dropped from the index
+	 */
+	void RefreshStoredPoints(const TArray<int32>& Ids);
+
 	/** Remove points matching a predicate */
 	template<typename Predicate>
 	int32 RemovePointsWhere(Predicate Pred);
@@ -60,9 +113,90 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
 	TArray<FBitmapPoint> FindPointsInBox(const FVector& MinBounds, const FVector& MaxBounds) const;
 
-	/** Get points along a ray with tolerance */
+	/**
+	 * Get points along a ray with tolerance
+	 * @param bSortByDistance - Order hits by distance along the ray, nearest first
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
-	TArray<FBitmapPoint> FindPointsAlongRay(const FVector& Origin, const FVector& Direction, float Tolerance = 10.0f, float MaxDistance = 1000.0f) const;
+	TArray<FBitmapPoint> FindPointsAlongRay(const FVector& Origin, const FVector& Direction, float Tolerance = 10.0f, float MaxDistance = 1000.0f, bool bSortByDistance = false) const;
+
+	/**
+	 * Visit every indexed point within radius of a location without allocating
+	 * Visitor signature is bool(int32 Id, const FVector3f& Position), return false to stop.
+	 * Resolve full points through GetStorage()->GetPointById only when needed.
+	 * @return False if the visitor stopped early
+	 */
+	template<typename VisitorType>
+	bool ForEachPointInRadius(const FVector& Location, float Radius, VisitorType&& Visitor) const;
+
+	/** Visit every indexed point inside a bounding box, same visitor signature as ForEachPointInRadius */
+	template<typename VisitorType>
+	bool ForEachPointInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const;
+
+	/**
+	 * ForEachPointInBox over the resident points only, without firing OnQueryBounds
+	 * For callers that paged in what they need up front, e.g. the margins around a meshed chunk
+	 */
+	template<typename VisitorType>
+	bool ForEachResidentPointInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const
+	{
+		return VisitPointsInBox(MinBounds, MaxBounds, Forward<VisitorType>(Visitor));
+	}
+
+	/**
+	 * Visit every indexed point within tolerance of a ray, same visitor signature as ForEachPointInRadius
+	 * Cells are walked with a 3D DDA along the ray, so hits arrive roughly, but not strictly, in ray order
+	 */
+	template<typename VisitorType>
+	bool ForEachPointAlongRay(const FVector& Origin, const FVector& Direction, float Tolerance, float MaxDistance, VisitorType&& Visitor) const;
+
+	/**
+	 * Output-buffer variants of the queries above
+	 * The buffer is reset but keeps its allocation, so reusing one across calls avoids reallocating
+	 */
+	void FindPointsInRadius(const FVector& Location, float Radius, TArray<FBitmapPoint>& OutPoints) const;
+	void FindPointsInBox(const FVector& MinBounds, const FVector& MaxBounds, TArray<FBitmapPoint>& OutPoints) const;
+	void FindPointsAlongRay(const FVector& Origin, const FVector& Direction, float Tolerance, float MaxDistance, TArray<FBitmapPoint>& OutPoints, bool bSortByDistance = false) const;
+	void FindKNearestPoints(const FVector& Location, int32 K, float MaxDistance, TArray<FBitmapPoint>& OutPoints) const;
+
+	/** Collect ids instead of points, skipping the storage lookup per result */
+	void FindPointIdsInRadius(const FVector& Location, float Radius, TArray<int32>& OutIds) const;
+	void FindKNearestPointIds(const FVector& Location, int32 K, float MaxDistance, TArray<int32>& OutIds) const;
+
+	/** Find the id of the nearest point to a location, or INDEX_NONE */
+	int32 FindNearestPointId(const FVector& Location, float MaxDistance = 1000.0f) const;
+
+	/**
+	 * Run independent radius queries in parallel, one output array per center
+	 * Small batches run on the calling thread. The index must not be modified while a batch runs.
+	 */
+	void FindPointsInRadiusBatch(TConstArrayView<FVector> Centers, float Radius, TArray<TArray<FBitmapPoint>>& OutPointsPerQuery) const;
+	void FindPointIdsInRadiusBatch(TConstArrayView<FVector> Centers, float Radius, TArray<TArray<int32>>& OutIdsPerQuery) const;
+
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Check that a scalar per-point loop, the vectorized single-query path and the parallel batch path return the same ids
+	 * Queries are centered on randomly chosen indexed points, run it with the MRS3D.VerifyRadiusQueries console command
+	 * @return Number of queries whose results disagreed
+	 */
+	int32 VerifyRadiusQueries(int32 NumQueries, float Radius) const;
+#endif
+
+	/**
+	 * Publish the indexed points as an immutable snapshot, or return the previous one if nothing changed
+	 * Call on the game thread and hand the result to workers, which can query it without locks while ingestion continues.
+	 * Only top-level bricks touched since the previous snapshot are rebuilt, every other page is shared with it.
+	 */
+	FBitmapPointSnapshotRef AcquireSnapshot();
+
+	/** Bytes held by the most recently published snapshot, pages still shared with readers included */
+	int32 GetSnapshotMemoryUsageBytes() const;
+
+	/**
+	 * Drop the index's reference to its last snapshot, readers holding it are unaffected
+	 * The next AcquireSnapshot rebuilds every page
+	 */
+	void ReleaseSnapshot();
 
 	/** Get the total number of indexed points */
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
@@ -76,16 +210,36 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
 	void GetSpatialStats(int32& ActiveCells, int32& MaxPointsPerCell, float& AveragePointsPerCell) const;
 
-	/** Rebuild the spatial index (useful after major changes) */
+	/** Rebuild the spatial index from every point in the backing storage */
 	UFUNCTION(BlueprintCallable, Category = "Spatial Index")
 	void Rebuild();
 
+	/**
+	 * Export the adaptive grid layout, the subdivided cells of every depth
+	 * Together with the cell sizes this is enough for RebuildWithLayout to place points straight into their leaves
+	 */
+	void GetLayout(float& OutCellSize, float& OutMinCellSize, TArray<FIntVector>& OutCells, TArray<int32>& OutCellLevels) const;
+
+	/**
+	 * Rebuild from the backing storage with a previously exported layout, skipping the cascade of cell splits
+	 * @return False if the layout was exported with other cell sizes, the index is then rebuilt normally
+	 */
+	bool RebuildWithLayout(float InCellSize, float InMinCellSize, const TArray<FIntVector>& Cells, const TArray<int32>& CellLevels);
+
 	/** Event fired when spatial index is updated */
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnSpatialIndexUpdated OnSpatialIndexUpdated;
 
+	/**
+	 * Called with the bounds of every query before it reads the index
+	 * The owner may add points in those bounds (e.g. page them in from disk), queries then see them.
+	 * Only fired for queries issued on the game thread, queries from other threads see whatever is resident.
+	 * Batch queries fire it once for the union of their bounds before fanning out, their workers never fire it.
+	 */
+	FOnSpatialIndexQueried OnQueryBounds;
+
 protected:
-	/** Size of each spatial grid cell */
+	/** Size of each top-level spatial grid cell */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configuration")
 	float CellSize;
 
@@ -93,101 +247,424 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configuration")
 	FVector WorldBounds;
 
-	/** Maximum points per cell before subdivision (future optimization) */
+	/**
+	 * Maximum points per cell before the cell is split into eight children (0 = never subdivide)
+	 * Subdivided cells merge back once fewer than half this many points remain below them
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configuration")
 	int32 MaxPointsPerCell;
 
+	/** Smallest cell size subdivision may reach, applied on Initialize */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configuration")
+	float MinCellSize;
+
+	/** Storage that indexed ids refer to */
+	UPROPERTY()
+	UBitmapPointStorage* Storage;
+
+	/** Whether Storage was created by this index rather than bound from outside */
+	bool bOwnsStorage;
+
 private:
-	/** Spatial grid structure */
-	struct FSpatialCell
+	/**
+	 * One depth of the adaptive grid, cells at depth N are CellSize / 2^N wide
+	 * A point lives at the shallowest depth whose cell around it is not subdivided
+	 */
+	struct FGridLevel
 	{
-		TArray<FBitmapPoint> Points;
-		
-		FSpatialCell() = default;
-		
-		void AddPoint(const FBitmapPoint& Point)
-		{
-			Points.Add(Point);
-		}
-		
-		bool RemovePoint(const FBitmapPoint& Point)
-		{
-			return Points.RemoveSingle(Point) > 0;
-		}
-		
-		void Clear()
-		{
-			Points.Empty();
-		}
-		
-		bool IsEmpty() const
-		{
-			return Points.Num() == 0;
-		}
+		/** Sparse voxel grid holding ids and positions of points that live at this depth */
+		FBitmapPointVoxelHash VoxelHash;
+
+		/** Cell size at this depth */
+		float CellSize;
+
+		/** Cells split into the next depth, with the number of points anywhere below each */
+		TMap<FIntVector, int32> SubdividedCells;
+
+		/** SubdividedCells grouped by the top-level brick containing them */
+		TMap<FIntVector, TArray<FIntVector>> SubdividedCellsByBrick;
 	};
 
-	/** 3D grid of spatial cells */
-	TMap<FIntVector, FSpatialCell> SpatialGrid;
+	/** Grid depths, at least one */
+	TArray<FGridLevel> Levels;
+
+	/** Batches smaller than this are not worth the task dispatch overhead */
+	static constexpr int32 MinParallelBatchSize = 16;
+
+	/** Hard cap on grid depths, coordinates at the deepest level must still fit the voxel hash */
+	static constexpr int32 MaxLevels = 8;
+
+	/** Locations pack the depth above the payload slot */
+	static constexpr int32 LocationLevelShift = 27;
+	static constexpr int32 LocationSlotMask = (1 << LocationLevelShift) - 1;
+
+	/** Ids per page of the location table */
+	static constexpr int32 LocationPageShift = 8;
+	static constexpr int32 LocationPageSize = 1 << LocationPageShift;
+
+	/** Packed locations of a run of consecutive ids */
+	struct FLocationPage
+	{
+		/** One entry per id in the run, INDEX_NONE where the id is not indexed */
+		TArray<int32> Entries;
+
+		/** Number of entries that are not INDEX_NONE */
+		int32 NumLive = 0;
+	};
+
+	/**
+	 * Depth and payload slot of every indexed id, keyed by Id >> LocationPageShift
+	 * Storage ids only grow, so runs of ids share a page instead of a per-point hash entry,
+	 * and a page is freed with its last id so long-lived survivors never pin the ids issued after them
+	 */
+	TMap<int32, FLocationPage> LocationPages;
 
 	/** Total number of points in the index */
 	int32 TotalPointCount;
 
-	/** Convert world position to grid coordinates */
-	FIntVector WorldToGrid(const FVector& WorldPos) const;
+	/** Most recently published snapshot, unset until the first AcquireSnapshot */
+	TSharedPtr<const FBitmapPointSnapshot, ESPMode::ThreadSafe> LatestSnapshot;
+
+	/** Top-level bricks changed since LatestSnapshot was published */
+	TSet<FIntVector> DirtySnapshotPages;
+
+	/** Whether the next snapshot has to be rebuilt from scratch */
+	bool bSnapshotFullyDirty;
+
+	/** Point counts and change stamps of the world chunks */
+	FBitmapPointChunkGrid ChunkGrid;
+
+	/** Record that the snapshot page containing a position changed */
+	void MarkSnapshotDirty(const FVector& Position);
+
+	/** Encode the points inside one top-level brick into a new page, or return null if there are none */
+	TSharedPtr<const FBitmapPointSnapshotPage, ESPMode::ThreadSafe> BuildSnapshotPage(const FIntVector& Brick) const;
+
+	/** Create an internal storage if none is bound */
+	UBitmapPointStorage* GetOrCreateStorage();
 
-	/** Convert grid coordinates to world position */
-	FVector GridToWorld(const FIntVector& GridPos) const;
+	/** Rebuild Levels from CellSize and MinCellSize, dropping every indexed point */
+	void ConfigureLevels();
 
-	/** Get all grid cells that intersect with a sphere */
-	TArray<FIntVector> GetCellsInSphere(const FVector& Center, float Radius) const;
+	/** Insert an id into its cell and record its location */
+	void InsertPoint(int32 Id, const FVector& Position);
 
-	/** Get all grid cells that intersect with a bounding box */
-	TArray<FIntVector> GetCellsInBox(const FVector& MinBounds, const FVector& MaxBounds) const;
+	/** Remove an indexed id from its cell and forget its location */
+	bool RemoveIndexedPoint(int32 Id);
 
-	/** Get cell for a world position, creating if necessary */
-	FSpatialCell& GetOrCreateCell(const FIntVector& GridPos);
+	/** Get the packed location of an indexed id, or nullptr if it is not indexed */
+	int32* FindLocation(int32 Id);
+
+	/** Record the packed location of an id, adding its page if needed */
+	void SetLocation(int32 Id, int32 Location);
+
+	/** Forget the location of an indexed id, freeing its page once empty */
+	void ClearLocation(int32 Id);
+
+	/** Depth at which a position currently lives */
+	int32 FindLeafLevel(const FVector& Position) const;
+
+	/** Fire OnQueryBounds ahead of a query, skipped off the game thread where the owner must not modify the index */
+	void NotifyQueryBounds(const FBox& Bounds) const;
+
+	/** Fire OnQueryBounds once with the union of a batch of radius queries */
+	void NotifyBatchQueryBounds(TConstArrayView<FVector> Centers, float Radius) const;
+
+	/** ForEachPointInRadius without firing OnQueryBounds, for the per-query work of batches */
+	template<typename VisitorType>
+	bool VisitPointsInRadius(const FVector& Location, float Radius, VisitorType&& Visitor) const;
+
+	/** ForEachPointInBox without firing OnQueryBounds */
+	template<typename VisitorType>
+	bool VisitPointsInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const;
+
+	/** Add an id to a depth and record its location */
+	void AddToLevel(int32 Level, int32 Id, const FVector3f& Position);
+
+	/** Remove the point at a packed location from its depth, fixing up whichever point moved into its slot */
+	void RemoveFromLevel(int32 Location);
+
+	/** Push every point of an overfull cell one depth down, splitting children that are still overfull */
+	void SplitCell(int32 Level, const FIntVector& Cell);
+
+	/** Pull every point below a subdivided cell back into it */
+	void MergeCell(int32 Level, const FIntVector& Cell);
+
+	/** Mark a cell as split into the next depth */
+	void AddSubdividedCell(int32 Level, const FIntVector& Cell, int32 PointCount);
+
+	/** Top-level brick containing a cell of a depth */
+	static FIntVector GetTopLevelBrick(int32 Level, const FIntVector& Cell)
+	{
+		const int32 Shift = Level + 2;
+		return FIntVector(Cell.X >> Shift, Cell.Y >> Shift, Cell.Z >> Shift);
+	}
 
-	/** Get cell for a world position (const version) */
-	const FSpatialCell* GetCell(const FIntVector& GridPos) const;
+	/**
+	 * Visit every occupied cell at any depth inside one top-level brick
+	 * Finer depths are only probed below the subdivided cells of the brick, never across the whole depth
+	 * Visitor signature is bool(const FGridLevel& Level, const FIntVector& GridPos, const FVoxelCellRef& CellRef), return false to stop
+	 */
+	template<typename VisitorType>
+	bool ForEachCellInTopLevelBrick(const FIntVector& Brick, VisitorType&& Visitor) const;
 
-	/** Helper function to check if a point is within distance */
-	bool IsPointInRadius(const FBitmapPoint& Point, const FVector& Center, float Radius) const;
+	static int32 MakeLocation(int32 Level, int32 Slot) { return (Level << LocationLevelShift) | Slot; }
+	static int32 GetLocationLevel(int32 Location) { return Location >> LocationLevelShift; }
+	static int32 GetLocationSlot(int32 Location) { return Location & LocationSlotMask; }
 
-	/** Helper function to get squared distance between point and location */
-	float GetSquaredDistance(const FBitmapPoint& Point, const FVector& Location) const;
+	/**
+	 * Pass the ids of the K nearest points to Sink, closest first
+	 * Top-level bricks are searched in shells of increasing distance until no unvisited shell can beat the K-th candidate
+	 */
+	template<typename SinkType>
+	void ForEachKNearestId(const FVector& Location, int32 K, float MaxDistance, SinkType&& Sink) const;
+
+	/** Copy a point out of the backing storage by id */
+	bool ResolvePoint(int32 Id, FBitmapPoint& OutPoint) const;
+
+	/** Convert world position to grid coordinates at a given cell size */
+	FIntVector WorldToGrid(const FVector& WorldPos, float InCellSize) const;
+
+	/** Convert grid coordinates at a given cell size to world position */
+	FVector GridToWorld(const FIntVector& GridPos, float InCellSize) const;
+
+	/** Squared distance from a location to the nearest point of a grid cell */
+	float GetSquaredDistanceToCell(const FIntVector& GridPos, float InCellSize, const FVector& Location) const;
 };
 
 template<typename Predicate>
 int32 UBitmapPointSpatialIndex::RemovePointsWhere(Predicate Pred)
 {
+	TArray<int32> IdsToRemove;
+
+	for (const FGridLevel& Level : Levels)
+	{
+		Level.VoxelHash.ForEachCell([this, &Level, &Pred, &IdsToRemove](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+			return Level.VoxelHash.ForEachSpan(CellRef, [this, &Pred, &IdsToRemove](const FVoxelPointSpan& Span) {
+				for (int32 Lane = 0; Lane < Span.Num; Lane++)
+				{
+					FBitmapPoint Point;
+					if (ResolvePoint(Span.Ids[Lane], Point) && Pred(Point))
+					{
+						IdsToRemove.Add(Span.Ids[Lane]);
+					}
+				}
+				return true;
+			});
+		});
+	}
+
 	int32 RemovedCount = 0;
-	
-	for (auto& GridPair : SpatialGrid)
+	for (int32 Id : IdsToRemove)
 	{
-		FSpatialCell& Cell = GridPair.Value;
-		const int32 InitialCount = Cell.Points.Num();
-		
-		Cell.Points.RemoveAll(Pred);
-		
-		const int32 CellRemovedCount = InitialCount - Cell.Points.Num();
-		RemovedCount += CellRemovedCount;
+		RemovedCount += RemoveIndexedPoint(Id) ? 1 : 0;
 	}
-	
-	// Remove empty cells to save memory
-	for (auto It = SpatialGrid.CreateIterator(); It; ++It)
+
+	if (bOwnsStorage && Storage)
 	{
-		if (It.Value().IsEmpty())
-		{
-			It.RemoveCurrent();
-		}
+		Storage->RemovePointsById(IdsToRemove);
 	}
-	
-	TotalPointCount -= RemovedCount;
-	
+
 	if (RemovedCount > 0)
 	{
 		OnSpatialIndexUpdated.Broadcast(0, RemovedCount);
 	}
-	
+
 	return RemovedCount;
-}
\ No newline at end of file
+}
+
+template<typename VisitorType>
+bool UBitmapPointSpatialIndex::ForEachPointInRadius(const FVector& Location, float Radius, VisitorType&& Visitor) const
+{
+	NotifyQueryBounds(FBox(Location - FVector(Radius), Location + FVector(Radius)));
+	return VisitPointsInRadius(Location, Radius, Forward<VisitorType>(Visitor));
+}
+
+template<typename VisitorType>
+bool UBitmapPointSpatialIndex::VisitPointsInRadius(const FVector& Location, float Radius, VisitorType&& Visitor) const
+{
+	const float RadiusSquared = Radius * Radius;
+	const FVector3f Center(Location);
+
+	for (const FGridLevel& Level : Levels)
+	{
+		if (Level.VoxelHash.GetNumPoints() == 0)
+		{
+			continue;
+		}
+
+		const bool bCompleted = Level.VoxelHash.ForEachCellInRange(
+			WorldToGrid(Location - FVector(Radius), Level.CellSize), WorldToGrid(Location + FVector(Radius), Level.CellSize),
+			[this, &Level, &Location, &Center, RadiusSquared, &Visitor](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+				// Skip corner cells of the bounding range that the sphere does not reach
+				if (GetSquaredDistanceToCell(GridPos, Level.CellSize, Location) > RadiusSquared)
+				{
+					return true;
+				}
+
+				return Level.VoxelHash.ForEachSpan(CellRef, [&Center, RadiusSquared, &Visitor](const FVoxelPointSpan& Span) {
+					for (uint32 Mask = Span.GetLanesInSphere(Center, RadiusSquared); Mask; Mask &= Mask - 1)
+					{
+						const int32 Lane = static_cast<int32>(FMath::CountTrailingZeros(Mask));
+						if (!Visitor(Span.Ids[Lane], FVector3f(Span.X[Lane], Span.Y[Lane], Span.Z[Lane])))
+						{
+							return false;
+						}
+					}
+					return true;
+				});
+			});
+
+		if (!bCompleted)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<typename VisitorType>
+bool UBitmapPointSpatialIndex::ForEachPointInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const
+{
+	NotifyQueryBounds(FBox(MinBounds, MaxBounds));
+	return VisitPointsInBox(MinBounds, MaxBounds, Forward<VisitorType>(Visitor));
+}
+
+template<typename VisitorType>
+bool UBitmapPointSpatialIndex::VisitPointsInBox(const FVector& MinBounds, const FVector& MaxBounds, VisitorType&& Visitor) const
+{
+	const FVector3f BoxMin(MinBounds);
+	const FVector3f BoxMax(MaxBounds);
+
+	for (const FGridLevel& Level : Levels)
+	{
+		if (Level.VoxelHash.GetNumPoints() == 0)
+		{
+			continue;
+		}
+
+		const bool bCompleted = Level.VoxelHash.ForEachCellInRange(
+			WorldToGrid(MinBounds, Level.CellSize), WorldToGrid(MaxBounds, Level.CellSize),
+			[&Level, &BoxMin, &BoxMax, &Visitor](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+				return Level.VoxelHash.ForEachSpan(CellRef, [&BoxMin, &BoxMax, &Visitor](const FVoxelPointSpan& Span) {
+					for (int32 Lane = 0; Lane < Span.Num; Lane++)
+					{
+						if (Span.X[Lane] >= BoxMin.X && Span.X[Lane] <= BoxMax.X &&
+							Span.Y[Lane] >= BoxMin.Y && Span.Y[Lane] <= BoxMax.Y &&
+							Span.Z[Lane] >= BoxMin.Z && Span.Z[Lane] <= BoxMax.Z &&
+							!Visitor(Span.Ids[Lane], FVector3f(Span.X[Lane], Span.Y[Lane], Span.Z[Lane])))
+						{
+							return false;
+						}
+					}
+					return true;
+				});
+			});
+
+		if (!bCompleted)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<typename VisitorType>
+bool UBitmapPointSpatialIndex::ForEachPointAlongRay(const FVector& Origin, const FVector& Direction, float Tolerance, float MaxDistance, VisitorType&& Visitor) const
+{
+	const FVector NormalizedDirection = Direction.GetSafeNormal();
+	if (NormalizedDirection.IsZero() || MaxDistance < 0.0f)
+	{
+		return true;
+	}
+
+	FBox RayBounds(Origin, Origin);
+	RayBounds += Origin + NormalizedDirection * MaxDistance;
+	NotifyQueryBounds(RayBounds.ExpandBy(Tolerance));
+
+	const float ToleranceSquared = Tolerance * Tolerance;
+
+	for (const FGridLevel& Level : Levels)
+	{
+		if (Level.VoxelHash.GetNumPoints() == 0)
+		{
+			continue;
+		}
+
+		auto VisitCell = [&Level, &Origin, &NormalizedDirection, ToleranceSquared, MaxDistance, &Visitor](const FIntVector& GridPos, const FVoxelCellRef& CellRef) {
+			return Level.VoxelHash.ForEachSpan(CellRef, [&Origin, &NormalizedDirection, ToleranceSquared, MaxDistance, &Visitor](const FVoxelPointSpan& Span) {
+				for (int32 Lane = 0; Lane < Span.Num; Lane++)
+				{
+					// Distance from point to ray
+					const FVector Position(Span.X[Lane], Span.Y[Lane], Span.Z[Lane]);
+					const FVector PointToOrigin = Position - Origin;
+					const float ProjectedDistance = FVector::DotProduct(PointToOrigin, NormalizedDirection);
+
+					if (ProjectedDistance >= 0.0f && ProjectedDistance <= MaxDistance &&
+						FVector::DistSquared(Position, Origin + NormalizedDirection * ProjectedDistance) <= ToleranceSquared &&
+						!Visitor(Span.Ids[Lane], FVector3f(Position)))
+					{
+						return false;
+					}
+				}
+				return true;
+			});
+		};
+
+		// Every cell within tolerance of the ray lies within this many cells of a cell the ray passes through
+		const int32 Reach = FMath::Max(0, FMath::CeilToInt(Tolerance / Level.CellSize));
+
+		FIntVector Cell = WorldToGrid(Origin, Level.CellSize);
+		if (!Level.VoxelHash.ForEachCellInRange(Cell - FIntVector(Reach), Cell + FIntVector(Reach), VisitCell))
+		{
+			return false;
+		}
+
+		// Amanatides-Woo traversal, TMax holds the ray distance to the next cell boundary on each axis
+		FIntVector Step;
+		FVector TMax;
+		FVector TDelta;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			const float DirectionComponent = NormalizedDirection[Axis];
+			if (FMath::IsNearlyZero(DirectionComponent))
+			{
+				Step[Axis] = 0;
+				TMax[Axis] = TNumericLimits<float>::Max();
+				TDelta[Axis] = TNumericLimits<float>::Max();
+				continue;
+			}
+
+			Step[Axis] = DirectionComponent > 0.0f ? 1 : -1;
+			const float Boundary = (Cell[Axis] + (Step[Axis] > 0 ? 1 : 0)) * Level.CellSize;
+			TMax[Axis] = (Boundary - Origin[Axis]) / DirectionComponent;
+			TDelta[Axis] = Level.CellSize / FMath::Abs(DirectionComponent);
+		}
+
+		while (true)
+		{
+			const int32 Axis = TMax.X < TMax.Y ? (TMax.X < TMax.Z ? 0 : 2) : (TMax.Y < TMax.Z ? 1 : 2);
+			if (TMax[Axis] > MaxDistance)
+			{
+				break;
+			}
+
+			Cell[Axis] += Step[Axis];
+			TMax[Axis] += TDelta[Axis];
+
+			// The ray moves monotonically, so only the leading face of the inflated neighbourhood is new
+			FIntVector SlabMin = Cell - FIntVector(Reach);
+			FIntVector SlabMax = Cell + FIntVector(Reach);
+			SlabMin[Axis] = SlabMax[Axis] = Cell[Axis] + Step[Axis] * Reach;
+
+			if (!Level.VoxelHash.ForEachCellInRange(SlabMin, SlabMax, VisitCell))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
@@ -3,9 +3,72 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "BitmapPoint.h"
+#include "BitmapPointColumns.h"
+#include "BitmapPointAgeIndex.h"
 #include "BitmapPointStorage.generated.h"
 
+/**
+ * Describes a single mutation of bitmap point storage
+ * Points are only ever appended, so added points occupy [AddedStart, AddedStart + AddedCount)
+ * in the storage as it was at Version and carry consecutive ids starting at FirstAddedId
+ */
+USTRUCT(BlueprintType)
+struct MRS3DPLUGIN_API FBitmapPointChangeSet
+{
+	GENERATED_BODY()
+
+	/** Storage version after this change was applied */
+	UPROPERTY(BlueprintReadOnly, Category = "Change")
+	int64 Version;
+
+	/** Index of the first added point */
+	UPROPERTY(BlueprintReadOnly, Category = "Change")
+	int32 AddedStart;
+
+	/** Number of added points */
+	UPROPERTY(BlueprintReadOnly, Category = "Change")
+	int32 AddedCount;
+
+	/** Id of the first added point */
+	UPROPERTY(BlueprintReadOnly, Category = "Change")
+	int32 FirstAddedId;
+
+	/** Ids of removed points in ascending order */
+	UPROPERTY(BlueprintReadOnly, Category = "Change")
+	TArray<int32> RemovedIds;
+
+	/** Ids of points whose attributes were overwritten in place, in ascending order */
+	UPROPERTY(BlueprintReadOnly, Category = "Change")
+	TArray<int32> UpdatedIds;
+
+	/** True if every point was removed, RemovedIds is left empty in that case */
+	UPROPERTY(BlueprintReadOnly, Category = "Change")
+	bool bCleared;
+
+	FBitmapPointChangeSet()
+		: Version(0)
+		, AddedStart(0)
+		, AddedCount(0)
+		, FirstAddedId(INDEX_NONE)
+		, bCleared(false)
+	{}
+
+	bool HasRemovals() const { return bCleared || RemovedIds.Num() > 0; }
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBitmapPointsChanged, const TArray<FBitmapPoint>&, BitmapPoints);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBitmapPointsChangeSet, const FBitmapPointChangeSet&, ChangeSet);
+
+/**
+ * Memory layout used by bitmap point storage
+ */
+UENUM(BlueprintType)
+enum class EBitmapPointStorageLayout : uint8
+{
+	ArrayOfStructs UMETA(DisplayName = "Array Of Structs"),
+	StructOfArrays UMETA(DisplayName = "Struct Of Arrays"),
+	ChunkedRing UMETA(DisplayName = "Chunked Ring Buffer")
+};
 
 /**
  * Pure storage component for bitmap points with basic CRUD operations
@@ -20,12 +83,13 @@ public:
 
 	/**
 	 * Add a single bitmap point
+	 * Points are snapped onto the compact lattice, see FBitmapPointQuantizer::Canonicalize
 	 */
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
 	void AddPoint(const FBitmapPoint& Point);
 
 	/**
-	 * Add multiple bitmap points
+	 * Add multiple bitmap points, snapped onto the compact lattice like AddPoint
 	 */
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
 	void AddPoints(const TArray<FBitmapPoint>& Points);
@@ -41,6 +105,36 @@ public:
 	 */
 	int32 RemovePointsWhere(TFunction<bool(const FBitmapPoint&)> Predicate);
 
+	/**
+	 * Remove points by id with a single change notification
+	 * Ids that are no longer stored are ignored
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	int32 RemovePointsById(const TArray<int32>& Ids);
+
+	/**
+	 * Overwrite the attributes of stored points by id with a single change notification
+	 * Ids keep their storage position, ids that are no longer stored are ignored
+	 * @param Points - New attributes, parallel to Ids
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	int32 UpdatePointsById(const TArray<int32>& Ids, const TArray<FBitmapPoint>& Points);
+
+	/**
+	 * Remove points captured before a given time
+	 * Expired ids come from the time-bucketed age index, so no layout scans its timestamps.
+	 * When the expired points are the oldest stored ones they are dropped like RemoveOldestPoints.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	int32 RemovePointsOlderThan(float OldestAllowedTime);
+
+	/**
+	 * Remove the oldest (first inserted) points with a single change notification
+	 * In the ChunkedRing layout this costs O(chunks) instead of shifting the whole store
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	int32 RemoveOldestPoints(int32 Count);
+
 	/**
 	 * Clear all points
 	 */
@@ -49,15 +143,16 @@ public:
 
 	/**
 	 * Get all points (read-only)
+	 * In the StructOfArrays layout this materializes a cached copy on first access after a change
 	 */
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
-	const TArray<FBitmapPoint>& GetAllPoints() const { return BitmapPoints; }
+	const TArray<FBitmapPoint>& GetAllPoints() const;
 
 	/**
 	 * Get point count
 	 */
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
-	int32 GetPointCount() const { return BitmapPoints.Num(); }
+	int32 GetPointCount() const;
 
 	/**
 	 * Get point by index
@@ -69,7 +164,100 @@ public:
 	 * Check if storage is empty
 	 */
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
-	bool IsEmpty() const { return BitmapPoints.Num() == 0; }
+	bool IsEmpty() const { return GetPointCount() == 0; }
+
+	/**
+	 * Get the stable id of a point by index, or INDEX_NONE if the index is invalid
+	 * Ids are assigned in insertion order and never reused
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	int32 GetPointId(int32 Index) const;
+
+	/**
+	 * Find the current index of a point by id, or INDEX_NONE if it has been removed
+	 * Ids are stored in ascending order so this is a binary search
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	int32 FindPointIndex(int32 Id) const;
+
+	/**
+	 * Get a point by id
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	bool GetPointById(int32 Id, FBitmapPoint& OutPoint) const;
+
+	/**
+	 * Get the storage version, incremented once per change set
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	int64 GetVersion() const { return Version; }
+
+	/**
+	 * Collect every change set applied after a given version, oldest first
+	 * @return False if the history no longer reaches back that far and the caller must resync from GetAllPoints
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	bool GetChangesSince(int64 SinceVersion, TArray<FBitmapPointChangeSet>& OutChanges) const;
+
+	/** Number of change sets retained for GetChangesSince */
+	static constexpr int32 MaxChangeHistory = 64;
+
+	/**
+	 * Switch the backing layout, converting any stored points
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	void SetLayout(EBitmapPointStorageLayout NewLayout);
+
+	/**
+	 * Get the backing layout
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
+	EBitmapPointStorageLayout GetLayout() const { return Layout; }
+
+	/**
+	 * Column accessors, only populated in the StructOfArrays layout (see GetChunk for ChunkedRing)
+	 */
+	TConstArrayView<FVector> GetPositions() const { return Columns.Positions; }
+	TConstArrayView<FColor> GetColors() const { return Columns.Colors; }
+	TConstArrayView<float> GetIntensities() const { return Columns.Intensities; }
+	TConstArrayView<float> GetTimestamps() const { return Columns.Timestamps; }
+	TConstArrayView<FVector> GetNormals() const { return Columns.Normals; }
+
+	/**
+	 * Get a field view of a point without copying it (StructOfArrays and ChunkedRing layouts)
+	 */
+	FBitmapPointView GetPointView(int32 Index) const;
+
+	/**
+	 * Visit every stored point once in storage order, walking the layout's arrays directly
+	 * Visitor signature is void(int32 Id, const FBitmapPointView& Point). Unlike GetPoint per index this never
+	 * searches for a ring chunk, so a full scan stays linear in the ChunkedRing layout.
+	 */
+	template<typename VisitorType>
+	void ForEachPoint(VisitorType&& Visitor) const;
+
+	/**
+	 * Visit Count points starting at StartIndex in storage order, same visitor signature as ForEachPoint
+	 * The ring chunk holding StartIndex is located once, the remaining rows are walked directly
+	 */
+	template<typename VisitorType>
+	void ForEachPointInRange(int32 StartIndex, int32 Count, VisitorType&& Visitor) const;
+
+	/**
+	 * Chunk accessors, only populated in the ChunkedRing layout
+	 * Live rows of a chunk start at FBitmapPointChunk::Start
+	 */
+	int32 GetNumChunks() const { return Chunks.Num(); }
+	const FBitmapPointChunk& GetChunk(int32 ChunkIndex) const { return *Chunks[ChunkIndex]; }
+
+	/** Rows per chunk in the ChunkedRing layout */
+	static constexpr int32 RingChunkCapacity = 4096;
+
+	/**
+	 * Collect indices of points within radius of a location
+	 * In the StructOfArrays layout this only streams the position column
+	 */
+	void FindPointIndicesInRadius(const FVector& Center, float Radius, TArray<int32>& OutIndices) const;
 
 	/**
 	 * Reserve storage capacity
@@ -77,6 +265,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
 	void Reserve(int32 Capacity);
 
+	/**
+	 * Copy every stored point out column by column, ids included
+	 * The StructOfArrays and ChunkedRing layouts copy whole column ranges without materializing points
+	 */
+	void ExportColumns(FBitmapPointColumns& OutColumns) const;
+
+	/**
+	 * Append points given as columns with a single change notification, e.g. when restoring a saved session
+	 * Points get fresh consecutive ids, the Ids column is ignored. The StructOfArrays layout appends whole columns.
+	 */
+	void AppendColumns(const FBitmapPointColumns& InColumns);
+
 	/**
 	 * Shrink storage to fit
 	 */
@@ -84,20 +284,170 @@ public:
 	void Shrink();
 
 	/**
-	 * Get memory usage in bytes
+	 * Get memory usage in bytes, including array slack, the point cache and change history
 	 */
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Storage")
 	int32 GetMemoryUsageBytes() const;
 
+	/** Bytes allocated by every container the storage owns */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Free the array-of-structs cache the StructOfArrays and ChunkedRing layouts materialize for GetAllPoints
+	 * The cache is rebuilt on the next GetAllPoints call
+	 * @return Bytes freed
+	 */
+	int32 ReleasePointCache();
+
 	/**
-	 * Event fired when points are added, removed, or cleared
+	 * Event fired with the full point array when points are added, removed, or cleared
+	 * Prefer OnBitmapPointsChangeSet, binding this forces the StructOfArrays and ChunkedRing layouts to materialize every point per change
 	 */
 	UPROPERTY(BlueprintAssignable, Category = "MRS3D|Storage")
 	FOnBitmapPointsChanged OnBitmapPointsChanged;
 
+	/**
+	 * Event fired with only the added and removed points of each change
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "MRS3D|Storage")
+	FOnBitmapPointsChangeSet OnBitmapPointsChangeSet;
+
 protected:
 	UPROPERTY()
-	TArray<FBitmapPoint> BitmapPoints;
+	EBitmapPointStorageLayout Layout;
+
+	/** Point data in the ArrayOfStructs layout, lazily materialized cache in the StructOfArrays layout */
+	UPROPERTY()
+	mutable TArray<FBitmapPoint> BitmapPoints;
+
+	/** Point ids in the ArrayOfStructs layout, parallel to BitmapPoints */
+	TArray<int32> PointIds;
+
+	/** Point data in the StructOfArrays layout */
+	FBitmapPointColumns Columns;
+
+	/** Point data in the ChunkedRing layout, oldest chunk first */
+	TArray<TUniquePtr<FBitmapPointChunk>> Chunks;
+
+	/** Emptied chunks kept for reuse by the ring */
+	TArray<TUniquePtr<FBitmapPointChunk>> FreeChunks;
+
+	/** Live point count across all chunks */
+	int32 RingPointCount;
+
+	/**
+	 * Ring position one past the last live row of each chunk, valid for the first RingValidChunkEnds chunks
+	 * Positions are storage indices offset by RingPositionBase, so dropping points from the front only moves the base
+	 */
+	mutable TArray<int32> RingChunkEnds;
+	mutable int32 RingValidChunkEnds;
+	mutable int32 RingPositionBase;
+
+	/** Whether BitmapPoints needs rebuilding from Columns or Chunks */
+	mutable bool bPointCacheDirty;
+
+	/** Id handed to the next added point */
+	int32 NextPointId;
+
+	/** Current storage version */
+	int64 Version;
+
+	/** Most recent change sets, oldest first */
+	TArray<FBitmapPointChangeSet> ChangeHistory;
+
+	/** Point ids by timestamp bucket, drives RemovePointsOlderThan */
+	FBitmapPointAgeIndex AgeIndex;
+
+	/** Stale entries the age index may hold beyond twice the point count before it is rebuilt */
+	static constexpr int32 AgeIndexSlack = 1024;
+
+	bool IsColumnar() const { return Layout == EBitmapPointStorageLayout::StructOfArrays; }
+	bool IsRing() const { return Layout == EBitmapPointStorageLayout::ChunkedRing; }
+
+	/** Ring helpers */
+	void RingAppend(const FBitmapPoint& Point, int32 Id);
+	bool RingLocate(int32 Index, int32& OutChunk, int32& OutRow) const;
+	bool RingFindId(int32 Id, int32& OutChunk, int32& OutRow) const;
+	int32 RingChunkStartIndex(int32 ChunkIndex) const;
+	void RingUpdateChunkEnds() const;
+	void RingInvalidateChunkEnds(int32 FromChunk) const { RingValidChunkEnds = FMath::Min(RingValidChunkEnds, FromChunk); }
+	int32 RingRemoveAll(TFunctionRef<bool(const FBitmapPointColumns&, int32)> ShouldRemove, TArray<int32>& OutRemovedIds);
+	void RingReleaseChunk(int32 ChunkIndex);
+	void RingReleaseAll();
+
+	/** Remove matching points in the ArrayOfStructs layout, keeping PointIds in step */
+	int32 RemoveAllStructs(TFunctionRef<bool(int32 Index)> ShouldRemove, TArray<int32>& OutRemovedIds);
+
+	/** Copy every stored point into an array-of-structs buffer regardless of layout */
+	void CopyAllPoints(TArray<FBitmapPoint>& OutPoints) const;
+
+	/** Copy every stored point id in storage order regardless of layout */
+	void CopyAllPointIds(TArray<int32>& OutIds) const;
+
+	/** Get the timestamp of a point by index regardless of layout */
+	float GetTimestampAt(int32 Index) const;
+
+	/** Re-add every stored point to an empty age index, dropping stale entries */
+	void RebuildAgeIndex();
+
+	/** Stamp a change with the next version, record it and notify listeners */
+	void CommitChange(FBitmapPointChangeSet& Change);
 
 	void NotifyPointsChanged();
-};
\ No newline at end of file
+};
+
+template<typename VisitorType>
+void UBitmapPointStorage::ForEachPoint(VisitorType&& Visitor) const
+{
+	ForEachPointInRange(0, GetPointCount(), Forward<VisitorType>(Visitor));
+}
+
+template<typename VisitorType>
+void UBitmapPointStorage::ForEachPointInRange(int32 StartIndex, int32 Count, VisitorType&& Visitor) const
+{
+	const int32 EndIndex = FMath::Min(StartIndex + Count, GetPointCount());
+	StartIndex = FMath::Max(StartIndex, 0);
+	if (EndIndex <= StartIndex)
+	{
+		return;
+	}
+
+	if (IsRing())
+	{
+		int32 ChunkIndex = 0;
+		int32 Row = 0;
+		RingLocate(StartIndex, ChunkIndex, Row);
+
+		int32 Remaining = EndIndex - StartIndex;
+		for (; ChunkIndex < Chunks.Num() && Remaining > 0; ChunkIndex++)
+		{
+			const FBitmapPointChunk& Chunk = *Chunks[ChunkIndex];
+			const int32 ChunkEnd = FMath::Min(Chunk.Columns.Num(), Row + Remaining);
+			Remaining -= ChunkEnd - Row;
+			for (; Row < ChunkEnd; Row++)
+			{
+				Visitor(Chunk.Columns.Ids[Row], Chunk.Columns.GetView(Row));
+			}
+
+			if (ChunkIndex + 1 < Chunks.Num())
+			{
+				Row = Chunks[ChunkIndex + 1]->Start;
+			}
+		}
+	}
+	else if (IsColumnar())
+	{
+		for (int32 Index = StartIndex; Index < EndIndex; Index++)
+		{
+			Visitor(Columns.Ids[Index], Columns.GetView(Index));
+		}
+	}
+	else
+	{
+		for (int32 Index = StartIndex; Index < EndIndex; Index++)
+		{
+			const FBitmapPoint& Point = BitmapPoints[Index];
+			Visitor(PointIds[Index], FBitmapPointView(Point.Position, Point.Color, Point.Intensity, Point.Timestamp, Point.Normal));
+		}
+	}
+}
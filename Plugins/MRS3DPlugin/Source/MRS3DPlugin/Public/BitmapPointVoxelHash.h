@@ -0,0 +1,370 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Run of points stored contiguously inside one voxel cell
+ * Positions are split per axis so distance tests can load several lanes at once.
+ * Axis arrays are 16-byte aligned and always hold FBitmapPointVoxelHash::BlockSize lanes, lanes past Num are stale.
+ */
+struct MRS3DPLUGIN_API FVoxelPointSpan
+{
+	const float* X;
+	const float* Y;
+	const float* Z;
+	const int32* Ids;
+	int32 Num;
+
+	/**
+	 * Test every lane against a sphere four lanes at a time
+	 * @return Mask with bit N set when lane N lies within the sphere
+	 */
+	uint32 GetLanesInSphere(const FVector3f& Center, float RadiusSquared) const
+	{
+		const VectorRegister4Float CenterX = VectorSetFloat1(Center.X);
+		const VectorRegister4Float CenterY = VectorSetFloat1(Center.Y);
+		const VectorRegister4Float CenterZ = VectorSetFloat1(Center.Z);
+		const VectorRegister4Float Limit = VectorSetFloat1(RadiusSquared);
+
+		uint32 Mask = 0;
+		for (int32 Lane = 0; Lane < Num; Lane += 4)
+		{
+			const VectorRegister4Float DX = VectorSubtract(VectorLoadAligned(X + Lane), CenterX);
+			const VectorRegister4Float DY = VectorSubtract(VectorLoadAligned(Y + Lane), CenterY);
+			const VectorRegister4Float DZ = VectorSubtract(VectorLoadAligned(Z + Lane), CenterZ);
+			const VectorRegister4Float DistanceSquared = VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX)));
+			Mask |= static_cast<uint32>(VectorMaskBits(VectorCompareLE(DistanceSquared, Limit))) << Lane;
+		}
+
+		// Stale lanes past Num may hold anything
+		return Mask & ((1u << Num) - 1);
+	}
+};
+
+/**
+ * Reference to an occupied cell inside FBitmapPointVoxelHash
+ * Only valid until the hash is next modified
+ */
+struct MRS3DPLUGIN_API FVoxelCellRef
+{
+	int32 Brick;
+	int32 CellBit;
+};
+
+/**
+ * Sparse voxel hash backing the spatial index
+ * Cells are grouped into 4x4x4 bricks found through an open-addressing table keyed by 64-bit Morton codes.
+ * Each brick carries a 64-bit occupancy mask so empty cells are skipped without probing the table,
+ * and cell contents live in fixed-size blocks drawn from a single pooled payload array.
+ */
+class MRS3DPLUGIN_API FBitmapPointVoxelHash
+{
+public:
+	/** Points per payload block */
+	static constexpr int32 BlockSize = 16;
+
+	/** Cells per brick edge */
+	static constexpr int32 BrickEdge = 4;
+
+	/** Largest cell coordinate magnitude per axis, coordinates are clamped to this range */
+	static constexpr int32 MaxCellCoord = (1 << 20) - 1;
+
+	FBitmapPointVoxelHash();
+
+	/** Remove every point and release all memory */
+	void Reset();
+
+	/**
+	 * Add a point to a cell
+	 * @return Payload slot of the point, valid until it is removed or moved by another removal
+	 */
+	int32 Add(const FIntVector& Cell, int32 Id, const FVector3f& Position);
+
+	/**
+	 * Remove the point in a payload slot by moving the last point of the same cell into it
+	 * @return Id of the point now occupying the slot, or INDEX_NONE if nothing moved
+	 */
+	int32 Remove(int32 Slot);
+
+	/** Id stored in a payload slot */
+	int32 GetId(int32 Slot) const { return Blocks[Slot / BlockSize].Ids[Slot % BlockSize]; }
+
+	/** Position stored in a payload slot */
+	FVector3f GetPosition(int32 Slot) const
+	{
+		const FBlock& Block = Blocks[Slot / BlockSize];
+		const int32 Lane = Slot % BlockSize;
+		return FVector3f(Block.X[Lane], Block.Y[Lane], Block.Z[Lane]);
+	}
+
+	int32 GetNumPoints() const { return NumPoints; }
+	int32 GetNumCells() const { return NumCells; }
+	int32 GetNumBricks() const { return NumBricks; }
+
+	/** Find an occupied cell */
+	bool FindCell(const FIntVector& Cell, FVoxelCellRef& OutRef) const;
+
+	/** Number of points in an occupied cell */
+	int32 GetCellPointCount(const FVoxelCellRef& Ref) const { return Bricks[Ref.Brick].Cells[Ref.CellBit].Count; }
+
+	/** Cell coordinate of an occupied cell */
+	FIntVector GetCellCoord(const FVoxelCellRef& Ref) const { return Bricks[Ref.Brick].Coord * BrickEdge + CellBitToOffset(Ref.CellBit); }
+
+	/**
+	 * Visit every occupied cell inside an inclusive cell range
+	 * Visitor signature is bool(const FIntVector& Cell, const FVoxelCellRef& Ref), return false to stop
+	 * @return False if the visitor stopped early
+	 */
+	template<typename VisitorType>
+	bool ForEachCellInRange(const FIntVector& MinCell, const FIntVector& MaxCell, VisitorType&& Visitor) const;
+
+	/** Visit every occupied cell, same visitor signature as ForEachCellInRange */
+	template<typename VisitorType>
+	bool ForEachCell(VisitorType&& Visitor) const;
+
+	/** Visit every occupied cell of one brick, same visitor signature as ForEachCellInRange */
+	template<typename VisitorType>
+	bool ForEachCellInBrick(const FIntVector& BrickCoord, VisitorType&& Visitor) const;
+
+	/**
+	 * Visit the payload spans of an occupied cell
+	 * Visitor signature is bool(const FVoxelPointSpan& Span), return false to stop
+	 * @return False if the visitor stopped early
+	 */
+	template<typename VisitorType>
+	bool ForEachSpan(const FVoxelCellRef& Ref, VisitorType&& Visitor) const;
+
+	/** Bytes allocated by the table, bricks and payload */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Brick containing a cell */
+	static FIntVector CellToBrick(const FIntVector& Cell)
+	{
+		return FIntVector(Cell.X >> 2, Cell.Y >> 2, Cell.Z >> 2);
+	}
+
+	/** Bit of a cell inside its brick occupancy mask */
+	static int32 CellToBit(const FIntVector& Cell)
+	{
+		return (Cell.X & 3) | ((Cell.Y & 3) << 2) | ((Cell.Z & 3) << 4);
+	}
+
+	/** Offset of a cell inside its brick from its occupancy bit */
+	static FIntVector CellBitToOffset(int32 CellBit)
+	{
+		return FIntVector(CellBit & 3, (CellBit >> 2) & 3, (CellBit >> 4) & 3);
+	}
+
+	/** Interleave the bits of three signed coordinates into a 64-bit Morton code */
+	static uint64 EncodeMorton(const FIntVector& Coord);
+
+private:
+	/** Fixed-size payload block, positions split per axis */
+	struct alignas(16) FBlock
+	{
+		float X[BlockSize];
+		float Y[BlockSize];
+		float Z[BlockSize];
+		int32 Ids[BlockSize];
+
+		/** Previous block of the same cell, or INDEX_NONE */
+		int32 Prev;
+
+		/** Owning brick and cell bit */
+		int32 Brick;
+		int32 CellBit;
+	};
+
+	/** Cell contents, every block but the last is full */
+	struct FCell
+	{
+		int32 LastBlock;
+		int32 Count;
+	};
+
+	struct FBrick
+	{
+		FIntVector Coord;
+		uint64 Occupancy;
+		FCell Cells[64];
+	};
+
+	/** Open-addressing table slot, Brick == INDEX_NONE marks an empty slot */
+	struct FTableSlot
+	{
+		uint64 Key;
+		int32 Brick;
+	};
+
+	TArray<FTableSlot> Table;
+	TArray<FBrick> Bricks;
+	TArray<int32> FreeBricks;
+	TArray<FBlock> Blocks;
+	TArray<int32> FreeBlocks;
+
+	int32 NumPoints;
+	int32 NumCells;
+	int32 NumBricks;
+
+	/** Mix a Morton key before masking, nearby keys differ only in low bits */
+	static uint64 HashKey(uint64 Key);
+
+	/** Occupancy bits of the cells of a brick inside an inclusive local range */
+	static uint64 MakeRangeMask(const FIntVector& LocalMin, const FIntVector& LocalMax);
+
+	int32 FindBrick(const FIntVector& BrickCoord) const;
+	int32 FindOrAddBrick(const FIntVector& BrickCoord);
+	void RemoveBrick(int32 BrickIndex);
+	void InsertIntoTable(uint64 Key, int32 BrickIndex);
+	void GrowTable();
+
+	int32 AllocateBlock();
+	void ReleaseBlock(int32 BlockIndex);
+
+	/** Visit the occupied cells of one brick that fall inside an inclusive cell range */
+	template<typename VisitorType>
+	bool VisitBrick(int32 BrickIndex, const FIntVector& MinCell, const FIntVector& MaxCell, VisitorType& Visitor) const;
+};
+
+template<typename VisitorType>
+bool FBitmapPointVoxelHash::VisitBrick(int32 BrickIndex, const FIntVector& MinCell, const FIntVector& MaxCell, VisitorType& Visitor) const
+{
+	const FBrick& Brick = Bricks[BrickIndex];
+	const FIntVector Origin = Brick.Coord * BrickEdge;
+
+	const FIntVector LocalMin(
+		FMath::Max(MinCell.X - Origin.X, 0),
+		FMath::Max(MinCell.Y - Origin.Y, 0),
+		FMath::Max(MinCell.Z - Origin.Z, 0));
+	const FIntVector LocalMax(
+		FMath::Min(MaxCell.X - Origin.X, BrickEdge - 1),
+		FMath::Min(MaxCell.Y - Origin.Y, BrickEdge - 1),
+		FMath::Min(MaxCell.Z - Origin.Z, BrickEdge - 1));
+
+	if (LocalMin.X > LocalMax.X || LocalMin.Y > LocalMax.Y || LocalMin.Z > LocalMax.Z)
+	{
+		return true;
+	}
+
+	uint64 Mask = Brick.Occupancy & MakeRangeMask(LocalMin, LocalMax);
+	while (Mask)
+	{
+		const int32 CellBit = static_cast<int32>(FMath::CountTrailingZeros64(Mask));
+		Mask &= Mask - 1;
+
+		const FVoxelCellRef Ref = { BrickIndex, CellBit };
+		if (!Visitor(Origin + CellBitToOffset(CellBit), Ref))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename VisitorType>
+bool FBitmapPointVoxelHash::ForEachCellInRange(const FIntVector& MinCell, const FIntVector& MaxCell, VisitorType&& Visitor) const
+{
+	if (NumBricks == 0)
+	{
+		return true;
+	}
+
+	const FIntVector MinBrick = CellToBrick(MinCell);
+	const FIntVector MaxBrick = CellToBrick(MaxCell);
+	const int64 RangeBricks = int64(MaxBrick.X - MinBrick.X + 1) * int64(MaxBrick.Y - MinBrick.Y + 1) * int64(MaxBrick.Z - MinBrick.Z + 1);
+
+	// Large ranges over sparse maps are cheaper to answer by walking the live bricks than by probing empty space
+	if (RangeBricks > NumBricks)
+	{
+		for (int32 BrickIndex = 0; BrickIndex < Bricks.Num(); BrickIndex++)
+		{
+			const FIntVector& Coord = Bricks[BrickIndex].Coord;
+			if (Bricks[BrickIndex].Occupancy == 0 ||
+				Coord.X < MinBrick.X || Coord.X > MaxBrick.X ||
+				Coord.Y < MinBrick.Y || Coord.Y > MaxBrick.Y ||
+				Coord.Z < MinBrick.Z || Coord.Z > MaxBrick.Z)
+			{
+				continue;
+			}
+
+			if (!VisitBrick(BrickIndex, MinCell, MaxCell, Visitor))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	for (int32 Z = MinBrick.Z; Z <= MaxBrick.Z; Z++)
+	{
+		for (int32 Y = MinBrick.Y; Y <= MaxBrick.Y; Y++)
+		{
+			for (int32 X = MinBrick.X; X <= MaxBrick.X; X++)
+			{
+				const int32 BrickIndex = FindBrick(FIntVector(X, Y, Z));
+				if (BrickIndex != INDEX_NONE && !VisitBrick(BrickIndex, MinCell, MaxCell, Visitor))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+template<typename VisitorType>
+bool FBitmapPointVoxelHash::ForEachCell(VisitorType&& Visitor) const
+{
+	const FIntVector MinCell(-MaxCellCoord - 1);
+	const FIntVector MaxCell(MaxCellCoord);
+
+	for (int32 BrickIndex = 0; BrickIndex < Bricks.Num(); BrickIndex++)
+	{
+		if (Bricks[BrickIndex].Occupancy != 0 && !VisitBrick(BrickIndex, MinCell, MaxCell, Visitor))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename VisitorType>
+bool FBitmapPointVoxelHash::ForEachCellInBrick(const FIntVector& BrickCoord, VisitorType&& Visitor) const
+{
+	const int32 BrickIndex = FindBrick(BrickCoord);
+	if (BrickIndex == INDEX_NONE)
+	{
+		return true;
+	}
+
+	const FIntVector MinCell = BrickCoord * BrickEdge;
+	return VisitBrick(BrickIndex, MinCell, MinCell + FIntVector(BrickEdge - 1), Visitor);
+}
+
+template<typename VisitorType>
+bool FBitmapPointVoxelHash::ForEachSpan(const FVoxelCellRef& Ref, VisitorType&& Visitor) const
+{
+	const FCell& Cell = Bricks[Ref.Brick].Cells[Ref.CellBit];
+	if (Cell.Count == 0)
+	{
+		return true;
+	}
+
+	// Only the last block of a cell can be partially filled
+	int32 BlockIndex = Cell.LastBlock;
+	int32 Lanes = ((Cell.Count - 1) % BlockSize) + 1;
+
+	while (BlockIndex != INDEX_NONE)
+	{
+		const FBlock& Block = Blocks[BlockIndex];
+		const FVoxelPointSpan Span = { Block.X, Block.Y, Block.Z, Block.Ids, Lanes };
+		if (!Visitor(Span))
+		{
+			return false;
+		}
+
+		BlockIndex = Block.Prev;
+		Lanes = BlockSize;
+	}
+	return true;
+}
\ No newline at end of file
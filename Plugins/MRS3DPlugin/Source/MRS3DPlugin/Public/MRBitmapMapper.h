@@ -7,6 +7,8 @@
 #include "BitmapPointStorage.h"
 #include "BitmapPointMemoryManager.h"
 #include "BitmapPointSpatialIndex.h"
+#include "BitmapPointFusion.h"
+#include "BitmapPointPlaneTracker.h"
 #include "MRTrackingStateManager.h"
 #include "MRBitmapMapper.generated.h"
 
@@ -39,6 +41,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
 	void AddBitmapPoints(const TArray<FBitmapPoint>& Points);
 
+	/**
+	 * Enable or disable fusing incoming points that fall into the same fine voxel into one running-average point
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
+	void SetPointFusionEnabled(bool bEnabled);
+
+	/**
+	 * Set the fusion voxel edge length, points already stored are not re-fused
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
+	void SetPointFusionVoxelSize(float VoxelSize);
+
 	/**
 	 * Clear all bitmap points
 	 */
@@ -51,6 +65,19 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
 	const TArray<FBitmapPoint>& GetBitmapPoints() const;
 
+	/**
+	 * Get the storage version, incremented on every add, remove, or clear
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
+	int64 GetBitmapPointsVersion() const;
+
+	/**
+	 * Get every change applied after a given version, oldest first
+	 * @return False if the change history no longer reaches back that far and the caller must resync from GetBitmapPoints
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
+	bool GetBitmapPointChangesSince(int64 SinceVersion, TArray<FBitmapPointChangeSet>& OutChanges) const;
+
 	/**
 	 * Get bitmap points within a specified radius
 	 */
@@ -87,6 +114,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
 	void SetMaxPointAge(float MaxAgeSeconds);
 
+	/**
+	 * Set which points are evicted first when over the point limit
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
+	void SetEvictionPolicy(EBitmapPointEvictionPolicy Policy);
+
+	/**
+	 * Page points out to disk instead of deleting them when over the point limit
+	 * Queries page chunks back in transparently, disabling pages everything back in
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
+	void SetPagingEnabled(bool bEnabled);
+
+	/**
+	 * Make every paged-out point inside a box resident again, e.g. before meshing that region from GetBitmapPoints
+	 * Spatial index queries do this on their own
+	 * @return Number of points paged in
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
+	int32 PageInRegion(const FBox& Bounds);
+
 	/**
 	 * Remove old bitmap points based on age
 	 */
@@ -99,6 +147,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
 	int32 GetMemoryUsageKB() const;
 
+	/**
+	 * Merge stored points that share a voxel into one averaged point, keeping the oldest id of each voxel
+	 * Used by the memory budget before it falls back to evicting points
+	 * @return Number of points removed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
+	int32 DownsamplePoints(float VoxelSize);
+
 	/**
 	 * Force garbage collection of old points
 	 */
@@ -156,80 +212,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR|Advanced")
 	UMRTrackingStateManager* GetTrackingStateManager() const { return TrackingStateManager; }
 
-	/**
-	 * Event fired when bitmap points are updated
-	 */
-	UPROPERTY(BlueprintAssignable, Category = "MRS3D|MR")
-	FOnBitmapPointsUpdated OnBitmapPointsUpdated;
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	TArray<FBitmapPoint> GetBitmapPointsInRadius(const FVector& Center, float Radius) const;
-
-	/**
-	 * Enable or disable real-time updates
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	void SetRealTimeUpdates(bool bEnabled);
-
-	/**
-	 * Set maximum number of bitmap points to store (0 = unlimited)
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	void SetMaxBitmapPoints(int32 MaxPoints);
-
-	/**
-	 * Set maximum age in seconds for bitmap points (0 = no age limit)
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	void SetMaxPointAge(float MaxAgeSeconds);
-
-	/**
-	 * Remove old bitmap points based on age
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	int32 RemoveOldPoints();
-
-	/**
-	 * Get current memory usage statistics
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	int32 GetMemoryUsageKB() const;
-
-	/**
-	 * Force garbage collection of old points
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	void ForceCleanup();
-
-	/**
-	 * Enable/disable automatic plane detection from point clouds
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	void SetAutoPlaneDetectionEnabled(bool bEnabled);
-
-	/**
-	 * Manually trigger plane detection from current points
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	TArray<FDetectedPlane> DetectPlanesFromCurrentPoints(float PlaneThickness = 0.1f);
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR|Advanced")
+	UBitmapPointFusion* GetPointFusion() const { return PointFusion; }
 
-	/**
-	 * Update AR/MR tracking state
-	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	void UpdateARTrackingState(ETrackingState NewState, float Quality = 1.0f, const FString& LossReason = TEXT(""));
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR|Advanced")
+	UBitmapPointPlaneTracker* GetPlaneTracker() const { return PlaneTracker; }
 
 	/**
-	 * Get current AR/MR tracking state
+	 * Event fired with the full point array when bitmap points are updated
+	 * Prefer OnBitmapPointsChangeSet for anything that runs per update
 	 */
-	UFUNCTION(BlueprintCallable, Category = "MRS3D|MR")
-	ETrackingState GetCurrentTrackingState() const;
+	UPROPERTY(BlueprintAssignable, Category = "MRS3D|MR")
+	FOnBitmapPointsUpdated OnBitmapPointsUpdated;
 
 	/**
-	 * Event fired when bitmap points are updated
+	 * Event fired with the added and removed points of each update
 	 */
 	UPROPERTY(BlueprintAssignable, Category = "MRS3D|MR")
-	FOnBitmapPointsUpdated OnBitmapPointsUpdated;
+	FOnBitmapPointsChangeSet OnBitmapPointsChangeSet;
 
 protected:
 	/** Specialized components following Single Responsibility Principle */
@@ -246,6 +246,14 @@ protected:
 	UPROPERTY()
 	UBitmapPointSpatialIndex* SpatialIndex;
 
+	/** Ingest-time voxel fusion of near-duplicate points */
+	UPROPERTY()
+	UBitmapPointFusion* PointFusion;
+
+	/** Incremental plane refits driven by storage change sets */
+	UPROPERTY()
+	UBitmapPointPlaneTracker* PlaneTracker;
+
 	/** AR/MR tracking state management */
 	UPROPERTY()
 	UMRTrackingStateManager* TrackingStateManager;
@@ -254,6 +262,35 @@ protected:
 	UPROPERTY()
 	bool bRealTimeUpdatesEnabled;
 
+	/** Backing layout for point storage */
+	UPROPERTY(Config)
+	EBitmapPointStorageLayout StorageLayout;
+
+	/** Eviction configuration, forwarded to the memory manager */
+	UPROPERTY(Config)
+	EBitmapPointEvictionPolicy EvictionPolicy;
+
+	/**
+	 * Edge length of the world chunks, shared by the eviction regions, the page store and chunked meshing
+	 * so a chunk is the unit of cleanup, paging and remeshing alike
+	 */
+	UPROPERTY(Config)
+	float ChunkSize;
+
+	/** Page excess points to disk instead of deleting them */
+	UPROPERTY(Config)
+	bool bPagingEnabled;
+
+	/** Point fusion configuration */
+	UPROPERTY(Config)
+	bool bPointFusionEnabled;
+
+	UPROPERTY(Config)
+	float PointFusionVoxelSize;
+
+	UPROPERTY(Config)
+	int32 PointFusionMaxWeight;
+
 	/** Plane detection configuration */
 	UPROPERTY(Config)
 	bool bAutoPlaneDetectionEnabled;
@@ -271,20 +308,32 @@ private:
 	/** Initialize specialized components */
 	void InitializeComponents();
 
+	/** Fuse points into the voxel map, updating fused points in place and storing the rest */
+	void AddFusedPoints(const TArray<FBitmapPoint>& Points);
+
 	/** Handle events from storage component */
 	UFUNCTION()
-	void OnStoragePointsChanged(const TArray<FBitmapPoint>& Points);
+	void OnStoragePointsChanged(const FBitmapPointChangeSet& ChangeSet);
 
 	/** Handle events from memory manager */
 	UFUNCTION()
 	void OnMemoryCleanup(int32 PointsRemoved, int32 MemoryFreedKB);
 
+	UFUNCTION()
+	void OnPointsEvicted(const TArray<int32>& EvictedIds);
+
 	/** Handle events from spatial index */
 	UFUNCTION()
 	void OnSpatialIndexUpdated(int32 AddedPoints, int32 RemovedPoints);
 
+	/** Page in whatever a spatial index query is about to read */
+	void OnSpatialIndexQueried(const FBox& Bounds);
+
+	/** Store and index points read back from the page store */
+	void StorePagedInPoints(const TArray<FBitmapPoint>& Points);
+
 	/** Broadcast update to listeners */
-	void BroadcastUpdate();
+	void BroadcastUpdate(const FBitmapPointChangeSet& ChangeSet);
 
 	/** Perform automatic plane detection if enabled */
 	void PerformAutoPlaneDetection();
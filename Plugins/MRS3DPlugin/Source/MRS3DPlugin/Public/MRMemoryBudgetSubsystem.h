@@ -0,0 +1,174 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "MRMemoryBudgetSubsystem.generated.h"
+
+class UProceduralGenerator;
+
+/**
+ * Memory shedding stages in the order the budget applies them
+ */
+UENUM(BlueprintType)
+enum class EMRMemoryShedStage : uint8
+{
+	None UMETA(DisplayName = "None"),
+	DropCaches UMETA(DisplayName = "Drop Caches"),
+	DropSnapshots UMETA(DisplayName = "Drop Snapshots"),
+	Downsample UMETA(DisplayName = "Downsample Points"),
+	Evict UMETA(DisplayName = "Evict Points")
+};
+
+/**
+ * Allocated memory per plugin component, including array slack
+ */
+USTRUCT(BlueprintType)
+struct FMRS3DPLUGIN_API FMRMemoryReport
+{
+	GENERATED_BODY()
+
+	/** Bitmap point storage, including its point cache and change history */
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 StorageKB;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 SpatialIndexKB;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 PointFusionKB;
+
+	/** Last published spatial index snapshot */
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 IndexSnapshotKB;
+
+	/** Cached points of every registered procedural generator */
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 GeneratorCacheKB;
+
+	/** Tracking-loss recovery snapshots of every registered procedural generator */
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 GeneratorSnapshotKB;
+
+	/** Mesh results held by the mesh generation manager */
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 MeshResultsKB;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 TotalKB;
+
+	/** Configured budget, 0 if unlimited */
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int32 BudgetKB;
+
+	FMRMemoryReport()
+		: StorageKB(0)
+		, SpatialIndexKB(0)
+		, PointFusionKB(0)
+		, IndexSnapshotKB(0)
+		, GeneratorCacheKB(0)
+		, GeneratorSnapshotKB(0)
+		, MeshResultsKB(0)
+		, TotalKB(0)
+		, BudgetKB(0)
+	{}
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMemoryShed, EMRMemoryShedStage, Stage, int32, FreedKB);
+
+/**
+ * Single memory budget authority for the plugin
+ * Accounts the allocated size of storage, spatial index, fusion, snapshots, generator caches and mesh results,
+ * and when the total nears the budget (or the device runs low on physical memory) sheds in priority order:
+ * drop caches, then snapshots, then downsample points, then evict points by the memory manager's eviction policy.
+ */
+UCLASS()
+class FMRS3DPLUGIN_API UMRMemoryBudgetSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UMRMemoryBudgetSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface
+
+	/**
+	 * Get the allocated memory of every accounted component
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	FMRMemoryReport GetMemoryReport() const;
+
+	/**
+	 * Shed memory until the total is back under the target fraction of the budget
+	 * Runs automatically every BudgetCheckInterval seconds
+	 * @return Kilobytes freed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	int32 EnforceBudget();
+
+	/**
+	 * Set the total memory budget in KB (0 = unlimited, only device memory pressure triggers shedding)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	void SetMemoryBudgetKB(int32 BudgetKB);
+
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Memory")
+	int32 GetMemoryBudgetKB() const { return MemoryBudgetKB; }
+
+	/**
+	 * Include a procedural generator's caches in accounting and shedding
+	 */
+	void RegisterGenerator(UProceduralGenerator* Generator);
+	void UnregisterGenerator(UProceduralGenerator* Generator);
+
+	/**
+	 * Event fired after each shedding stage that ran
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "MRS3D|Memory")
+	FOnMemoryShed OnMemoryShed;
+
+protected:
+	/** Total budget in KB, 0 for unlimited */
+	UPROPERTY(Config)
+	int32 MemoryBudgetKB;
+
+	/** Shedding starts once the total exceeds this fraction of the budget */
+	UPROPERTY(Config)
+	float ShedStartFraction;
+
+	/** Shedding stops once the total is back under this fraction of the budget */
+	UPROPERTY(Config)
+	float ShedTargetFraction;
+
+	/** Seconds between automatic budget checks */
+	UPROPERTY(Config)
+	float BudgetCheckInterval;
+
+	/** Voxel edge length points are merged at by the downsample stage */
+	UPROPERTY(Config)
+	float DownsampleVoxelSize;
+
+	/** Shed regardless of the budget when the device has less free physical memory than this, in MB (0 = ignore) */
+	UPROPERTY(Config)
+	int32 MinFreePhysicalMemoryMB;
+
+private:
+	/** Generators whose caches are accounted */
+	TArray<TWeakObjectPtr<UProceduralGenerator>> Generators;
+
+	float TimeSinceBudgetCheck;
+	bool bInitialized;
+
+	/** Whether the device is close to running out of physical memory */
+	bool IsDeviceLowOnMemory() const;
+
+	/** Run one shedding stage */
+	void RunShedStage(EMRMemoryShedStage Stage, int32 ExcessKB);
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Containers/Queue.h"
+#include "MRPointCloudReader.h"
+#include "MRPointCloudImporter.generated.h"
+
+/**
+ * Runnable that decodes a point cloud file into a bounded queue of point blocks
+ * The thread stops reading while MaxQueuedBlocks blocks are waiting, so memory stays bounded by the queue size.
+ */
+class FMRS3DPLUGIN_API FMRPointCloudImportTask : public FRunnable
+{
+public:
+	/**
+	 * @param InReader - Opened reader, owned by the task from here on
+	 * @param InTransform - Transform from scaled file space to world space
+	 * @param InUnitScale - Scale from file units to world units, applied before the transform
+	 */
+	FMRPointCloudImportTask(TUniquePtr<FMRPointCloudReader> InReader, const FTransform& InTransform, float InUnitScale, int32 InBlockSize, int32 InMaxQueuedBlocks);
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
+
+	/** Take the next decoded block, game thread only */
+	bool DequeueBlock(TArray<FBitmapPoint>& OutBlock);
+
+	/** Whether the whole file has been decoded and queued */
+	bool IsReadingFinished() const { return bReadingFinished; }
+
+	/** Whether every decoded block has been taken */
+	bool IsQueueEmpty() const { return QueuedBlocks.GetValue() == 0; }
+
+	int64 GetTotalPoints() const { return TotalPoints; }
+
+private:
+	TUniquePtr<FMRPointCloudReader> Reader;
+	FTransform Transform;
+	float UnitScale;
+	int32 BlockSize;
+	int32 MaxQueuedBlocks;
+	int64 TotalPoints;
+
+	/** Decoded blocks, produced by the worker and consumed by the game thread */
+	TQueue<TArray<FBitmapPoint>, EQueueMode::Spsc> Blocks;
+	FThreadSafeCounter QueuedBlocks;
+
+	TAtomic<bool> bStopRequested;
+	TAtomic<bool> bReadingFinished;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPointCloudImportComplete, const FString&, Filename, int32, PointsImported);
+
+/**
+ * Replays captured PLY or LAS scans through the real mapping pipeline
+ * A background thread decodes the file in fixed-size blocks into a small queue, and every tick the game thread feeds
+ * up to ImportPointsPerSecond worth of points into UMRBitmapMapper::AddBitmapPoints, stamped with the current time
+ * so fusion, eviction and aging treat them like live sensor data.
+ */
+UCLASS()
+class FMRS3DPLUGIN_API UMRPointCloudImporter : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UMRPointCloudImporter();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface
+
+	/**
+	 * Start streaming a point cloud file into the bitmap mapper, stopping any import in progress
+	 * @param Filename - Binary PLY or uncompressed LAS file
+	 * @param Transform - Placement of the scan in the world, applied after ImportUnitScale
+	 * @return False if the file could not be opened or its format is not supported
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Import")
+	bool StartImport(const FString& Filename, const FTransform& Transform);
+
+	/**
+	 * Stop the import in progress, points already fed stay in the mapper
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Import")
+	void StopImport();
+
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Import")
+	bool IsImporting() const { return ImportTask.IsValid(); }
+
+	/**
+	 * Get the fraction of the file fed to the mapper (0.0 to 1.0)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Import")
+	float GetImportProgress() const;
+
+	/**
+	 * Set the feed rate in points per second (0 = as fast as the file decodes)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Import")
+	void SetImportRate(int32 PointsPerSecond);
+
+	/**
+	 * Event fired when an import has fed its last point
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "MRS3D|Import")
+	FOnPointCloudImportComplete OnImportComplete;
+
+protected:
+	/** Points fed to the mapper per second, 0 for unlimited */
+	UPROPERTY(Config)
+	int32 ImportPointsPerSecond;
+
+	/** Points decoded per block */
+	UPROPERTY(Config)
+	int32 ImportBlockSize;
+
+	/** Decoded blocks allowed to wait for the game thread */
+	UPROPERTY(Config)
+	int32 MaxQueuedBlocks;
+
+	/** Scale from file units to world units, 100 for scans in meters */
+	UPROPERTY(Config)
+	float ImportUnitScale;
+
+private:
+	TUniquePtr<FMRPointCloudImportTask> ImportTask;
+	FRunnableThread* ImportThread;
+	FString ImportFilename;
+
+	/** Block being fed and how far into it we are */
+	TArray<FBitmapPoint> CurrentBlock;
+	int32 CurrentBlockOffset;
+
+	/** Points the rate limit allows but that have not been fed yet */
+	float FeedBudget;
+	int64 PointsFed;
+
+	bool bInitialized;
+
+	/** Feed one tick's worth of points */
+	void FeedPoints(float DeltaTime);
+
+	/** Join the worker and drop the import state */
+	void ReleaseImport();
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BitmapPoint.h"
+
+/**
+ * Point cloud file formats the reader understands
+ */
+enum class EMRPointCloudFormat : uint8
+{
+	Unknown,
+	/** Binary little or big endian PLY with a vertex element */
+	PLY,
+	/** Uncompressed LAS 1.0 to 1.4, point data formats 0 to 10 */
+	LAS
+};
+
+/**
+ * Streams points out of a PLY or LAS file in fixed-size blocks
+ * Only one block of raw records is held at a time, so memory stays bounded however large the file is.
+ * Positions are returned in file units with the file's scale and offset applied; the caller transforms them.
+ * Not thread safe, but may be used from any one thread.
+ */
+class MRS3DPLUGIN_API FMRPointCloudReader
+{
+public:
+	FMRPointCloudReader();
+	~FMRPointCloudReader();
+
+	/**
+	 * Open a file and parse its header, the format is detected from the content
+	 * @return False if the file is missing, compressed (LAZ), ASCII, or has no usable position properties
+	 */
+	bool Open(const FString& Filename);
+
+	/** Release the file */
+	void Close();
+
+	/**
+	 * Decode up to MaxPoints points following the last block
+	 * @return Number of points appended to OutPoints, 0 at the end of the file or on a read error
+	 */
+	int32 ReadBlock(int32 MaxPoints, TArray<FBitmapPoint>& OutPoints);
+
+	EMRPointCloudFormat GetFormat() const { return Format; }
+
+	/** Points declared by the header */
+	int64 GetTotalPoints() const { return TotalPoints; }
+
+	/** Points decoded so far */
+	int64 GetPointsRead() const { return PointsRead; }
+
+	bool IsAtEnd() const { return PointsRead >= TotalPoints; }
+
+	/** Whether the file carries per-point colors, white is used otherwise */
+	bool HasColors() const;
+
+	/** Whether the file carries per-point normals, up is used otherwise */
+	bool HasNormals() const;
+
+private:
+	/** Scalar encodings used by either format */
+	enum class EScalarType : uint8
+	{
+		Int8,
+		UInt8,
+		Int16,
+		UInt16,
+		Int32,
+		UInt32,
+		Float32,
+		Float64
+	};
+
+	/** Point field a record property feeds */
+	enum class EPointField : uint8
+	{
+		X, Y, Z,
+		Red, Green, Blue,
+		NormalX, NormalY, NormalZ,
+		Intensity
+	};
+
+	/** Where one field lives inside a record */
+	struct FFieldLayout
+	{
+		EPointField Field;
+		EScalarType Type;
+		int32 Offset;
+	};
+
+	TUniquePtr<FArchive> Reader;
+	EMRPointCloudFormat Format;
+
+	/** Byte size of one point record */
+	int32 RecordStride;
+	bool bBigEndian;
+	TArray<FFieldLayout> Fields;
+
+	/** Scale and offset applied to raw positions (LAS stores scaled integers) */
+	FVector PositionScale;
+	FVector PositionOffset;
+
+	int64 TotalPoints;
+	int64 PointsRead;
+
+	/**
+	 * Range colors are normalized by, 0 to use the range of their scalar type
+	 * LAS declares 16-bit colors but many writers store 8-bit values in them, so LAS files pick the range from the data
+	 */
+	double ColorRange;
+
+	/** Whether ColorRange is still to be picked from the next block holding a non-black color */
+	bool bDetectColorRange;
+
+	/** Raw records of the current block */
+	TArray<uint8> BlockBuffer;
+
+	bool ParsePLYHeader();
+	bool ParseLASHeader();
+
+	bool HasField(EPointField Field) const;
+
+	/** Pick ColorRange from the largest color component among the first Count records of the block buffer */
+	void DetectColorRange(int32 Count);
+
+	/** Range a color component of a given type is normalized by */
+	double GetColorRange(EScalarType Type) const { return ColorRange > 0.0 ? ColorRange : GetNormalizationRange(Type); }
+
+	/** Read a scalar from a record, swapping bytes for big endian files */
+	double ReadScalar(const uint8* Data, EScalarType Type) const;
+
+	/** Largest value of an unsigned integer type, 1 for floats, used to normalize colors and intensity */
+	static double GetNormalizationRange(EScalarType Type);
+
+	static int32 GetScalarSize(EScalarType Type);
+	static bool ParsePLYScalarType(const FString& Name, EScalarType& OutType);
+};
@@ -44,6 +44,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Gameplay")
 	void SimulateARInput(int32 NumPoints, float Radius);
 
+	/**
+	 * Replay a captured PLY or LAS scan through the mapping pipeline, placed at this actor
+	 * Points are streamed in the background at the importer's configured rate
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Gameplay")
+	bool ReplayPointCloudFile(const FString& Filename);
+
 	/**
 	 * Enable/disable AR data reception
 	 */
@@ -254,6 +261,9 @@ protected:
 	int32 CurrentAsyncJobID;
 	bool bAsyncGenerationInProgress;
 
+	/** Time since the last automatic regeneration */
+	float TimeSinceGeneration;
+
 	// AR Tracking Loss Management
 	ETrackingState CurrentTrackingState;
 	float CurrentTrackingQuality;
@@ -263,8 +273,6 @@ protected:
 	FTransform PreLossActorTransform;
 	UMRTrackingStateManager* TrackingStateManager;
 
-	void OnBitmapPointsUpdated(const TArray<FBitmapPoint>& Points);
-	
 	// Plane detection event handlers
 	UFUNCTION()
 	void OnPlaneDetected(const FDetectedPlane& DetectedPlane);
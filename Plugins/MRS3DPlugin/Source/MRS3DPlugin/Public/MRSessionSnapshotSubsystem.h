@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "Async/Future.h"
+#include "MeshGenerationTask.h"
+#include "MRSessionSnapshotSubsystem.generated.h"
+
+class UProceduralGenerator;
+
+/**
+ * Saves and restores a mapping session through binary snapshot files
+ * Points, the spatial index layout, detected planes and each registered generator's mesh go to separate files under
+ * Saved/MRS3D/Session. Points are written as one file per chunk of the index's chunk grid next to a small manifest,
+ * and points paged out to disk as a copy of each page file. A save publishes an index snapshot and copies the changed
+ * page files on the game thread; chunk export, writer buffers and file writes happen on a background thread. Only the
+ * chunks and files whose content changed since the last save are rewritten. Loading maps each file and copies whole columns and buffers out, with no
+ * per-point parsing, then places the points straight into the saved index layout.
+ */
+UCLASS()
+class FMRS3DPLUGIN_API UMRSessionSnapshotSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UMRSessionSnapshotSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface
+
+	/**
+	 * Save the session in the background
+	 * @return False if a previous save is still being written
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Session")
+	bool SaveSnapshot();
+
+	/**
+	 * Replace the current session with the saved one, waiting for any save in flight first
+	 * Meshes of generators that have not registered yet are applied when they register
+	 * @return False if no compatible point snapshot exists
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Session")
+	bool LoadSnapshot();
+
+	/**
+	 * Whether a saved session exists
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Session")
+	bool HasSnapshot() const;
+
+	/**
+	 * Delete the saved session
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Session")
+	void DeleteSnapshot();
+
+	/**
+	 * Whether a save is still being written
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Session")
+	bool IsSaveInProgress() const;
+
+	/**
+	 * Include a procedural generator's mesh in snapshots
+	 */
+	void RegisterGenerator(UProceduralGenerator* Generator);
+	void UnregisterGenerator(UProceduralGenerator* Generator);
+
+protected:
+	/** Save automatically every AutoSaveInterval seconds */
+	UPROPERTY(Config)
+	bool bAutoSaveEnabled;
+
+	/** Seconds between automatic saves */
+	UPROPERTY(Config)
+	float AutoSaveInterval;
+
+	/** Resume the saved session when the game instance starts */
+	UPROPERTY(Config)
+	bool bLoadSnapshotOnStart;
+
+private:
+	/** Generators whose meshes are saved */
+	TArray<TWeakObjectPtr<UProceduralGenerator>> Generators;
+
+	/** Loaded meshes waiting for their generator to register, by snapshot key */
+	TMap<FString, FMeshGenerationResult> PendingMeshes;
+
+	/** Write of the last save, true if every file was written */
+	TFuture<bool> PendingSave;
+
+	/** Chunk grid cursor of the points on disk, 0 if every chunk must be rewritten */
+	int64 SavedChunkCursor;
+
+	/** Chunk size the point files on disk were cut at */
+	float SavedChunkSize;
+
+	/** Page store write stamps of the paged chunks on disk, used to skip unchanged page files */
+	TMap<FIntVector, int64> SavedPagedChunkStamps;
+
+	/** Checksums of the planes and meshes on disk, used to skip unchanged files */
+	uint32 SavedPlanesCrc;
+	TMap<FString, uint32> SavedMeshCrcs;
+
+	float TimeSinceAutoSave;
+	bool bInitialized;
+
+	FString GetSnapshotDirectory() const;
+	FString GetPointsFilename() const;
+	FString GetPointChunkDirectory() const;
+	FString GetPointChunkFilename(const FIntVector& ChunkKey) const;
+	FString GetPagedChunkDirectory() const;
+	FString GetPagedChunkFilename(const FIntVector& ChunkKey) const;
+	FString GetPlanesFilename() const;
+	FString GetMeshFilename(const FString& Key) const;
+
+	/** Block until the save in flight has been written */
+	void WaitForPendingSave();
+
+	bool LoadPoints();
+	bool LoadPlanes();
+	bool LoadMesh(const FString& Filename, FMeshGenerationResult& OutMesh) const;
+};
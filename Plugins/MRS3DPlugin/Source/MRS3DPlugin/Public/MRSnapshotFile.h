@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+
+/**
+ * Versioned binary container for session snapshots
+ * A file is a header, a section table and raw section payloads aligned to 16 bytes. Sections hold plain arrays
+ * (point columns, mesh buffers), so the reader maps the file and copies each array out in one memcpy.
+ */
+namespace MRSnapshotFile
+{
+	/** Build a four character section tag */
+	constexpr uint32 MakeTag(char A, char B, char C, char D)
+	{
+		return static_cast<uint32>(A) | (static_cast<uint32>(B) << 8) | (static_cast<uint32>(C) << 16) | (static_cast<uint32>(D) << 24);
+	}
+
+	/** Bumped whenever the layout of a section changes, older files are then ignored */
+	constexpr uint32 FormatVersion = 1;
+}
+
+/**
+ * Collects sections in memory and writes them out as one snapshot file
+ */
+class MRS3DPLUGIN_API FMRSnapshotWriter
+{
+public:
+	/** @param InKind - Tag identifying what the file holds, checked on load */
+	explicit FMRSnapshotWriter(uint32 InKind);
+
+	/** Add a section holding a copy of raw bytes */
+	void AddSection(uint32 Tag, const void* Data, int64 NumBytes);
+
+	/** Add a section holding a copy of a plain array */
+	template<typename ElementType>
+	void AddArray(uint32 Tag, const TArray<ElementType>& Array)
+	{
+		static_assert(TIsPODType<ElementType>::Value, "Snapshot arrays must be plain data");
+		AddSection(Tag, Array.GetData(), static_cast<int64>(Array.Num()) * sizeof(ElementType));
+	}
+
+	/**
+	 * Write the file, going through a temporary file so a crash never leaves a torn snapshot behind
+	 * Safe to call from any thread
+	 */
+	bool SaveToFile(const FString& Filename) const;
+
+private:
+	struct FSection
+	{
+		uint32 Tag;
+		TArray<uint8> Bytes;
+	};
+
+	uint32 Kind;
+	TArray<FSection> Sections;
+};
+
+/**
+ * Reads a snapshot file through a memory-mapped view
+ */
+class MRS3DPLUGIN_API FMRSnapshotReader
+{
+public:
+	/**
+	 * Map a file and validate its header and section table
+	 * @return False if the file is missing, of another kind, of another format version, or truncated
+	 */
+	bool Open(const FString& Filename, uint32 ExpectedKind);
+
+	/** Get the bytes of a section, empty if absent */
+	TConstArrayView<uint8> GetSection(uint32 Tag) const;
+
+	/**
+	 * Copy a section out as a plain array
+	 * @return False if the section is absent or not a whole number of elements
+	 */
+	template<typename ElementType>
+	bool ReadArray(uint32 Tag, TArray<ElementType>& OutArray) const
+	{
+		static_assert(TIsPODType<ElementType>::Value, "Snapshot arrays must be plain data");
+		const TConstArrayView<uint8> Bytes = GetSection(Tag);
+		if (Bytes.Num() % sizeof(ElementType) != 0 || (Bytes.Num() == 0 && !Sections.Contains(Tag)))
+		{
+			return false;
+		}
+		OutArray.SetNumUninitialized(Bytes.Num() / sizeof(ElementType));
+		FMemory::Memcpy(OutArray.GetData(), Bytes.GetData(), Bytes.Num());
+		return true;
+	}
+
+private:
+	/** Declared before the region so the region is unmapped first */
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** Offset and size of each section */
+	TMap<uint32, TPair<int64, int64>> Sections;
+};
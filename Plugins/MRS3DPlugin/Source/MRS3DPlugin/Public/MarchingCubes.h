@@ -4,6 +4,8 @@
 #include "BitmapPoint.h"
 #include "MarchingCubes.generated.h"
 
+class FBitmapPointSnapshot;
+
 /**
  * Marching cubes configuration structure
  */
@@ -31,14 +33,25 @@ struct FMRS3DPLUGIN_API FMarchingCubesConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MarchingCubes")
 	FIntVector GridResolution;
 
-	/** Smoothing factor for generated mesh */
+	/** Smoothing factor for generated mesh, no longer used since smooth normals come from welded vertices */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MarchingCubes")
 	float SmoothingFactor;
 
-	/** Enable normal smoothing */
+	/**
+	 * Enable normal smoothing
+	 * Edge vertices are welded and their normals averaged over the faces around them. Otherwise every triangle
+	 * keeps its own flat shaded vertices.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MarchingCubes")
 	bool bSmoothNormals;
 
+	/**
+	 * Only voxelize and polygonize the bricks within the density kernel of a point
+	 * Produces the same surface as the dense grid at a cost that follows the scanned surface instead of the grid volume
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MarchingCubes")
+	bool bSparseVoxelization;
+
 	FMarchingCubesConfig()
 		: VoxelSize(10.0f)
 		, IsoValue(0.5f)
@@ -47,6 +60,7 @@ struct FMRS3DPLUGIN_API FMarchingCubesConfig
 		, GridResolution(FIntVector(100, 100, 100))
 		, SmoothingFactor(0.5f)
 		, bSmoothNormals(true)
+		, bSparseVoxelization(true)
 	{}
 };
 
@@ -75,6 +89,61 @@ struct FMRS3DPLUGIN_API FVoxel
 	{}
 };
 
+/**
+ * Narrow-band voxel grid for marching cubes
+ * Samples are grouped into bricks of BrickEdge^3 and only bricks reached by the density kernel of a point are
+ * allocated. Every other sample has zero density, so it is produced on demand at its grid position.
+ */
+struct FMRS3DPLUGIN_API FMCSparseVoxelGrid
+{
+	static constexpr int32 BrickEdge = 8;
+	static constexpr int32 BrickVoxels = BrickEdge * BrickEdge * BrickEdge;
+
+	/** Samples along each axis of the full grid */
+	FIntVector Resolution;
+	FVector GridMin;
+	FVector VoxelSpacing;
+
+	/** Coordinates of the allocated bricks, brick N owns Voxels[N * BrickVoxels, (N + 1) * BrickVoxels) */
+	TArray<FIntVector> BrickCoords;
+	TArray<FVoxel> Voxels;
+	TMap<FIntVector, int32> BrickLookup;
+
+	FMCSparseVoxelGrid()
+		: Resolution(FIntVector::ZeroValue)
+		, GridMin(FVector::ZeroVector)
+		, VoxelSpacing(FVector::OneVector)
+	{}
+
+	/** Take the grid layout from a config and drop every brick */
+	void Init(const FMarchingCubesConfig& Config);
+
+	/** Allocate a brick with its samples placed at their grid positions, returning its index */
+	int32 FindOrAddBrick(const FIntVector& Brick);
+
+	/** World position of a sample */
+	FVector GetSamplePosition(int32 X, int32 Y, int32 Z) const
+	{
+		return GridMin + FVector(X * VoxelSpacing.X, Y * VoxelSpacing.Y, Z * VoxelSpacing.Z);
+	}
+
+	/** Index of a sample within its brick */
+	static int32 GetLocalIndex(int32 LocalX, int32 LocalY, int32 LocalZ)
+	{
+		return (LocalZ * BrickEdge + LocalY) * BrickEdge + LocalX;
+	}
+
+	/** Sample at grid coordinates, an empty sample at its position when its brick is not allocated */
+	FVoxel GetVoxel(int32 X, int32 Y, int32 Z) const;
+
+	int32 GetNumBricks() const { return BrickCoords.Num(); }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return BrickCoords.GetAllocatedSize() + Voxels.GetAllocatedSize() + BrickLookup.GetAllocatedSize();
+	}
+};
+
 /**
  * Marching cubes triangle structure
  */
@@ -97,6 +166,23 @@ struct FMRS3DPLUGIN_API FMCTriangle
 	}
 };
 
+/**
+ * Indexed marching cubes output
+ * With smooth normals every surface crossing of a grid edge is a single vertex shared by all triangles around it
+ */
+struct FMRS3DPLUGIN_API FMCMesh
+{
+	TArray<FVector> Vertices;
+	TArray<FVector> Normals;
+	TArray<FColor> Colors;
+	TArray<FVector2D> UVs;
+
+	/** Three vertex indices per triangle */
+	TArray<int32> Indices;
+
+	int32 GetNumTriangles() const { return Indices.Num() / 3; }
+};
+
 /**
  * Marching cubes algorithm implementation
  */
@@ -107,20 +193,54 @@ public:
 	~FMarchingCubesGenerator();
 
 	/**
-	 * Generate mesh from bitmap points using marching cubes
+	 * Generate an indexed mesh from bitmap points using marching cubes
+	 */
+	FMCMesh GenerateMeshFromBitmapPoints(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config);
+
+	/**
+	 * Generate mesh from bitmap points using marching cubes, expanded to three vertices per triangle
 	 */
 	TArray<FMCTriangle> GenerateFromBitmapPoints(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config);
 
 	/**
-	 * Generate mesh from voxel grid
+	 * Generate an indexed mesh from voxel grid
+	 * Z slabs are polygonized in parallel into per-task buffers that are joined once every slab is done
+	 */
+	FMCMesh GenerateMeshFromVoxelGrid(const TArray<FVoxel>& VoxelGrid, const FMarchingCubesConfig& Config);
+
+	/**
+	 * Generate mesh from voxel grid, expanded to three vertices per triangle
 	 */
 	TArray<FMCTriangle> GenerateFromVoxelGrid(const TArray<FVoxel>& VoxelGrid, const FMarchingCubesConfig& Config);
 
 	/**
 	 * Create voxel grid from bitmap points
+	 * Each point scatters its quadratic falloff kernel into the voxels it overlaps, which also collect the
+	 * kernel-weighted average color and normal of their points
 	 */
 	TArray<FVoxel> CreateVoxelGrid(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config);
 
+	/**
+	 * Create a narrow-band voxel grid holding only the bricks within the density kernel of a point
+	 */
+	FMCSparseVoxelGrid CreateSparseVoxelGrid(const TArray<FBitmapPoint>& Points, const FMarchingCubesConfig& Config);
+
+	/**
+	 * Generate an indexed mesh from the allocated bricks of a narrow-band voxel grid
+	 */
+	FMCMesh GenerateMeshFromSparseVoxelGrid(const FMCSparseVoxelGrid& VoxelGrid, const FMarchingCubesConfig& Config);
+
+	/**
+	 * Generate an indexed mesh straight from a spatial index snapshot
+	 * Points are splatted as their pages are decoded, so no flat copy of the snapshot is made
+	 */
+	FMCMesh GenerateMeshFromSnapshot(const FBitmapPointSnapshot& Snapshot, const FMarchingCubesConfig& Config);
+
+	/**
+	 * Expand an indexed mesh to independent triangles
+	 */
+	static TArray<FMCTriangle> ExpandToTriangles(const FMCMesh& Mesh);
+
 	/**
 	 * Get marching cubes lookup tables
 	 */
@@ -128,30 +248,47 @@ public:
 	static const int32 TriTable[256][16];
 
 private:
+	/** Mesh polygonized by one parallel task, with the grid edges its vertices lie on */
+	struct FMeshPart;
+
 	/**
-	 * Process a single cube in the marching cubes algorithm
+	 * Splat points into a dense or narrow-band voxel grid
+	 * ForEachPoint is called once with a callback taking const FBitmapPoint&, and passes it every point to splat
 	 */
-	TArray<FMCTriangle> ProcessCube(const FVoxel Cube[8], const FMarchingCubesConfig& Config);
+	template<typename PointSourceType>
+	TArray<FVoxel> SplatVoxelGrid(PointSourceType&& ForEachPoint, const FMarchingCubesConfig& Config);
+
+	template<typename PointSourceType>
+	FMCSparseVoxelGrid SplatSparseVoxelGrid(PointSourceType&& ForEachPoint, const FMarchingCubesConfig& Config);
 
 	/**
-	 * Interpolate vertex position along an edge
+	 * Process a single cube in the marching cubes algorithm, appending its triangles to a task's mesh part
+	 * Crossings of edges already visited by the part reuse their vertex. Touches no generator state, so workers
+	 * may process cubes concurrently.
+	 * @param Cell - Grid coordinates of the cube's minimum corner
 	 */
-	FVector InterpolateVertex(const FVoxel& V1, const FVoxel& V2, float IsoValue);
+	void ProcessCube(const FVoxel Cube[8], const FIntVector& Cell, const FIntVector& GridResolution, const FMarchingCubesConfig& Config, FMeshPart& Part);
 
 	/**
-	 * Interpolate vertex color along an edge
+	 * Join the parts of every task into one mesh, welding vertices on the grid edges parts share
+	 * Vertices are numbered in one serial pass, the data is then copied in parallel
 	 */
-	FColor InterpolateColor(const FVoxel& V1, const FVoxel& V2, float IsoValue);
+	static void MergeMeshParts(TArray<FMeshPart>& Parts, bool bWeldVertices, FMCMesh& OutMesh);
+
+	/**
+	 * Set every vertex normal to the area-weighted average of the faces around it
+	 */
+	static void ComputeWeldedNormals(FMCMesh& Mesh);
 
 	/**
-	 * Calculate normal vector for a vertex
+	 * Interpolate vertex position along an edge
 	 */
-	FVector CalculateNormal(const FVector& Position, const TArray<FVoxel>& VoxelGrid, const FMarchingCubesConfig& Config);
+	FVector InterpolateVertex(const FVoxel& V1, const FVoxel& V2, float IsoValue);
 
 	/**
-	 * Calculate density value at a position from bitmap points
+	 * Interpolate vertex color along an edge
 	 */
-	float CalculateDensity(const FVector& Position, const TArray<FBitmapPoint>& Points, float Radius = 50.0f);
+	FColor InterpolateColor(const FVoxel& V1, const FVoxel& V2, float IsoValue);
 
 	/**
 	 * Get voxel index from 3D coordinates
@@ -162,9 +299,4 @@ private:
 	 * Get voxel from grid by coordinates
 	 */
 	FVoxel GetVoxel(int32 X, int32 Y, int32 Z, const TArray<FVoxel>& VoxelGrid, const FIntVector& GridResolution);
-
-	/**
-	 * Smooth normals across the mesh
-	 */
-	void SmoothNormals(TArray<FMCTriangle>& Triangles, float SmoothingFactor);
-};
\ No newline at end of file
+};
@@ -88,6 +88,19 @@ public:
 		const FOnMeshGenerationComplete& CompletionCallback = FOnMeshGenerationComplete()
 	);
 
+	/**
+	 * Submit a mesh generation job that reads from a spatial index snapshot
+	 * The game thread does not copy any points, marching cubes jobs voxelize straight from the snapshot pages
+	 * @return Job ID for tracking, or -1 if failed to submit
+	 */
+	int32 SubmitSnapshotMeshGenerationJob(
+		const FBitmapPointSnapshotRef& Snapshot,
+		EMeshGenerationTaskType TaskType,
+		const FMarchingCubesConfig& MarchingCubesConfig = FMarchingCubesConfig(),
+		float VoxelSize = 10.0f,
+		const FOnMeshGenerationComplete& CompletionCallback = FOnMeshGenerationComplete()
+	);
+
 	/**
 	 * Cancel a mesh generation job
 	 */
@@ -142,6 +155,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|MeshGeneration")
 	int32 GetTotalMemoryUsageKB() const;
 
+	/**
+	 * Drop every completed job and its result now instead of waiting for the cleanup delay
+	 * @return Kilobytes of mesh results freed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|MeshGeneration")
+	int32 ReleaseCompletedResults();
+
 	/**
 	 * Set automatic cleanup of completed jobs
 	 */
@@ -217,6 +237,9 @@ private:
 	/** Generate unique job ID */
 	int32 GenerateJobID();
 
+	/** Wrap a created task in a job and start its thread */
+	int32 StartJob(const TSharedPtr<FMeshGenerationTask>& Task, EMeshGenerationTaskType TaskType, int32 PointCount, const FOnMeshGenerationComplete& CompletionCallback);
+
 	/** Handle job completion */
 	void OnJobCompleted(int32 JobID, bool bSuccess, const FMeshGenerationResult& Result);
 
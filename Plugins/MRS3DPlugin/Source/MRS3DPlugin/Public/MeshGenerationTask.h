@@ -4,6 +4,7 @@
 #include "HAL/Runnable.h"
 #include "HAL/RunnableThread.h"
 #include "BitmapPoint.h"
+#include "BitmapPointSnapshot.h"
 #include "MarchingCubes.h"
 #include "ProceduralMeshComponent.h"
 #include "MeshGenerationTask.generated.h"
@@ -90,6 +91,14 @@ public:
 		float InVoxelSize = 10.0f
 	);
 
+	/** Generate from a spatial index snapshot, marching cubes reads its pages directly and the other types flatten it on the worker thread */
+	FMeshGenerationTask(
+		const FBitmapPointSnapshotRef& InSnapshot,
+		EMeshGenerationTaskType InTaskType,
+		const FMarchingCubesConfig& InMarchingCubesConfig = FMarchingCubesConfig(),
+		float InVoxelSize = 10.0f
+	);
+
 	virtual ~FMeshGenerationTask();
 
 	//~ Begin FRunnable Interface
@@ -120,6 +129,7 @@ public:
 private:
 	/** Input data */
 	TArray<FBitmapPoint> Points;
+	TSharedPtr<const FBitmapPointSnapshot, ESPMode::ThreadSafe> Snapshot;
 	EMeshGenerationTaskType TaskType;
 	FMarchingCubesConfig MarchingCubesConfig;
 	float VoxelSize;
@@ -9,6 +9,7 @@
 #include "ProceduralGenerator.generated.h"
 
 class UMeshGenerationManager;
+class UMRBitmapMapper;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAsyncMeshGenerationComplete, bool, bSuccess, int32, JobID);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAsyncMeshProgress, int32, JobID, float, Progress);
@@ -40,6 +41,7 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:	
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
@@ -56,6 +58,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Procedural")
 	void UpdateGeometry(const TArray<FBitmapPoint>& Points);
 
+	/**
+	 * Bring the geometry up to date with the mapper's points, doing nothing if they have not changed
+	 * Chunked marching cubes only remeshes the chunks changed since the last update, other generation types rebuild
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Procedural")
+	void UpdateFromMapper(UMRBitmapMapper* Mapper);
+
+	/**
+	 * Page in the region a whole-cloud job meshes, once ahead of acquiring its snapshot
+	 * Marching cubes meshes its grid bounds, other generation types have no bounds and mesh whatever is resident
+	 * @return Number of points paged in
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Procedural")
+	int32 PageInMeshBounds(UMRBitmapMapper* Mapper);
+
 	/**
 	 * Clear all generated geometry
 	 */
@@ -74,12 +91,48 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Procedural")
 	int32 GetCachedPointsMemoryKB() const;
 
+	/**
+	 * Get memory held by the pre-loss geometry snapshot in KB
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Procedural")
+	int32 GetPreLossSnapshotMemoryKB() const;
+
+	/**
+	 * Drop the cached points without touching generated geometry
+	 * @return Kilobytes freed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Procedural")
+	int32 ReleaseCachedPoints();
+
+	/**
+	 * Drop the points kept for recovering from tracking loss, recovery then waits for fresh mapper points
+	 * @return Kilobytes freed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|Procedural")
+	int32 ReleasePreLossSnapshot();
+
 	/**
 	 * Force cleanup of cached geometry and points
 	 */
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|Procedural")
 	void ForceMemoryCleanup();
 
+	/**
+	 * Name this generator's mesh is saved under in session snapshots, stable across runs for placed actors
+	 */
+	FString GetSnapshotKey() const;
+
+	/**
+	 * Copy the generated mesh sections out for a session snapshot, merged into one mesh
+	 * @return False if nothing has been generated
+	 */
+	bool CaptureMeshSnapshot(FMeshGenerationResult& OutMesh) const;
+
+	/**
+	 * Show a mesh restored from a session snapshot until the next generation replaces it
+	 */
+	void ApplyMeshSnapshot(const FMeshGenerationResult& Mesh);
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MRS3D|Procedural")
 	EProceduralGenerationType GenerationType;
 
@@ -99,6 +152,17 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MRS3D|MarchingCubes")
 	FMarchingCubesConfig MarchingCubesConfig;
 
+	/**
+	 * Mesh marching cubes per world chunk, one mesh section each
+	 * Only chunks whose points changed are remeshed, so an update costs the area that changed rather than the area mapped
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MRS3D|MarchingCubes")
+	bool bChunkedMeshing;
+
+	/** Most chunks remeshed per update, the rest wait for the following updates */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MRS3D|MarchingCubes")
+	int32 MaxChunksPerUpdate;
+
 	// Worker Thread Configuration
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MRS3D|AsyncGeneration")
 	int32 AsyncGenerationThreshold;
@@ -162,6 +226,7 @@ public:
 
 	/**
 	 * Generate mesh asynchronously using worker threads for large datasets
+	 * The points are copied into the job, the mapper's own points go through GenerateAsyncFromSnapshot instead
 	 * @param Points - Input bitmap points
 	 * @param bForceAsync - Force async generation even for small datasets
 	 * @return Job ID for tracking, or -1 if generated synchronously
@@ -169,6 +234,22 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MRS3D|AsyncGeneration")
 	int32 GenerateAsyncFromBitmapPoints(const TArray<FBitmapPoint>& Points, bool bForceAsync = false);
 
+	/**
+	 * Generate mesh asynchronously from a spatial index snapshot
+	 * The job shares the snapshot instead of copying the points, marching cubes voxelizes straight from its pages
+	 * @param Snapshot - Snapshot acquired on the game thread, e.g. from the mapper's spatial index
+	 * @param bForceAsync - Force async generation even for small datasets
+	 * @return Job ID for tracking, or -1 if no job was started
+	 */
+	int32 GenerateAsyncFromSnapshot(const FBitmapPointSnapshotRef& Snapshot, bool bForceAsync = false);
+
+	/**
+	 * Check whether a cloud of this size would be generated asynchronously
+	 * Acquiring a snapshot publishes dirty index pages, so callers check this first and only acquire one it will be used
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MRS3D|AsyncGeneration")
+	bool WillGenerateAsync(int32 PointCount, bool bForceAsync = false) const;
+
 	/**
 	 * Cancel an active async generation job
 	 */
@@ -253,6 +334,25 @@ protected:
 
 	float TimeSinceLastUpdate;
 
+	/** Mapper point version the current geometry was generated from */
+	int64 GeneratedPointsVersion;
+
+	// Chunked meshing state
+	/** Mesh section showing each meshed chunk */
+	TMap<FIntVector, int32> ChunkMeshSections;
+
+	/** Sections of emptied chunks, reused before new ones are added */
+	TArray<int32> FreeMeshSections;
+
+	/** Changed chunks not yet remeshed */
+	TSet<FIntVector> PendingChunks;
+
+	/** Chunk grid cursor the pending chunks were collected up to */
+	int64 ChunkCursor;
+
+	/** Chunk size the current sections were meshed with, 0 while chunked meshing is inactive */
+	float MeshedChunkSize;
+
 	// Worker thread management
 	UPROPERTY()
 	UMeshGenerationManager* MeshGenerationManager;
@@ -277,7 +377,16 @@ protected:
 	void GenerateMarchingCubesInternal(const TArray<FBitmapPoint>& Points);
 	
 	void CreateProceduralMeshIfNeeded();
-	void ConvertMCTrianglesToMesh(const TArray<FMCTriangle>& MCTriangles);
+	void ConvertMCMeshToSection(const FMCMesh& MCMesh, int32 SectionIndex = 0);
+
+	/** Remesh the changed chunks of the mapper, bounded by MaxChunksPerUpdate */
+	void UpdateChunkedMarchingCubes(UMRBitmapMapper* Mapper);
+
+	/** Run marching cubes over one chunk and replace its mesh section */
+	void GenerateChunkMarchingCubes(UMRBitmapMapper* Mapper, const FIntVector& ChunkKey);
+
+	/** Drop every per-chunk section, the next update remeshes every chunk */
+	void ResetChunkedMeshing();
 
 	// Async generation support
 	bool ShouldUseAsyncGeneration(int32 PointCount) const;